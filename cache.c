@@ -22,6 +22,13 @@ static int  cache_check(int ix, int i);
 static int  cache_isbusy(int ix, int i);
 static int  cache_isempty(int ix, int i);
 static void cache_allocbuf(int ix, int i, int len);
+static int  cache_hash(int ix, U64 key);
+static void cache_hash_insert(int ix, int i);
+static void cache_hash_remove(int ix, int i);
+static void cache_lru_unlink(int ix, int i);
+static void cache_lru_head(int ix, int i);
+static void cache_lru_tail(int ix, int i);
+static int  cache_lru_steal(int ix, int s);
 
 DISABLE_GCC_UNUSED_FUNCTION_WARNING;
 
@@ -33,6 +40,21 @@ static CACHEBLK  cacheblk[ CACHE_MAX_INDEX ] = {0};
 #define OBTAIN_GLOBAL_CACHE_LOCK()   obtain_lock(  &sysblk.dasdcache_lock )
 #define RELEASE_GLOBAL_CACHE_LOCK()  release_lock( &sysblk.dasdcache_lock )
 
+/* Shard that a key or an entry belongs to */
+#define KEY_SHARD(_ix, _key) \
+  (cache_hash((_ix), (_key)) >> (cacheblk[(_ix)].hashbits - cacheblk[(_ix)].shardbits))
+#define ENTRY_SHARD(_ix, _i) \
+  ((_i) / cacheblk[(_ix)].shardnbr)
+
+/* Sum a shard statistic over all shards of a cache */
+#define CACHE_SUM(_ix, _field, _sum)                                  \
+  do {                                                               \
+    int _s;                                                          \
+    (_sum) = 0;                                                      \
+    for (_s = 0; _s < cacheblk[(_ix)].shards; _s++)                  \
+      (_sum) += cacheblk[(_ix)].shard[_s]._field;                    \
+  } while (0)
+
 /*-------------------------------------------------------------------*/
 /* Public functions                                                  */
 /*-------------------------------------------------------------------*/
@@ -45,114 +67,112 @@ int cache_nbr (int ix)
 
 int cache_busy (int ix)
 {
+    int n;
     if (cache_check_ix(ix)) return -1;
-    return cacheblk[ix].busy;
+    CACHE_SUM(ix, busy, n);
+    return n;
 }
 
 int cache_empty (int ix)
 {
+    int n;
     if (cache_check_ix(ix)) return -1;
-    return cacheblk[ix].empty;
+    CACHE_SUM(ix, empty, n);
+    return n;
 }
 
 int cache_waiters (int ix)
 {
+    int n;
     if (cache_check_ix(ix)) return -1;
-    return cacheblk[ix].waiters;
+    CACHE_SUM(ix, waiters, n);
+    return n;
 }
 
 S64 cache_size (int ix)
 {
+    S64 n;
     if (cache_check_ix(ix)) return -1;
-    return cacheblk[ix].size;
+    CACHE_SUM(ix, size, n);
+    return n;
 }
 
 S64 cache_hits (int ix)
 {
+    S64 n;
     if (cache_check_ix(ix)) return -1;
-    return cacheblk[ix].hits;
+    CACHE_SUM(ix, hits, n);
+    return n;
 }
 
 S64 cache_misses (int ix)
 {
+    S64 n;
     if (cache_check_ix(ix)) return -1;
-    return cacheblk[ix].misses;
+    CACHE_SUM(ix, misses, n);
+    return n;
 }
 
 int cache_busy_percent (int ix)
 {
     if (cache_check_ix(ix)) return -1;
-    return (cacheblk[ix].busy * 100) / cacheblk[ix].nbr;
+    return (cache_busy(ix) * 100) / cacheblk[ix].nbr;
 }
 
 int cache_empty_percent (int ix)
 {
     if (cache_check_ix(ix)) return -1;
-    return (cacheblk[ix].empty * 100) / cacheblk[ix].nbr;
+    return (cache_empty(ix) * 100) / cacheblk[ix].nbr;
 }
 
 int cache_hit_percent (int ix)
 {
-    S64 total;
+    S64 hits, total;
     if (cache_check_ix(ix)) return -1;
-    total = cacheblk[ix].hits + cacheblk[ix].misses;
+    hits = cache_hits(ix);
+    total = hits + cache_misses(ix);
     if (total == 0) return -1;
-    return (int)((cacheblk[ix].hits * 100) / total);
+    return (int)((hits * 100) / total);
 }
 
 int cache_lookup (int ix, U64 key, int *oldest_entry)
 {
-    int i,p;
+    CACHESHARD *shard;
+    int i, s, n = 0;
 
     if (oldest_entry)
         *oldest_entry = -1;
     if (cache_check_ix(ix))
         return -1;
-    /* `p' is the preferred index */
-    p = (int)(key % cacheblk[ix].nbr);
 
-    if (cacheblk[ix].cache[p].key == key)
-    {
-        i = p;
-        if (!cache_isempty(ix, i))
-        {
-            cacheblk[ix].fasthits++;
-        }
-    }
-    else
-    {
-        if (cache_isbusy(ix, p) || cacheblk[ix].age - cacheblk[ix].cache[p].age < 20)
-            p = -2;
-        for (i = 0; i < cacheblk[ix].nbr; i++)
-        {
-            if (cacheblk[ix].cache[i].key == key) break;
-            if (oldest_entry && !cache_isbusy(ix, i)
-             && (*oldest_entry < 0 || i == p || cacheblk[ix].cache[i].age < cacheblk[ix].cache[*oldest_entry].age))
-                if (*oldest_entry != p) *oldest_entry = i;
-        }
-    }
+    s = KEY_SHARD(ix, key);
+    shard = &cacheblk[ix].shard[s];
 
-    if (i >= cacheblk[ix].nbr)
-    {
-        i = -1;
-    }
-    else if ( i >= 0 && cache_isempty(ix, i) )
+    /* Search the hash chain for the key */
+    for (i = cacheblk[ix].hash[cache_hash(ix, key)];
+         i >= 0; i = cacheblk[ix].cache[i].hnext)
     {
-        if ( oldest_entry && *oldest_entry < 0 )
-        {
-            *oldest_entry = i;
-        }
-        i = -1;
+        n++;
+        if (cacheblk[ix].cache[i].key == key)
+            break;
     }
-    if ( i >= 0 )
-    {
-        cacheblk[ix].hits++;
-    }
-    else
+
+    shard->probes += n;
+    if (n > shard->maxprobe)
+        shard->maxprobe = n;
+
+    if (i >= 0)
     {
-        cacheblk[ix].misses++;
+        shard->hits++;
+        if (n == 1)
+            shard->fasthits++;
+        return i;
     }
-    return i;
+
+    shard->misses++;
+    if (oldest_entry)
+        *oldest_entry = cache_lru_steal(ix, s);
+    return -1;
 }
 
 int cache_scan (int ix, CACHE_SCAN_RTN rtn, void *data)
@@ -171,27 +191,62 @@ int      answer = -1;                   /* Answer from routine       */
 
 int cache_lock(int ix)
 {
+    int s;
     if (cache_check_cache(ix)) return -1;
-    obtain_lock(&cacheblk[ix].lock);
+    for (s = 0; s < cacheblk[ix].shards; s++)
+        obtain_lock(&cacheblk[ix].shard[s].lock);
     return 0;
 }
 
 int cache_unlock(int ix)
 {
+    int s;
     if (cache_check_ix(ix)) return -1;
-    release_lock(&cacheblk[ix].lock);
-    if (cacheblk[ix].empty == cacheblk[ix].nbr)
+    for (s = cacheblk[ix].shards - 1; s >= 0; s--)
+        release_lock(&cacheblk[ix].shard[s].lock);
+    if (cache_empty(ix) == cacheblk[ix].nbr)
         cache_destroy(ix);
     return 0;
 }
 
-int cache_wait(int ix)
+int cache_lock_key(int ix, U64 key)
+{
+    if (cache_check_cache(ix)) return -1;
+    obtain_lock(&cacheblk[ix].shard[KEY_SHARD(ix, key)].lock);
+    return 0;
+}
+
+int cache_unlock_key(int ix, U64 key)
+{
+    if (cache_check_ix(ix)) return -1;
+    release_lock(&cacheblk[ix].shard[KEY_SHARD(ix, key)].lock);
+    return 0;
+}
+
+int cache_lock_entry(int ix, int i)
+{
+    if (cache_check_cache(ix) || cache_check(ix,i)) return -1;
+    obtain_lock(&cacheblk[ix].shard[ENTRY_SHARD(ix, i)].lock);
+    return 0;
+}
+
+int cache_unlock_entry(int ix, int i)
 {
+    if (cache_check(ix,i)) return -1;
+    release_lock(&cacheblk[ix].shard[ENTRY_SHARD(ix, i)].lock);
+    return 0;
+}
+
+int cache_wait(int ix, U64 key)
+{
+    CACHESHARD *shard;
+
     if (cache_check_ix(ix)) return -1;
-    if (cacheblk[ix].busy < cacheblk[ix].nbr)
+    shard = &cacheblk[ix].shard[KEY_SHARD(ix, key)];
+    if (shard->busy < cacheblk[ix].shardnbr)
         return 0;
 
-    cacheblk[ix].waiters++; cacheblk[ix].waits++;
+    shard->waiters++; shard->waits++;
 
 #if FALSE
     {
@@ -202,12 +257,12 @@ int cache_wait(int ix)
         tm.tv_nsec = (now.tv_usec + CACHE_WAITTIME) * 1000;
         tm.tv_sec += tm.tv_nsec / 1000000000;
         tm.tv_nsec = tm.tv_nsec % 1000000000;
-        timed_wait_condition(&cacheblk[ix].waitcond, &cacheblk[ix].lock, &tm);
+        timed_wait_condition(&shard->waitcond, &shard->lock, &tm);
     }
 #else
-    wait_condition(&cacheblk[ix].waitcond, &cacheblk[ix].lock);
+    wait_condition(&shard->waitcond, &shard->lock);
 #endif
-    cacheblk[ix].waiters--;
+    shard->waiters--;
     return 0;
 }
 
@@ -219,17 +274,26 @@ U64 cache_getkey(int ix, int i)
 
 U64 cache_setkey(int ix, int i, U64 key)
 {
+    CACHESHARD *shard;
     U64 oldkey;
     int empty;
 
     if (cache_check(ix,i)) return (U64)-1;
+    shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
     empty = cache_isempty(ix, i);
     oldkey = cacheblk[ix].cache[i].key;
-    cacheblk[ix].cache[i].key = key;
+    if (oldkey != key)
+    {
+        if (oldkey != 0)
+            cache_hash_remove(ix, i);
+        cacheblk[ix].cache[i].key = key;
+        if (key != 0)
+            cache_hash_insert(ix, i);
+    }
     if (empty && !cache_isempty(ix, i))
-        cacheblk[ix].empty--;
+        shard->empty--;
     else if (!empty && cache_isempty(ix, i))
-        cacheblk[ix].empty++;
+        shard->empty++;
     return oldkey;
 }
 
@@ -241,11 +305,13 @@ U32 cache_getflag(int ix, int i)
 
 U32 cache_setflag(int ix, int i, U32 andbits, U32 orbits)
 {
+    CACHESHARD *shard;
     U32 oldflags;
     int empty;
     int busy;
 
     if (cache_check(ix,i)) return (U32)-1;
+    shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
 
     empty = cache_isempty(ix, i);
     busy = cache_isbusy(ix, i);
@@ -254,16 +320,24 @@ U32 cache_setflag(int ix, int i, U32 andbits, U32 orbits)
     cacheblk[ix].cache[i].flag &= andbits;
     cacheblk[ix].cache[i].flag |= orbits;
 
-    if (!cache_isbusy(ix, i) && cacheblk[ix].waiters > 0)
-        signal_condition(&cacheblk[ix].waitcond);
+    if (!cache_isbusy(ix, i) && shard->waiters > 0)
+        signal_condition(&shard->waitcond);
+    /* Busy entries are kept off the steal list; an entry that
+       becomes free again is relinked as the youngest */
     if (busy && !cache_isbusy(ix, i))
-        cacheblk[ix].busy--;
+    {
+        shard->busy--;
+        cache_lru_tail(ix, i);
+    }
     else if (!busy && cache_isbusy(ix, i))
-        cacheblk[ix].busy++;
+    {
+        shard->busy++;
+        cache_lru_unlink(ix, i);
+    }
     if (empty && !cache_isempty(ix, i))
-        cacheblk[ix].empty--;
+        shard->empty--;
     else if (!empty && cache_isempty(ix, i))
-        cacheblk[ix].empty++;
+        shard->empty++;
     return oldflags;
 }
 
@@ -275,14 +349,21 @@ U64 cache_getage(int ix, int i)
 
 U64 cache_setage(int ix, int i)
 {
+    CACHESHARD *shard;
     U64 oldage;
     int empty;
 
     if (cache_check(ix,i)) return (U64)-1;
+    shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
     empty = cache_isempty(ix, i);
     oldage = cacheblk[ix].cache[i].age;
-    cacheblk[ix].cache[i].age = ++cacheblk[ix].age;
-    if (empty) cacheblk[ix].empty--;
+    cacheblk[ix].cache[i].age = ++shard->age;
+    if (!cache_isbusy(ix, i))
+    {
+        cache_lru_unlink(ix, i);
+        cache_lru_tail(ix, i);
+    }
+    if (empty) shard->empty--;
     return oldage;
 }
 
@@ -292,7 +373,7 @@ void *cache_getbuf(int ix, int i, int len)
     if (len > 0
      && cacheblk[ix].cache[i].buf != NULL
      && cacheblk[ix].cache[i].len < len) {
-        cacheblk[ix].size -= cacheblk[ix].cache[i].len;
+        cacheblk[ix].shard[ENTRY_SHARD(ix, i)].size -= cacheblk[ix].cache[i].len;
         free (cacheblk[ix].cache[i].buf);
         cacheblk[ix].cache[i].buf = NULL;
         cacheblk[ix].cache[i].len = 0;
@@ -304,13 +385,15 @@ void *cache_getbuf(int ix, int i, int len)
 
 void *cache_setbuf(int ix, int i, void *buf, int len)
 {
+    CACHESHARD *shard;
     void *oldbuf;
     if (cache_check(ix,i)) return NULL;
+    shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
     oldbuf = cacheblk[ix].cache[i].buf;
-    cacheblk[ix].size -= cacheblk[ix].cache[i].len;
+    shard->size -= cacheblk[ix].cache[i].len;
     cacheblk[ix].cache[i].buf = buf;
     cacheblk[ix].cache[i].len = len;
-    cacheblk[ix].size += len;
+    shard->size += len;
     return oldbuf;
 }
 
@@ -337,12 +420,14 @@ int cache_setval(int ix, int i, int val)
 
 int cache_release(int ix, int i, int flag)
 {
+    CACHESHARD *shard;
     void *buf;
     int   len;
     int   empty;
     int   busy;
 
     if (cache_check(ix,i)) return -1;
+    shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
 
     empty = cache_isempty(ix, i);
     busy = cache_isbusy(ix, i);
@@ -350,11 +435,19 @@ int cache_release(int ix, int i, int flag)
     buf = cacheblk[ix].cache[i].buf;
     len = cacheblk[ix].cache[i].len;
 
+    if (cacheblk[ix].cache[i].key != 0)
+        cache_hash_remove(ix, i);
+    cache_lru_unlink(ix, i);
+
     memset(&cacheblk[ix].cache[i], 0, sizeof(CACHE));
 
+    /* An empty entry is the first to be stolen */
+    cacheblk[ix].cache[i].hnext = -1;
+    cache_lru_head(ix, i);
+
     if ((flag & CACHE_FREEBUF) && buf != NULL) {
         free (buf);
-        cacheblk[ix].size -= len;
+        shard->size -= len;
         buf = NULL;
         len = 0;
     }
@@ -362,18 +455,20 @@ int cache_release(int ix, int i, int flag)
     cacheblk[ix].cache[i].buf = buf;
     cacheblk[ix].cache[i].len = len;
 
-    if (cacheblk[ix].waiters > 0)
-        signal_condition(&cacheblk[ix].waitcond);
+    if (shard->waiters > 0)
+        signal_condition(&shard->waitcond);
 
-    if (!empty) cacheblk[ix].empty++;
-    if (busy) cacheblk[ix].busy--;
+    if (!empty) shard->empty++;
+    if (busy) shard->busy--;
 
     return 0;
 }
 
 DLL_EXPORT int cachestats_cmd(int argc, char *argv[], char *cmdline)
 {
-    int ix, i;
+    CACHESHARD *shard;
+    int ix, i, s, n, maxprobe;
+    S64 hits, misses, probes;
     char buf[128];
 
     UNREFERENCED(cmdline);
@@ -391,43 +486,73 @@ DLL_EXPORT int cachestats_cmd(int argc, char *argv[], char *cmdline)
             continue;
         }
 
+        hits = cache_hits(ix);
+        misses = cache_misses(ix);
+
         MSGBUF( buf, "Cache............ %10d", ix);
         WRMSG(HHC02294, "I", buf);
 
         MSGBUF( buf, "nbr ............. %10d", cacheblk[ix].nbr);
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "busy ............ %10d", cacheblk[ix].busy);
+        MSGBUF( buf, "shards .......... %10d", cacheblk[ix].shards);
+        WRMSG(HHC02294, "I", buf);
+
+        MSGBUF( buf, "busy ............ %10d", cache_busy(ix));
         WRMSG(HHC02294, "I", buf);
 
         MSGBUF( buf, "busy%% ........... %10d",cache_busy_percent(ix));
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "empty ........... %10d", cacheblk[ix].empty);
+        MSGBUF( buf, "empty ........... %10d", cache_empty(ix));
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "waiters ......... %10d", cacheblk[ix].waiters);
+        MSGBUF( buf, "waiters ......... %10d", cache_waiters(ix));
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "waits ........... %10d", cacheblk[ix].waits);
+        CACHE_SUM(ix, waits, n);
+        MSGBUF( buf, "waits ........... %10d", n);
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "buf size ........ %10"PRId64, cacheblk[ix].size);
+        MSGBUF( buf, "buf size ........ %10"PRId64, cache_size(ix));
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "hits ............ %10"PRId64, cacheblk[ix].hits);
+        MSGBUF( buf, "hits ............ %10"PRId64, hits);
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "fast hits ....... %10"PRId64, cacheblk[ix].fasthits);
+        CACHE_SUM(ix, fasthits, probes);
+        MSGBUF( buf, "fast hits ....... %10"PRId64, probes);
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "misses .......... %10"PRId64, cacheblk[ix].misses);
+        MSGBUF( buf, "misses .......... %10"PRId64, misses);
+        WRMSG(HHC02294, "I", buf);
+
+        MSGBUF( buf, "hash buckets .... %10d", 1 << cacheblk[ix].hashbits);
+        WRMSG(HHC02294, "I", buf);
+
+        CACHE_SUM(ix, probes, probes);
+        MSGBUF( buf, "probes .......... %10"PRId64, probes);
+        WRMSG(HHC02294, "I", buf);
+
+        MSGBUF( buf, "avg probe ....... %10.2f",
+            hits + misses == 0 ? 0.0 : (double)probes / (double)(hits + misses));
+        WRMSG(HHC02294, "I", buf);
+
+        for (maxprobe = 0, s = 0; s < cacheblk[ix].shards; s++)
+            if (cacheblk[ix].shard[s].maxprobe > maxprobe)
+                maxprobe = cacheblk[ix].shard[s].maxprobe;
+        MSGBUF( buf, "max probe ....... %10d", maxprobe);
+        WRMSG(HHC02294, "I", buf);
+
+        CACHE_SUM(ix, lruprobes, probes);
+        MSGBUF( buf, "steal probes .... %10"PRId64, probes);
         WRMSG(HHC02294, "I", buf);
 
         MSGBUF( buf, "hit%% ............ %10d", cache_hit_percent(ix));
         WRMSG(HHC02294, "I", buf);
 
-        MSGBUF( buf, "age ............. %10"PRId64, cacheblk[ix].age);
+        CACHE_SUM(ix, age, probes);
+        MSGBUF( buf, "age ............. %10"PRId64, probes);
         WRMSG(HHC02294, "I", buf);
 
         MSGBUF( buf, "last adjusted ... %s", cacheblk[ix].atime == 0 ? "none\n" : ctime(&cacheblk[ix].atime));
@@ -441,6 +566,18 @@ DLL_EXPORT int cachestats_cmd(int argc, char *argv[], char *cmdline)
         MSGBUF( buf, "adjustments ..... %10d", cacheblk[ix].adjusts);
         WRMSG(HHC02294, "I", buf);
 
+        if (cacheblk[ix].shards > 1)
+        {
+            for (s = 0; s < cacheblk[ix].shards; s++)
+            {
+                shard = &cacheblk[ix].shard[s];
+                MSGBUF( buf, "shard[%d] busy %4d empty %4d waits %6d hits %10"PRId64" misses %10"PRId64,
+                    s, shard->busy, shard->empty, shard->waits,
+                    shard->hits, shard->misses);
+                WRMSG(HHC02294, "I", buf);
+            }
+        }
+
         if (argc > 1)
         {
             for (i = 0; i < cacheblk[ix].nbr; i++)
@@ -463,11 +600,14 @@ DLL_EXPORT int cachestats_cmd(int argc, char *argv[], char *cmdline)
 /*-------------------------------------------------------------------*/
 static int cache_destroy_locked (int ix)
 {
-    int i;
+    int i, s;
     if (cacheblk[ix].magic == CACHE_MAGIC)
     {
-        destroy_lock (&cacheblk[ix].lock);
-        destroy_condition (&cacheblk[ix].waitcond);
+        for (s = 0; s < cacheblk[ix].shards; s++)
+        {
+            destroy_lock (&cacheblk[ix].shard[s].lock);
+            destroy_condition (&cacheblk[ix].shard[s].waitcond);
+        }
 
         if (cacheblk[ix].cache)
         {
@@ -476,6 +616,7 @@ static int cache_destroy_locked (int ix)
 
             free (cacheblk[ix].cache);
         }
+        free (cacheblk[ix].hash);
     }
     memset(&cacheblk[ix], 0, sizeof(CACHEBLK));
     return 0;
@@ -483,18 +624,26 @@ static int cache_destroy_locked (int ix)
 
 static int cache_create_locked( int ix )
 {
+    int i, s;
+
     cache_destroy_locked (ix);
-    cacheblk[ix].magic = CACHE_MAGIC;
+
+    /* Split the cache into shards of equal size */
+    cacheblk[ix].shardbits = 0;
+    if (ix == CACHE_DEVBUF)
+        while ((1 << cacheblk[ix].shardbits) < CACHE_DEVBUF_SHARDS
+            && (1 << cacheblk[ix].shardbits) < CACHE_MAX_SHARDS)
+            cacheblk[ix].shardbits++;
+    cacheblk[ix].shards = 1 << cacheblk[ix].shardbits;
 
     // FIXME: See the note in cache.h about CACHE_DEFAULT_L2_NBR
 
     cacheblk[ix].nbr = ix != CACHE_L2 ? CACHE_DEFAULT_NBR
                                       : CACHE_DEFAULT_L2_NBR;
 
-    cacheblk[ix].empty = cacheblk[ix].nbr;
-
-    initialize_lock (&cacheblk[ix].lock);
-    initialize_condition (&cacheblk[ix].waitcond);
+    cacheblk[ix].shardnbr = (cacheblk[ix].nbr + cacheblk[ix].shards - 1)
+                          / cacheblk[ix].shards;
+    cacheblk[ix].nbr = cacheblk[ix].shardnbr * cacheblk[ix].shards;
 
     cacheblk[ix].cache = calloc (cacheblk[ix].nbr, sizeof(CACHE));
 
@@ -504,8 +653,50 @@ static int cache_create_locked( int ix )
         WRMSG (HHC00011, "E", "cache()", ix,
             (int)(cacheblk[ix].nbr * (int)sizeof(CACHE)),
             errno, strerror(errno));
+        memset(&cacheblk[ix], 0, sizeof(CACHEBLK));
+        return -1;
+    }
+
+    /* Size the hash table to a power of 2 of at least
+       CACHE_HASH_RATIO buckets per entry */
+    cacheblk[ix].hashbits = cacheblk[ix].shardbits;
+    while ((1 << cacheblk[ix].hashbits) < cacheblk[ix].nbr * CACHE_HASH_RATIO)
+        cacheblk[ix].hashbits++;
+
+    cacheblk[ix].hash = malloc ((1 << cacheblk[ix].hashbits) * sizeof(int));
+
+    if (cacheblk[ix].hash == NULL)
+    {
+        // "Function %s failed; cache %d size %d: [%02d] %s"
+        WRMSG (HHC00011, "E", "cache()", ix,
+            (int)((1 << cacheblk[ix].hashbits) * (int)sizeof(int)),
+            errno, strerror(errno));
+        free (cacheblk[ix].cache);
+        memset(&cacheblk[ix], 0, sizeof(CACHEBLK));
         return -1;
     }
+
+    for (i = 0; i < (1 << cacheblk[ix].hashbits); i++)
+        cacheblk[ix].hash[i] = -1;
+
+    /* Every entry starts out empty on its shard's steal list */
+    for (s = 0; s < cacheblk[ix].shards; s++)
+    {
+        initialize_lock (&cacheblk[ix].shard[s].lock);
+        initialize_condition (&cacheblk[ix].shard[s].waitcond);
+        cacheblk[ix].shard[s].empty = cacheblk[ix].shardnbr;
+        cacheblk[ix].shard[s].lruhead = cacheblk[ix].shard[s].lrutail = -1;
+    }
+    for (i = 0; i < cacheblk[ix].nbr; i++)
+    {
+        cacheblk[ix].cache[i].hnext = -1;
+        cache_lru_tail(ix, i);
+    }
+
+#if defined( HARDWARE_SYNC )
+    HARDWARE_SYNC();
+#endif
+    cacheblk[ix].magic = CACHE_MAGIC;
     return 0;
 }
 
@@ -540,10 +731,21 @@ static int cache_check_ix(int ix)
 static int cache_check_cache(int ix)
 {
     int rc;
+
+    /* The magic number is only set once the cache is complete, so
+       an existing cache needs no serialization against its creator */
+    if (cache_check_ix(ix)) return -1;
+    if (cacheblk[ix].magic == CACHE_MAGIC)
+    {
+#if defined( HARDWARE_SYNC )
+        HARDWARE_SYNC();
+#endif
+        return 0;
+    }
+
     OBTAIN_GLOBAL_CACHE_LOCK();
     {
-        rc = cache_check_ix(ix) ||
-            (cacheblk[ix].magic != CACHE_MAGIC && cache_create_locked(ix));
+        rc = cacheblk[ix].magic != CACHE_MAGIC && cache_create_locked(ix);
     }
     RELEASE_GLOBAL_CACHE_LOCK();
     return rc;
@@ -570,12 +772,16 @@ static int cache_isempty(int ix, int i)
 
 static void cache_allocbuf(int ix, int i, int len)
 {
+    int j, first;
+
     cacheblk[ix].cache[i].buf = calloc (len, 1);
     if (cacheblk[ix].cache[i].buf == NULL) {
         WRMSG (HHC00011, "E", "calloc()", ix, len, errno, strerror(errno));
         WRMSG (HHC00012, "W");
-        for (i = 0; i < cacheblk[ix].nbr; i++)
-            if (!cache_isbusy(ix, i)) cache_release(ix, i, CACHE_FREEBUF);
+        /* Only the entries of our own shard may be touched */
+        first = ENTRY_SHARD(ix, i) * cacheblk[ix].shardnbr;
+        for (j = first; j < first + cacheblk[ix].shardnbr; j++)
+            if (!cache_isbusy(ix, j)) cache_release(ix, j, CACHE_FREEBUF);
         cacheblk[ix].cache[i].buf = calloc (len, 1);
         if (cacheblk[ix].cache[i].buf == NULL) {
             WRMSG (HHC00011, "E", "calloc()", ix, len, errno, strerror(errno));
@@ -583,5 +789,94 @@ static void cache_allocbuf(int ix, int i, int len)
         }
     }
     cacheblk[ix].cache[i].len = len;
-    cacheblk[ix].size += len;
+    cacheblk[ix].shard[ENTRY_SHARD(ix, i)].size += len;
+}
+
+/*-------------------------------------------------------------------*/
+/* Hash chains                                                       */
+/*-------------------------------------------------------------------*/
+static int cache_hash(int ix, U64 key)
+{
+    /* Fibonacci hashing: multiply by 2**64 divided by the golden
+       ratio and keep the high order bits, so keys that differ only
+       in their low order track number spread across the table */
+    return (int)((key * 0x9E3779B97F4A7C15ULL) >> (64 - cacheblk[ix].hashbits));
+}
+
+static void cache_hash_insert(int ix, int i)
+{
+    int h = cache_hash(ix, cacheblk[ix].cache[i].key);
+
+    cacheblk[ix].cache[i].hnext = cacheblk[ix].hash[h];
+    cacheblk[ix].hash[h] = i;
+}
+
+static void cache_hash_remove(int ix, int i)
+{
+    int *p = &cacheblk[ix].hash[cache_hash(ix, cacheblk[ix].cache[i].key)];
+
+    while (*p >= 0 && *p != i)
+        p = &cacheblk[ix].cache[*p].hnext;
+    if (*p == i)
+        *p = cacheblk[ix].cache[i].hnext;
+    cacheblk[ix].cache[i].hnext = -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Steal (LRU) list for each shard, oldest entry first               */
+/*-------------------------------------------------------------------*/
+static void cache_lru_unlink(int ix, int i)
+{
+    CACHESHARD *shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
+    int prev = cacheblk[ix].cache[i].lruprev;
+    int next = cacheblk[ix].cache[i].lrunext;
+
+    /* Busy entries are not on the list */
+    if (prev < 0 && shard->lruhead != i)
+        return;
+
+    if (prev >= 0) cacheblk[ix].cache[prev].lrunext = next;
+    else           shard->lruhead = next;
+    if (next >= 0) cacheblk[ix].cache[next].lruprev = prev;
+    else           shard->lrutail = prev;
+    cacheblk[ix].cache[i].lruprev = cacheblk[ix].cache[i].lrunext = -1;
+}
+
+static void cache_lru_head(int ix, int i)
+{
+    CACHESHARD *shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
+
+    cacheblk[ix].cache[i].lruprev = -1;
+    cacheblk[ix].cache[i].lrunext = shard->lruhead;
+    if (shard->lruhead >= 0)
+        cacheblk[ix].cache[shard->lruhead].lruprev = i;
+    else
+        shard->lrutail = i;
+    shard->lruhead = i;
+}
+
+static void cache_lru_tail(int ix, int i)
+{
+    CACHESHARD *shard = &cacheblk[ix].shard[ENTRY_SHARD(ix, i)];
+
+    cacheblk[ix].cache[i].lrunext = -1;
+    cacheblk[ix].cache[i].lruprev = shard->lrutail;
+    if (shard->lrutail >= 0)
+        cacheblk[ix].cache[shard->lrutail].lrunext = i;
+    else
+        shard->lruhead = i;
+    shard->lrutail = i;
+}
+
+/* Return the oldest entry of shard `s' that is not busy, or -1 if
+   all of them are busy.  Only entries that are not busy are on the
+   list, so this is the head of the list. */
+static int cache_lru_steal(int ix, int s)
+{
+    CACHESHARD *shard = &cacheblk[ix].shard[s];
+    int i = shard->lruhead;
+
+    if (i >= 0)
+        shard->lruprobes++;
+    return i;
 }
@@ -24,11 +24,36 @@
       void     *buf;
       int       value;
       U64       age;
+      int       hnext;
+      int       lruprev;
+      int       lrunext;
 
     The first 8 bits of the flag indicates if the entry is `busy' or
     not.  If any of the first 8 bits are non-zero then the entry is
     considered `busy' and will not be stolen or otherwise reused.
 
+    Entries with a non-zero key are chained from a hash table by
+    `hnext', so a lookup only examines entries whose key hashes to
+    the same bucket.  Entries that are not busy are also kept on a
+    doubly linked list (`lruprev', `lrunext'), oldest first: setting
+    an entry's age or freeing a busy entry moves it to the tail,
+    releasing it moves it to the head, and an entry is unlinked
+    while it is busy.  The entry to be stolen is therefore always
+    the head of the list.  Link values are entry indexes; -1 ends
+    a chain.
+
+  Shards:
+
+    A cache is divided into a power of 2 number of shards, each with
+    its own lock, hash buckets, LRU list and statistics.  Entries
+    [n*s .. n*s+n-1] belong to shard s, where n is the number of
+    entries per shard, and a key belongs to the shard selected by
+    the high order bits of its hash.  An entry only ever holds a
+    key belonging to its own shard, so looking up a key and stealing
+    an entry for it needs only that shard's lock and I/O for tracks
+    hashing to different shards proceeds in parallel.  Ages are kept
+    per shard and so are only strictly ordered within a shard.
+
   APIs:
 
     General query functions:
@@ -117,16 +142,37 @@
     Locking functions:
 
       int         cache_lock(int ix);
-                  Obtain the lock for cache `ix'.  If the cache does
-                  not exist then it will be created.  Generally, the
-                  lock should be obtained when referencing cache
-                  entries and must be held when a cache entry status
-                  may change from `busy' to `not busy' or vice versa.
-                  Likewise, the lock must be held when a cache entry
-                  changes from `empty' to `not empty' or vice versa.
+                  Obtain the locks for all shards of cache `ix'.  If
+                  the cache does not exist then it will be created.
+                  Generally, the lock for an entry's shard should be
+                  obtained when referencing cache entries and must be
+                  held when a cache entry status may change from
+                  `busy' to `not busy' or vice versa.  Likewise, the
+                  lock must be held when a cache entry changes from
+                  `empty' to `not empty' or vice versa.  All shards
+                  must be locked to call `cache_scan'.
 
       int         cache_unlock(int ix);
-                  Release the cache lock
+                  Release the locks for all shards
+
+      int         cache_lock_key(int ix, U64 key);
+                  Obtain the lock for the shard that `key' belongs
+                  to, creating the cache if it does not exist.  This
+                  is sufficient to call `cache_lookup' for the key
+                  and to use the returned entry indexes.
+
+      int         cache_unlock_key(int ix, U64 key);
+                  Release the lock for the shard of `key'
+
+      int         cache_lock_entry(int ix, int i);
+                  Obtain the lock for the shard that entry `i'
+                  belongs to
+
+      int         cache_unlock_entry(int ix, int i);
+                  Release the lock for the shard of entry `i'
+
+                  A thread may hold at most one shard lock obtained
+                  by these four functions at a time.
 
     Search functions:
 
@@ -134,7 +180,9 @@
                   Search cache `ix' for entry matching `key'.
                   If a non-NULL pointer `o' is provided, then the
                   oldest or preferred cache entry index is returned
-                  that is available to be stolen.
+                  that is available to be stolen.  The number of
+                  entries examined for each is recorded and shown
+                  by the `cachestats' command.
 
       int         cache_scan (int ix, int (rtn)(), void *data);
                   Scan a cache routine entry by entry calling routine
@@ -149,8 +197,9 @@
 
     Other functions:
 
-      int         cache_wait(int ix);
-                  Wait for a non-busy cache entry to become available.
+      int         cache_wait(int ix, U64 key);
+                  Wait for a non-busy cache entry to become available
+                  in the shard of `key', whose lock must be held.
                   Typically called after `cache_lookup' was
                   unsuccessful and `*o' is -1.
 
@@ -169,6 +218,7 @@
 /* Reserve cache indexes here                                        */
 /*-------------------------------------------------------------------*/
 #define  CACHE_MAX_INDEX              8 /* Max number caches [0..7]  */
+#define  CACHE_MAX_SHARDS             8 /* Max shards per cache      */
 
 #define  CACHE_DEVBUF                 0 /* Device Buffer cache       */
 #define  CACHE_L2                     1 /* L2 cache                  */
@@ -189,14 +239,18 @@ typedef struct _CACHE {                 /* Cache entry               */
       void     *buf;                    /* Buffer address            */
       int       value;                  /* Arbitrary value           */
       U64       age;                    /* Age                       */
+      int       hnext;                  /* Next entry in hash chain  */
+      int       lruprev;                /* Previous (older) entry    */
+      int       lrunext;                /* Next (younger) entry      */
     } CACHE;
 
 /*-------------------------------------------------------------------*/
-/* Cache header                                                      */
+/* Cache shard                                                       */
 /*-------------------------------------------------------------------*/
-typedef struct _CACHEBLK {              /* Cache header              */
-      int       magic;                  /* Magic number              */
-      int       nbr;                    /* Number entries            */
+typedef struct _CACHESHARD {            /* Cache shard               */
+      CACHE_ALIGN
+      LOCK      lock;                   /* Lock                      */
+      COND      waitcond;               /* Wait for available entry  */
       int       busy;                   /* Number busy entries       */
       int       empty;                  /* Number empty entries      */
       int       waiters;                /* Number waiters            */
@@ -206,9 +260,26 @@ typedef struct _CACHEBLK {              /* Cache header              */
       S64       fasthits;               /* Number fast lookup hits   */
       S64       misses;                 /* Number lookup misses      */
       U64       age;                    /* Age counter               */
-      LOCK      lock;                   /* Lock                      */
-      COND      waitcond;               /* Wait for available entry  */
+      int       lruhead;                /* Oldest entry              */
+      int       lrutail;                /* Youngest entry            */
+      S64       probes;                 /* Hash chain entries probed */
+      int       maxprobe;               /* Longest lookup probe      */
+      S64       lruprobes;              /* Entries probed for steal  */
+    } CACHESHARD;
+
+/*-------------------------------------------------------------------*/
+/* Cache header                                                      */
+/*-------------------------------------------------------------------*/
+typedef struct _CACHEBLK {              /* Cache header              */
+      int       magic;                  /* Magic number              */
+      int       nbr;                    /* Number entries            */
+      int       shards;                 /* Number shards             */
+      int       shardbits;              /* log2 of number of shards  */
+      int       shardnbr;               /* Number entries per shard  */
       CACHE    *cache;                  /* Cache table address       */
+      int      *hash;                   /* Hash table address        */
+      int       hashbits;               /* log2 of hash table size   */
+      CACHESHARD shard[CACHE_MAX_SHARDS]; /* Shards                  */
       time_t    atime;                  /* Time last adjustment      */
       time_t    wtime;                  /* Time last wait            */
       int       adjusts;                /* Number of adjustments     */
@@ -231,6 +302,9 @@ typedef struct _CACHEBLK {              /* Cache header              */
 //      This is a workaround to increase the max number of devices
 #define CACHE_DEFAULT_L2_NBR       1031 /* Initial entries for L2    */
 
+#define CACHE_HASH_RATIO              2 /* Min hash buckets per entry*/
+#define CACHE_DEVBUF_SHARDS           8 /* Device buffer shards (2**n)*/
+
 #define CACHE_WAITTIME             1000 /* Wait time for entry(usec) */
 
 #define CACHE_ADJUST_INTERVAL        15 /* Adjustment interval (sec) */
@@ -266,7 +340,11 @@ typedef int CACHE_SCAN_RTN (int *answer, int ix, int i, void *data);
 int         cache_scan (int ix, CACHE_SCAN_RTN rtn, void *data);
 int         cache_lock(int ix);
 int         cache_unlock(int ix);
-int         cache_wait(int ix);
+int         cache_lock_key(int ix, U64 key);
+int         cache_unlock_key(int ix, U64 key);
+int         cache_lock_entry(int ix, int i);
+int         cache_unlock_entry(int ix, int i);
+int         cache_wait(int ix, U64 key);
 U64         cache_getkey(int ix, int i);
 U64         cache_setkey(int ix, int i, U64 key);
 U32         cache_getflag(int ix, int i);
@@ -34,6 +34,11 @@ typedef struct CCKD_L2ENT       CCKD_L2ENT;     // Level 2 table entry
 typedef struct CCKD_FREEBLK     CCKD_FREEBLK;   // Free block
 typedef struct CCKD_IFREEBLK    CCKD_IFREEBLK;  // Free block (internal)
 typedef struct CCKD_RA          CCKD_RA;        // Readahead queue entry
+typedef struct CCKD_RASTREAM    CCKD_RASTREAM;  // Readahead stream
+typedef struct CCKD_IOREQ       CCKD_IOREQ;     // Batched read request
+typedef struct CCKD_URING       CCKD_URING;     // Readahead io_uring
+typedef struct CCKD_WRQ         CCKD_WRQ;       // Compressed write queue
+typedef struct CCKD_WRSCAN      CCKD_WRSCAN;    // Compressor cache scan
 typedef struct CCKDBLK          CCKDBLK;        // Global CCKD dasd block
 typedef struct CCKD_EXT         CCKD_EXT;       // CCKD Extension block
 typedef struct SPCTAB           SPCTAB;         // Space table
@@ -190,6 +195,23 @@ struct CCKD_RA {                        /* Readahead queue entry     */
         int              ra_idxnxt;     /* Index to next entry       */
 };
 
+struct CCKD_RASTREAM {                  /* Readahead stream          */
+        unsigned int     age;           /* Last use (0=unused)       */
+        int              last;          /* Last track referenced     */
+        int              stride;        /* Track increment           */
+        int              seen;          /* Times stride was seen     */
+        int              depth;         /* Strides to read ahead     */
+        int              qlast;         /* Last track read ahead     */
+};
+
+struct CCKD_IOREQ {                     /* Batched read request      */
+        int              fd;            /* File descriptor           */
+        U64              off;           /* File offset               */
+        BYTE            *buf;           /* Buffer                    */
+        unsigned int     len;           /* Length to read            */
+        int              rc;            /* Bytes read or -errno      */
+};
+
 typedef  U32          CCKD_L1ENT;       /* Level 1 table entry       */
 typedef  CCKD_L1ENT   CCKD_L1TAB[];     /* Level 1 table             */
 typedef  CCKD_L2ENT   CCKD_L2TAB[256];  /* Level 2 table             */
@@ -229,6 +251,9 @@ typedef  char         CCKD_ITRACE[256]; /* Trace table entry         */
 #define CCKD_DEF_RA_SIZE       4        /* Readahead queue size      */
 #define CCKD_MAX_RA_SIZE       16       /* Readahead queue size      */
 
+#define CCKD_RA_STREAMS        4        /* Readahead streams per dev */
+#define CCKD_RA_MAX_STRIDE     16       /* Largest stride detected   */
+
 #define CCKD_MIN_RA            0        /* Min readahead threads     */
 #define CCKD_DEF_RA            2        /* Def readahead threads     */
 #define CCKD_MAX_RA            9        /* Max readahead threads     */
@@ -237,6 +262,13 @@ typedef  char         CCKD_ITRACE[256]; /* Trace table entry         */
 #define CCKD_DEF_WRITER        2        /* Def writer threads        */
 #define CCKD_MAX_WRITER        9        /* Max writer threads        */
 
+#define CCKD_MIN_CMP           0        /* Min compressor threads    */
+#define CCKD_MAX_CMP           16       /* Max compressor threads    */
+
+#define CCKD_WRQ_SIZE          32       /* Compressed write queue size */
+#define CCKD_DEF_CMPQ          8        /* Def queued writes per dev */
+#define CCKD_MAX_CMPQ          CCKD_WRQ_SIZE /* Max queued writes/dev */
+
 #define CCKD_MIN_GCOL          0        /* Min garbage collectors    */
 #define CCKD_DEF_GCOL          1        /* Def garbage collectors    */
 #define CCKD_MAX_GCOL          1        /* Max garbage collectors    */
@@ -255,6 +287,24 @@ typedef  char         CCKD_ITRACE[256]; /* Trace table entry         */
 #define CCKD_DEF_FREEPEND     -1        /* Def free pending cycles   */
 #define CCKD_MAX_FREEPEND      4        /* Max free pending cycles   */
 
+/*-------------------------------------------------------------------*/
+/*                 Compressed write queue                            */
+/*-------------------------------------------------------------------*/
+struct CCKD_WRQ {                       /* Compressed write queue    */
+        BYTE            *wrq_buf;       /* Compression buffer        */
+        BYTE            *wrq_bufp;      /* -> Image to be written    */
+        int              wrq_bufl;      /* Image length              */
+        int              wrq_o;         /* Cache entry (-1=free)     */
+        U16              wrq_devnum;    /* Device number             */
+        int              wrq_idxnxt;    /* Index to next entry       */
+};
+
+struct CCKD_WRSCAN {                    /* Compressor cache scan     */
+        U16              full[CCKD_WRQ_SIZE]; /* Devices at limit    */
+        int              nfull;         /* Number devices at limit   */
+        int              skipped;       /* Writes held back          */
+};
+
 /*-------------------------------------------------------------------*/
 /*                   Global CCKD dasd block                          */
 /*-------------------------------------------------------------------*/
@@ -291,6 +341,18 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         int              wrmax;         /* Max writer threads        */
         int              wrprio;        /* Writer thread priority    */
 
+        COND             cmpcond;       /* Compressor condition      */
+        int              cmps;          /* Number compressor threads started */
+        int              cmpa;          /* Number compressor threads active */
+        int              cmpmax;        /* Max compressor threads    */
+        int              cmpwaiting;    /* Number compressors waiting*/
+        int              cmpqmax;       /* Max queued writes per dev */
+        CCKD_WRQ         wrq[CCKD_WRQ_SIZE];  /* Compressed write queue */
+        int              wrq1st;        /* First compressed write    */
+        int              wrqlast;       /* Last compressed write     */
+        int              wrqfree;       /* Free write queue entry    */
+        int              wrqn;          /* Write queue entries in use*/
+
         LOCK             ralock;        /* Readahead lock            */
         COND             racond;        /* Readahead condition       */
         int              ras;           /* Number readahead threads started */
@@ -299,6 +361,7 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         int              rawaiting;     /* Number threads waiting    */
         int              ranbr;         /* Readahead queue size      */
         int              readaheads;    /* Nbr tracks to read ahead  */
+        int              rauring;       /* 1=Batch reads via io_uring*/
         CCKD_RA          ra[CCKD_MAX_RA_SIZE];    /* Readahead queue */
         int              ra1st;         /* First readahead entry     */
         int              ralast;        /* Last readahead entry      */
@@ -321,9 +384,19 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         U64              stats_cachemisses;    /* Cache misses       */
         U64              stats_readaheads;     /* Readaheads         */
         U64              stats_readaheadmisses;/* Readahead misses   */
+        U64              stats_readaheadhits;  /* Readahead hits     */
+        U64              stats_rastreams;      /* Readahead streams  */
+        U64              stats_rarampups;      /* Ra depth increases */
+        U64              stats_rarampdowns;    /* Ra depth decreases */
+        U64              stats_rabatches;      /* Readahead batches  */
+        U64              stats_rabatchtrks;    /* Tracks in batches  */
         U64              stats_iowaits;        /* Waits for i/o      */
         U64              stats_cachewaits;     /* Waits for cache    */
         U64              stats_stresswrites;   /* Writes under stress*/
+        U64              stats_compresses;     /* Tracks compressed  */
+        U64              stats_compressusecs;  /* Compression time   */
+        U64              stats_cmpthrottles;   /* Per-dev limit hits */
+        U64              stats_wrqhigh;        /* Write queue high   */
         U64              stats_l2cachehits;    /* L2 cache hits      */
         U64              stats_l2cachemisses;  /* L2 cache misses    */
         U64              stats_l2reads;        /* L2 reads           */
@@ -399,9 +472,13 @@ struct CCKD_EXT {                       /* Ext for compressed ckd    */
 
         int              lastsync;      /* Time of last sync         */
 
+        CCKD_RASTREAM    rastream[CCKD_RA_STREAMS];/* Streams        */
+        unsigned int     raage;         /* Readahead stream clock    */
         int              ralkup[CCKD_MAX_RA_SIZE];/* Lookup table    */
 
         int              ratrk;         /* Track to readahead        */
+        int              rastride;      /* Readahead stride          */
+        int              ranum;         /* Nbr lookup table entries  */
         unsigned int     totreads;      /* Total nbr trk reads       */
         unsigned int     totwrites;     /* Total nbr trk writes      */
         unsigned int     totl2reads;    /* Total nbr l2 reads        */
@@ -411,6 +488,7 @@ struct CCKD_EXT {                       /* Ext for compressed ckd    */
         unsigned int     readaheads;    /* Number trks read ahead    */
         unsigned int     switches;      /* Number trk switches       */
         unsigned int     misses;        /* Number readahead misses   */
+        unsigned int     rahits;        /* Number readahead hits     */
 
         int              fd[CCKD_MAX_SF+1];      /* File descriptors */
         BYTE             swapend[CCKD_MAX_SF+1]; /* Swap endian flag */
@@ -188,9 +188,13 @@ struct CCKD64_EXT {                     /* Ext for compressed ckd    */
 
         int              lastsync;      /* Time of last sync         */
 
+        CCKD_RASTREAM    rastream[CCKD_RA_STREAMS];/* Streams        */
+        unsigned int     raage;         /* Readahead stream clock    */
         int              ralkup[CCKD_MAX_RA_SIZE];/* Lookup table    */
 
         int              ratrk;         /* Track to readahead        */
+        int              rastride;      /* Readahead stride          */
+        int              ranum;         /* Nbr lookup table entries  */
         unsigned int     totreads;      /* Total nbr trk reads       */
         unsigned int     totwrites;     /* Total nbr trk writes      */
         unsigned int     totl2reads;    /* Total nbr l2 reads        */
@@ -200,6 +204,7 @@ struct CCKD64_EXT {                     /* Ext for compressed ckd    */
         unsigned int     readaheads;    /* Number trks read ahead    */
         unsigned int     switches;      /* Number trk switches       */
         unsigned int     misses;        /* Number readahead misses   */
+        unsigned int     rahits;        /* Number readahead hits     */
 
         int              fd[CCKD_MAX_SF+1];      /* File descriptors */
         BYTE             swapend[CCKD_MAX_SF+1]; /* Swap endian flag */
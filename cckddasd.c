@@ -67,6 +67,7 @@ int cckd_dasd_init( int argc, BYTE* argv[] )
     initialize_condition( &cckdblk.gccond   );
     initialize_condition( &cckdblk.racond   );
     initialize_condition( &cckdblk.wrcond   );
+    initialize_condition( &cckdblk.cmpcond  );
     initialize_condition( &cckdblk.devcond  );
     initialize_condition( &cckdblk.termcond );
 
@@ -83,11 +84,16 @@ int cckd_dasd_init( int argc, BYTE* argv[] )
     cckdblk.ranbr      = CCKD_DEF_RA_SIZE;
     cckdblk.ramax      = CCKD_DEF_RA;
     cckdblk.wrmax      = CCKD_DEF_WRITER;
+    cckdblk.cmpmax     = MAX( 1, MIN( hostinfo.num_procs, CCKD_MAX_CMP ));
+    cckdblk.cmpqmax    = CCKD_DEF_CMPQ;
     cckdblk.gcmax      = CCKD_DEF_GCOL;
     cckdblk.gcint      = CCKD_DEF_GCINT;
     cckdblk.gcparm     = CCKD_DEF_GCPARM;
     cckdblk.readaheads = CCKD_DEF_READAHEADS;
     cckdblk.freepend   = CCKD_DEF_FREEPEND;
+#if defined( OPTION_CCKD_IO_URING )
+    cckdblk.rauring    = 1;
+#endif
 
 #if defined( HAVE_ZLIB )
     cckdblk.comps     |= CCKD_COMPRESS_ZLIB;
@@ -114,6 +120,20 @@ int cckd_dasd_init( int argc, BYTE* argv[] )
 
     cckdblk.ra[cckdblk.ranbr - 1].ra_idxnxt = -1;
 
+    /* Initialize the compressed write queue */
+
+    cckdblk.wrq1st  = -1;
+    cckdblk.wrqlast = -1;
+    cckdblk.wrqfree =  0;
+
+    for (i=0; i < CCKD_WRQ_SIZE; i++)
+    {
+        cckdblk.wrq[i].wrq_o      = -1;
+        cckdblk.wrq[i].wrq_idxnxt = i + 1;
+    }
+
+    cckdblk.wrq[CCKD_WRQ_SIZE - 1].wrq_idxnxt = -1;
+
     /* Clear the empty L2 tables */
 
     for (i=0; i <= CKD_NULLTRK_FMTMAX; i++)
@@ -137,6 +157,8 @@ int cckd_dasd_init( int argc, BYTE* argv[] )
 /*-------------------------------------------------------------------*/
 void cckd_dasd_term_if_appropriate()
 {
+int i;                                  /* Index                     */
+
     /* Check if it's time to terminate yet */
     obtain_lock( &cckdblk.devlock );
     {
@@ -174,6 +196,19 @@ void cckd_dasd_term_if_appropriate()
     }
     release_lock( &cckdblk.gclock );
 
+    /* Terminate all compressor threads before the writers so
+       that every compressed image gets written... */
+    obtain_lock( &cckdblk.wrlock );
+    {
+        cckdblk.cmpmax = 0;     /* signal   all threads to terminate */
+        while (cckdblk.cmps)    /* wait for all threads to terminate */
+        {
+            broadcast_condition( &cckdblk.cmpcond );
+            wait_condition( &cckdblk.termcond, &cckdblk.wrlock );
+        }
+    }
+    release_lock( &cckdblk.wrlock );
+
     /* Terminate all writer threads... */
     obtain_lock( &cckdblk.wrlock );
     {
@@ -186,6 +221,13 @@ void cckd_dasd_term_if_appropriate()
     }
     release_lock( &cckdblk.wrlock );
 
+    /* Free the compressed write queue buffers */
+    for (i=0; i < CCKD_WRQ_SIZE; i++)
+    {
+        free( cckdblk.wrq[i].wrq_buf );
+        cckdblk.wrq[i].wrq_buf = NULL;
+    }
+
 } /* end function cckd_dasd_term */
 
 /*-------------------------------------------------------------------*/
@@ -415,6 +457,7 @@ void cckd_dasd_start (DEVBLK *dev)
 CCKD_EXT       *cckd;                   /* -> cckd extension         */
 U16             devnum = 0;             /* Last active device number */
 int             trk = 0;                /* Last active track         */
+int             i;                      /* Last active cache index   */
 
     if (dev->cckd64)
     {
@@ -446,10 +489,12 @@ int             trk = 0;                /* Last active track         */
     }
     cckd->cckdioact = 1;
 
-    cache_lock(CACHE_DEVBUF);
-
-    if (dev->cache >= 0)
+    /* Only the shard of the previous active entry need be locked */
+    if ((i = dev->cache) >= 0)
+    {
+        cache_lock_entry (CACHE_DEVBUF, i);
         CCKD_CACHE_GETKEY(dev->cache, devnum, trk);
+    }
 
     /* Check if previous active entry is still valid and not busy */
     if (dev->cache >= 0 && dev->devnum == devnum && dev->bufcur == trk
@@ -470,7 +515,8 @@ int             trk = 0;                /* Last active track         */
     else
         dev->bufcur = dev->cache = -1;
 
-    cache_unlock (CACHE_DEVBUF);
+    if (i >= 0)
+        cache_unlock_entry (CACHE_DEVBUF, i);
 
     release_lock (&cckd->cckdiolock);
 
@@ -512,9 +558,9 @@ CCKD_EXT       *cckd;                   /* -> cckd extension         */
     /* Make the current entry inactive */
     if (dev->cache >= 0)
     {
-        cache_lock (CACHE_DEVBUF);
+        cache_lock_entry (CACHE_DEVBUF, dev->cache);
         cache_setflag (CACHE_DEVBUF, dev->cache, ~CCKD_CACHE_ACTIVE, 0);
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_entry (CACHE_DEVBUF, dev->cache);
     }
 
     /* Cause writers to start after first update */
@@ -617,6 +663,10 @@ int             rc;                     /* Return code               */
     CCKD_TRACE( "file[%d] fd[%d] read, off 0x%16.16"PRIx64" len %d",
                 sfx, cckd->fd[ sfx ], off, len );
 
+#if defined( OPTION_POSITIONED_IO )
+    /* Read the data at the specified offset */
+    rc = pread( cckd->fd[ sfx ], buf, len, off );
+#else
     /* Seek to specified offset */
     if (lseek( cckd->fd[ sfx ], off, SEEK_SET ) < 0)
     {
@@ -629,6 +679,7 @@ int             rc;                     /* Return code               */
 
     /* Read the data */
     rc = read( cckd->fd[ sfx ], buf, len );
+#endif
     if (rc < (int)len)
     {
         if (rc < 0)
@@ -664,6 +715,10 @@ int             rc = 0;                 /* Return code               */
     CCKD_TRACE( "file[%d] fd[%d] write, off 0x%16.16"PRIx64" len %d",
                 sfx, cckd->fd[ sfx ], off, len );
 
+#if defined( OPTION_POSITIONED_IO )
+    /* Write the data at the specified offset */
+    rc = pwrite( cckd->fd[ sfx ], buf, len, off );
+#else
     /* Seek to specified offset */
     if (lseek( cckd->fd[ sfx ], off, SEEK_SET ) < 0)
     {
@@ -676,6 +731,7 @@ int             rc = 0;                 /* Return code               */
 
     /* Write the data */
     rc = write( cckd->fd[ sfx ], buf, len );
+#endif
     if (rc < (int)len)
     {
         if (rc < 0)
@@ -1172,12 +1228,14 @@ int cckd_read_trk(DEVBLK *dev, int trk, int ra, BYTE *unitstat)
 CCKD_EXT       *cckd;                   /* -> cckd extension         */
 int             fnd;                    /* Cache index for hit       */
 int             lru;                    /* Oldest unused cache index */
+U64             key;                    /* Cache key of the track    */
 int             len;                    /* Length of track image     */
 int             maxlen;                 /* Length for buffer         */
 int             curtrk = -1;            /* Current track (at entry)  */
 U16             devnum;                 /* Device number             */
 U32             oldtrk;                 /* Stolen track number       */
 U32             flag;                   /* Cache flag                */
+int             rahit;                  /* 1=Hit on a readahead trk  */
 BYTE           *buf;                    /* Read buffer               */
 
     if (dev->cckd64)
@@ -1192,32 +1250,40 @@ BYTE           *buf;                    /* Read buffer               */
 
     if (!ra) obtain_lock (&cckd->cckdiolock);
 
-    cache_lock (CACHE_DEVBUF);
-
     /* Inactivate the old entry */
     if (!ra)
     {
         curtrk = dev->bufcur;
         if (dev->cache >= 0)
+        {
+            cache_lock_entry (CACHE_DEVBUF, dev->cache);
             cache_setflag(CACHE_DEVBUF, dev->cache, ~CCKD_CACHE_ACTIVE, 0);
+            cache_unlock_entry (CACHE_DEVBUF, dev->cache);
+        }
         dev->bufcur = dev->cache = -1;
     }
 
+    /* Only the shard the track belongs to is locked from here on */
+    key = CCKD_CACHE_SETKEY(dev->devnum, trk);
+    cache_lock_key (CACHE_DEVBUF, key);
+
 cckd_read_trk_retry:
 
     /* scan the cache array for the track */
-    fnd = cache_lookup (CACHE_DEVBUF, CCKD_CACHE_SETKEY(dev->devnum, trk), &lru);
+    fnd = cache_lookup (CACHE_DEVBUF, key, &lru);
 
     /* check for cache hit */
     if (fnd >= 0)
     {
         if (ra) /* readahead doesn't care about a cache hit */
-        {   cache_unlock (CACHE_DEVBUF);
+        {   cache_unlock_key (CACHE_DEVBUF, key);
             return fnd;
         }
 
-        /* Mark the new entry active */
-        cache_setflag(CACHE_DEVBUF, fnd, ~0, CCKD_CACHE_ACTIVE | CCKD_CACHE_USED);
+        /* Mark the new entry active; if it wasn't used before then
+           it was brought in by a readahead */
+        flag = cache_setflag(CACHE_DEVBUF, fnd, ~0, CCKD_CACHE_ACTIVE | CCKD_CACHE_USED);
+        rahit = !(flag & CCKD_CACHE_USED);
         cache_setage(CACHE_DEVBUF, fnd);
 
         /* If the entry is pending write then change it to `updated' */
@@ -1230,13 +1296,17 @@ cckd_read_trk_retry:
         }
         buf = cache_getbuf(CACHE_DEVBUF, fnd, 0);
 
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_key (CACHE_DEVBUF, key);
 
         CCKD_TRACE( "%d rdtrk[%d] %d cache hit buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x",
                     ra, fnd, trk, buf, buf[0], buf[1], buf[2], buf[3], buf[4]);
 
         cckdblk.stats_switches++;  cckd->switches++;
         cckdblk.stats_cachehits++; cckd->cachehits++;
+        if (rahit)
+        {
+            cckdblk.stats_readaheadhits++; cckd->rahits++;
+        }
 
         /* if read/write is in progress then wait for it to finish */
         while (cache_getflag(CACHE_DEVBUF, fnd) & CCKD_CACHE_IOBUSY)
@@ -1257,8 +1327,8 @@ cckd_read_trk_retry:
         release_lock (&cckd->cckdiolock);
 
         /* Asynchrously schedule readaheads */
-        if (curtrk > 0 && trk > curtrk && trk <= curtrk + 2)
-            cckd_readahead (dev, trk);
+        if (trk != curtrk)
+            cckd_readahead (dev, trk, rahit);
 
         return fnd;
 
@@ -1268,23 +1338,23 @@ cckd_read_trk_retry:
 
     /* If no cache entry was stolen, then flush all outstanding writes.
        This requires us to release our locks.  cache_wait should be
-       called with only the cache_lock held.  Fortunately, cache waits
+       called with only the shard lock held.  Fortunately, cache waits
        occur very rarely. */
     if (lru < 0) /* No available entry to be stolen */
     {
         CCKD_TRACE( "%d rdtrk[%d] %d no available cache entry",
                     ra, lru, trk);
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_key (CACHE_DEVBUF, key);
         if (!ra) release_lock (&cckd->cckdiolock);
         cckd_flush_cache_all();
-        cache_lock (CACHE_DEVBUF);
+        cache_lock_key (CACHE_DEVBUF, key);
         cckdblk.stats_cachewaits++;
-        cache_wait (CACHE_DEVBUF);
+        cache_wait (CACHE_DEVBUF, key);
         if (!ra)
         {
-            cache_unlock (CACHE_DEVBUF);
+            cache_unlock_key (CACHE_DEVBUF, key);
             obtain_lock (&cckd->cckdiolock);
-            cache_lock (CACHE_DEVBUF);
+            cache_lock_key (CACHE_DEVBUF, key);
         }
         goto cckd_read_trk_retry;
     }
@@ -1301,7 +1371,7 @@ cckd_read_trk_retry:
     }
 
     /* Initialize the entry */
-    cache_setkey(CACHE_DEVBUF, lru, CCKD_CACHE_SETKEY(dev->devnum, trk));
+    cache_setkey(CACHE_DEVBUF, lru, key);
     cache_setflag(CACHE_DEVBUF, lru, 0, CCKD_CACHE_READING);
     cache_setage(CACHE_DEVBUF, lru);
     cache_setval(CACHE_DEVBUF, lru, 0);
@@ -1318,13 +1388,13 @@ cckd_read_trk_retry:
     CCKD_TRACE( "%d rdtrk[%d] %d buf %p len %d",
                 ra, lru, trk, buf, cache_getlen(CACHE_DEVBUF, lru));
 
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_key (CACHE_DEVBUF, key);
 
     if (!ra) release_lock (&cckd->cckdiolock);
 
     /* Asynchronously schedule readaheads */
-    if (!ra && curtrk > 0 && trk > curtrk && trk <= curtrk + 2)
-        cckd_readahead (dev, trk);
+    if (!ra && trk != curtrk)
+        cckd_readahead (dev, trk, -1);
 
     /* Clear the buffer if batch mode */
     if (dev->batch) memset(buf, 0, maxlen);
@@ -1338,9 +1408,9 @@ cckd_read_trk_retry:
     obtain_lock (&cckd->cckdiolock);
 
     /* Turn off the READING bit */
-    cache_lock (CACHE_DEVBUF);
+    cache_lock_entry (CACHE_DEVBUF, lru);
     flag = cache_setflag(CACHE_DEVBUF, lru, ~CCKD_CACHE_READING, 0);
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_entry (CACHE_DEVBUF, lru);
 
     /* Wakeup other thread waiting for this read */
     if (cckd->cckdwaiters && (flag & CCKD_CACHE_IOWAIT))
@@ -1367,11 +1437,29 @@ cckd_read_trk_retry:
 
 /*-------------------------------------------------------------------*/
 /* Schedule asynchronous readaheads                                  */
-/*-------------------------------------------------------------------*/
-void cckd_readahead (DEVBLK *dev, int trk)
+/*                                                                   */
+/* Called by the i/o thread for every track switch.  `hit' is 1 if   */
+/* the track was read ahead and not referenced until now, 0 for any  */
+/* other cache hit and -1 for a cache miss.                          */
+/*                                                                   */
+/* Each device keeps CCKD_RA_STREAMS sequential streams.  A track    */
+/* continues the stream whose last track lies up to                  */
+/* CCKD_RA_MAX_STRIDE tracks below it, otherwise it restarts the     */
+/* least recently used stream.  Strides of 1 or 2 are read ahead at  */
+/* once, larger strides only after they have been seen twice.  The   */
+/* depth starts at cckdblk.readaheads strides, doubles whenever the  */
+/* stream hits a track that was read ahead and halves whenever it    */
+/* misses a track that had been queued for readahead.                */
+/*-------------------------------------------------------------------*/
+void cckd_readahead (DEVBLK *dev, int trk, int hit)
 {
 CCKD_EXT       *cckd;                   /* -> cckd extension         */
-int             i, r;                   /* Indexes                   */
+CCKD_RASTREAM  *s;                      /* -> matching stream        */
+CCKD_RASTREAM  *t;                      /* -> stream being checked   */
+int             i, k, r;                /* Indexes                   */
+int             d;                      /* Track delta               */
+int             base;                   /* Last track already queued */
+int             n;                      /* Nbr tracks to queue       */
 TID             tid;                    /* Readahead thread id       */
 int             rc;
 
@@ -1382,43 +1470,121 @@ int             rc;
 
     obtain_lock (&cckdblk.ralock);
 
-    /* Scan the cache to see if the tracks are already there */
-    memset( cckd->ralkup, 0, sizeof(cckd->ralkup) );
-    cckd->ratrk = trk;
-    cache_lock(CACHE_DEVBUF);
-    cache_scan(CACHE_DEVBUF, cckd_readahead_scan, dev);
-    cache_unlock(CACHE_DEVBUF);
-
-    /* Scan the queue to see if the tracks are already there */
-    for (r = cckdblk.ra1st; r >= 0; r = cckdblk.ra[r].ra_idxnxt)
-        if (cckdblk.ra[r].ra_dev == dev)
+    /* Find the stream the track belongs to */
+    for (s = NULL, i = 0; i < CCKD_RA_STREAMS; i++)
+    {
+        t = &cckd->rastream[i];
+        if (!t->age) continue;
+        d = trk - t->last;
+        if (d == 0 || (t->stride && d == t->stride))
         {
-            i = cckdblk.ra[r].ra_trk - trk;
-            if (i > 0 && i <= cckdblk.readaheads)
-                cckd->ralkup[i-1] = 1;
+            s = t;
+            break;
         }
+        if (d > 0 && d <= CCKD_RA_MAX_STRIDE && (!s || d < trk - s->last))
+            s = t;
+    }
 
-    /* Queue the tracks to the readahead queue */
-    for (i = 1; i <= cckdblk.readaheads && cckdblk.rafree >= 0; i++)
+    if (s == NULL)
+    {
+        /* Restart the least recently used stream */
+        for (s = t = cckd->rastream; t < cckd->rastream + CCKD_RA_STREAMS; t++)
+            if (t->age < s->age) s = t;
+        s->last = s->qlast = trk;
+        s->stride = s->seen = 0;
+        s->depth = cckdblk.readaheads;
+    }
+    else if ((d = trk - s->last) != 0 && d == s->stride)
     {
-        if (cckd->ralkup[i-1]) continue;
-        if (trk + i >= dev->ckdtrks) break;
-        r = cckdblk.rafree;
-        cckdblk.rafree = cckdblk.ra[r].ra_idxnxt;
-        if (cckdblk.ralast < 0)
+        /* Same stride again; ramp the depth up or down if the track
+           was queued for readahead */
+        s->seen++;
+        if (s->seen == 2 && s->stride > 2)
+            cckdblk.stats_rastreams++;
+        if (trk <= s->qlast)
         {
-            cckdblk.ra1st = cckdblk.ralast = r;
-            cckdblk.ra[r].ra_idxprv = cckdblk.ra[r].ra_idxnxt = -1;
+            if (hit > 0 && s->depth < CCKD_MAX_READAHEADS)
+            {
+                s->depth = MIN(s->depth * 2, CCKD_MAX_READAHEADS);
+                cckdblk.stats_rarampups++;
+            }
+            else if (hit < 0 && s->depth > 1)
+            {
+                s->depth /= 2;
+                cckdblk.stats_rarampdowns++;
+            }
         }
-        else
+        s->last = trk;
+    }
+    else if (d != 0)
+    {
+        /* New stride */
+        s->last = s->qlast = trk;
+        s->stride = d;
+        s->seen = 1;
+        s->depth = cckdblk.readaheads;
+        if (s->stride <= 2)
+            cckdblk.stats_rastreams++;
+    }
+
+    s->age = ++cckd->raage;
+
+    /* Tracks beyond the ones already queued, up to `depth' strides */
+    n = 0;
+    base = s->qlast > trk ? s->qlast : trk;
+    if (s->stride && (s->stride <= 2 || s->seen > 1))
+        n = (trk + s->depth * s->stride - base) / s->stride;
+
+    if (n > 0)
+    {
+        if (n > CCKD_MAX_RA_SIZE)
+            n = CCKD_MAX_RA_SIZE;
+
+        /* Scan the cache to see if the tracks are already there */
+        memset( cckd->ralkup, 0, sizeof(cckd->ralkup) );
+        cckd->ratrk = base;
+        cckd->rastride = s->stride;
+        cckd->ranum = n;
+        cache_lock(CACHE_DEVBUF);
+        cache_scan(CACHE_DEVBUF, cckd_readahead_scan, dev);
+        cache_unlock(CACHE_DEVBUF);
+
+        /* Scan the queue to see if the tracks are already there */
+        for (r = cckdblk.ra1st; r >= 0; r = cckdblk.ra[r].ra_idxnxt)
+            if (cckdblk.ra[r].ra_dev == dev)
+            {
+                k = cckdblk.ra[r].ra_trk - base;
+                if (k > 0 && k % s->stride == 0 && k / s->stride <= n)
+                    cckd->ralkup[k / s->stride - 1] = 1;
+            }
+
+        /* Queue the tracks to the readahead queue */
+        for (i = 1; i <= n; i++)
         {
-            cckdblk.ra[cckdblk.ralast].ra_idxnxt = r;
-            cckdblk.ra[r].ra_idxprv = cckdblk.ralast;
-            cckdblk.ra[r].ra_idxnxt = -1;
-            cckdblk.ralast = r;
+            k = base + i * s->stride;
+            if (k >= dev->ckdtrks) break;
+            if (!cckd->ralkup[i-1])
+            {
+                if (cckdblk.rafree < 0) break;
+                r = cckdblk.rafree;
+                cckdblk.rafree = cckdblk.ra[r].ra_idxnxt;
+                if (cckdblk.ralast < 0)
+                {
+                    cckdblk.ra1st = cckdblk.ralast = r;
+                    cckdblk.ra[r].ra_idxprv = cckdblk.ra[r].ra_idxnxt = -1;
+                }
+                else
+                {
+                    cckdblk.ra[cckdblk.ralast].ra_idxnxt = r;
+                    cckdblk.ra[r].ra_idxprv = cckdblk.ralast;
+                    cckdblk.ra[r].ra_idxnxt = -1;
+                    cckdblk.ralast = r;
+                }
+                cckdblk.ra[r].ra_trk = k;
+                cckdblk.ra[r].ra_dev = dev;
+            }
+            s->qlast = k;
         }
-        cckdblk.ra[r].ra_trk = trk + i;
-        cckdblk.ra[r].ra_dev = dev;
     }
 
     /* Schedule the readahead if any are pending */
@@ -1473,12 +1639,160 @@ int             k;                      /* Index                     */
     if (devnum == dev->devnum)
     {
         k = (int)trk - cckd->ratrk;
-        if (k > 0 && k <= cckdblk.readaheads)
-            cckd->ralkup[k-1] = 1;
+        if (k > 0 && k % cckd->rastride == 0
+         && k / cckd->rastride <= cckd->ranum)
+            cckd->ralkup[k / cckd->rastride - 1] = 1;
     }
     return 0;
 }
 
+#if defined( OPTION_CCKD_IO_URING )
+/*-------------------------------------------------------------------*/
+/* Readahead io_uring                                                */
+/*                                                                   */
+/* Each readahead thread owns a ring, so no locking is needed.  The  */
+/* ring is driven with the raw system calls; readv is used because   */
+/* it is the oldest read opcode io_uring supports.                   */
+/*-------------------------------------------------------------------*/
+struct CCKD_URING {
+        int              fd;            /* Ring fd (-1=no ring)      */
+        struct io_uring_params p;       /* Ring parameters           */
+        BYTE            *sq;            /* Submission queue ring     */
+        size_t           sqlen;         /* Length of sq mapping      */
+        BYTE            *cq;            /* Completion queue ring     */
+        size_t           cqlen;         /* Length of cq mapping      */
+        struct io_uring_sqe *sqes;      /* Submission queue entries  */
+        size_t           sqeslen;       /* Length of sqes mapping    */
+};
+
+#define URING_U32(_r,_q,_f) \
+        ((U32*)((_r)->_q + (_r)->p._q##_off._f))
+
+int cckd_uring_init (CCKD_URING *ring)
+{
+    memset( ring, 0, sizeof( *ring ));
+    ring->sq = ring->cq = MAP_FAILED;
+    ring->sqes = MAP_FAILED;
+
+    ring->fd = syscall( __NR_io_uring_setup, CCKD_MAX_RA_SIZE, &ring->p );
+    if (ring->fd < 0)
+        return -1;
+
+    ring->sqlen   = ring->p.sq_off.array + ring->p.sq_entries * sizeof( U32 );
+    ring->cqlen   = ring->p.cq_off.cqes
+                  + ring->p.cq_entries * sizeof( struct io_uring_cqe );
+    ring->sqeslen = ring->p.sq_entries * sizeof( struct io_uring_sqe );
+
+    ring->sq   = mmap( NULL, ring->sqlen, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING );
+    ring->cq   = mmap( NULL, ring->cqlen, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING );
+    ring->sqes = mmap( NULL, ring->sqeslen, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES );
+
+    if (ring->sq == MAP_FAILED || ring->cq == MAP_FAILED
+     || ring->sqes == MAP_FAILED)
+    {
+        int save_errno = errno;
+        cckd_uring_term( ring );
+        errno = save_errno;
+        return -1;
+    }
+
+    return 0;
+}
+
+void cckd_uring_term (CCKD_URING *ring)
+{
+    if (ring->fd < 0)
+        return;
+    if (ring->sqes != MAP_FAILED) munmap( ring->sqes, ring->sqeslen );
+    if (ring->cq   != MAP_FAILED) munmap( ring->cq,   ring->cqlen   );
+    if (ring->sq   != MAP_FAILED) munmap( ring->sq,   ring->sqlen   );
+    close( ring->fd );
+    ring->fd = -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Read a batch of file extents and wait for all of them             */
+/*                                                                   */
+/* req[i].rc is set to the number of bytes read or to -errno.  Any   */
+/* request the kernel didn't accept is read with pread instead.      */
+/*-------------------------------------------------------------------*/
+void cckd_uring_read (CCKD_URING *ring, CCKD_IOREQ *req, int n)
+{
+struct iovec    iov[CCKD_MAX_RA_SIZE];  /* One buffer per request    */
+struct io_uring_sqe *sqe;               /* -> submission entry       */
+struct io_uring_cqe *cqe;               /* -> completion entry       */
+U32             mask, head, tail;       /* Ring indexes              */
+int             i, rc;
+int             sent = 0;               /* Requests submitted        */
+int             done = 0;               /* Requests completed        */
+
+    /* Queue the requests */
+    mask = *URING_U32( ring, sq, ring_mask );
+    tail = *URING_U32( ring, sq, tail );
+    for (i = 0; i < n; i++, tail++)
+    {
+        iov[i].iov_base = req[i].buf;
+        iov[i].iov_len  = req[i].len;
+        req[i].rc = -ECANCELED;
+
+        sqe = &ring->sqes[ tail & mask ];
+        memset( sqe, 0, sizeof( *sqe ));
+        sqe->opcode    = IORING_OP_READV;
+        sqe->fd        = req[i].fd;
+        sqe->off       = req[i].off;
+        sqe->addr      = (U64)(uintptr_t)&iov[i];
+        sqe->len       = 1;
+        sqe->user_data = i;
+        URING_U32( ring, sq, array )[ tail & mask ] = tail & mask;
+    }
+    __atomic_store_n( URING_U32( ring, sq, tail ), tail, __ATOMIC_RELEASE );
+
+    /* Submit them */
+    while (sent < n)
+    {
+        rc = syscall( __NR_io_uring_enter, ring->fd, n - sent, 0, 0, NULL, 0 );
+        if (rc > 0)
+            sent += rc;
+        else if (rc == 0 || errno != EINTR)
+            break;
+    }
+
+    /* Reap the completions of the submitted ones */
+    mask = *URING_U32( ring, cq, ring_mask );
+    while (done < sent)
+    {
+        head = *URING_U32( ring, cq, head );
+        tail = __atomic_load_n( URING_U32( ring, cq, tail ), __ATOMIC_ACQUIRE );
+        if (head == tail)
+        {
+            syscall( __NR_io_uring_enter, ring->fd, 0, 1,
+                     IORING_ENTER_GETEVENTS, NULL, 0 );
+            continue;
+        }
+        cqe = &((struct io_uring_cqe*)(ring->cq + ring->p.cq_off.cqes))[ head & mask ];
+        if (cqe->user_data < (U64)n)
+            req[ cqe->user_data ].rc = cqe->res;
+        __atomic_store_n( URING_U32( ring, cq, head ), head + 1, __ATOMIC_RELEASE );
+        done++;
+    }
+
+    /* The ring is unusable if the kernel refused requests */
+    if (sent < n)
+    {
+        cckd_uring_term( ring );
+        for (i = sent; i < n; i++)
+        {
+            rc = pread( req[i].fd, req[i].buf, req[i].len, req[i].off );
+            req[i].rc = rc < 0 ? -errno : rc;
+        }
+    }
+
+} /* end function cckd_uring_read */
+#endif /* defined( OPTION_CCKD_IO_URING ) */
+
 /*-------------------------------------------------------------------*/
 /* Asynchronous readahead thread                                     */
 /*-------------------------------------------------------------------*/
@@ -1493,6 +1807,12 @@ TID             tid;                    /* Readahead thread id       */
 char            threadname[40];
 int             rc;
 int             ras;
+#if defined( OPTION_CCKD_IO_URING )
+CCKD_URING      ring;                   /* This thread's io_uring    */
+int             trks[CCKD_MAX_RA_SIZE]; /* Tracks to read in a batch */
+int             n;                      /* Number of tracks in batch */
+int             k;                      /* Next readahead queue index*/
+#endif
 
     UNREFERENCED(arg);
 
@@ -1528,6 +1848,18 @@ int             ras;
         // "Thread id "TIDPAT", prio %d, name '%s' started"
         LOG_THREAD_BEGIN( threadname );
 
+#if defined( OPTION_CCKD_IO_URING )
+    /* Without a ring the tracks are read one at a time */
+    if (!cckdblk.rauring)
+        ring.fd = -1;
+    else if (cckd_uring_init( &ring ) < 0)
+    {
+        // "CCKD io_uring not available: %s; reading ahead one track at a time"
+        WRMSG( HHC00382, "W", strerror( errno ));
+        cckdblk.rauring = 0;
+    }
+#endif
+
     while (ra <= cckdblk.ramax)   /* continue until ramax=0 (shutdown) or max reduced by command line */
     {
         if (cckdblk.ra1st < 0)
@@ -1555,6 +1887,27 @@ int             ras;
         cckdblk.ra[r].ra_idxnxt = cckdblk.rafree;
         cckdblk.rafree = r;
 
+#if defined( OPTION_CCKD_IO_URING )
+        /* Take the device's other queued tracks along in the batch */
+        trks[0] = trk;
+        n = 1;
+        for (r = cckdblk.ra1st; r >= 0 && ring.fd >= 0 && cckdblk.rauring; r = k)
+        {
+            k = cckdblk.ra[r].ra_idxnxt;
+            if (cckdblk.ra[r].ra_dev != dev)
+                continue;
+            trks[n++] = cckdblk.ra[r].ra_trk;
+            if (cckdblk.ra[r].ra_idxprv >= 0)
+                cckdblk.ra[cckdblk.ra[r].ra_idxprv].ra_idxnxt = k;
+            else cckdblk.ra1st = k;
+            if (k >= 0)
+                cckdblk.ra[k].ra_idxprv = cckdblk.ra[r].ra_idxprv;
+            else cckdblk.ralast = cckdblk.ra[r].ra_idxprv;
+            cckdblk.ra[r].ra_idxnxt = cckdblk.rafree;
+            cckdblk.rafree = r;
+        }
+#endif
+
         /* Schedule the other readaheads if any are still pending */
         if (cckdblk.ra1st)
         {
@@ -1593,6 +1946,11 @@ int             ras;
 
         release_lock (&cckdblk.ralock);
         {
+#if defined( OPTION_CCKD_IO_URING )
+            if (n > 1)
+                cckd_ra_batch (dev, trks, n, ra, &ring);
+            else
+#endif
             /* Read the readahead track */
             cckd_read_trk (dev, trk, ra, NULL);
         }
@@ -1605,6 +1963,10 @@ int             ras;
         // "Thread id "TIDPAT", prio %d, name '%s' ended"
         LOG_THREAD_END( threadname );
 
+#if defined( OPTION_CCKD_IO_URING )
+    cckd_uring_term( &ring );
+#endif
+
     --cckdblk.ras;
     --cckdblk.raa;
 
@@ -1618,6 +1980,188 @@ int             ras;
     return NULL;
 } /* end thread cckd_ra_thread */
 
+#if defined( OPTION_CCKD_IO_URING )
+/*-------------------------------------------------------------------*/
+/* Read a batch of readahead tracks                                  */
+/*                                                                   */
+/* Called by a readahead thread for queued tracks of one device.     */
+/* A cache entry is stolen for each track not already cached, the    */
+/* level 2 entries are looked up and the track images are then read  */
+/* with a single io_uring submission, so that all of them can be in  */
+/* flight at once on any of the shadow files.  Tracks for which no   */
+/* cache entry is available are simply not read ahead.               */
+/*-------------------------------------------------------------------*/
+void cckd_ra_batch (DEVBLK *dev, int *trks, int n, int ra, CCKD_URING *ring)
+{
+CCKD_EXT       *cckd;                   /* -> cckd extension         */
+CCKD_L2ENT      l2;                     /* Level 2 entry             */
+CCKD_IOREQ      req[CCKD_MAX_RA_SIZE];  /* Track image reads         */
+int             map[CCKD_MAX_RA_SIZE];  /* Track index for each read */
+int             ix[CCKD_MAX_RA_SIZE];   /* Cache index for each track*/
+int             trk[CCKD_MAX_RA_SIZE];  /* Track numbers             */
+int             sfx[CCKD_MAX_RA_SIZE];  /* File index for each track */
+int             len[CCKD_MAX_RA_SIZE];  /* Track image lengths       */
+int             i, m, r;                /* Indexes                   */
+int             fnd, lru;               /* Cache indexes             */
+int             maxlen;                 /* Length for buffer         */
+U64             key;                    /* Cache key of the track    */
+U16             devnum;                 /* Device number             */
+U32             oldtrk;                 /* Stolen track number       */
+U32             flag;                   /* Cache flag                */
+BYTE           *buf;                    /* Read buffer               */
+
+    if (dev->cckd64)
+    {
+        cckd64_ra_batch( dev, trks, n, ra, ring );
+        return;
+    }
+
+    cckd = dev->cckd_ext;
+
+    maxlen = cckd->ckddasd ? dev->ckdtrksz
+                           : CFBA_BLKGRP_SIZE + CKD_TRKHDR_SIZE;
+
+    /* Steal a cache entry for each track that isn't cached */
+    for (i = m = 0; i < n && i < CCKD_MAX_RA_SIZE; i++)
+    {
+        key = CCKD_CACHE_SETKEY(dev->devnum, trks[i]);
+        cache_lock_key (CACHE_DEVBUF, key);
+        fnd = cache_lookup (CACHE_DEVBUF, key, &lru);
+        if (fnd >= 0 || lru < 0)
+        {
+            cache_unlock_key (CACHE_DEVBUF, key);
+            continue;
+        }
+
+        CCKD_CACHE_GETKEY(lru, devnum, oldtrk);
+        if (devnum != 0)
+        {
+            CCKD_TRACE( "%d rdtrk[%d] %d dropping %4.4X:%d from cache",
+                        ra, lru, trks[i], devnum, oldtrk);
+            if (!(cache_getflag(CACHE_DEVBUF, lru) & CCKD_CACHE_USED))
+            {
+                cckdblk.stats_readaheadmisses++;  cckd->misses++;
+            }
+        }
+
+        cache_setkey(CACHE_DEVBUF, lru, key);
+        cache_setflag(CACHE_DEVBUF, lru, 0, CCKD_CACHE_READING);
+        cache_setage(CACHE_DEVBUF, lru);
+        cache_setval(CACHE_DEVBUF, lru, 0);
+        cache_setflag(CACHE_DEVBUF, lru, ~CACHE_TYPE,
+                      cckd->ckddasd ? DEVBUF_TYPE_CCKD : DEVBUF_TYPE_CFBA);
+        buf = cache_getbuf(CACHE_DEVBUF, lru, maxlen);
+
+        cache_unlock_key (CACHE_DEVBUF, key);
+
+        if (dev->batch) memset(buf, 0, maxlen);
+
+        ix[m] = lru;
+        trk[m++] = trks[i];
+    }
+
+    if (m == 0)
+        return;
+
+    obtain_lock (&cckd->filelock);
+
+    /* Look up the track images, building the null ones right away */
+    for (i = r = 0; i < m; i++)
+    {
+        buf = cache_getbuf(CACHE_DEVBUF, ix[i], 0);
+        if ((sfx[i] = cckd_read_l2ent (dev, &l2, trk[i])) < 0)
+            len[i] = -1;
+        else if (l2.L2_trkoff == 0)
+            len[i] = cckd_null_trk (dev, buf, trk[i], l2.L2_len);
+        else
+        {
+            CCKD_TRACE( "file[%d] fd[%d] read, off 0x%16.16"PRIx64" len %d",
+                        sfx[i], cckd->fd[sfx[i]], (U64)l2.L2_trkoff, l2.L2_len);
+            req[r].fd  = cckd->fd[sfx[i]];
+            req[r].off = l2.L2_trkoff;
+            req[r].buf = buf;
+            req[r].len = l2.L2_len;
+            map[r++] = i;
+        }
+    }
+
+    /* Read the track images */
+    if (r > 0)
+        cckd_uring_read (ring, req, r);
+
+    while (r-- > 0)
+    {
+        i = map[r];
+        if (req[r].rc < (int)req[r].len)
+        {
+            if (req[r].rc < 0)
+                // "%1d:%04X CCKD file[%d] %s: error in function %s at offset 0x%16.16"PRIX64": %s"
+                WRMSG( HHC00302, "E", LCSS_DEVNUM, sfx[i], cckd_sf_name( dev, sfx[i] ),
+                    "read()", req[r].off, strerror( -req[r].rc ));
+            else
+            {
+                char msgbuf[128];
+                MSGBUF( msgbuf, "read incomplete: read %d, expected %d",
+                        req[r].rc, req[r].len );
+                // "%1d:%04X CCKD file[%d] %s: error in function %s at offset 0x%16.16"PRIX64": %s"
+                WRMSG( HHC00302, "E", LCSS_DEVNUM, sfx[i], cckd_sf_name( dev, sfx[i] ),
+                    "read()", req[r].off, msgbuf );
+            }
+            cckd_print_itrace ();
+            len[i] = -1;
+            continue;
+        }
+
+        len[i] = req[r].rc;
+        cckd->reads[sfx[i]]++;
+        cckd->totreads++;
+        cckdblk.stats_reads++;
+        cckdblk.stats_readbytes += len[i];
+        if (cckd->notnull == 0 && trk[i] > 1) cckd->notnull = 1;
+    }
+
+    /* Validate the track images */
+    for (i = 0; i < m; i++)
+    {
+        buf = cache_getbuf(CACHE_DEVBUF, ix[i], 0);
+        if (len[i] < 0 || cckd_cchh (dev, buf, trk[i]) < 0)
+            len[i] = cckd_null_trk (dev, buf, trk[i], 0);
+    }
+
+    release_lock (&cckd->filelock);
+
+    obtain_lock (&cckd->cckdiolock);
+
+    for (i = 0; i < m; i++)
+    {
+        cache_setval (CACHE_DEVBUF, ix[i], len[i]);
+
+        /* Turn off the READING bit */
+        cache_lock_entry (CACHE_DEVBUF, ix[i]);
+        flag = cache_setflag(CACHE_DEVBUF, ix[i], ~CCKD_CACHE_READING, 0);
+        cache_unlock_entry (CACHE_DEVBUF, ix[i]);
+
+        /* Wakeup other thread waiting for this read */
+        if (cckd->cckdwaiters && (flag & CCKD_CACHE_IOWAIT))
+        {   CCKD_TRACE( "%d rdtrk[%d] %d signalling read complete",
+                        ra, ix[i], trk[i]);
+            broadcast_condition (&cckd->cckdiocond);
+        }
+
+        CCKD_TRACE( "%d rdtrk[%d] %d batch read complete", ra, ix[i], trk[i]);
+    }
+
+    release_lock (&cckd->cckdiolock);
+
+    cckdblk.stats_readaheads += m; cckd->readaheads += m;
+    cckdblk.stats_rabatches++;
+    cckdblk.stats_rabatchtrks += m;
+
+    if (cache_busy_percent(CACHE_DEVBUF) > 80) cckd_flush_cache_all();
+
+} /* end function cckd_ra_batch */
+#endif /* defined( OPTION_CCKD_IO_URING ) */
+
 /*-------------------------------------------------------------------*/
 /* Flush updated cache entries for a device                          */
 /*                                                                   */
@@ -1626,9 +2170,6 @@ int             ras;
 /*-------------------------------------------------------------------*/
 void cckd_flush_cache(DEVBLK *dev)
 {
-int             rc;                     /* Return code               */
-TID             tid;                    /* Writer thread id          */
-
     if (dev->cckd64)
     {
         cckd64_flush_cache( dev );
@@ -1641,38 +2182,9 @@ TID             tid;                    /* Writer thread id          */
     cache_scan (CACHE_DEVBUF, cckd_flush_cache_scan, dev);
     cache_unlock (CACHE_DEVBUF);
 
-    /* Schedule the writer if any writes are pending */
+    /* Schedule the compressors or writers if any writes are pending */
     if (cckdblk.wrpending)
-    {
-        if (cckdblk.wrwaiting)
-            signal_condition (&cckdblk.wrcond);
-        else if (cckdblk.wrs < cckdblk.wrmax)
-        {
-            /* Schedule a new writer thread  */
-            if (!cckdblk.batch || cckdblk.batchml > 1)
-                // "Starting thread %s, active=%d, started=%d, max=%d"
-                WRMSG(HHC00107, "I", CCKD_WR_THREAD_NAME "()",
-                    cckdblk.wra, cckdblk.wrs, cckdblk.wrmax);
-
-            ++cckdblk.wrs;
-
-            /* Release lock across thread create to prevent interlock  */
-            release_lock(&cckdblk.wrlock);
-            {
-                rc = create_thread( &tid, JOINABLE, cckd_writer, NULL, CCKD_WR_THREAD_NAME );
-            }
-            obtain_lock(&cckdblk.wrlock);
-
-            if (rc)
-            {
-                // "Error in function create_thread() for %s %d of %d: %s"
-                WRMSG(HHC00106, "E", CCKD_WR_THREAD_NAME "()",
-                    cckdblk.wrs-1, cckdblk.wrmax, strerror(rc));
-
-                --cckdblk.wrs;
-            }
-        }
-    }
+        cckd_schedule_writes();
 
     release_lock (&cckdblk.wrlock);
 }
@@ -1704,89 +2216,371 @@ void cckd_flush_cache_all()
 CCKD_EXT       *cckd;                   /* -> cckd extension         */
 DEVBLK         *dev = NULL;             /* -> device block           */
 
-    cckd_lock_devchain(0);
-    for (dev = cckdblk.dev1st; dev; dev = cckd->devnext)
-    {
-        cckd = dev->cckd_ext;
-        obtain_lock (&cckd->cckdiolock);
-        if (!cckd->merging && !cckd->stopping)
-            cckd_flush_cache(dev);
-        release_lock (&cckd->cckdiolock);
-    }
-    cckd_unlock_devchain();
+    cckd_lock_devchain(0);
+    for (dev = cckdblk.dev1st; dev; dev = cckd->devnext)
+    {
+        cckd = dev->cckd_ext;
+        obtain_lock (&cckd->cckdiolock);
+        if (!cckd->merging && !cckd->stopping)
+            cckd_flush_cache(dev);
+        release_lock (&cckd->cckdiolock);
+    }
+    cckd_unlock_devchain();
+}
+
+/*-------------------------------------------------------------------*/
+/* Purge cache entries for a device                                  */
+/*                                                                   */
+/* Caller holds the cckdiolock                                       */
+/* cache_lock is obtained and released                               */
+/*-------------------------------------------------------------------*/
+void cckd_purge_cache(DEVBLK *dev)
+{
+    if (dev->cckd64)
+    {
+        cckd64_purge_cache( dev );
+        return;
+    }
+
+    /* Scan cache and purge entries */
+    cache_lock (CACHE_DEVBUF);
+    cache_scan (CACHE_DEVBUF, cckd_purge_cache_scan, dev);
+    cache_unlock (CACHE_DEVBUF);
+}
+int cckd_purge_cache_scan (int *answer, int ix, int i, void *data)
+{
+U16             devnum;                 /* Cached device number      */
+U32             trk;                    /* Cached track              */
+DEVBLK         *dev = data;             /* -> device block           */
+
+    UNREFERENCED(answer);
+    CCKD_CACHE_GETKEY(i, devnum, trk);
+    if (dev->devnum == devnum)
+    {
+        cache_release (ix, i, 0);
+        CCKD_TRACE( "purge cache[%d] %4.4X trk %d purged",
+                    i, devnum, trk);
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Wake a waiting writer thread or start a new one                   */
+/*                                                                   */
+/* Caller holds cckdblk.wrlock, which is released across the create  */
+/*-------------------------------------------------------------------*/
+void cckd_writer_start( const char* desc )
+{
+int             rc;                     /* Return code               */
+TID             tid;                    /* Writer thread id          */
+
+    if (cckdblk.wrwaiting)
+    {
+        signal_condition( &cckdblk.wrcond );
+        return;
+    }
+
+    if (cckdblk.wrs >= cckdblk.wrmax)
+        return;
+
+    /* Schedule a new writer thread */
+
+    if (!cckdblk.batch || cckdblk.batchml > 1)
+        // "Starting thread %s, active=%d, started=%d, max=%d"
+        WRMSG( HHC00107, "I", desc,
+            cckdblk.wra, cckdblk.wrs, cckdblk.wrmax );
+
+    ++cckdblk.wrs;
+
+    /* Release lock across thread create to prevent interlock  */
+    release_lock( &cckdblk.wrlock );
+    {
+        rc = create_thread( &tid, JOINABLE, cckd_writer, NULL, CCKD_WR_THREAD_NAME );
+    }
+    obtain_lock( &cckdblk.wrlock );
+
+    if (rc)
+    {
+        // "Error in function create_thread() for %s %d of %d: %s"
+        WRMSG( HHC00106, "E", desc,
+            cckdblk.wrs-1, cckdblk.wrmax, strerror( rc ));
+
+        --cckdblk.wrs;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Schedule the pending writes                                       */
+/*                                                                   */
+/* The compressor threads take the pending writes if there are any;  */
+/* otherwise the writer threads compress the track images inline.    */
+/*                                                                   */
+/* Caller holds cckdblk.wrlock                                       */
+/*-------------------------------------------------------------------*/
+void cckd_schedule_writes()
+{
+    if (cckdblk.cmpmax > 0)
+    {
+        cckd_cmp_start( CCKD_CMP_THREAD_NAME "()" );
+
+        if (cckdblk.cmps)
+            return;
+    }
+
+    cckd_writer_start( CCKD_WR_THREAD_NAME "()" );
+}
+
+/*-------------------------------------------------------------------*/
+/* Writer thread                                                     */
+/*-------------------------------------------------------------------*/
+void* cckd_writer( void* arg )
+{
+int             writer;                 /* Writer identifier         */
+int             o;                      /* Cache entry found         */
+int             q;                      /* Write queue entry         */
+char            threadname[40];
+int             wrs;
+
+    UNREFERENCED( arg );
+
+    /* Set the writer thread's priority just BELOW the CPU threads'
+       in order to minimize any potential impact from compression.
+    */
+    if (!cckdblk.batch)
+    {
+        cckdblk.wrprio = sysblk.cpuprio - 1;
+        set_thread_priority( cckdblk.wrprio );
+    }
+
+    obtain_lock( &cckdblk.wrlock );
+
+    writer = ++cckdblk.wra;
+    MSGBUF( threadname, CCKD_WR_THREAD_NAME " thread %d", writer );
+
+    /* Return with message if too many already started */
+    if (writer > cckdblk.wrmax)
+    {
+        --cckdblk.wrs;  /* decrease threads started */
+        --cckdblk.wra;  /* decrease threads active  */
+
+        if (!cckdblk.wrmax)  /* choose thread termination message  */
+        {
+            if (!cckdblk.batch || cckdblk.batchml > 1)
+              // "Thread id "TIDPAT", prio %d, name '%s' ended"
+              LOG_THREAD_END( threadname  );
+        }
+        else
+            if (!cckdblk.batch || cckdblk.batchml > 0)
+                // "Ending thread "TIDPAT" %s, pri=%d, started=%d, max=%d exceeded"
+                WRMSG( HHC00108, "W", TID_CAST( thread_id()), threadname,
+                get_thread_priority(), writer, cckdblk.wrmax );
+
+        release_lock( &cckdblk.wrlock );
+        signal_condition( &cckdblk.termcond );/* shutting down */
+        return NULL;
+    }
+
+    if (!cckdblk.batch || cckdblk.batchml > 1)
+        // "Thread id "TIDPAT", prio %d, name '%s' started"
+        LOG_THREAD_BEGIN( threadname  );
+
+    while (0
+        || writer <= cckdblk.wrmax
+        || cckdblk.wrq1st >= 0
+        || (!cckdblk.cmps && cckdblk.wrpending)
+    )
+    {
+        /* Take the oldest track image already compressed */
+        if ((q = cckdblk.wrq1st) >= 0)
+        {
+            if ((cckdblk.wrq1st = cckdblk.wrq[q].wrq_idxnxt) < 0)
+                cckdblk.wrqlast = -1;
+            o = cckdblk.wrq[q].wrq_o;
+        }
+
+        /* With no compressors, scan the cache for the oldest pending
+           write and compress it here */
+        else if (!cckdblk.cmps && cckdblk.wrpending)
+        {
+            cache_lock( CACHE_DEVBUF );
+            {
+                o = cache_scan( CACHE_DEVBUF, cckd_writer_scan, NULL );
+
+                /* Possibly shutting down if no writes pending */
+                if (o < 0)
+                {
+                    cache_unlock( CACHE_DEVBUF );
+                    cckdblk.wrpending = 0;
+                    continue;
+                }
+
+                /* We will process this cache entry. Clear flags to prevent
+                   any other writer threads from trying to process it too. */
+                cache_setflag( CACHE_DEVBUF, o, ~CCKD_CACHE_WRITE, CCKD_CACHE_WRITING );
+            }
+            cache_unlock (CACHE_DEVBUF);
+
+            cckdblk.wrpending--;
+        }
+
+        /* Wait for work */
+        else
+        {
+            cckdblk.wrwaiting++;
+            {
+                wait_condition( &cckdblk.wrcond, &cckdblk.wrlock );
+            }
+            cckdblk.wrwaiting--;
+            continue;
+        }
+
+        /* Schedule the other writers if any writes are still pending */
+        if (cckdblk.wrq1st >= 0 || (!cckdblk.cmps && cckdblk.wrpending))
+            cckd_writer_start( CCKD_WR_THREAD_NAME "() from " CCKD_WR_THREAD_NAME "()" );
+
+        /* Write the updated track image */
+        release_lock( &cckdblk.wrlock );
+        {
+            if (q >= 0)
+                cckd_writer_write( writer, o, cckdblk.wrq[q].wrq_bufp,
+                                              cckdblk.wrq[q].wrq_bufl );
+            else
+                cckd_writer_write( writer, o, NULL, 0 );
+        }
+        obtain_lock( &cckdblk.wrlock );
+
+        /* Free the write queue entry and let any compressor
+           that was held back by the queue limits continue */
+        if (q >= 0)
+        {
+            cckdblk.wrq[q].wrq_o      = -1;
+            cckdblk.wrq[q].wrq_idxnxt = cckdblk.wrqfree;
+            cckdblk.wrqfree = q;
+            cckdblk.wrqn--;
+
+            if (cckdblk.cmpwaiting && cckdblk.wrpending)
+                signal_condition( &cckdblk.cmpcond );
+        }
+    }
+    /* end while (writer <= cckdblk.wrmax || writes pending) */
+
+    if (!cckdblk.batch || cckdblk.batchml > 1)
+        // "Thread id "TIDPAT", prio %d, name '%s' ended"
+        LOG_THREAD_END( threadname  );
+
+    cckdblk.wrs--;
+    cckdblk.wra--;
+
+    wrs = cckdblk.wrs;
+
+    release_lock( &cckdblk.wrlock );
+
+    if (!wrs)
+        signal_condition( &cckdblk.termcond );
+
+    return NULL;
+} /* end thread cckd_writer */
+
+int cckd_writer_scan( int* o, int ix, int i, void* data )
+{
+    UNREFERENCED( data );
+
+    if (1
+        && (cache_getflag( ix, i ) & DEVBUF_TYPE_COMP)
+        && (cache_getflag( ix, i ) & CCKD_CACHE_WRITE)
+        && (0
+            || *o == -1
+            || cache_getage( ix, i ) < cache_getage( ix, *o )
+           )
+    )
+        *o = i;
+
+    return 0;
 }
 
 /*-------------------------------------------------------------------*/
-/* Purge cache entries for a device                                  */
+/* Wake a waiting compressor thread or start a new one               */
 /*                                                                   */
-/* Caller holds the cckdiolock                                       */
-/* cache_lock is obtained and released                               */
+/* Caller holds cckdblk.wrlock, which is released across the create  */
 /*-------------------------------------------------------------------*/
-void cckd_purge_cache(DEVBLK *dev)
+void cckd_cmp_start( const char* desc )
 {
-    if (dev->cckd64)
+int             rc;                     /* Return code               */
+TID             tid;                    /* Compressor thread id      */
+
+    if (cckdblk.cmpwaiting)
     {
-        cckd64_purge_cache( dev );
+        signal_condition( &cckdblk.cmpcond );
         return;
     }
 
-    /* Scan cache and purge entries */
-    cache_lock (CACHE_DEVBUF);
-    cache_scan (CACHE_DEVBUF, cckd_purge_cache_scan, dev);
-    cache_unlock (CACHE_DEVBUF);
-}
-int cckd_purge_cache_scan (int *answer, int ix, int i, void *data)
-{
-U16             devnum;                 /* Cached device number      */
-U32             trk;                    /* Cached track              */
-DEVBLK         *dev = data;             /* -> device block           */
+    if (cckdblk.cmps >= cckdblk.cmpmax)
+        return;
 
-    UNREFERENCED(answer);
-    CCKD_CACHE_GETKEY(i, devnum, trk);
-    if (dev->devnum == devnum)
+    /* Schedule a new compressor thread */
+
+    if (!cckdblk.batch || cckdblk.batchml > 1)
+        // "Starting thread %s, active=%d, started=%d, max=%d"
+        WRMSG( HHC00107, "I", desc,
+            cckdblk.cmpa, cckdblk.cmps, cckdblk.cmpmax );
+
+    ++cckdblk.cmps;
+
+    /* Release lock across thread create to prevent interlock  */
+    release_lock( &cckdblk.wrlock );
     {
-        cache_release (ix, i, 0);
-        CCKD_TRACE( "purge cache[%d] %4.4X trk %d purged",
-                    i, devnum, trk);
+        rc = create_thread( &tid, JOINABLE, cckd_cmp, NULL, CCKD_CMP_THREAD_NAME );
+    }
+    obtain_lock( &cckdblk.wrlock );
+
+    if (rc)
+    {
+        // "Error in function create_thread() for %s %d of %d: %s"
+        WRMSG( HHC00106, "E", desc,
+            cckdblk.cmps-1, cckdblk.cmpmax, strerror( rc ));
+
+        --cckdblk.cmps;
     }
-    return 0;
 }
 
 /*-------------------------------------------------------------------*/
-/* Writer thread                                                     */
+/* Compressor thread                                                 */
+/*                                                                   */
+/* Takes the oldest pending write, compresses the track image into   */
+/* a write queue entry and passes the entry on to the writers, so    */
+/* that compression runs on as many host processors as there are     */
+/* compressors while the writers only do the file i/o.               */
 /*-------------------------------------------------------------------*/
-void* cckd_writer( void* arg )
+void* cckd_cmp( void* arg )
 {
-int             writer;                 /* Writer identifier         */
+int             cmp;                    /* Compressor identifier     */
 int             o;                      /* Cache entry found         */
-TID             tid;                    /* Writer thead id           */
+int             q;                      /* Write queue entry         */
+U16             devnum;                 /* Device number             */
+int             trk;                    /* Track number              */
+BYTE*           bufp;                   /* Image to be written       */
+int             bufl;                   /* Image length              */
 char            threadname[40];
-int             rc;
-int             wrs;
+int             cmps;
 
     UNREFERENCED( arg );
 
-    /* Set the writer thread's priority just BELOW the CPU threads'
-       in order to minimize any potential impact from compression.
-    */
+    /* Run just BELOW the CPU threads like the writers do */
     if (!cckdblk.batch)
-    {
-        cckdblk.wrprio = sysblk.cpuprio - 1;
         set_thread_priority( cckdblk.wrprio );
-    }
 
     obtain_lock( &cckdblk.wrlock );
 
-    writer = ++cckdblk.wra;
-    MSGBUF( threadname, CCKD_WR_THREAD_NAME " thread %d", writer );
+    cmp = ++cckdblk.cmpa;
+    MSGBUF( threadname, CCKD_CMP_THREAD_NAME " thread %d", cmp );
 
     /* Return with message if too many already started */
-    if (writer > cckdblk.wrmax)
+    if (cmp > cckdblk.cmpmax)
     {
-        --cckdblk.wrs;  /* decrease threads started */
-        --cckdblk.wra;  /* decrease threads active  */
+        --cckdblk.cmps;  /* decrease threads started */
+        --cckdblk.cmpa;  /* decrease threads active  */
 
-        if (!cckdblk.wrmax)  /* choose thread termination message  */
+        if (!cckdblk.cmpmax)  /* choose thread termination message  */
         {
             if (!cckdblk.batch || cckdblk.batchml > 1)
               // "Thread id "TIDPAT", prio %d, name '%s' ended"
@@ -1796,7 +2590,11 @@ int             wrs;
             if (!cckdblk.batch || cckdblk.batchml > 0)
                 // "Ending thread "TIDPAT" %s, pri=%d, started=%d, max=%d exceeded"
                 WRMSG( HHC00108, "W", TID_CAST( thread_id()), threadname,
-                get_thread_priority(), writer, cckdblk.wrmax );
+                get_thread_priority(), cmp, cckdblk.cmpmax );
+
+        /* Let the writers take over any writes still pending */
+        if (!cckdblk.cmps && cckdblk.wrpending)
+            cckd_writer_start( CCKD_WR_THREAD_NAME "() from " CCKD_CMP_THREAD_NAME "()" );
 
         release_lock( &cckdblk.wrlock );
         signal_condition( &cckdblk.termcond );/* shutting down */
@@ -1807,105 +2605,153 @@ int             wrs;
         // "Thread id "TIDPAT", prio %d, name '%s' started"
         LOG_THREAD_BEGIN( threadname  );
 
-    while (writer <= cckdblk.wrmax || cckdblk.wrpending)
+    while (cmp <= cckdblk.cmpmax)
     {
-        /* Wait for work */
-        if (cckdblk.wrpending == 0)
-        {
-            cckdblk.wrwaiting++;
-            {
-                wait_condition( &cckdblk.wrcond, &cckdblk.wrlock );
-            }
-            cckdblk.wrwaiting--;
-        }
+        /* Wait for a pending write and a free write queue entry */
+        o = -1;
+        if (cckdblk.wrpending && cckdblk.wrqfree >= 0)
+            o = cckd_cmp_select();
 
-        /* Scan the cache for the oldest pending write */
-        cache_lock( CACHE_DEVBUF );
+        if (o < 0)
         {
-            o = cache_scan( CACHE_DEVBUF, cckd_writer_scan, NULL );
-
-            /* Possibly shutting down if no writes pending */
-            if (o < 0)
+            cckdblk.cmpwaiting++;
             {
-                cache_unlock( CACHE_DEVBUF );
-                cckdblk.wrpending = 0;
-                continue;
+                wait_condition( &cckdblk.cmpcond, &cckdblk.wrlock );
             }
-
-            /* We will process this cache entry. Clear flags to prevent
-               any other writer threads from trying to process it too. */
-            cache_setflag( CACHE_DEVBUF, o, ~CCKD_CACHE_WRITE, CCKD_CACHE_WRITING );
+            cckdblk.cmpwaiting--;
+            continue;
         }
-        cache_unlock (CACHE_DEVBUF);
-
-        /* Schedule the other writers if any writes are still pending */
-
-        cckdblk.wrpending--;
-
-        if (cckdblk.wrpending)
-        {
-            if (cckdblk.wrwaiting)
-            {
-                signal_condition( &cckdblk.wrcond );
-            }
-            else if (cckdblk.wrs < cckdblk.wrmax)
-            {
-                /* Schedule a new writer thread */
 
-                if (!cckdblk.batch || cckdblk.batchml > 1)
-                    // "Starting thread %s, active=%d, started=%d, max=%d"
-                    WRMSG( HHC00107, "I", CCKD_WR_THREAD_NAME "() from " CCKD_WR_THREAD_NAME "()",
-                        cckdblk.wra, cckdblk.wrs, cckdblk.wrmax );
+        /* Claim a write queue entry for the track */
+        CCKD_CACHE_GETKEY( o, devnum, trk );
 
-                ++cckdblk.wrs;
+        q = cckdblk.wrqfree;
+        cckdblk.wrqfree = cckdblk.wrq[q].wrq_idxnxt;
+        cckdblk.wrq[q].wrq_o      = o;
+        cckdblk.wrq[q].wrq_devnum = devnum;
+        cckdblk.wrq[q].wrq_idxnxt = -1;
 
-                /* Release lock across thread create to prevent interlock  */
-                release_lock( &cckdblk.wrlock );
-                {
-                    rc = create_thread( &tid, JOINABLE, cckd_writer, NULL, CCKD_WR_THREAD_NAME );
-                }
-                obtain_lock( &cckdblk.wrlock );
+        if (++cckdblk.wrqn > (int) cckdblk.stats_wrqhigh)
+            cckdblk.stats_wrqhigh = cckdblk.wrqn;
 
-                if (rc)
-                {
-                    // "Error in function create_thread() for %s %d of %d: %s"
-                    WRMSG( HHC00106, "E", CCKD_WR_THREAD_NAME "() from " CCKD_WR_THREAD_NAME "()",
-                        cckdblk.wrs-1, cckdblk.wrmax, strerror( rc ));
+        cckdblk.wrpending--;
 
-                    --cckdblk.wrs;
-                }
-            }
-        }
+        /* Schedule the other compressors if any writes are still pending */
+        if (cckdblk.wrpending && cckdblk.wrqfree >= 0)
+            cckd_cmp_start( CCKD_CMP_THREAD_NAME "() from " CCKD_CMP_THREAD_NAME "()" );
 
-        /* Write the updated track image */
+        /* Compress the track image into the queue entry's buffer.
+           If no buffer can be had the writer compresses it instead. */
         release_lock( &cckdblk.wrlock );
         {
-            cckd_writer_write( writer, o );
+            if (!cckdblk.wrq[q].wrq_buf)
+                cckdblk.wrq[q].wrq_buf = malloc( 64*1024 );
+
+            if ((bufp = cckdblk.wrq[q].wrq_buf) != NULL)
+                bufl = cckd_writer_compress( cmp, o, &bufp );
+            else
+                bufl = 0;
         }
         obtain_lock( &cckdblk.wrlock );
+
+        cckdblk.wrq[q].wrq_bufp = bufp;
+        cckdblk.wrq[q].wrq_bufl = bufl;
+
+        /* Queue the image for the writers */
+        if (cckdblk.wrqlast >= 0)
+            cckdblk.wrq[cckdblk.wrqlast].wrq_idxnxt = q;
+        else
+            cckdblk.wrq1st = q;
+        cckdblk.wrqlast = q;
+
+        cckd_writer_start( CCKD_WR_THREAD_NAME "() from " CCKD_CMP_THREAD_NAME "()" );
     }
-    /* end while (writer <= cckdblk.wrmax || cckdblk.wrpending) */
+    /* end while (cmp <= cckdblk.cmpmax) */
 
     if (!cckdblk.batch || cckdblk.batchml > 1)
         // "Thread id "TIDPAT", prio %d, name '%s' ended"
         LOG_THREAD_END( threadname  );
 
-    cckdblk.wrs--;
-    cckdblk.wra--;
+    cckdblk.cmps--;
+    cckdblk.cmpa--;
 
-    wrs = cckdblk.wrs;
+    /* Let the writers take over any writes still pending */
+    if (!cckdblk.cmps && cckdblk.wrpending)
+        cckd_writer_start( CCKD_WR_THREAD_NAME "() from " CCKD_CMP_THREAD_NAME "()" );
+
+    cmps = cckdblk.cmps;
 
     release_lock( &cckdblk.wrlock );
 
-    if (!wrs)
+    if (!cmps)
         signal_condition( &cckdblk.termcond );
 
     return NULL;
-} /* end thread cckd_writer */
+} /* end thread cckd_cmp */
 
-int cckd_writer_scan( int* o, int ix, int i, void* data )
+/*-------------------------------------------------------------------*/
+/* Select the oldest pending write for a compressor                  */
+/*                                                                   */
+/* Writes for a device that already has cmpqmax tracks queued are    */
+/* held back so a single busy volume can't take the whole queue.     */
+/*                                                                   */
+/* Caller holds cckdblk.wrlock; cache_lock is obtained and released  */
+/*-------------------------------------------------------------------*/
+int cckd_cmp_select()
 {
-    UNREFERENCED( data );
+CCKD_WRSCAN     scan;                   /* Scan parameters           */
+int             o;                      /* Cache entry found         */
+int             i, j, n;                /* Indexes, count            */
+
+    /* Find the devices at their queue limit */
+    scan.nfull   = 0;
+    scan.skipped = 0;
+
+    for (i=0; i < CCKD_WRQ_SIZE; i++)
+    {
+        if (cckdblk.wrq[i].wrq_o < 0)
+            continue;
+
+        for (j=n=0; j < CCKD_WRQ_SIZE; j++)
+            if (cckdblk.wrq[j].wrq_o >= 0
+             && cckdblk.wrq[j].wrq_devnum == cckdblk.wrq[i].wrq_devnum)
+                n++;
+
+        for (j=0; j < scan.nfull; j++)
+            if (scan.full[j] == cckdblk.wrq[i].wrq_devnum)
+                break;
+
+        if (n >= cckdblk.cmpqmax && j == scan.nfull)
+            scan.full[scan.nfull++] = cckdblk.wrq[i].wrq_devnum;
+    }
+
+    cache_lock( CACHE_DEVBUF );
+    {
+        o = cache_scan( CACHE_DEVBUF, cckd_cmp_scan, &scan );
+
+        /* We will process this cache entry. Clear flags to prevent
+           any other thread from trying to process it too. */
+        if (o >= 0)
+            cache_setflag( CACHE_DEVBUF, o, ~CCKD_CACHE_WRITE, CCKD_CACHE_WRITING );
+    }
+    cache_unlock( CACHE_DEVBUF );
+
+    if (scan.skipped)
+        cckdblk.stats_cmpthrottles++;
+
+    /* No writes are pending if none were found or held back */
+    else if (o < 0)
+        cckdblk.wrpending = 0;
+
+    return o;
+}
+
+int cckd_cmp_scan( int* o, int ix, int i, void* data )
+{
+CCKD_WRSCAN    *scan = data;            /* Scan parameters           */
+U16             devnum;                 /* Cached device number      */
+U32             trk;                    /* Cached track              */
+int             j;                      /* Index                     */
 
     if (1
         && (cache_getflag( ix, i ) & DEVBUF_TYPE_COMP)
@@ -1915,39 +2761,48 @@ int cckd_writer_scan( int* o, int ix, int i, void* data )
             || cache_getage( ix, i ) < cache_getage( ix, *o )
            )
     )
+    {
+        CCKD_CACHE_GETKEY( i, devnum, trk );
+        UNREFERENCED( trk );
+
+        for (j=0; j < scan->nfull; j++)
+            if (scan->full[j] == devnum)
+            {
+                scan->skipped++;
+                return 0;
+            }
+
         *o = i;
+    }
 
     return 0;
 }
 
 /*-------------------------------------------------------------------*/
-/* cckd writer thread helper:   write the cached track image         */
+/* cckd writer thread helper:   compress the cached track image      */
+/*                                                                   */
+/* On entry *bufp points to a 64K buffer for the compressed image.   */
+/* On return it points to the image to be written, which is the      */
+/* cached track image itself if it was not compressed.               */
 /*-------------------------------------------------------------------*/
-void cckd_writer_write( int writer, int o )
+int cckd_writer_compress( int writer, int o, BYTE** bufp )
 {
-TID             tid;                    /* Writer thead id           */
 CCKD_EXT*       cckd;                   /* -> cckd extension         */
 DEVBLK*         dev;                    /* Device block              */
 U16             devnum;                 /* Device number             */
-int             rc;                     /* (work) return code        */
 int             trk;                    /* Track number              */
 BYTE*           buf;                    /* Buffer                    */
-BYTE*           bufp;                   /* Buffer to be written      */
 int             len, bufl;              /* Buffer lengths            */
 int             comp;                   /* Compression algorithm     */
 int             parm;                   /* Compression parameter     */
-U32             flag;                   /* Cache flag                */
-BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
+struct timeval  tv_beg, tv_end;         /* Compression time          */
 
     /* Prepare to compress */
     CCKD_CACHE_GETKEY( o, devnum, trk );
     dev = cckd_find_device_by_devnum( devnum );
 
     if (dev->cckd64)
-    {
-        cckd64_writer_write( writer, o );
-        return;
-    }
+        return cckd64_writer_compress( writer, o, bufp );
 
     cckd = dev->cckd_ext;
     buf  = cache_getbuf( CACHE_DEVBUF, o, 0 );
@@ -1988,16 +2843,61 @@ BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
         CCKD_TRACE( "%d wrtrk[%d] %d comp %s parm %d",
                     writer, o, trk, compname[ comp ], parm );
 
-        bufp = (BYTE*) &buf2;
-        bufl = cckd_compress( dev, &bufp, buf, len, comp, parm );
+        gettimeofday( &tv_beg, NULL );
+        bufl = cckd_compress( dev, bufp, buf, len, comp, parm );
+        gettimeofday( &tv_end, NULL );
+
+        cckdblk.stats_compresses++;
+        cckdblk.stats_compressusecs +=
+            (tv_end.tv_sec  - tv_beg.tv_sec) * 1000000
+          + (tv_end.tv_usec - tv_beg.tv_usec);
 
         CCKD_TRACE( "%d wrtrk[%d] %d compressed length %d",
                     writer, o, trk, bufl );
     }
     else
     {
-        bufp = buf;
-        bufl = len;
+        *bufp = buf;
+        bufl  = len;
+    }
+
+    return bufl;
+
+} /* end function cckd_writer_compress */
+
+/*-------------------------------------------------------------------*/
+/* cckd writer thread helper:   write the cached track image         */
+/*                                                                   */
+/* bufp and bufl are the image prepared by a compressor thread;      */
+/* if bufp is NULL the image is compressed here.                     */
+/*-------------------------------------------------------------------*/
+void cckd_writer_write( int writer, int o, BYTE* bufp, int bufl )
+{
+TID             tid;                    /* Writer thead id           */
+CCKD_EXT*       cckd;                   /* -> cckd extension         */
+DEVBLK*         dev;                    /* Device block              */
+U16             devnum;                 /* Device number             */
+int             rc;                     /* (work) return code        */
+int             trk;                    /* Track number              */
+U32             flag;                   /* Cache flag                */
+BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
+
+    CCKD_CACHE_GETKEY( o, devnum, trk );
+    dev = cckd_find_device_by_devnum( devnum );
+
+    if (dev->cckd64)
+    {
+        cckd64_writer_write( writer, o, bufp, bufl );
+        return;
+    }
+
+    cckd = dev->cckd_ext;
+
+    /* Compress the image if a compressor hasn't already */
+    if (!bufp)
+    {
+        bufp = (BYTE*) &buf2;
+        bufl = cckd_writer_compress( writer, o, &bufp );
     }
 
     obtain_lock( &cckd->filelock );
@@ -2049,11 +2949,11 @@ BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
 
     obtain_lock( &cckd->cckdiolock );
     {
-        cache_lock( CACHE_DEVBUF );
+        cache_lock_entry( CACHE_DEVBUF, o );
         {
             flag = cache_setflag( CACHE_DEVBUF, o, ~CCKD_CACHE_WRITING, 0 );
         }
-        cache_unlock( CACHE_DEVBUF );
+        cache_unlock_entry( CACHE_DEVBUF, o );
 
         cckd->wrpending--;
 
@@ -4783,7 +5683,7 @@ int             free_count=0;           /* Total number free spaces  */
     WRMSG (HHC00333, "I", LCSS_DEVNUM);
 
     if (cckd->readaheads || cckd->misses)
-    // "%1d:%04X                                                      readaheads   misses"
+    // "%1d:%04X                                             readaheads   useful   wasted"
     WRMSG (HHC00334, "I", LCSS_DEVNUM);
 
     // "%1d:%04X ------------------------------------------------------------------------"
@@ -4804,9 +5704,9 @@ int             free_count=0;           /* Total number free spaces  */
     );
 
     if (cckd->readaheads || cckd->misses)
-    // "%1d:%04X                                                         %7.7d  %7.7d"
+    // "%1d:%04X                                                %7.7d  %7.7d  %7.7d"
     WRMSG (HHC00337, "I", LCSS_DEVNUM,
-            cckd->readaheads, cckd->misses);
+            cckd->readaheads, cckd->rahits, cckd->misses);
 
     /* base file statistics */
 
@@ -5918,6 +6818,8 @@ void cckd_command_help()
 
         //    ***  Please keep these in alphabetical order!  ***
 
+        , "  cmp=<n>       Set number compressor threads        ( 0 .. 16)"
+        , "  cmpq=<n>      Set queued writes per device         ( 1 .. 32)"
         , "  comp=<n>      Override compression                 (-1,0,1,2)"
         , "  compparm=<n>  Override compression parm            (-1 ... 9)"
         , "  debug=<n>     Enable CCW tracing debug messages      (0 or 1)"
@@ -5933,6 +6835,7 @@ void cckd_command_help()
         , "  raq=<n>       Set readahead queue size             ( 0 .. 16)"
         , "  rat=<n>       Set number tracks to read ahead      ( 0 .. 16)"
         , "  trace=<n>     Set trace table size             (0 ... 200000)"
+        , "  uring=<n>     Batch readaheads using io_uring        (0 or 1)"
         , "  wr=<n>        Set number writer threads            ( 1 ... 9)"
 
         , NULL
@@ -5954,7 +6857,9 @@ void cckd_command_opts()
 
         // ***  Please keep these in alphabetical order!  ***
 
-        " "   "comp=%d"
+        " "   "cmp=%d"
+        ","   "cmpq=%d"
+        ","   "comp=%d"
         ","   "compparm=%d"
         ","   "debug=%d"
         ","   "freepend=%d"
@@ -5962,6 +6867,8 @@ void cckd_command_opts()
         ","   "gcint=%d"
         ","   "gcparm=%d"
 
+        , cckdblk.cmpmax
+        , cckdblk.cmpqmax
         , cckdblk.comp == 0xff ? -1 : cckdblk.comp
         , cckdblk.compparm
         , cckdblk.debug
@@ -5983,6 +6890,7 @@ void cckd_command_opts()
         ","   "raq=%d"
         ","   "rat=%d"
         ","   "trace=%d"
+        ","   "uring=%d"
         ","   "wr=%d"
 
         , cckdblk.linuxnull
@@ -5992,6 +6900,7 @@ void cckd_command_opts()
         , cckdblk.ranbr
         , cckdblk.readaheads
         , cckdblk.itracen
+        , cckdblk.rauring
         , cckdblk.wrmax
     );
     WRMSG( HHC00346, "I", msgbuf );
@@ -6016,8 +6925,29 @@ void cckd_command_stats()
                     cckdblk.stats_writes, cckdblk.stats_writebytes >> SHIFT_1K );
     WRMSG( HHC00347, "I", msgbuf );
 
-    MSGBUF( msgbuf, "  readaheads%9"PRId64" misses...%10"PRId64,
-                    cckdblk.stats_readaheads, cckdblk.stats_readaheadmisses );
+    MSGBUF( msgbuf, "  readaheads%9"PRId64" useful...%10"PRId64" wasted...%10"PRId64,
+                    cckdblk.stats_readaheads, cckdblk.stats_readaheadhits,
+                    cckdblk.stats_readaheadmisses );
+    WRMSG( HHC00347, "I", msgbuf );
+
+    MSGBUF( msgbuf, "  streams..%10"PRId64" ramp ups.%10"PRId64" ramp dns.%10"PRId64,
+                    cckdblk.stats_rastreams, cckdblk.stats_rarampups,
+                    cckdblk.stats_rarampdowns );
+    WRMSG( HHC00347, "I", msgbuf );
+
+    MSGBUF( msgbuf, "  ra batch.%10"PRId64" tracks...%10"PRId64,
+                    cckdblk.stats_rabatches, cckdblk.stats_rabatchtrks );
+    WRMSG( HHC00347, "I", msgbuf );
+
+    MSGBUF( msgbuf, "  compress.%10"PRId64" avg usecs%10"PRId64" throttled%10"PRId64,
+                    cckdblk.stats_compresses,
+                    cckdblk.stats_compresses ? cckdblk.stats_compressusecs /
+                                               cckdblk.stats_compresses : 0,
+                    cckdblk.stats_cmpthrottles );
+    WRMSG( HHC00347, "I", msgbuf );
+
+    MSGBUF( msgbuf, "  wr queue.%10d high.....%10"PRId64,
+                    cckdblk.wrqn, cckdblk.stats_wrqhigh );
     WRMSG( HHC00347, "I", msgbuf );
 
     MSGBUF( msgbuf, "  switches.%10"PRId64" l2 reads.%10"PRId64" strs wrt.%10"PRId64,
@@ -6134,6 +7064,42 @@ int   rc;
         /* If rc == 1 && c == 0, then "keyword=value" syntax */
         /* Please keep the below tests in alphabetical order! */
 
+        // Number compressor threads
+        else if (CMD( kw, CMP, 3 ))
+        {
+            if (val < CCKD_MIN_CMP || val > CCKD_MAX_CMP)
+            {
+                // "CCKD file: value %d invalid for %s"
+                WRMSG( HHC00348, "E", val, kw );
+                return -1;
+            }
+            else
+            {
+                /* Wake the compressors so any excess ones end */
+                obtain_lock( &cckdblk.wrlock );
+                {
+                    cckdblk.cmpmax = val;
+                    broadcast_condition( &cckdblk.cmpcond );
+                }
+                release_lock( &cckdblk.wrlock );
+                opts = 1;
+            }
+        }
+        // Queued writes per device
+        else if (CMD( kw, CMPQ, 4 ))
+        {
+            if (val < 1 || val > CCKD_MAX_CMPQ)
+            {
+                // "CCKD file: value %d invalid for %s"
+                WRMSG( HHC00348, "E", val, kw );
+                return -1;
+            }
+            else
+            {
+                cckdblk.cmpqmax = val;
+                opts = 1;
+            }
+        }
         // Compression to be used
         else if (CMD( kw, COMP, 4 ))
         {
@@ -6420,6 +7386,25 @@ int   rc;
                 RELEASE_TRACE_LOCK();
             }
         }
+        // Batch readaheads using io_uring
+        else if (CMD( kw, URING, 5 ))
+        {
+#if defined( OPTION_CCKD_IO_URING )
+            if (val < 0 || val > 1)
+#else
+            if (val != 0)
+#endif
+            {
+                // "CCKD file: value %d invalid for %s"
+                WRMSG( HHC00348, "E", val, kw );
+                return -1;
+            }
+            else
+            {
+                cckdblk.rauring = val;
+                opts = 1;
+            }
+        }
         // Number writer threads
         else if (CMD( kw, WR, 2 ))
         {
@@ -27,6 +27,19 @@
   #define CCKD_CHK_SPACE(_dev)      /* (do nothing) */
 #endif
 
+/*-------------------------------------------------------------------*/
+/* The readahead threads batch their reads with io_uring when the    */
+/* host headers know about it (see hostopts.h)                       */
+/*-------------------------------------------------------------------*/
+
+#if defined( OPTION_CCKD_IO_URING )
+  #include <linux/io_uring.h>
+  #include <sys/syscall.h>
+  #if !defined( __NR_io_uring_setup ) || !defined( __NR_io_uring_enter )
+    #undef OPTION_CCKD_IO_URING
+  #endif
+#endif
+
 /*-------------------------------------------------------------------*/
 /*                       Global Variables                            */
 /*-------------------------------------------------------------------*/
@@ -91,17 +104,30 @@ int     cfba64_write_block(DEVBLK *dev, int blkgrp, int off,
 int     cfba64_used(DEVBLK *dev);
 /*-------------------------------------------------------------------*/
 int     cckd_read_trk(DEVBLK *dev, int trk, int ra, BYTE *unitstat);
-void    cckd_readahead(DEVBLK *dev, int trk);
+void    cckd_readahead(DEVBLK *dev, int trk, int hit);
 int     cckd_readahead_scan(int *answer, int ix, int i, void *data);
 void*   cckd_ra(void* arg);
+#if defined( OPTION_CCKD_IO_URING )
+int     cckd_uring_init(CCKD_URING *ring);
+void    cckd_uring_term(CCKD_URING *ring);
+void    cckd_uring_read(CCKD_URING *ring, CCKD_IOREQ *req, int n);
+void    cckd_ra_batch(DEVBLK *dev, int *trks, int n, int ra, CCKD_URING *ring);
+#endif
 void    cckd_flush_cache(DEVBLK *dev);
 int     cckd_flush_cache_scan(int *answer, int ix, int i, void *data);
 void    cckd_flush_cache_all();
 void    cckd_purge_cache(DEVBLK *dev);
 int     cckd_purge_cache_scan(int *answer, int ix, int i, void *data);
+void    cckd_writer_start(const char *desc);
+void    cckd_schedule_writes();
 void*   cckd_writer(void *arg);
 int     cckd_writer_scan(int *o, int ix, int i, void *data);
-void    cckd_writer_write( int writer, int o );
+int     cckd_writer_compress( int writer, int o, BYTE **bufp );
+void    cckd_writer_write( int writer, int o, BYTE *bufp, int bufl );
+void    cckd_cmp_start(const char *desc);
+void*   cckd_cmp(void *arg);
+int     cckd_cmp_select();
+int     cckd_cmp_scan(int *o, int ix, int i, void *data);
 off_t   cckd_get_space(DEVBLK *dev, int *size, int flags);
 void    cckd_rel_space(DEVBLK *dev, off_t pos, int len, int size);
 void    cckd_flush_space(DEVBLK *dev);
@@ -143,6 +169,9 @@ int     cckd_gc_l2(DEVBLK *dev, BYTE *buf);
 DEVBLK *cckd_find_device_by_devnum (U16 devnum);
 /*-------------------------------------------------------------------*/
 int     cckd64_read_trk(DEVBLK *dev, int trk, int ra, BYTE *unitstat);
+#if defined( OPTION_CCKD_IO_URING )
+void    cckd64_ra_batch(DEVBLK *dev, int *trks, int n, int ra, CCKD_URING *ring);
+#endif
 //id    cckd64_readahead(DEVBLK *dev, int trk);
 //t     cckd64_readahead_scan(int *answer, int ix, int i, void *data);
 //id*   cckd64_ra(void* arg);
@@ -153,7 +182,8 @@ void    cckd64_purge_cache(DEVBLK *dev);
 int     cckd64_purge_cache_scan(int *answer, int ix, int i, void *data);
 //id*   cckd64_writer(void *arg);
 //t     cckd64_writer_scan(int *o, int ix, int i, void *data);
-void    cckd64_writer_write( int writer, int o );
+int     cckd64_writer_compress( int writer, int o, BYTE **bufp );
+void    cckd64_writer_write( int writer, int o, BYTE *bufp, int bufl );
 S64     cckd64_get_space(DEVBLK *dev, int *size, int flags);
 void    cckd64_rel_space(DEVBLK *dev, U64 pos, int len, int size);
 void    cckd64_flush_space(DEVBLK *dev);
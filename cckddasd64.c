@@ -254,6 +254,7 @@ void cckd64_dasd_start (DEVBLK *dev)
 CCKD64_EXT     *cckd;                   /* -> cckd extension         */
 U16             devnum = 0;             /* Last active device number */
 int             trk = 0;                /* Last active track         */
+int             i;                      /* Last active cache index   */
 
     if (!dev->cckd64)
     {
@@ -285,10 +286,12 @@ int             trk = 0;                /* Last active track         */
     }
     cckd->cckdioact = 1;
 
-    cache_lock(CACHE_DEVBUF);
-
-    if (dev->cache >= 0)
+    /* Only the shard of the previous active entry need be locked */
+    if ((i = dev->cache) >= 0)
+    {
+        cache_lock_entry (CACHE_DEVBUF, i);
         CCKD_CACHE_GETKEY(dev->cache, devnum, trk);
+    }
 
     /* Check if previous active entry is still valid and not busy */
     if (dev->cache >= 0 && dev->devnum == devnum && dev->bufcur == trk
@@ -309,7 +312,8 @@ int             trk = 0;                /* Last active track         */
     else
         dev->bufcur = dev->cache = -1;
 
-    cache_unlock (CACHE_DEVBUF);
+    if (i >= 0)
+        cache_unlock_entry (CACHE_DEVBUF, i);
 
     release_lock (&cckd->cckdiolock);
 
@@ -351,9 +355,9 @@ CCKD64_EXT     *cckd;                   /* -> cckd extension         */
     /* Make the current entry inactive */
     if (dev->cache >= 0)
     {
-        cache_lock (CACHE_DEVBUF);
+        cache_lock_entry (CACHE_DEVBUF, dev->cache);
         cache_setflag (CACHE_DEVBUF, dev->cache, ~CCKD_CACHE_ACTIVE, 0);
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_entry (CACHE_DEVBUF, dev->cache);
     }
 
     /* Cause writers to start after first update */
@@ -456,6 +460,10 @@ int             rc;                     /* Return code               */
     CCKD_TRACE( "file[%d] fd[%d] read, off 0x%16.16"PRIx64" len %d",
                 sfx, cckd->fd[ sfx ], off, len );
 
+#if defined( OPTION_POSITIONED_IO )
+    /* Read the data at the specified offset */
+    rc = pread( cckd->fd[ sfx ], buf, len, off );
+#else
     /* Seek to specified offset */
     if (lseek( cckd->fd[ sfx ], off, SEEK_SET ) < 0)
     {
@@ -468,6 +476,7 @@ int             rc;                     /* Return code               */
 
     /* Read the data */
     rc = read( cckd->fd[ sfx ], buf, len );
+#endif
     if (rc < (int)len)
     {
         if (rc < 0)
@@ -503,6 +512,10 @@ int             rc = 0;                 /* Return code               */
     CCKD_TRACE( "file[%d] fd[%d] write, off 0x%16.16"PRIx64" len %d",
                 sfx, cckd->fd[ sfx ], off, len );
 
+#if defined( OPTION_POSITIONED_IO )
+    /* Write the data at the specified offset */
+    rc = pwrite( cckd->fd[ sfx ], buf, len, off );
+#else
     /* Seek to specified offset */
     if (lseek( cckd->fd[ sfx ], off, SEEK_SET ) < 0)
     {
@@ -515,6 +528,7 @@ int             rc = 0;                 /* Return code               */
 
     /* Write the data */
     rc = write( cckd->fd[ sfx ], buf, len );
+#endif
     if (rc < (int)len)
     {
         if (rc < 0)
@@ -932,12 +946,14 @@ int cckd64_read_trk(DEVBLK *dev, int trk, int ra, BYTE *unitstat)
 CCKD64_EXT     *cckd;                   /* -> cckd extension         */
 int             fnd;                    /* Cache index for hit       */
 int             lru;                    /* Oldest unused cache index */
+U64             key;                    /* Cache key of the track    */
 int             len;                    /* Length of track image     */
 int             maxlen;                 /* Length for buffer         */
 int             curtrk = -1;            /* Current track (at entry)  */
 U16             devnum;                 /* Device number             */
 U32             oldtrk;                 /* Stolen track number       */
 U32             flag;                   /* Cache flag                */
+int             rahit;                  /* 1=Hit on a readahead trk  */
 BYTE           *buf;                    /* Read buffer               */
 
     if (!dev->cckd64)
@@ -952,32 +968,40 @@ BYTE           *buf;                    /* Read buffer               */
 
     if (!ra) obtain_lock (&cckd->cckdiolock);
 
-    cache_lock (CACHE_DEVBUF);
-
     /* Inactivate the old entry */
     if (!ra)
     {
         curtrk = dev->bufcur;
         if (dev->cache >= 0)
+        {
+            cache_lock_entry (CACHE_DEVBUF, dev->cache);
             cache_setflag(CACHE_DEVBUF, dev->cache, ~CCKD_CACHE_ACTIVE, 0);
+            cache_unlock_entry (CACHE_DEVBUF, dev->cache);
+        }
         dev->bufcur = dev->cache = -1;
     }
 
+    /* Only the shard the track belongs to is locked from here on */
+    key = CCKD_CACHE_SETKEY(dev->devnum, trk);
+    cache_lock_key (CACHE_DEVBUF, key);
+
 cckd_read_trk_retry:
 
     /* scan the cache array for the track */
-    fnd = cache_lookup (CACHE_DEVBUF, CCKD_CACHE_SETKEY(dev->devnum, trk), &lru);
+    fnd = cache_lookup (CACHE_DEVBUF, key, &lru);
 
     /* check for cache hit */
     if (fnd >= 0)
     {
         if (ra) /* readahead doesn't care about a cache hit */
-        {   cache_unlock (CACHE_DEVBUF);
+        {   cache_unlock_key (CACHE_DEVBUF, key);
             return fnd;
         }
 
-        /* Mark the new entry active */
-        cache_setflag(CACHE_DEVBUF, fnd, ~0, CCKD_CACHE_ACTIVE | CCKD_CACHE_USED);
+        /* Mark the new entry active; if it wasn't used before then
+           it was brought in by a readahead */
+        flag = cache_setflag(CACHE_DEVBUF, fnd, ~0, CCKD_CACHE_ACTIVE | CCKD_CACHE_USED);
+        rahit = !(flag & CCKD_CACHE_USED);
         cache_setage(CACHE_DEVBUF, fnd);
 
         /* If the entry is pending write then change it to `updated' */
@@ -990,13 +1014,17 @@ cckd_read_trk_retry:
         }
         buf = cache_getbuf(CACHE_DEVBUF, fnd, 0);
 
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_key (CACHE_DEVBUF, key);
 
         CCKD_TRACE( "%d rdtrk[%d] %d cache hit buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x",
                     ra, fnd, trk, buf, buf[0], buf[1], buf[2], buf[3], buf[4]);
 
         cckdblk.stats_switches++;  cckd->switches++;
         cckdblk.stats_cachehits++; cckd->cachehits++;
+        if (rahit)
+        {
+            cckdblk.stats_readaheadhits++; cckd->rahits++;
+        }
 
         /* if read/write is in progress then wait for it to finish */
         while (cache_getflag(CACHE_DEVBUF, fnd) & CCKD_CACHE_IOBUSY)
@@ -1017,8 +1045,8 @@ cckd_read_trk_retry:
         release_lock (&cckd->cckdiolock);
 
         /* Asynchrously schedule readaheads */
-        if (curtrk > 0 && trk > curtrk && trk <= curtrk + 2)
-            cckd_readahead (dev, trk);
+        if (trk != curtrk)
+            cckd_readahead (dev, trk, rahit);
 
         return fnd;
 
@@ -1028,23 +1056,23 @@ cckd_read_trk_retry:
 
     /* If no cache entry was stolen, then flush all outstanding writes.
        This requires us to release our locks.  cache_wait should be
-       called with only the cache_lock held.  Fortunately, cache waits
+       called with only the shard lock held.  Fortunately, cache waits
        occur very rarely. */
     if (lru < 0) /* No available entry to be stolen */
     {
         CCKD_TRACE( "%d rdtrk[%d] %d no available cache entry",
                     ra, lru, trk);
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_key (CACHE_DEVBUF, key);
         if (!ra) release_lock (&cckd->cckdiolock);
         cckd64_flush_cache_all();
-        cache_lock (CACHE_DEVBUF);
+        cache_lock_key (CACHE_DEVBUF, key);
         cckdblk.stats_cachewaits++;
-        cache_wait (CACHE_DEVBUF);
+        cache_wait (CACHE_DEVBUF, key);
         if (!ra)
         {
-            cache_unlock (CACHE_DEVBUF);
+            cache_unlock_key (CACHE_DEVBUF, key);
             obtain_lock (&cckd->cckdiolock);
-            cache_lock (CACHE_DEVBUF);
+            cache_lock_key (CACHE_DEVBUF, key);
         }
         goto cckd_read_trk_retry;
     }
@@ -1061,7 +1089,7 @@ cckd_read_trk_retry:
     }
 
     /* Initialize the entry */
-    cache_setkey(CACHE_DEVBUF, lru, CCKD_CACHE_SETKEY(dev->devnum, trk));
+    cache_setkey(CACHE_DEVBUF, lru, key);
     cache_setflag(CACHE_DEVBUF, lru, 0, CCKD_CACHE_READING);
     cache_setage(CACHE_DEVBUF, lru);
     cache_setval(CACHE_DEVBUF, lru, 0);
@@ -1078,13 +1106,13 @@ cckd_read_trk_retry:
     CCKD_TRACE( "%d rdtrk[%d] %d buf %p len %d",
                 ra, lru, trk, buf, cache_getlen(CACHE_DEVBUF, lru));
 
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_key (CACHE_DEVBUF, key);
 
     if (!ra) release_lock (&cckd->cckdiolock);
 
     /* Asynchronously schedule readaheads */
-    if (!ra && curtrk > 0 && trk > curtrk && trk <= curtrk + 2)
-        cckd_readahead (dev, trk);
+    if (!ra && trk != curtrk)
+        cckd_readahead (dev, trk, -1);
 
     /* Clear the buffer if batch mode */
     if (dev->batch) memset(buf, 0, maxlen);
@@ -1098,9 +1126,9 @@ cckd_read_trk_retry:
     obtain_lock (&cckd->cckdiolock);
 
     /* Turn off the READING bit */
-    cache_lock (CACHE_DEVBUF);
+    cache_lock_entry (CACHE_DEVBUF, lru);
     flag = cache_setflag(CACHE_DEVBUF, lru, ~CCKD_CACHE_READING, 0);
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_entry (CACHE_DEVBUF, lru);
 
     /* Wakeup other thread waiting for this read */
     if (cckd->cckdwaiters && (flag & CCKD_CACHE_IOWAIT))
@@ -1125,6 +1153,182 @@ cckd_read_trk_retry:
 
 } /* end function cckd_read_trk */
 
+#if defined( OPTION_CCKD_IO_URING )
+/*-------------------------------------------------------------------*/
+/* Read a batch of readahead tracks                                  */
+/*                                                                   */
+/* Called by a readahead thread for queued tracks of one device.     */
+/* A cache entry is stolen for each track not already cached, the    */
+/* level 2 entries are looked up and the track images are then read  */
+/* with a single io_uring submission, so that all of them can be in  */
+/* flight at once on any of the shadow files.  Tracks for which no   */
+/* cache entry is available are simply not read ahead.               */
+/*-------------------------------------------------------------------*/
+void cckd64_ra_batch (DEVBLK *dev, int *trks, int n, int ra, CCKD_URING *ring)
+{
+CCKD64_EXT     *cckd;                   /* -> cckd extension         */
+CCKD64_L2ENT    l2;                     /* Level 2 entry             */
+CCKD_IOREQ      req[CCKD_MAX_RA_SIZE];  /* Track image reads         */
+int             map[CCKD_MAX_RA_SIZE];  /* Track index for each read */
+int             ix[CCKD_MAX_RA_SIZE];   /* Cache index for each track*/
+int             trk[CCKD_MAX_RA_SIZE];  /* Track numbers             */
+int             sfx[CCKD_MAX_RA_SIZE];  /* File index for each track */
+int             len[CCKD_MAX_RA_SIZE];  /* Track image lengths       */
+int             i, m, r;                /* Indexes                   */
+int             fnd, lru;               /* Cache indexes             */
+int             maxlen;                 /* Length for buffer         */
+U64             key;                    /* Cache key of the track    */
+U16             devnum;                 /* Device number             */
+U32             oldtrk;                 /* Stolen track number       */
+U32             flag;                   /* Cache flag                */
+BYTE           *buf;                    /* Read buffer               */
+
+    cckd = dev->cckd_ext;
+
+    maxlen = cckd->ckddasd ? dev->ckdtrksz
+                           : CFBA_BLKGRP_SIZE + CKD_TRKHDR_SIZE;
+
+    /* Steal a cache entry for each track that isn't cached */
+    for (i = m = 0; i < n && i < CCKD_MAX_RA_SIZE; i++)
+    {
+        key = CCKD_CACHE_SETKEY(dev->devnum, trks[i]);
+        cache_lock_key (CACHE_DEVBUF, key);
+        fnd = cache_lookup (CACHE_DEVBUF, key, &lru);
+        if (fnd >= 0 || lru < 0)
+        {
+            cache_unlock_key (CACHE_DEVBUF, key);
+            continue;
+        }
+
+        CCKD_CACHE_GETKEY(lru, devnum, oldtrk);
+        if (devnum != 0)
+        {
+            CCKD_TRACE( "%d rdtrk[%d] %d dropping %4.4X:%d from cache",
+                        ra, lru, trks[i], devnum, oldtrk);
+            if (!(cache_getflag(CACHE_DEVBUF, lru) & CCKD_CACHE_USED))
+            {
+                cckdblk.stats_readaheadmisses++;  cckd->misses++;
+            }
+        }
+
+        cache_setkey(CACHE_DEVBUF, lru, key);
+        cache_setflag(CACHE_DEVBUF, lru, 0, CCKD_CACHE_READING);
+        cache_setage(CACHE_DEVBUF, lru);
+        cache_setval(CACHE_DEVBUF, lru, 0);
+        cache_setflag(CACHE_DEVBUF, lru, ~CACHE_TYPE,
+                      cckd->ckddasd ? DEVBUF_TYPE_CCKD : DEVBUF_TYPE_CFBA);
+        buf = cache_getbuf(CACHE_DEVBUF, lru, maxlen);
+
+        cache_unlock_key (CACHE_DEVBUF, key);
+
+        if (dev->batch) memset(buf, 0, maxlen);
+
+        ix[m] = lru;
+        trk[m++] = trks[i];
+    }
+
+    if (m == 0)
+        return;
+
+    obtain_lock (&cckd->filelock);
+
+    /* Look up the track images, building the null ones right away */
+    for (i = r = 0; i < m; i++)
+    {
+        buf = cache_getbuf(CACHE_DEVBUF, ix[i], 0);
+        if ((sfx[i] = cckd64_read_l2ent (dev, &l2, trk[i])) < 0)
+            len[i] = -1;
+        else if (l2.L2_trkoff == 0)
+            len[i] = cckd64_null_trk (dev, buf, trk[i], l2.L2_len);
+        else
+        {
+            CCKD_TRACE( "file[%d] fd[%d] read, off 0x%16.16"PRIx64" len %d",
+                        sfx[i], cckd->fd[sfx[i]], (U64)l2.L2_trkoff, l2.L2_len);
+            req[r].fd  = cckd->fd[sfx[i]];
+            req[r].off = l2.L2_trkoff;
+            req[r].buf = buf;
+            req[r].len = l2.L2_len;
+            map[r++] = i;
+        }
+    }
+
+    /* Read the track images */
+    if (r > 0)
+        cckd_uring_read (ring, req, r);
+
+    while (r-- > 0)
+    {
+        i = map[r];
+        if (req[r].rc < (int)req[r].len)
+        {
+            if (req[r].rc < 0)
+                // "%1d:%04X CCKD file[%d] %s: error in function %s at offset 0x%16.16"PRIX64": %s"
+                WRMSG( HHC00302, "E", LCSS_DEVNUM, sfx[i], cckd_sf_name( dev, sfx[i] ),
+                    "read()", req[r].off, strerror( -req[r].rc ));
+            else
+            {
+                char msgbuf[128];
+                MSGBUF( msgbuf, "read incomplete: read %d, expected %d",
+                        req[r].rc, req[r].len );
+                // "%1d:%04X CCKD file[%d] %s: error in function %s at offset 0x%16.16"PRIX64": %s"
+                WRMSG( HHC00302, "E", LCSS_DEVNUM, sfx[i], cckd_sf_name( dev, sfx[i] ),
+                    "read()", req[r].off, msgbuf );
+            }
+            cckd_print_itrace ();
+            len[i] = -1;
+            continue;
+        }
+
+        len[i] = req[r].rc;
+        cckd->reads[sfx[i]]++;
+        cckd->totreads++;
+        cckdblk.stats_reads++;
+        cckdblk.stats_readbytes += len[i];
+        if (cckd->notnull == 0 && trk[i] > 1) cckd->notnull = 1;
+    }
+
+    /* Validate the track images */
+    for (i = 0; i < m; i++)
+    {
+        buf = cache_getbuf(CACHE_DEVBUF, ix[i], 0);
+        if (len[i] < 0 || cckd64_cchh (dev, buf, trk[i]) < 0)
+            len[i] = cckd64_null_trk (dev, buf, trk[i], 0);
+    }
+
+    release_lock (&cckd->filelock);
+
+    obtain_lock (&cckd->cckdiolock);
+
+    for (i = 0; i < m; i++)
+    {
+        cache_setval (CACHE_DEVBUF, ix[i], len[i]);
+
+        /* Turn off the READING bit */
+        cache_lock_entry (CACHE_DEVBUF, ix[i]);
+        flag = cache_setflag(CACHE_DEVBUF, ix[i], ~CCKD_CACHE_READING, 0);
+        cache_unlock_entry (CACHE_DEVBUF, ix[i]);
+
+        /* Wakeup other thread waiting for this read */
+        if (cckd->cckdwaiters && (flag & CCKD_CACHE_IOWAIT))
+        {   CCKD_TRACE( "%d rdtrk[%d] %d signalling read complete",
+                        ra, ix[i], trk[i]);
+            broadcast_condition (&cckd->cckdiocond);
+        }
+
+        CCKD_TRACE( "%d rdtrk[%d] %d batch read complete", ra, ix[i], trk[i]);
+    }
+
+    release_lock (&cckd->cckdiolock);
+
+    cckdblk.stats_readaheads += m; cckd->readaheads += m;
+    cckdblk.stats_rabatches++;
+    cckdblk.stats_rabatchtrks += m;
+
+    if (cache_busy_percent(CACHE_DEVBUF) > 80) cckd64_flush_cache_all();
+
+} /* end function cckd64_ra_batch */
+#endif /* defined( OPTION_CCKD_IO_URING ) */
+
 /*-------------------------------------------------------------------*/
 /* Flush updated cache entries for a device                          */
 /*                                                                   */
@@ -1133,9 +1337,6 @@ cckd_read_trk_retry:
 /*-------------------------------------------------------------------*/
 void cckd64_flush_cache(DEVBLK *dev)
 {
-int             rc;                     /* Return code               */
-TID             tid;                    /* Writer thread id          */
-
     if (!dev->cckd64)
     {
         cckd_flush_cache( dev );
@@ -1148,38 +1349,9 @@ TID             tid;                    /* Writer thread id          */
     cache_scan (CACHE_DEVBUF, cckd64_flush_cache_scan, dev);
     cache_unlock (CACHE_DEVBUF);
 
-    /* Schedule the writer if any writes are pending */
+    /* Schedule the compressors or writers if any writes are pending */
     if (cckdblk.wrpending)
-    {
-        if (cckdblk.wrwaiting)
-            signal_condition (&cckdblk.wrcond);
-        else if (cckdblk.wrs < cckdblk.wrmax)
-        {
-            /* Schedule a new writer thread  */
-            if (!cckdblk.batch || cckdblk.batchml > 1)
-                // "Starting thread %s, active=%d, started=%d, max=%d"
-                WRMSG(HHC00107, "I", CCKD_WR_THREAD_NAME "()",
-                    cckdblk.wra, cckdblk.wrs, cckdblk.wrmax);
-
-            ++cckdblk.wrs;
-
-            /* Release lock across thread create to prevent interlock  */
-            release_lock(&cckdblk.wrlock);
-            {
-                rc = create_thread( &tid, JOINABLE, cckd_writer, NULL, CCKD_WR_THREAD_NAME );
-            }
-            obtain_lock(&cckdblk.wrlock);
-
-            if (rc)
-            {
-                // "Error in function create_thread() for %s %d of %d: %s"
-                WRMSG(HHC00106, "E", CCKD_WR_THREAD_NAME "()",
-                    cckdblk.wrs-1, cckdblk.wrmax, strerror(rc));
-
-                --cckdblk.wrs;
-            }
-        }
-    }
+        cckd_schedule_writes();
 
     release_lock (&cckdblk.wrlock);
 }
@@ -1260,33 +1432,26 @@ DEVBLK         *dev = data;             /* -> device block           */
 }
 
 /*-------------------------------------------------------------------*/
-/* cckd writer thread helper:   write the cached track image         */
+/* cckd writer thread helper:   compress the cached track image      */
 /*-------------------------------------------------------------------*/
-void cckd64_writer_write( int writer, int o )
+int cckd64_writer_compress( int writer, int o, BYTE** bufp )
 {
-TID             tid;                    /* Writer thead id           */
 CCKD64_EXT*     cckd;                   /* -> cckd extension         */
 DEVBLK*         dev;                    /* Device block              */
 U16             devnum;                 /* Device number             */
-int             rc;                     /* (work) return code        */
 int             trk;                    /* Track number              */
 BYTE*           buf;                    /* Buffer                    */
-BYTE*           bufp;                   /* Buffer to be written      */
 int             len, bufl;              /* Buffer lengths            */
 int             comp;                   /* Compression algorithm     */
 int             parm;                   /* Compression parameter     */
-U32             flag;                   /* Cache flag                */
-BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
+struct timeval  tv_beg, tv_end;         /* Compression time          */
 
     /* Prepare to compress */
     CCKD_CACHE_GETKEY( o, devnum, trk );
     dev = cckd_find_device_by_devnum( devnum );
 
     if (!dev->cckd64)
-    {
-        cckd_writer_write( writer, o );
-        return;
-    }
+        return cckd_writer_compress( writer, o, bufp );
 
     cckd = dev->cckd_ext;
     buf  = cache_getbuf( CACHE_DEVBUF, o, 0 );
@@ -1327,16 +1492,58 @@ BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
         CCKD_TRACE( "%d wrtrk[%d] %d comp %s parm %d",
                     writer, o, trk, compname[ comp ], parm );
 
-        bufp = (BYTE*) &buf2;
-        bufl = cckd_compress( dev, &bufp, buf, len, comp, parm );
+        gettimeofday( &tv_beg, NULL );
+        bufl = cckd_compress( dev, bufp, buf, len, comp, parm );
+        gettimeofday( &tv_end, NULL );
+
+        cckdblk.stats_compresses++;
+        cckdblk.stats_compressusecs +=
+            (tv_end.tv_sec  - tv_beg.tv_sec) * 1000000
+          + (tv_end.tv_usec - tv_beg.tv_usec);
 
         CCKD_TRACE( "%d wrtrk[%d] %d compressed length %d",
                     writer, o, trk, bufl );
     }
     else
     {
-        bufp = buf;
-        bufl = len;
+        *bufp = buf;
+        bufl  = len;
+    }
+
+    return bufl;
+
+} /* end function cckd64_writer_compress */
+
+/*-------------------------------------------------------------------*/
+/* cckd writer thread helper:   write the cached track image         */
+/*-------------------------------------------------------------------*/
+void cckd64_writer_write( int writer, int o, BYTE* bufp, int bufl )
+{
+TID             tid;                    /* Writer thead id           */
+CCKD64_EXT*     cckd;                   /* -> cckd extension         */
+DEVBLK*         dev;                    /* Device block              */
+U16             devnum;                 /* Device number             */
+int             rc;                     /* (work) return code        */
+int             trk;                    /* Track number              */
+U32             flag;                   /* Cache flag                */
+BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
+
+    CCKD_CACHE_GETKEY( o, devnum, trk );
+    dev = cckd_find_device_by_devnum( devnum );
+
+    if (!dev->cckd64)
+    {
+        cckd_writer_write( writer, o, bufp, bufl );
+        return;
+    }
+
+    cckd = dev->cckd_ext;
+
+    /* Compress the image if a compressor hasn't already */
+    if (!bufp)
+    {
+        bufp = (BYTE*) &buf2;
+        bufl = cckd64_writer_compress( writer, o, &bufp );
     }
 
     obtain_lock( &cckd->filelock );
@@ -1388,11 +1595,11 @@ BYTE            buf2[ 64*1024 ];        /* 64K Compress buffer       */
 
     obtain_lock( &cckd->cckdiolock );
     {
-        cache_lock( CACHE_DEVBUF );
+        cache_lock_entry( CACHE_DEVBUF, o );
         {
             flag = cache_setflag( CACHE_DEVBUF, o, ~CCKD_CACHE_WRITING, 0 );
         }
-        cache_unlock( CACHE_DEVBUF );
+        cache_unlock_entry( CACHE_DEVBUF, o );
 
         cckd->wrpending--;
 
@@ -4023,7 +4230,7 @@ S64             free_count=0;           /* Total number free spaces  */
     WRMSG (HHC00333, "I", LCSS_DEVNUM);
 
     if (cckd->readaheads || cckd->misses)
-    // "%1d:%04X                                                      readaheads   misses"
+    // "%1d:%04X                                             readaheads   useful   wasted"
     WRMSG (HHC00334, "I", LCSS_DEVNUM);
 
     // "%1d:%04X ------------------------------------------------------------------------"
@@ -4044,9 +4251,9 @@ S64             free_count=0;           /* Total number free spaces  */
     );
 
     if (cckd->readaheads || cckd->misses)
-    // "%1d:%04X                                                         %7.7d  %7.7d"
+    // "%1d:%04X                                                %7.7d  %7.7d  %7.7d"
     WRMSG (HHC00337, "I", LCSS_DEVNUM,
-            cckd->readaheads, cckd->misses);
+            cckd->readaheads, cckd->rahits, cckd->misses);
 
     /* base file statistics */
 
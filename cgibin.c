@@ -65,6 +65,7 @@
 #include "devtype.h"
 #include "opcode.h"
 #include "httpmisc.h"
+#include "ctcadpt.h"
 
 /*-------------------------------------------------------------------*/
 /*                     cgibin_blinkenlights_cpu                      */
@@ -855,6 +856,182 @@ char   *devclass;
 
 }
 
+/*-------------------------------------------------------------------*/
+/*                    cgibin_debug_device_lcs                        */
+/*-------------------------------------------------------------------*/
+/*   LLC2 statistics of the SNA connections of each LCS device,      */
+/*   the same as displayed by the 'lcs stats' panel command.         */
+/*-------------------------------------------------------------------*/
+void cgibin_debug_device_lcs(WEBBLK *webblk)
+{
+DEVBLK   *dev;
+LCSDEV   *pLCSDEV;
+LCSCONN  *pLCSCONN;
+
+    html_header(webblk);
+
+    hprintf(webblk->sock,"<h2>LCS SNA Connections</h2>\n"
+                          "<table>\n"
+                          "<tr><th>Device</th>"
+                          "<th>Port</th>"
+                          "<th>Partner MAC</th>"
+                          "<th>I-frames in</th>"
+                          "<th>I-frames out</th>"
+                          "<th>Bytes in</th>"
+                          "<th>Bytes out</th>"
+                          "<th>RR in</th>"
+                          "<th>RR out</th>"
+                          "<th>RNR in</th>"
+                          "<th>REJ in</th>"
+                          "<th>Retransmits</th>"
+                          "<th>Out of sequence</th>"
+                          "<th>Queued</th>"
+                          "<th>Queued max</th>"
+                          "<th>Queue usecs avg</th>"
+                          "<th>Queue usecs max</th></tr>\n");
+
+    for(dev = sysblk.firstdev; dev; dev = dev->nextdev)
+    {
+        if(!dev->allocated
+          || 0x3088 != dev->devtype
+          || CTC_LCS != dev->ctctype
+          || !dev->group
+          || dev->group->members != dev->group->acount
+          || dev != dev->group->memdev[0])
+            continue;
+
+        for(pLCSDEV = ((LCSDEV*)dev->dev_data)->pLCSBLK->pDevices; pLCSDEV; pLCSDEV = pLCSDEV->pNext)
+        {
+            if(pLCSDEV->bMode != LCSDEV_MODE_SNA)
+                continue;
+
+            obtain_lock(&pLCSDEV->LCSCONNChainLock);
+
+            for(pLCSCONN = pLCSDEV->pFirstLCSCONN; pLCSCONN; pLCSCONN = pLCSCONN->pNextLCSCONN)
+                hprintf(webblk->sock,"<tr>"
+                                      "<td>%4.4X</td>"
+                                      "<td>%2.2X</td>"
+                                      "<td>%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "<td>%.1f</td>"
+                                      "<td>%"PRIu64"</td>"
+                                      "</tr>\n",
+                                      pLCSDEV->sAddr,
+                                      pLCSDEV->bPort,
+                                      pLCSCONN->bRemoteMAC[0], pLCSCONN->bRemoteMAC[1],
+                                      pLCSCONN->bRemoteMAC[2], pLCSCONN->bRemoteMAC[3],
+                                      pLCSCONN->bRemoteMAC[4], pLCSCONN->bRemoteMAC[5],
+                                      pLCSCONN->uIFramesIn, pLCSCONN->uIFramesOut,
+                                      pLCSCONN->uBytesIn, pLCSCONN->uBytesOut,
+                                      pLCSCONN->uRRIn, pLCSCONN->uRROut,
+                                      pLCSCONN->uRNRIn, pLCSCONN->uREJIn,
+                                      pLCSCONN->uRetransmits, pLCSCONN->uOutOfSeq,
+                                      pLCSCONN->uQueueDepth, pLCSCONN->uQueueDepthMax,
+                                      pLCSCONN->uQueueReads ? (double)pLCSCONN->uQueueTime /
+                                                              (double)pLCSCONN->uQueueReads : 0.0,
+                                      pLCSCONN->uQueueTimeMax);
+
+            release_lock(&pLCSDEV->LCSCONNChainLock);
+        }
+    }
+
+    hprintf(webblk->sock,"</table>\n");
+
+    html_footer(webblk);
+
+}
+
+/*-------------------------------------------------------------------*/
+/*                      cgibin_debug_pswsamp                         */
+/*                                                                   */
+/* Histogram of the sampled guest PSWs (see the pswsamp command)     */
+/*     http://localhost:8081/cgi-bin/debug/pswsamp?top=50&range=256  */
+/* Add "csv" to receive every range as comma separated values.       */
+/*-------------------------------------------------------------------*/
+void cgibin_debug_pswsamp(WEBBLK *webblk)
+{
+PSWHIST  *tab;
+U64       total, waits, size = 4096;
+int       i, n, shift, top = 20;
+char     *value;
+
+    if ((value = cgi_variable(webblk,"top")) && atoi(value) > 0)
+        top = atoi(value);
+
+    if ((value = cgi_variable(webblk,"range")))
+    {
+        size = strtoull(value, NULL, 0);
+        if (size < 2 || (size & (size - 1)))
+            size = 4096;
+    }
+    for (shift = 0; ((U64)1 << shift) < size; shift++);
+
+    if ((n = pswsamp_histogram(&tab, shift, &total, &waits)) < 0)
+        n = 0;
+
+    if (cgi_variable(webblk,"csv"))
+    {
+        hprintf(webblk->sock, "Expires: 0\n");
+        hprintf(webblk->sock, "Content-type: text/csv;\n\n");
+
+        hprintf(webblk->sock, "start,end,state,asn,asce,samples\n");
+
+        for (i = 0; i < n; i++)
+            hprintf(webblk->sock, "%16.16"PRIX64",%16.16"PRIX64",%s,%4.4X,%16.16"PRIX64",%"PRIu64"\n",
+                                  tab[i].addr, tab[i].addr + size - 1,
+                                  pswsamp_state(tab[i].flags), tab[i].asn,
+                                  tab[i].asce, tab[i].count);
+        free(tab);
+        return;
+    }
+
+    html_header(webblk);
+
+    hprintf(webblk->sock,"<h2>PSW Hot Spots</h2>\n"
+                          "<p>Sampling %s every %u msecs; "
+                          "%"PRIu64" samples, %"PRIu64" in wait state</p>\n"
+                          "<table>\n"
+                          "<tr><th>Address range</th>"
+                          "<th>State</th>"
+                          "<th>ASN</th>"
+                          "<th>ASCE</th>"
+                          "<th>Samples</th>"
+                          "<th>%%</th></tr>\n",
+                          sysblk.pswsample ? "enabled" : "disabled",
+                          sysblk.pswsampint, total, waits);
+
+    for (i = 0; i < n && i < top; i++)
+        hprintf(webblk->sock,"<tr>"
+                              "<td>%16.16"PRIX64"-%16.16"PRIX64"</td>"
+                              "<td>%s</td>"
+                              "<td>%4.4X</td>"
+                              "<td>%16.16"PRIX64"</td>"
+                              "<td>%"PRIu64"</td>"
+                              "<td>%.2f</td>"
+                              "</tr>\n",
+                              tab[i].addr, tab[i].addr + size - 1,
+                              pswsamp_state(tab[i].flags), tab[i].asn,
+                              tab[i].asce, tab[i].count,
+                              (100.0 * tab[i].count) / total);
+
+    hprintf(webblk->sock,"</table>\n");
+
+    html_footer(webblk);
+
+    free(tab);
+}
+
 /*-------------------------------------------------------------------*/
 /*                  cgibin_debug_device_detail                       */
 /*-------------------------------------------------------------------*/
@@ -1333,6 +1510,8 @@ CGITAB cgidir[] =
     { "debug/version_info",  &cgibin_debug_version_info  },
     { "debug/device/list",   &cgibin_debug_device_list   },
     { "debug/device/detail", &cgibin_debug_device_detail },
+    { "debug/device/lcs",    &cgibin_debug_device_lcs    },
+    { "debug/pswsamp",       &cgibin_debug_pswsamp       },
 
     { "tasks/cmd",           &cgibin_cmd                 },
     { "tasks/syslog",        &cgibin_syslog              },
@@ -3372,6 +3372,11 @@ do {                                                                   \
                             (STORKEY_REF|STORKEY_CHANGE) :
                              STORKEY_REF);
 
+                    /* Note input into frames holding executed code */
+                    if (to_memory)
+                        SMC_STORE( dev->mainstor + (readbackwards ?
+                            (midawdat - midawlen) + 1 : midawdat), midawlen );
+
                     /* Copy data between main storage and channel
                        buffer */
                     if (readbackwards)
@@ -3578,6 +3583,11 @@ do {                                                                   \
                     (to_memory ? (STORKEY_REF | STORKEY_CHANGE)
                                : (STORKEY_REF));
 
+                /* Note input into frames holding executed code */
+                if (to_memory)
+                    SMC_STORE( dev->mainstor + (readbackwards ?
+                        (idadata - idalen) + 1 : idadata), idalen );
+
                 /* Copy data between main storage and channel buffer */
                 if (readbackwards)
                 {
@@ -3724,6 +3734,10 @@ do {                                                                   \
                                : (STORKEY_REF));
             } /* end for(page) */
 
+            /* Note input into frames holding executed code */
+            if (to_memory)
+                SMC_STORE( dev->mainstor + addr, count );
+
 #if DEBUG_PREFETCH
             if (CCW_TRACE_OR_STEP( dev ))
             {
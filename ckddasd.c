@@ -797,6 +797,7 @@ int             cyl = 0;                /* Cylinder                  */
 int             head = 0;               /* Head                      */
 U64             offset;                 /* File offsets              */
 int             i,o,f;                  /* Indexes                   */
+U64             key;                    /* Cache key of the track    */
 CKD_TRKHDR     *trkhdr;                 /* -> New track header       */
 
     // "%1d:%04X CKD file %s: read trk %d cur trk %d"
@@ -837,9 +838,9 @@ CKD_TRKHDR     *trkhdr;                 /* -> New track header       */
             ckd_build_sense (dev, SENSE_EC, 0, 0,
                             FORMAT_1, MESSAGE_0);
             *unitstat = CSW_CE | CSW_DE | CSW_UC;
-            cache_lock(CACHE_DEVBUF);
+            cache_lock_entry(CACHE_DEVBUF, dev->cache);
             cache_setflag(CACHE_DEVBUF, dev->cache, ~CKD_CACHE_ACTIVE, 0);
-            cache_unlock(CACHE_DEVBUF);
+            cache_unlock_entry(CACHE_DEVBUF, dev->cache);
             dev->bufupdlo = dev->bufupdhi = 0;
             dev->bufcur = dev->cache = -1;
             return -1;
@@ -857,9 +858,9 @@ CKD_TRKHDR     *trkhdr;                 /* -> New track header       */
             ckd_build_sense (dev, SENSE_EC, 0, 0,
                             FORMAT_1, MESSAGE_0);
             *unitstat = CSW_CE | CSW_DE | CSW_UC;
-            cache_lock(CACHE_DEVBUF);
+            cache_lock_entry(CACHE_DEVBUF, dev->cache);
             cache_setflag(CACHE_DEVBUF, dev->cache, ~CKD_CACHE_ACTIVE, 0);
-            cache_unlock(CACHE_DEVBUF);
+            cache_unlock_entry(CACHE_DEVBUF, dev->cache);
             dev->bufupdlo = dev->bufupdhi = 0;
             dev->bufcur = dev->cache = -1;
             return -1;
@@ -868,31 +869,33 @@ CKD_TRKHDR     *trkhdr;                 /* -> New track header       */
         dev->bufupdlo = dev->bufupdhi = 0;
     }
 
-    cache_lock (CACHE_DEVBUF);
-
     /* Make the previous cache entry inactive */
     if (dev->cache >= 0)
+    {
+        cache_lock_entry(CACHE_DEVBUF, dev->cache);
         cache_setflag(CACHE_DEVBUF, dev->cache, ~CKD_CACHE_ACTIVE, 0);
+        cache_unlock_entry(CACHE_DEVBUF, dev->cache);
+    }
     dev->bufcur = dev->cache = -1;
 
     /* Return on special case when called by the close handler */
     if (trk < 0)
-    {
-        cache_unlock (CACHE_DEVBUF);
         return 0;
-    }
+
+    key = CKD_CACHE_SETKEY(dev->devnum, trk);
+    cache_lock_key (CACHE_DEVBUF, key);
 
 ckd_read_track_retry:
 
     /* Search the cache */
-    i = cache_lookup (CACHE_DEVBUF, CKD_CACHE_SETKEY(dev->devnum, trk), &o);
+    i = cache_lookup (CACHE_DEVBUF, key, &o);
 
     /* Cache hit */
     if (i >= 0)
     {
         cache_setflag(CACHE_DEVBUF, i, ~0, CKD_CACHE_ACTIVE);
         cache_setage(CACHE_DEVBUF, i);
-        cache_unlock(CACHE_DEVBUF);
+        cache_unlock_key(CACHE_DEVBUF, key);
 
         // "%1d:%04X CKD file %s: read trk %d cache hit, using cache[%d]"
         LOGDEVTR( HHC00426, "I", dev->filename, trk, i );
@@ -925,7 +928,7 @@ ckd_read_track_retry:
         LOGDEVTR( HHC00427, "I", dev->filename, trk );
 
         dev->cachewaits++;
-        cache_wait(CACHE_DEVBUF);
+        cache_wait(CACHE_DEVBUF, key);
         goto ckd_read_track_retry;
     }
 
@@ -937,11 +940,11 @@ ckd_read_track_retry:
     dev->cachemisses++;
 
     /* Make this cache entry active */
-    cache_setkey (CACHE_DEVBUF, o, CKD_CACHE_SETKEY(dev->devnum, trk));
+    cache_setkey (CACHE_DEVBUF, o, key);
     cache_setflag(CACHE_DEVBUF, o, 0, CKD_CACHE_ACTIVE|DEVBUF_TYPE_CKD);
     cache_setage (CACHE_DEVBUF, o);
     dev->buf = cache_getbuf(CACHE_DEVBUF, o, dev->ckdtrksz);
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_key (CACHE_DEVBUF, key);
 
     /* Set the file descriptor */
     for (f = 0; f < dev->ckdnumfd; f++)
@@ -967,9 +970,9 @@ ckd_read_track_retry:
         ckd_build_sense (dev, SENSE_EC, 0, 0, FORMAT_1, MESSAGE_0);
         *unitstat = CSW_CE | CSW_DE | CSW_UC;
         dev->bufcur = dev->cache = -1;
-        cache_lock(CACHE_DEVBUF);
+        cache_lock_entry(CACHE_DEVBUF, o);
         cache_release(CACHE_DEVBUF, o, 0);
-        cache_unlock(CACHE_DEVBUF);
+        cache_unlock_entry(CACHE_DEVBUF, o);
         return -1;
     }
 
@@ -986,9 +989,9 @@ ckd_read_track_retry:
             ckd_build_sense (dev, SENSE_EC, 0, 0, FORMAT_1, MESSAGE_0);
             *unitstat = CSW_CE | CSW_DE | CSW_UC;
             dev->bufcur = dev->cache = -1;
-            cache_lock(CACHE_DEVBUF);
+            cache_lock_entry(CACHE_DEVBUF, o);
             cache_release(CACHE_DEVBUF, o, 0);
-            cache_unlock(CACHE_DEVBUF);
+            cache_unlock_entry(CACHE_DEVBUF, o);
             return -1;
         }
     }
@@ -1022,9 +1025,9 @@ ckd_read_track_retry:
         ckd_build_sense (dev, 0, SENSE1_ITF, 0, 0, 0);
         *unitstat = CSW_CE | CSW_DE | CSW_UC;
         dev->bufcur = dev->cache = -1;
-        cache_lock(CACHE_DEVBUF);
+        cache_lock_entry(CACHE_DEVBUF, o);
         cache_release(CACHE_DEVBUF, o, 0);
-        cache_unlock(CACHE_DEVBUF);
+        cache_unlock_entry(CACHE_DEVBUF, o);
         return -1;
     }
 
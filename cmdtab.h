@@ -190,6 +190,8 @@
   "                    single comma and no intervening blanks. The list of\n"   \
   "                    supported cckd options are:\n"                           \
                                                                          "\n"   \
+  "  cmp=n         Set number compressor threads         ( 0 .. 16)\n"          \
+  "  cmpq=n        Set queued writes per device          ( 1 .. 32)\n"          \
   "  comp=n        Override compression                  (-1,0,1,2)\n"          \
   "  compparm=n    Override compression parm             (-1 ... 9)\n"          \
   "  debug=n       Enable CCW tracing debug messages       (0 or 1)\n"          \
@@ -205,6 +207,7 @@
   "  raq=n         Set readahead queue size              ( 0 .. 16)\n"          \
   "  rat=n         Set number tracks to read ahead       ( 0 .. 16)\n"          \
   "  trace=n       Set trace table size              (0 ... 200000)\n"          \
+  "  uring=n       Batch readaheads using io_uring         (0 or 1)\n"          \
   "  wr=n          Set number writer threads             ( 1 ... 9)\n"          \
                                                                          "\n"   \
   "Refer to the Hercules CCKD documentation web page for more information.\n"
@@ -340,6 +343,26 @@
 #define cpumodel_cmd_desc       "Set CPU model number"
 #define cpuserial_cmd_desc      "Set CPU serial number"
 #define cpuverid_cmd_desc       "Set CPU verion number"
+#define cputelem_cmd_desc       "Per-CPU telemetry feed"
+#define cputelem_cmd_help       \
+                                \
+  "Format: \"cputelem [ON target [msecs]|OFF]\".\n"                              \
+  "\n"                                                                           \
+  "Per-CPU telemetry. Every CPU continuously counts the instructions it\n"       \
+  "executes, the interrupt handling passes it makes, and the host\n"             \
+  "nanoseconds it spends executing, in an enabled wait, spinning on the\n"       \
+  "interrupt lock, handling interrupts and stopped. The instruction count\n"     \
+  "is approximate: when a program check or other interruption ends the\n"        \
+  "execution loop early, the unrolled pair of instructions that was in\n"        \
+  "progress may go uncounted.\n"                                                 \
+  "\n"                                                                           \
+  "ON streams the counters of each online CPU as one JSON object per\n"          \
+  "line every 1000 (or msecs) milliseconds to target, which is either a\n"       \
+  "file name (appended to) or host:port for a TCP connection. The\n"             \
+  "counters are cumulative since the CPU came online; \"mips\" is the rate\n"    \
+  "over the interval just ended. OFF stops the feed. Entering the\n"             \
+  "command without arguments displays the counters of each online CPU.\n"
+
 #define cr_cmd_desc             "Display or alter control registers"
 #define cr_cmd_help             \
                                 \
@@ -535,6 +558,17 @@
   "only facilities which are enabled. DISABLED shows only disabled failities.\n" \
   "LONG sorts the display by Long Description. SHORT is the default.\n"
 
+#define fastbranch_cmd_desc     "Enable/disable TLB-based cross-page branching"
+#define fastbranch_cmd_help     \
+                                \
+  "Format: \"fastbranch  [ ON | OFF ]\"\n"                                       \
+  "\n"                                                                           \
+  "When ON (the default), a successful branch to an instruction in a\n"          \
+  "different page whose translation is still present in the CPU's TLB\n"         \
+  "continues execution directly at the target without performing a full\n"       \
+  "instruction fetch. OFF forces every such branch through the full\n"           \
+  "instruction fetch path. Enter the command without an argument to\n"           \
+  "display the current setting.\n"
 #define fcb_cmd_desc            "Display a printer's current FCB"
 #define fcb_cmd_help            "Format: \"fcb <devnum>\""
 #define fpc_cmd_desc            "Display or alter floating point control register"
@@ -705,6 +739,29 @@
   "Specifies additional modules that are to be loaded by the\n"                 \
   "Hercules dynamic loader.\n"
 
+#define lcs_cmd_desc            "Display LCS statistics"
+#define lcs_cmd_help            \
+                                \
+  "Format:  \"lcs  { stats | attn }  [ <devnum> | ALL ]\".\n\n"                 \
+  "Displays the statistics of each port of the LCS device group identified\n"   \
+  "by <devnum>, or of all LCS device groups if <devnum> is not specified or\n"  \
+  "specified as 'ALL'. The statistics include the number of frames read\n"      \
+  "from the port's TAP interface and the number of frames read per wakeup\n"    \
+  "of the port's read thread and, for each SNA device on the port, the\n"       \
+  "number of SNA connections and the average number of connections\n"           \
+  "compared to find the connection for a frame.\n\n"                            \
+  "Each SNA connection is then listed by its partner's MAC address with\n"      \
+  "the LLC2 I-frames and bytes received and sent, the RR, RNR and REJ\n"        \
+  "frames received, the RR frames sent, the I-frames the partner sent\n"        \
+  "again or out of sequence, the I-frames waiting to be read by the\n"          \
+  "guest now and at most, and the average and longest time in\n"                \
+  "microseconds that they waited.\n\n"                                          \
+  "'attn' displays, for each SNA device on each port, the number of\n"          \
+  "Attention interrupts raised, retried because the device was busy, and\n"     \
+  "abandoned, the number of inbound frames covered by an Attention that\n"      \
+  "was already outstanding, and a histogram of the microseconds from an\n"      \
+  "Attention being wanted for inbound data to the guest reading that data.\n"
+
 #define legacy_cmd_desc         "Set legacysenseid setting"
 #define loadcore_cmd_desc       "Load a core image file"
 #define loadcore_cmd_help       \
@@ -953,6 +1010,23 @@
 
 #define numcpu_cmd_desc         "Set numcpu parameter"
 //#define numvec_cmd_desc         "Set numvec parameter"
+#define opprof_cmd_desc         "Per-opcode execution profiler"
+#define opprof_cmd_help         \
+                                \
+  "Format: \"opprof [ON|OFF|RESET|nnn|CSV filename]\".\n"                        \
+  "\n"                                                                           \
+  "Per-opcode execution profiler. While enabled, every instruction each\n"       \
+  "CPU executes is counted and timed with the host cycle counter (the\n"         \
+  "time stamp counter on x86 hosts, nanoseconds otherwise), per CPU and\n"       \
+  "per opcode. When disabled the normal opcode tables are used and the\n"        \
+  "profiler adds no overhead. Time spent in an instruction that ends in\n"       \
+  "a program interrupt is not counted.\n"                                        \
+  "\n"                                                                           \
+  "ON and OFF start and stop profiling and RESET zeroes the counters.\n"         \
+  "Entering the command without arguments displays the 20 opcodes (or\n"         \
+  "the nnn opcodes) of all CPUs combined that used the most host cycles.\n"      \
+  "CSV writes every non-zero per-CPU counter to the named file.\n"
+
 #define osa_cmd_desc            "(Synonym for 'qeth')"
 #define ostailor_cmd_desc       "Tailor trace information for specific OS"
 #define ostailor_cmd_help       \
@@ -1056,6 +1130,25 @@
   "\n"                                                                          \
   "Enter \"psw\" by itself to display the current PSW without altering it.\n"
 
+#define pswsamp_cmd_desc        "Guest PSW hot-spot sampler"
+#define pswsamp_cmd_help        \
+                                \
+  "Format: \"pswsamp [ON [msecs]|OFF|RESET|nnn [size]]\".\n"                     \
+  "\n"                                                                           \
+  "Guest PSW hot-spot sampler. While enabled, the timer thread records\n"        \
+  "each started CPU's PSW instruction address, primary address space\n"          \
+  "(ASCE and ASN) and problem/supervisor state every 10 milliseconds (or\n"      \
+  "every msecs milliseconds) in a ring holding each CPU's 16384 most\n"          \
+  "recent samples. The PSW of a SIE guest is sampled in place of the\n"          \
+  "host's.\n"                                                                    \
+  "\n"                                                                           \
+  "ON and OFF start and stop sampling and RESET discards the samples\n"          \
+  "taken so far. Entering the command without arguments displays the\n"          \
+  "20 (or the nnn) most frequently sampled 4K (or size byte) address\n"          \
+  "ranges of all CPUs combined. Wait state samples are counted but not\n"        \
+  "shown. The same histogram is available from the HTTP server as the\n"         \
+  "cgi-bin/debug/pswsamp page.\n"
+
 #define ptp_cmd_desc            "Enable/Disable PTP debugging"
 #define ptp_cmd_help            \
                                 \
@@ -1510,7 +1603,39 @@
 
 #endif // defined( OPTION_SHARED_DEVICES )
 
+#define simd_cmd_desc           "Select or benchmark host SIMD operand kernels"
+#define simd_cmd_help           \
+                                \
+  "Format: \"simd [SCALAR|SSE2|AVX2|BENCH [len]]\".\n"                           \
+  "\n"                                                                           \
+  "Selects the host SIMD kernels used by the MVC, MVCL, CLCL, TR, TRT\n"        \
+  "and XC instructions for operands contained within a page. At\n"              \
+  "startup the best kernels the host CPU supports are selected: AVX2 or\n"       \
+  "SSE2 on x86 hosts having them, otherwise the portable SCALAR ones.\n"         \
+  "There are no SSE2 kernels for TR and TRT; SCALAR ones are used.\n"            \
+  "\n"                                                                           \
+  "BENCH measures each kernel the host supports in bytes per host cycle\n"       \
+  "(time stamp counter ticks on x86 hosts) for operands of len bytes\n"          \
+  "(default 256, maximum 4096). Stop all CPUs first for stable figures.\n"       \
+  "\n"                                                                           \
+  "Entering the command without arguments displays the current setting.\n"
+
 #define sizeof_cmd_desc         "Display size of structures"
+#define smc_cmd_desc            "Self-modifying code tracking"
+#define smc_cmd_help            \
+                                \
+  "Format: \"smc  [ ON | OFF | RESET ]\"\n"                                      \
+  "\n"                                                                           \
+  "Controls self-modifying code tracking. While ON, every 4K frame of main\n"    \
+  "storage from which instructions are fetched is marked as a code frame,\n"     \
+  "and the first subsequent modification of a marked frame by a CPU store,\n"    \
+  "channel input, or SET STORAGE KEY removes the mark and is counted as an\n"    \
+  "invalidation of that frame. OFF (the default) stops tracking and removes\n"   \
+  "all marks. RESET zeroes the invalidation counters.\n"                         \
+  "\n"                                                                           \
+  "Enter the command without an argument to display the tracking status,\n"      \
+  "the total number of code frame invalidations, and the ten frames which\n"     \
+  "were invalidated most often.\n"
 #define spm_cmd_desc            "SIE performance monitor"
 #define ssd_cmd_desc            "Signal shutdown"
 #define ssd_cmd_help            \
@@ -1697,7 +1822,30 @@
   "CAUTION when choosing your desired TIMERINT value in relationship\n"         \
   "to your chosen HERCPRIO and TODPRIO priority settings.\n"
 
-#define tlb_cmd_desc            "Display TLB tables"
+#define tlb_cmd_desc            "Display TLB tables or statistics"
+#define tlb_cmd_help            \
+                                \
+  "Format: \"TLB [STATS|RESET]\".\n"                                             \
+  "With no arguments, displays the translation lookaside buffer of the\n"        \
+  "target CPU (and of its SIE guest if one is active). STATS displays\n"         \
+  "the TLB hit and miss counts of every online CPU, and how many of the\n"       \
+  "TLB entry purges (IPTE and similar) had to scan the TLB because the\n"        \
+  "page frame may have been cached in it. RESET clears the counts.\n"            \
+  "Use the TLBSIZE statement to change the size of the TLB.\n"
+
+#define tlbsize_cmd_desc        "Display or set TLB size and associativity"
+#define tlbsize_cmd_help        \
+                                \
+  "Format: \"TLBSIZE [entries [ways]]\".\n"                                      \
+  "Sets the number of translation lookaside buffer entries per CPU and\n"        \
+  "their associativity. 'entries' must be a power of two from 1024 to\n"         \
+  "the most the build allows: 1024, unless Hercules was built with TLBN\n"       \
+  "defined as 2048 or 4096. 'ways' must be 1, 2 or 4, with at least 1024\n"      \
+  "entries in each way. The default is 1024 entries, 1-way (direct\n"            \
+  "mapped). All CPUs must be stopped. Entering the command with no\n"            \
+  "arguments displays the current setting. Use \"TLB STATS\" to display\n"       \
+  "the TLB hit ratio.\n"
+
 #define toddrag_cmd_desc        "Display or set TOD clock drag factor"
 #define traceopt_cmd_desc       "Instruction and/or CCW trace display option"
 #define traceopt_cmd_help       \
@@ -1804,6 +1952,7 @@ COMMAND( "define",                  define_cmd,             SYSCMD,
 COMMAND( "detach",                  detach_cmd,             SYSCMD,             detach_cmd_desc,        detach_cmd_help     )
 COMMAND( "devinit",                 devinit_cmd,            SYSCMD,             devinit_cmd_desc,       devinit_cmd_help    )
 COMMAND( "devlist",                 devlist_cmd,            SYSCMD,             devlist_cmd_desc,       devlist_cmd_help    )
+COMMAND( "fastbranch",              fastbranch_cmd,         SYSCMD,             fastbranch_cmd_desc,    fastbranch_cmd_help )
 COMMAND( "fcb",                     fcb_cmd,                SYSCMD,             fcb_cmd_desc,           fcb_cmd_help        )
 COMMAND( "cctape",                  cctape_cmd,             SYSCMD,             cctape_cmd_desc,        cctape_cmd_help     )
 COMMAND( "loadparm",                loadparm_cmd,           SYSCMD,             loadparm_cmd_desc,      loadparm_cmd_help   )
@@ -1838,6 +1987,7 @@ COMMAND( "clocks",                  clocks_cmd,             SYSCMDNOPER,
 COMMAND( "codepage",                codepage_cmd,           SYSCMDNOPER,        codepage_cmd_desc,      codepage_cmd_help   )
 COMMAND( "conkpalv",                conkpalv_cmd,           SYSCMDNOPER,        conkpalv_cmd_desc,      conkpalv_cmd_help   )
 COMMAND( "cp_updt",                 cp_updt_cmd,            SYSCMDNOPER,        cp_updt_cmd_desc,       cp_updt_cmd_help    )
+COMMAND( "cputelem",                cputelem_cmd,           SYSCMDNOPER,        cputelem_cmd_desc,      cputelem_cmd_help   )
 COMMAND( "cr",                      cr_cmd,                 SYSCMDNOPER,        cr_cmd_desc,            cr_cmd_help         )
 COMMAND( "cscript",                 cscript_cmd,            SYSCMDNOPER,        cscript_cmd_desc,       cscript_cmd_help    )
 COMMAND( "ctc",                     ctc_cmd,                SYSCMDNOPER,        ctc_cmd_desc,           ctc_cmd_help        )
@@ -1849,6 +1999,7 @@ COMMAND( "gpr",                     gpr_cmd,                SYSCMDNOPER,
 COMMAND( "herclogo",                herclogo_cmd,           SYSCMDNOPER,        herclogo_cmd_desc,      herclogo_cmd_help   )
 COMMAND( "ipending",                ipending_cmd,           SYSCMDNOPER,        ipending_cmd_desc,      NULL                )
 COMMAND( "k",                       k_cmd,                  SYSCMDNOPER,        k_cmd_desc,             NULL                )
+COMMAND( "lcs",                     lcs_cmd,                SYSCMDNOPER,        lcs_cmd_desc,           lcs_cmd_help        )
 COMMAND( "loadcore",                loadcore_cmd,           SYSCMDNOPER,        loadcore_cmd_desc,      loadcore_cmd_help   )
 COMMAND( "loadtext",                loadtext_cmd,           SYSCMDNOPER,        loadtext_cmd_desc,      loadtext_cmd_help   )
 COMMAND( "maxcpu",                  maxcpu_cmd,             SYSCMDNOPER,        maxcpu_cmd_desc,        NULL                )
@@ -1856,11 +2007,13 @@ CMDABBR( "mounted_tape_reinit",  9, mounted_tape_reinit_cmd,SYSCMDNOPER,
 COMMAND( "netdev",                  netdev_cmd,             SYSCMDNOPER,        netdev_cmd_desc,        netdev_cmd_help     )
 COMMAND( "numcpu",                  numcpu_cmd,             SYSCMDNOPER,        numcpu_cmd_desc,        NULL                )
 //COMMAND( "numvec",                  numvec_cmd,             SYSCMDNOPER,        numvec_cmd_desc,        NULL                )
+COMMAND( "opprof",                  opprof_cmd,             SYSCMDNOPER,        opprof_cmd_desc,        opprof_cmd_help     )
 COMMAND( "osa",                     qeth_cmd,               SYSCMDNOPER,        osa_cmd_desc,           qeth_cmd_help       )
 COMMAND( "ostailor",                ostailor_cmd,           SYSCMDNOPER,        ostailor_cmd_desc,      ostailor_cmd_help   )
 COMMAND( "pgmtrace",                pgmtrace_cmd,           SYSCMDNOPER,        pgmtrace_cmd_desc,      pgmtrace_cmd_help   )
 COMMAND( "pr",                      pr_cmd,                 SYSCMDNOPER,        pr_cmd_desc,            pr_cmd_help         )
 COMMAND( "psw",                     psw_cmd,                SYSCMDNOPER,        psw_cmd_desc,           psw_cmd_help        )
+COMMAND( "pswsamp",                 pswsamp_cmd,            SYSCMDNOPER,        pswsamp_cmd_desc,       pswsamp_cmd_help    )
 COMMAND( "ptp",                     ptp_cmd,                SYSCMDNOPER,        ptp_cmd_desc,           ptp_cmd_help        )
 COMMAND( "ptt",                     EXTCMD( ptt_cmd ),      SYSCMDNOPER,        ptt_cmd_desc,           ptt_cmd_help        )
 COMMAND( "qd",                      qd_cmd,                 SYSCMDNOPER,        qd_cmd_desc,            qd_cmd_help         )
@@ -1877,6 +2030,7 @@ COMMAND( "s+",                      trace_cmd,              SYSCMDNOPER,
 COMMAND( "savecore",                savecore_cmd,           SYSCMDNOPER,        savecore_cmd_desc,      savecore_cmd_help   )
 COMMAND( "script",                  script_cmd,             SYSCMDNOPER,        script_cmd_desc,        script_cmd_help     )
 COMMAND( "sh",                      sh_cmd,                 SYSCMDNOPER,        sh_cmd_desc,            sh_cmd_help         )
+COMMAND( "simd",                    simd_cmd,               SYSCMDNOPER,        simd_cmd_desc,          simd_cmd_help       )
 COMMAND( "suspend",                 suspend_cmd,            SYSCMDNOPER,        suspend_cmd_desc,       NULL                )
 COMMAND( "symptom",                 traceopt_cmd,           SYSCMDNOPER,        symptom_cmd_desc,       NULL                )
 
@@ -1889,7 +2043,7 @@ COMMAND( "txf",                     txf_cmd,                SYSCMDNOPER,
 #endif
 COMMAND( "t+-",                     auto_trace_cmd,         SYSCMDNOPER,        auto_trace_desc,        auto_trace_help     )
 COMMAND( "timerint",                timerint_cmd,           SYSCMDNOPER,        timerint_cmd_desc,      timerint_cmd_help   )
-COMMAND( "tlb",                     tlb_cmd,                SYSCMDNOPER,        tlb_cmd_desc,           NULL                )
+COMMAND( "tlb",                     tlb_cmd,                SYSCMDNOPER,        tlb_cmd_desc,           tlb_cmd_help        )
 COMMAND( "toddrag",                 toddrag_cmd,            SYSCMDNOPER,        toddrag_cmd_desc,       NULL                )
 COMMAND( "traceopt",                traceopt_cmd,           SYSCMDNOPER,        traceopt_cmd_desc,      traceopt_cmd_help   )
 COMMAND( "u",                       u_cmd,                  SYSCMDNOPER,        u_cmd_desc,             u_cmd_help          )
@@ -1920,6 +2074,7 @@ COMMAND( "model",                   stsi_model_cmd,         SYSCFGNDIAG8,
 COMMAND( "plant",                   stsi_plant_cmd,         SYSCFGNDIAG8,       plant_cmd_desc,         NULL                )
 COMMAND( "shcmdopt",                shcmdopt_cmd,           SYSCFGNDIAG8,       shcmdopt_cmd_desc,      shcmdopt_cmd_help   )
 COMMAND( "sysepoch",                sysepoch_cmd,           SYSCFGNDIAG8,       sysepoch_cmd_desc,      NULL                )
+COMMAND( "tlbsize",                 tlbsize_cmd,            SYSCFGNDIAG8,       tlbsize_cmd_desc,       tlbsize_cmd_help    )
 COMMAND( "tzoffset",                tzoffset_cmd,           SYSCFGNDIAG8,       tzoffset_cmd_desc,      NULL                )
 COMMAND( "xpndsize",                xpndsize_cmd,           SYSCFGNDIAG8,       xpndsize_cmd_desc,      xpndsize_cmd_help   )
 COMMAND( "yroffset",                yroffset_cmd,           SYSCFGNDIAG8,       yroffset_cmd_desc,      NULL                )
@@ -1971,6 +2126,7 @@ COMMAND( "!message",                g_cmd,                  SYSCMD,
 COMMAND( ".reply",                  g_cmd,                  SYSCMD,             reply_cmd_desc,         reply_cmd_help      )
 COMMAND( "scpecho",                 scpecho_cmd,            SYSCMD,             scpecho_cmd_desc,       scpecho_cmd_help    )
 COMMAND( "scpimply",                scpimply_cmd,           SYSCMD,             scpimply_cmd_desc,      scpimply_cmd_help   )
+COMMAND( "smc",                     smc_cmd,                SYSCMD,             smc_cmd_desc,           smc_cmd_help        )
 COMMAND( "ssd",                     ssd_cmd,                SYSCMD,             ssd_cmd_desc,           ssd_cmd_help        )
 #endif
 #if defined( _FEATURE_SCSI_IPL )
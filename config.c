@@ -252,9 +252,12 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
         if (config_allocmaddr)
             free( config_allocmaddr );
 
+        free( sysblk.smcmap );
+
         sysblk.storkeys = 0;
         sysblk.mainstor = 0;
         sysblk.mainsize = 0;
+        sysblk.smcmap   = NULL;
 
         config_allocmsize = 0;
         config_allocmaddr = NULL;
@@ -368,6 +371,19 @@ int configure_storage( U64 mainsize /* number of 4K pages */ )
     sysblk.mainstor = mainstor;
     sysblk.mainsize = mainsize << SHIFT_4K;
 
+    /* Self-modifying code map: one entry per 4K frame */
+    free( sysblk.smcmap );
+    sysblk.smcmap = calloc( (size_t) MAX( 1, mainsize ), sizeof( U32 ));
+    sysblk.smcinvals = 0;
+
+    if (!sysblk.smcmap)
+    {
+        sysblk.smctrack = 0;
+
+        // "Error in function %s: %s"
+        WRMSG( HHC01430, "E", "configure_storage( smcmap )", strerror( errno ));
+    }
+
     /*  Free previously allocated storage if no longer needed
      *
      *  FIXME: The storage ordering further limits the amount of storage
@@ -535,6 +551,49 @@ int configure_xstorage( U64 xpndsize )
 
 POP_GCC_WARNINGS()
 
+/*-------------------------------------------------------------------*/
+/* configure_tlb - configure TLB size and associativity              */
+/*-------------------------------------------------------------------*/
+static void configure_tlb_regs( REGS* regs )
+{
+    regs->tlbways    = sysblk.tlbways;
+    regs->tlbsets    = sysblk.tlbentries / sysblk.tlbways;
+    regs->tlbsetmask = regs->tlbsets - 1;
+    regs->tlbnextway = 0;
+
+    /* Discard all existing entries */
+    memset( &regs->tlb.vaddr, 0, TLBN * sizeof( DW ));
+    regs->tlbID = 1;
+    memset( regs->tlbfilter, 0, sizeof( regs->tlbfilter ));
+}
+
+int configure_tlb( U32 entries, U32 ways )
+{
+    int  cpu;
+
+    /* Ensure all CPUs have been stopped */
+    if (are_any_cpus_started())
+        return HERRCPUONL;
+
+    sysblk.tlbentries = entries;
+    sysblk.tlbways    = ways;
+
+    for (cpu = 0; cpu < sysblk.maxcpu; cpu++)
+    {
+        if (!IS_CPU_ONLINE( cpu ))
+            continue;
+
+        configure_tlb_regs( sysblk.regs[ cpu ]);
+
+#if defined( _FEATURE_SIE )
+        if (GUEST( sysblk.regs[ cpu ]))
+            configure_tlb_regs( GUEST( sysblk.regs[ cpu ]));
+#endif
+    }
+
+    return 0;
+}
+
 /*-------------------------------------------------------------------*/
 /* Next 4 functions used for fast device lookup cache management     */
 /*-------------------------------------------------------------------*/
@@ -5325,6 +5325,9 @@ RADR    n;                              /* Absolute storage addr     */
 
     STORKEY_INVALIDATE( regs, n );
 
+    /* Invalidate anything cached for code in this frame */
+    SMC_STORE( regs->mainstor + n, 1 );
+
 //  /*debug*/LOGMSG( "SSK storage block %8.8X key %2.2X\n",
 //  /*debug*/        regs->GR_L(r2), regs->GR_LHLCL(r1) & 0xFE );
 
@@ -5670,6 +5673,9 @@ BYTE    r1key;
            when referenced next */
         STORKEY_INVALIDATE( regs, n );
 
+        /* Invalidate anything cached for code in this frame */
+        SMC_STORE( regs->mainstor + n, 1 );
+
 #if defined( FEATURE_008_ENHANCED_DAT_FACILITY_1 )
         /* Update r2 in the case of a multiple page update */
         if (FACILITY_ENABLED( 008_EDAT_1, regs )
@@ -398,6 +398,58 @@ DLL_EXPORT void ARCH_DEP( Set_BEAR_Reg )( U64* bear, REGS* regs, BYTE* ip )
 }
 #endif
 
+/*-------------------------------------------------------------------*/
+/*                       branch_to_page                              */
+/*-------------------------------------------------------------------*/
+/* Called for a successful branch whose target lies in a different  */
+/* page than the current instruction.  If the target page is still  */
+/* translated in the TLB for instruction fetch, the instruction     */
+/* address fields are pointed directly at it so run_cpu's loop can  */
+/* keep executing without leaving to perform a full instfetch().    */
+/* The TLB itself is the cache: anything that invalidates the entry */
+/* (PTLB, IPTE, IDTE, SSKE, CR changes, ...) also invalidates this  */
+/* shortcut.  Returns false whenever instfetch() must be used.      */
+/*-------------------------------------------------------------------*/
+static inline bool ARCH_DEP( branch_to_page )( REGS* regs, VADR vaddr )
+{
+    int     tlbix;
+    int     offset;
+    BYTE*   aip;
+
+    offset = (int)(vaddr & PAGEFRAME_BYTEMASK);
+
+    if (0
+        || !sysblk.fastbranch
+        || regs->permode
+        || regs->execflag
+        || regs->breakortrace
+        || (vaddr & 0x01)
+        || vaddr < 0x800
+        || offset >= PAGEFRAME_PAGESIZE - 5
+#if defined( FEATURE_073_TRANSACT_EXEC_FACILITY )
+        || regs->txf_contran
+#endif
+    )
+        return false;
+
+    tlbix = ARCH_DEP( tlb_probe )( vaddr, regs->AEA_AR( USE_INST_SPACE ),
+                                   regs, ACCTYPE_INSTFETCH, regs->psw.pkey );
+    if (tlbix < 0)
+        return false;
+
+    aip = (BYTE*)((uintptr_t)MAINADDR( regs->tlb.main[ tlbix ], vaddr ) & ~PAGEFRAME_BYTEMASK);
+
+    regs->AIV = vaddr & PAGEFRAME_PAGEMASK;
+    regs->aip = aip;
+    regs->aie = aip + PAGEFRAME_PAGESIZE - 5;
+    regs->ip  = aip + offset;
+
+    SMC_MARK_CODE( aip );
+    regs->tlbhits++;
+
+    return true;
+}
+
 /*-------------------------------------------------------------------*/
 /*                      SuccessfulBranch                             */
 /*-------------------------------------------------------------------*/
@@ -424,6 +476,9 @@ void ARCH_DEP( SuccessfulBranch )( REGS* regs, VADR vaddr )
         return;
     }
 
+    if (ARCH_DEP( branch_to_page )( regs, vaddr ))
+        return;
+
     /* Branch target is in another page: point the PSW to the target
        instruction and force a new "regs->ip" value to get set by
        forcing a full instruction fetch from the new target address.
@@ -468,6 +523,9 @@ void ARCH_DEP( SuccessfulRelativeBranch )( REGS* regs, S64 offset )
     */
     PTT_INF( "rbranch >", regs->psw.IA, offset, regs->execflag );
 
+    if (!regs->execflag && ARCH_DEP( branch_to_page )( regs, PSW_IA_FROM_IP( regs, offset )))
+        return;
+
     /* Point PSW to target instruction */
     if (!regs->execflag)
         regs->psw.IA = PSW_IA_FROM_IP( regs, offset );
@@ -720,8 +778,11 @@ bool    intercept;                      /* False for virtual pgmint  */
     PTT_PGM( "PGM (r)h,g,a", realregs->host, realregs->guest, realregs->sie_active );
 
     /* Prevent machine check when in (almost) interrupt loop */
-    realregs->instcount++;
-    UPDATE_SYSBLK_INSTCOUNT( 1 );
+    UPDATE_INSTCOUNT( realregs, 1 );
+
+    /* run_cpu or run_sie switches back to executing once we're done */
+    cputelem_enter( realregs, CPUTELEM_INTR );
+    CPUTELEM_ADD( realregs, intcount, 1 );
 
     /* Release any locks */
     if (sysblk.intowner == realregs->cpuad)
@@ -1683,6 +1744,9 @@ RADR    fsta;                           /* Failing storage address   */
 /*-------------------------------------------------------------------*/
 void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
 {
+    cputelem_enter( regs, CPUTELEM_INTR );
+    CPUTELEM_ADD( regs, intcount, 1 );
+
     /* Process PER program interrupts */
     if( OPEN_IC_PER(regs) )
         regs->program_interrupt (regs, PGM_PER_EVENT);
@@ -1814,7 +1878,9 @@ cpustate_stopping:
         regs->ints_state = IC_INITIAL_STATE;
         sysblk.started_mask ^= regs->cpubit;
 
+        cputelem_enter( regs, CPUTELEM_STOPPED );
         CPU_Wait(regs);
+        cputelem_enter( regs, CPUTELEM_INTR );
 
         sysblk.started_mask |= regs->cpubit;
         regs->ints_state |= sysblk.ints_state;
@@ -1863,7 +1929,9 @@ cpustate_stopping:
 
         /* Indicate waiting and invoke CPU wait */
         sysblk.waiting_mask |= regs->cpubit;
+        cputelem_enter( regs, CPUTELEM_WAIT );
         CPU_Wait(regs);
+        cputelem_enter( regs, CPUTELEM_INTR );
 
         /* Turn off the waiting bit .
          *
@@ -1890,8 +1958,49 @@ cpustate_stopping:
     /* Release the interrupt lock */
     RELEASE_INTLOCK(regs);
 
+    cputelem_enter( regs, CPUTELEM_EXEC );
+
 } /* process_interrupt */
 
+/*-------------------------------------------------------------------*/
+/* Opcode profiling (see opcode.h)                                   */
+/*-------------------------------------------------------------------*/
+static INSTR_FUNC ARCH_DEP( opprof_table )[ OPPROF_OPCODES ];
+
+static DEF_INST( opprof_instruction )
+{
+    U16     ix    = opprof_index( inst );
+    U64*    count = OPPROF_COUNT( regs->cpuad );
+    U64     start;
+
+    count[ ix ]++;
+    start = host_cycles();
+    regs->ARCH_DEP( runtime_opcode_xxxx )[ fetch_hw( inst )]( inst, regs );
+    count[ OPPROF_OPCODES + ix ] += host_cycles() - start;
+}
+
+/*-------------------------------------------------------------------*/
+/* Build the profiling opcode table (once, before any CPU starts)    */
+/*-------------------------------------------------------------------*/
+static void ARCH_DEP( init_opprof_table )()
+{
+    int  i;
+
+    for (i = 0; i < OPPROF_OPCODES; i++)
+        ARCH_DEP( opprof_table )[i] = ARCH_DEP( opprof_instruction );
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the opcode table the run loop should dispatch through      */
+/*-------------------------------------------------------------------*/
+static inline const INSTR_FUNC* ARCH_DEP( run_opcode_table )( REGS* regs )
+{
+    if (likely( !sysblk.opprofile ) || !OPPROF_COUNT( regs->cpuad ))
+        return regs->ARCH_DEP( runtime_opcode_xxxx );
+
+    return ARCH_DEP( opprof_table );
+}
+
 /*-------------------------------------------------------------------*/
 /* Run CPU                                                           */
 /*-------------------------------------------------------------------*/
@@ -2002,14 +2111,21 @@ int     aswitch;
         /* Our instruction execution loop further below didn't finish
            due to a longjmp(progjmp) having been executed bringing us
            to here, thereby causing the instruction counter to not be
-           properly updated. Thus, we need to update it here instead.
+           properly updated. Thus, we need to update it here instead,
+           from the number of unrolled loop iterations that completed.
+           The count is approximate: the iteration in progress is not
+           counted, so when its second instruction longjmps the first
+           one is lost, and a longjmp other than a program check (which
+           program_interrupt already counted) loses the whole pair.
        */
-        regs->instcount   +=     MAX_CPU_LOOPS/2;   /* approximate */
-        UPDATE_SYSBLK_INSTCOUNT( MAX_CPU_LOOPS/2 ); /* approximate */
+        if (regs->execpos >= 0)
+            UPDATE_INSTCOUNT( regs, regs->execpos * 2 );
 
         /* Perform automatic instruction tracing if it's enabled */
         do_automatic_tracing();
     }
+    regs->execpos = -1;
+    cputelem_enter( regs, CPUTELEM_EXEC );
 
     /* Set `execflag' to 0 in case EXecuted instruction did a longjmp() */
     regs->execflag = 0;
@@ -2050,21 +2166,23 @@ fastest_no_txf_loop:
     if (INTERRUPT_PENDING( regs ))
         ARCH_DEP( process_interrupt )( regs );
 
+    current_opcode_table = ARCH_DEP( run_opcode_table )( regs );
+
 enter_fastest_no_txf_loop:
 
     ip = INSTRUCTION_FETCH( regs, 0 );
     PROCESS_TRACE( regs, ip, enter_fastest_no_txf_loop );
     EXECUTE_INSTRUCTION( current_opcode_table, ip, regs );
-    regs->instcount++;
-    UPDATE_SYSBLK_INSTCOUNT( 1 );
+    UPDATE_INSTCOUNT( regs, 1 );
 
     for (i=0; i < MAX_CPU_LOOPS/2; i++)
     {
+        regs->execpos = i;
         UNROLLED_EXECUTE( current_opcode_table, regs );
         UNROLLED_EXECUTE( current_opcode_table, regs );
     }
-    regs->instcount   +=     (i * 2);
-    UPDATE_SYSBLK_INSTCOUNT( (i * 2) );
+    regs->execpos = -1;
+    UPDATE_INSTCOUNT( regs, i * 2 );
 
     /* Perform automatic instruction tracing if it's enabled */
     do_automatic_tracing();
@@ -2077,6 +2195,8 @@ txf_facility_loop:
     if (INTERRUPT_PENDING( regs ))
         ARCH_DEP( process_interrupt )( regs );
 
+    current_opcode_table = ARCH_DEP( run_opcode_table )( regs );
+
     if (regs->txf_tnd)
         goto enter_txf_slower_loop;
 
@@ -2085,11 +2205,12 @@ enter_txf_faster_loop:
     ip = INSTRUCTION_FETCH( regs, 0 );
     PROCESS_TRACE( regs, ip, enter_txf_faster_loop );
     EXECUTE_INSTRUCTION( current_opcode_table, ip, regs );
-    regs->instcount++;
-    UPDATE_SYSBLK_INSTCOUNT( 1 );
+    UPDATE_INSTCOUNT( regs, 1 );
 
     for (i=0; i < MAX_CPU_LOOPS/2; i++)
     {
+        regs->execpos = i;
+
         if (regs->txf_tnd)
             break;
 
@@ -2100,8 +2221,8 @@ enter_txf_faster_loop:
 
         UNROLLED_EXECUTE( current_opcode_table, regs );
     }
-    regs->instcount   +=     (i * 2);
-    UPDATE_SYSBLK_INSTCOUNT( (i * 2) );
+    regs->execpos = -1;
+    UPDATE_INSTCOUNT( regs, i * 2 );
 
     /* Perform automatic instruction tracing if it's enabled */
     do_automatic_tracing();
@@ -2119,11 +2240,12 @@ enter_txf_slower_loop:
     ip = INSTRUCTION_FETCH( regs, 0 );
     PROCESS_TRACE( regs, ip, enter_txf_slower_loop );
     TXF_EXECUTE_INSTRUCTION( current_opcode_table, ip, regs );
-    regs->instcount++;
-    UPDATE_SYSBLK_INSTCOUNT( 1 );
+    UPDATE_INSTCOUNT( regs, 1 );
 
     for (i=0; i < MAX_CPU_LOOPS/2; i++)
     {
+        regs->execpos = i;
+
         if (!regs->txf_tnd)
             break;
 
@@ -2134,8 +2256,8 @@ enter_txf_slower_loop:
 
         TXF_UNROLLED_EXECUTE( current_opcode_table, regs );
     }
-    regs->instcount   +=     (i * 2);
-    UPDATE_SYSBLK_INSTCOUNT( (i * 2) );
+    regs->execpos = -1;
+    UPDATE_INSTCOUNT( regs, i * 2 );
 
     /* Perform automatic instruction tracing if it's enabled */
     do_automatic_tracing();
@@ -2193,12 +2315,15 @@ void ARCH_DEP( process_trace )( REGS* regs, BYTE* dest )
             sysblk.started_mask &= ~hostregs->cpubit;
             hostregs->stepwait = 1;
             sysblk.intowner = LOCK_OWNER_NONE;
+            cputelem_enter( hostregs, CPUTELEM_STOPPED );
 
             while (hostregs->cpustate == CPUSTATE_STOPPED)
             {
                 wait_condition( &hostregs->intcond, &sysblk.intlock );
             }
 
+            cputelem_enter( hostregs, CPUTELEM_EXEC );
+
             sysblk.intowner = hostregs->cpuad;
             hostregs->stepwait = 0;
             sysblk.started_mask |= hostregs->cpubit;
@@ -2299,6 +2424,23 @@ static REGS* (*run_cpu[ NUM_GEN_ARCHS ])( int cpu, REGS* oldregs ) =
 #endif
 };
 
+/*-------------------------------------------------------------------*/
+/* Build the opcode profiling tables -- called by impl.c function    */
+/* impl before any CPU thread is started                             */
+/*-------------------------------------------------------------------*/
+void init_opprof_tables()
+{
+#if defined(_370)
+    s370_init_opprof_table();
+#endif
+#if defined(_390)
+    s390_init_opprof_table();
+#endif
+#if defined(_900)
+    z900_init_opprof_table();
+#endif
+}
+
 /*-------------------------------------------------------------------*/
 /* CPU instruction execution thread                                  */
 /*-------------------------------------------------------------------*/
@@ -2314,6 +2456,9 @@ int   rc;
     /* Increment number of CPUs online */
     sysblk.cpus++;
 
+    /* Start counting this CPU's telemetry afresh */
+    cputelem_reset( cpu );
+
     /* Set hi CPU */
     if (cpu >= sysblk.hicpu)
         sysblk.hicpu = cpu + 1;
@@ -2402,6 +2547,12 @@ int i;
     regs->mainlim   = sysblk.mainsize - 1;
     regs->tod_epoch = get_tod_epoch();
 
+    /* TLB geometry as configured by the TLBSIZE statement */
+    regs->tlbways    = sysblk.tlbways;
+    regs->tlbsets    = sysblk.tlbentries / sysblk.tlbways;
+    regs->tlbsetmask = regs->tlbsets - 1;
+    regs->tlbnextway = 0;
+
     /* Set initial CPU ID by REGS context.  Note that this
        must only be done AFTER regs->arch_mode has been set.
     */
@@ -120,10 +120,24 @@ static void     LCS_DelMulticast  ( PLCSDEV pLCSDEV, PLCSCMDHDR pCmdFrame, int i
 static void     LCS_DefaultCmdProc( PLCSDEV pLCSDEV, PLCSCMDHDR pCmdFrame, int iCmdLen );
 
 static void*    LCS_PortThread( void* arg /* PLCSPORT pLCSPORT */ );
+static void*    LCS_QueueThread( void* arg /* PLCSQUEUE pLCSQUEUE */ );
+static void     LCS_PortReader( PLCSPORT pLCSPORT, int fd );
+static void     LCS_DispatchFrame( PLCSPORT pLCSPORT, DEVBLK* pDEVBLK, BYTE* pFrame, int iLength, char* pbReported );
+static PLCSDEV  LCS_MatchFrame( PLCSPORT pLCSPORT, DEVBLK* pDEVBLK, BYTE* pFrame, int iLength, char* pbReported );
+static void     LCS_BuildDispatch( PLCSBLK pLCSBLK, PLCSPORT pLCSPORT );
+static void     LCS_UnhashDev( PLCSBLK pLCSBLK, PLCSPORT pLCSPORT, PLCSDEV pLCSDEV );
+static PLCSDEV  LCS_FindDevByIP( PLCSPORT pLCSPORT, U32 lIPAddress );
+#if !defined( OPTION_W32_CTCI )
+static PLCSDEV  LCS_ZeroCopyDevice( PLCSPORT pLCSPORT );
+static int      LCS_ReadDirect( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, DEVBLK* pDEVBLK, int fd, int iMaxFrames, char* pbReported );
+#endif
 static void*    LCS_AttnThread( void* arg /* PLCSBLK pLCSBLK */ );
+static void     LCS_QueueAttn( PLCSDEV pLCSDEV, int iFrames );
+static void     remove_and_free_any_attns_for_device( PLCSBLK pLCSBLK, PLCSDEV pLCSDEV );
 
 static void     LCS_EnqueueEthFrame     ( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pData, size_t iSize );
 static int      LCS_DoEnqueueEthFrame   ( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pData, size_t iSize );
+static void     LCS_SignalReadEvent     ( PLCSDEV pLCSDEV );
 
 static void     LCS_EnqueueReplyFrame   ( PLCSDEV pLCSDEV, PLCSCMDHDR pReply, size_t iSize );
 static int      LCS_DoEnqueueReplyFrame ( PLCSDEV pLCSDEV, PLCSCMDHDR pReply, size_t iSize );
@@ -165,10 +179,14 @@ static void     Process_0C0E (PLCSDEV pLCSDEV, PLCSHDR pLCSHDR, PLCSBAF1 pLCSBAF
 static void     Process_0C98 (PLCSDEV pLCSDEV, PLCSHDR pLCSHDR, PLCSBAF1 pLCSBAF1, PLCSBAF2 pLCSBAF2, U16 hwLenBaf1, U16 hwLenBaf2);
 
 static PLCSIBH  alloc_lcs_buffer( PLCSDEV pLCSDEV, int iSize );
+static PLCSIBH  alloc_lcs_pool_buffer( PLCSDEV pLCSDEV, int iSize );
 static void     add_lcs_buffer_to_chain( PLCSDEV pLCSDEV, PLCSIBH pLCSIBH );
+static PLCSIBH  first_lcs_buffer_on_chain( PLCSDEV pLCSDEV );
 static PLCSIBH  remove_lcs_buffer_from_chain( PLCSDEV pLCSDEV );
 static void     remove_and_free_any_lcs_buffers_on_chain( PLCSDEV pLCSDEV );
 static void     free_lcs_buffer( PLCSDEV pLCSDEV, PLCSIBH pLCSIBH );
+static void     free_lcs_buffer_pool( PLCSDEV pLCSDEV );
+static void     free_lcs_frame_buffers( PLCSDEV pLCSDEV );
 
 static PLCSCONN alloc_connection( PLCSDEV pLCSDEV );
 static void     add_connection_to_chain( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN );
@@ -177,6 +195,7 @@ static PLCSCONN find_connection_by_outbound_token( PLCSDEV pLCSDEV, BYTE* pToken
 static PLCSCONN find_connection_by_inbound_token( PLCSDEV pLCSDEV, BYTE* pToken );
 //??  static PLCSCONN find_connection_by_token_and_mac( PLCSDEV pLCSDEV, BYTE* pToken, int iWhichToken, MAC* pMAC, int iWhichMAC );
 static int      remove_connection_from_chain( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN );
+static void     rehash_connection_tokens( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN );
 static void     remove_and_free_any_connections_on_chain( PLCSDEV pLCSDEV );
 static void     free_connection( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN );
 
@@ -202,6 +221,21 @@ static void     free_connection( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN );
     }                                                                \
     while (0)
 
+// The LCSCONN statistics are updated by the port and queue threads and
+// by the device's channel programs, so they are updated atomically. The
+// maxima are not: an occasional lost maximum is of no consequence.
+
+#define LCSCONN_COUNT( pLCSCONN, ctr, n )                            \
+    atomic_update64( (volatile S64*) &(pLCSCONN)->ctr, (S64)(n) )
+
+#define LCSCONN_MAX( pLCSCONN, ctr, n )                              \
+    do                                                               \
+    {                                                                \
+        if ( (U64)(n) > (pLCSCONN)->ctr )                            \
+            (pLCSCONN)->ctr = (U64)(n);                              \
+    }                                                                \
+    while (0)
+
 // ====================================================================
 //                    find_group_device
 // ====================================================================
@@ -273,6 +307,7 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
 
             // Initialize locking and event mechanisms
             initialize_lock( &pLCSPORT->PortDataLock );
+            initialize_lock( &pLCSPORT->PortRxLock );
             initialize_lock( &pLCSPORT->PortEventLock );
             initialize_condition( &pLCSPORT->PortEvent );
         }
@@ -348,6 +383,11 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
 
     // When this code is reached the last devblk has been allocated.
 
+    // Build each port's inbound frame dispatch table...
+
+    for (i=0; i < LCS_MAX_PORTS; i++)
+        LCS_BuildDispatch( pLCSBLK, &pLCSBLK->Port[i] );
+
     // Now build the LCSDEV's...
 
     // If an OAT is specified, the addresses that were specified in the
@@ -411,6 +451,30 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
         // command might reduce the value in pLCSDEV->iMaxFrameBufferSize.
         // For SNA, the LCS_Startup command seems to be not used.
         pLCSDev->iMaxFrameBufferSize = sizeof(pLCSDev->bFrameBuffer);
+        pLCSDev->pFrameBuffer = pLCSDev->bFrameBuffer;
+
+#if !defined( OPTION_W32_CTCI )
+        // With zerocopy, IP devices get a pair of page aligned frame
+        // buffers so the port thread can keep filling one while the
+        // other is being copied to the channel. If we can't get them
+        // just use the normal frame buffer.
+        if (pLCSBLK->fZeroCopy && pLCSDev->bMode == LCSDEV_MODE_IP)
+        {
+            pLCSDev->pFrameBuffers[0] = calloc_aligned( sizeof(pLCSDev->bFrameBuffer), LCS_FRAMEBUF_ALIGN );
+            pLCSDev->pFrameBuffers[1] = calloc_aligned( sizeof(pLCSDev->bFrameBuffer), LCS_FRAMEBUF_ALIGN );
+
+            if (!pLCSDev->pFrameBuffers[0] || !pLCSDev->pFrameBuffers[1])
+            {
+                char buf[40];
+                MSGBUF( buf, "calloc_aligned(%d)", (int)sizeof(pLCSDev->bFrameBuffer) );
+                // "CTC: error in function %s: %s"
+                WRMSG( HHC00940, "W", buf, strerror( errno ));
+                free_lcs_frame_buffers( pLCSDev );
+            }
+            else
+                pLCSDev->pFrameBuffer = pLCSDev->pFrameBuffers[0];
+        }
+#endif
 
         // Indicate that the DEVBLK(s) have been create sucessfully
         pLCSDev->fDevCreated = 1;
@@ -420,6 +484,7 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
         initialize_lock( &pLCSDev->DevEventLock );
         initialize_condition( &pLCSDev->DevEvent );
         initialize_lock( &pLCSDev->LCSIBHChainLock );
+        initialize_lock( &pLCSDev->LCSIBHQueueLock );
         initialize_lock( &pLCSDev->LCSCONNChainLock );
 
         // Create the TAP interface (if not already created by a
@@ -431,8 +496,16 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
         {
             int  rc;
 
+            int  iFlags = IFF_TAP | IFF_NO_PI;
+
+#if !defined( OPTION_W32_CTCI )
+            if (pLCSBLK->iQueues > 1)
+                iFlags |= IFF_MULTI_QUEUE;
+#endif
+            pLCSPORT->iQueues = 1;
+
             rc = TUNTAP_CreateInterface( pLCSBLK->pszTUNDevice,
-                                         IFF_TAP | IFF_NO_PI,
+                                         iFlags,
                                          &pLCSPORT->fd,
                                          pLCSPORT->szNetIfName );
 
@@ -451,6 +524,40 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
                                   pLCSDev->pDEVBLK[0]->typname,
                                   pLCSPORT->szNetIfName, "TAP");
 
+#if !defined( OPTION_W32_CTCI )
+            // Attach the interface's other queues, each with its own fd.
+            // If one can't be attached, just use the ones we have.
+            for (i=1; i < pLCSBLK->iQueues; i++)
+            {
+                pLCSPORT->Queue[i].pLCSPORT = pLCSPORT;
+
+                if (TUNTAP_CreateInterface( pLCSBLK->pszTUNDevice,
+                                            iFlags,
+                                            &pLCSPORT->Queue[i].fd,
+                                            pLCSPORT->szNetIfName ) < 0)
+                {
+                    // "%1d:%04X %s: error in function %s: %s"
+                    WRMSG( HHC00900, "W", SSID_TO_LCSS( pLCSDev->pDEVBLK[0]->ssid),
+                        pLCSDev->pDEVBLK[0]->devnum, pLCSDev->pDEVBLK[0]->typname,
+                        "TUNTAP_CreateInterface", strerror( errno ));
+                    break;
+                }
+                pLCSPORT->iQueues++;
+            }
+
+            // The port thread drains all of the frames that are ready
+            // each time it wakes up, which requires non-blocking reads.
+            if (pLCSBLK->iRxBatch > 1)
+            {
+                VERIFY( fcntl( pLCSPORT->fd, F_SETFL,
+                        fcntl( pLCSPORT->fd, F_GETFL ) | O_NONBLOCK ) == 0 );
+
+                for (i=1; i < pLCSPORT->iQueues; i++)
+                    VERIFY( fcntl( pLCSPORT->Queue[i].fd, F_SETFL,
+                            fcntl( pLCSPORT->Queue[i].fd, F_GETFL ) | O_NONBLOCK ) == 0 );
+            }
+#endif
+
             //
             if (!pLCSPORT->fPreconfigured)
             {
@@ -522,6 +629,30 @@ int  LCS_Init( DEVBLK* pDEVBLK, int argc, char *argv[] )
                 WRMSG( HHC00102, "E", strerror( rc ));
             }
 
+            // And a thread to read each of the port's other queues.
+            for (i=1; i < pLCSPORT->iQueues; i++)
+            {
+                MSGBUF( thread_name, "%s %4.4X Port %d Queue %d",
+                                     pLCSBLK->pDevices->pDEVBLK[0]->typname,
+                                     pLCSBLK->pDevices->pDEVBLK[0]->devnum,
+                                     pLCSPORT->bPort, i);
+                rc = create_thread( &pLCSPORT->Queue[i].tid, JOINABLE,
+                                    LCS_QueueThread, &pLCSPORT->Queue[i], thread_name );
+                if (rc)
+                {
+                    // "Error in function create_thread(): %s"
+                    WRMSG( HHC00102, "E", strerror( rc ));
+
+                    // (close the queues that have no thread)
+                    for (; pLCSPORT->iQueues > i; pLCSPORT->iQueues--)
+                    {
+                        VERIFY( TUNTAP_Close( pLCSPORT->Queue[ pLCSPORT->iQueues - 1 ].fd ) == 0 );
+                        pLCSPORT->Queue[ pLCSPORT->iQueues - 1 ].fd = -1;
+                    }
+                    break;
+                }
+            }
+
             // Identify thread ID with devices on which they're active
             pLCSDev->pDEVBLK[0]->tid = pLCSPORT->tid;
             if (pLCSDev->pDEVBLK[1])
@@ -964,7 +1095,6 @@ void  LCS_EndChannelProgram( DEVBLK* pDEVBLK )
 {
     PLCSDEV     pLCSDEV;
     PLCSBLK     pLCSBLK;
-    PLCSATTN    pLCSATTN;
 
 
     pLCSDEV = (PLCSDEV)pDEVBLK->dev_data;
@@ -972,6 +1102,7 @@ void  LCS_EndChannelProgram( DEVBLK* pDEVBLK )
 
     if (pLCSDEV->bMode == LCSDEV_MODE_SNA)
     {
+        pLCSBLK = pLCSDEV->pLCSBLK;
 
         if (pLCSDEV->fAttnRequired)
         {
@@ -979,46 +1110,36 @@ void  LCS_EndChannelProgram( DEVBLK* pDEVBLK )
             // device_attention at this point, but the channel program
             // is still considered to be busy, and a return code of one
             // would be returned to us.
+            LCS_QueueAttn( pLCSDEV, 0 );
 
-            pLCSBLK = pLCSDEV->pLCSBLK;
-
-            /* Create an LCSATTN block */
-            pLCSATTN = malloc( sizeof( LCSATTN ) );
-            if (!pLCSATTN) return;  /* FixMe! Produce a message? */
-            pLCSATTN->pNext = NULL;
-            pLCSATTN->pDevice = pLCSDEV;
-
-//          if (pLCSBLK->fDebug)                                                                         /* FixMe! Remove! */
-//            net_data_trace( pDEVBLK, (BYTE*)pLCSATTN, sizeof( LCSATTN ), ' ', 'D', "LCSATTN in", 0 );  /* FixMe! Remove! */
+            pLCSDEV->fAttnRequired = FALSE;
+        }
+        else if (!pLCSDEV->fAttnQueued && (pLCSDEV->pFirstLCSIBH || pLCSDEV->pQueuedLCSIBH))
+        {
+            // The guest did not read everything that was waiting, or
+            // more arrived as it read, so it needs telling again.
+            LCS_QueueAttn( pLCSDEV, 0 );
+        }
 
-            /* Add LCSATTN block to start of chain */
-            PTT_DEBUG( "GET  AttnLock", 000, pDEVBLK->devnum, 000 );
-            obtain_lock( &pLCSBLK->AttnLock );
-            PTT_DEBUG( "GOT  AttnLock", 000, pDEVBLK->devnum, 000 );
-            {
-                PTT_DEBUG( "ADD  Attn", pLCSATTN, pDEVBLK->devnum, 000 );
-                pLCSATTN->pNext = pLCSBLK->pAttns;
-                pLCSBLK->pAttns = pLCSATTN;
-            }
-            PTT_DEBUG( "REL  AttnLock", 000, pDEVBLK->devnum, 000 );
-            release_lock( &pLCSBLK->AttnLock );
+        pLCSDEV->bFlipFlop = 0;
+        pLCSDEV->fChanProgActive = FALSE;
 
-            /* Signal the LCS_AttnThread to process the LCSATTN block(s) on the chain */
+        // The device is no longer running a channel program, so tell
+        // the LCS_AttnThread to retry any attention that was deferred
+        // because the device was busy now, rather than after a delay.
+        if (pLCSDEV->fAttnDeferred)
+        {
             PTT_DEBUG( "GET  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
             obtain_lock( &pLCSBLK->AttnEventLock );
             PTT_DEBUG( "GOT  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
             {
                 PTT_DEBUG( "SIG  AttnEvent", 000, pDEVBLK->devnum, 000 );
+                pLCSBLK->fAttnRetry = TRUE;
                 signal_condition( &pLCSBLK->AttnEvent );
             }
             PTT_DEBUG( "REL  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
             release_lock( &pLCSBLK->AttnEventLock );
-
-            pLCSDEV->fAttnRequired = FALSE;
         }
-
-        pLCSDEV->bFlipFlop = 0;
-        pLCSDEV->fChanProgActive = FALSE;
     }
 }
 
@@ -1084,7 +1205,7 @@ int  LCS_Close( DEVBLK* pDEVBLK )
                 PTT_DEBUG( "SET  closeInProg  ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
                 pLCSPORT->fCloseInProgress = 1;
                 PTT_DEBUG(             "SIG  PortEvent    ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
-                signal_condition( &pLCSPORT->PortEvent );
+                broadcast_condition( &pLCSPORT->PortEvent );
             }
             PTT_DEBUG(         "REL  PortEventLock", 000, pDEVBLK->devnum, pLCSPORT->bPort );
             release_lock( &pLCSPORT->PortEventLock );
@@ -1125,6 +1246,7 @@ int  LCS_Close( DEVBLK* pDEVBLK )
             if (pCurrLCSDev == pLCSDEV)
             {
                 *ppPrevLCSDev = pCurrLCSDev->pNext;
+                LCS_UnhashDev( pLCSBLK, pLCSPORT, pCurrLCSDev );
 
                 if (pCurrLCSDev->pszIPAddress)
                 {
@@ -1132,6 +1254,11 @@ int  LCS_Close( DEVBLK* pDEVBLK )
                     pCurrLCSDev->pszIPAddress = NULL;
                 }
 
+                remove_and_free_any_lcs_buffers_on_chain( pCurrLCSDev );
+                free_lcs_buffer_pool( pCurrLCSDev );
+                free_lcs_frame_buffers( pCurrLCSDev );
+                remove_and_free_any_attns_for_device( pLCSBLK, pCurrLCSDev );
+
                 free( pLCSDEV );
                 pLCSDEV = NULL;
                 break;
@@ -1669,7 +1796,7 @@ static void  UpdatePortStarted( int bStarted, DEVBLK* pDEVBLK, PLCSPORT pLCSPORT
         // Wake up the LCS_PortThread...
 
         PTT_DEBUG(             "SIG  PortEvent    ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
-        signal_condition( &pLCSPORT->PortEvent );
+        broadcast_condition( &pLCSPORT->PortEvent );
     }
     PTT_DEBUG(         "REL  PortEventLock", 000, pDEVBLK->devnum, pLCSPORT->bPort );
     release_lock( &pLCSPORT->PortEventLock );
@@ -2175,6 +2302,7 @@ static void LCS_EnqueueReplyFrame( PLCSDEV pLCSDEV, PLCSCMDHDR pReply, size_t iS
         // Wait for LCS_Read to empty the buffer...
 
         ASSERT( ENOBUFS == errno );
+        LCS_SignalReadEvent( pLCSDEV );
         usleep( CTC_DELAY_USECS );
     }
     PTT_TIMING( "af repNQ", 0, iSize, 0 );
@@ -2218,11 +2346,12 @@ static int  LCS_DoEnqueueReplyFrame( PLCSDEV pLCSDEV, PLCSCMDHDR pReply, size_t
         }
 
         // Point to next available LCS Frame slot in our buffer...
-        pReplyCmdFrame = (PLCSCMDHDR)( pLCSDEV->bFrameBuffer +
+        pReplyCmdFrame = (PLCSCMDHDR)( pLCSDEV->pFrameBuffer +
                                        pLCSDEV->iFrameOffset );
 
         // Copy the reply frame into the frame buffer slot...
         memcpy( pReplyCmdFrame, pReply, iSize );
+        pLCSDEV->uBytesCopied += iSize;
 
         // Increment buffer offset to NEXT next-available-slot...
         pLCSDEV->iFrameOffset += (U16) iSize;
@@ -2252,44 +2381,50 @@ static int  LCS_DoEnqueueReplyFrame( PLCSDEV pLCSDEV, PLCSCMDHDR pReply, size_t
 }
 
 // ====================================================================
-//                       LCS_PortThread
+//                       LCS_PortReader
 // ====================================================================
-// This is the thread that does the actual read from the tap device.
+// This is the loop that does the actual read from one queue of the tap
+// device, run by the port thread (queue 0) and by each queue thread.
 // It waits for packets to arrive on the device and then enqueues them
 // to the device input queue to be read by the LCS_Read() function the
-// next time the guest issues a read CCW.
+// next time the guest issues a read CCW. It returns when the port is
+// closing or a read error occurs.
 // --------------------------------------------------------------------
 
-static void*  LCS_PortThread( void* arg)
+static void  LCS_PortReader( PLCSPORT pLCSPORT, int fd )
 {
     DEVBLK*     pDEVBLK;
-    PLCSPORT    pLCSPORT = (PLCSPORT) arg;
     PLCSDEV     pLCSDev;
-    PLCSDEV     pPrimaryLCSDEV;
-    PLCSDEV     pSecondaryLCSDEV;
-    PLCSDEV     pMatchingLCSDEV;
-    PLCSRTE     pLCSRTE;
-    PETHFRM     pEthFrame;
-    PIP4FRM     pIPFrame   = NULL;
-    PARPFRM     pARPFrame  = NULL;
-    int         iLength;
-    U32         lIPAddress;             // (network byte order)
-    BYTE*       pMAC;
-    BYTE        szBuff[2048];
+    int         i;
+    int         iFrames;
+    int         iRxBatch;
+    int         iFrameLen[ LCS_MAX_RXBATCH ];
+    BYTE*       pRxRing;
+    BYTE        szBuff[ LCS_RXBUF_SIZE ];
     char        bReported = 0;
     char        bStartReported = 0;
-    char        cPktType[16];
-    U16         hwEthernetType;
-    BYTE        bHas8022;
-    BYTE        bHas8022Snap;
-    int         iTraceLen;
-    MAC         mac;
 
     pDEVBLK = pLCSPORT->pLCSBLK->pDevices->pDEVBLK[ LCSDEV_READ_SUBCHANN ];
 
-    pLCSPORT->pid = getpid();
+    // Allocate the ring of receive buffers that each batch of frames
+    // is read into. If we can't, fall back to one frame per wakeup.
 
-    PTT_DEBUG(            "PORTHRD: ENTRY    ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
+    iRxBatch = pLCSPORT->pLCSBLK->iRxBatch;
+    pRxRing  = NULL;
+
+    if (iRxBatch > 1 && !(pRxRing = malloc( iRxBatch * LCS_RXBUF_SIZE )))
+    {
+        char buf[40];
+        MSGBUF( buf, "malloc(%d)", iRxBatch * LCS_RXBUF_SIZE );
+        // "CTC: error in function %s: %s"
+        WRMSG( HHC00940, "W", buf, strerror( errno ));
+    }
+
+    if (!pRxRing)
+    {
+        iRxBatch = 1;
+        pRxRing  = szBuff;
+    }
 
     for (;;)
     {
@@ -2319,10 +2454,11 @@ static void*  LCS_PortThread( void* arg)
                 if (0
                     || (pLCSPORT->fd < 0)
                     || pLCSPORT->fCloseInProgress
+                    || pLCSPORT->fStopQueues
                     || pLCSPORT->fPortStarted
                 )
                 {
-                    if ((pLCSPORT->fd < 0) || pLCSPORT->fCloseInProgress)
+                    if ((pLCSPORT->fd < 0) || pLCSPORT->fCloseInProgress || pLCSPORT->fStopQueues)
                         PTT_DEBUG( "PORTHRD is closing", pLCSPORT->fPortStarted, pDEVBLK->devnum, pLCSPORT->bPort );
                     else
                         PTT_DEBUG( "PORTHRD is started", pLCSPORT->fPortStarted, pDEVBLK->devnum, pLCSPORT->bPort );
@@ -2354,309 +2490,128 @@ static void*  LCS_PortThread( void* arg)
 
         // Exit when told...
 
-        if ( pLCSPORT->fd < 0 || pLCSPORT->fCloseInProgress )
+        if ( pLCSPORT->fd < 0 || pLCSPORT->fCloseInProgress || pLCSPORT->fStopQueues )
             break;
 
-        // Read an IP packet from the TAP device
+        pLCSDev = NULL;
+
+        // Read all of the frames that are ready on the TAP device,
+        // straight into the device's frame buffer if we can.
         PTT_TIMING( "b4 tt read", 0, 0, 0 );
-        iLength = read_tuntap( pLCSPORT->fd, szBuff, sizeof( szBuff ), DEF_NET_READ_TIMEOUT_SECS );
-        PTT_TIMING( "af tt read", 0, 0, iLength );
+#if !defined( OPTION_W32_CTCI )
+        if ((pLCSDev = LCS_ZeroCopyDevice( pLCSPORT )))
+        {
+            iFrames = wait_tuntap( fd, DEF_NET_READ_TIMEOUT_SECS );
+            if (iFrames > 0)
+                iFrames = LCS_ReadDirect( pLCSPORT, pLCSDev, pDEVBLK, fd, iRxBatch, &bReported );
+        }
+        else
+#endif
+        iFrames = read_tuntap_batch( fd, pRxRing, LCS_RXBUF_SIZE,
+                                     iFrameLen, iRxBatch, DEF_NET_READ_TIMEOUT_SECS );
+        PTT_TIMING( "af tt read", 0, 0, iFrames );
+
+        if (iFrames == 0)      // (probably EINTR; ignore)
+            continue;
 
-        if (iLength == 0)      // (probably EINTR; ignore)
+#if !defined( OPTION_W32_CTCI )
+        // Wait for LCS_Read to empty the frame buffer...
+        if (iFrames < 0 && pLCSDev && ENOBUFS == errno)
+        {
+            PTT_TIMING( "*direct wait", 0, 0, 0 );
+            LCS_SignalReadEvent( pLCSDev );
+            usleep( CTC_DELAY_USECS );
             continue;
+        }
+#endif
 
         // Check for other error condition
-        if (iLength < 0)
+        if (iFrames < 0)
         {
-            if (pLCSPORT->fd < 0 || pLCSPORT->fCloseInProgress)
+            if (pLCSPORT->fd < 0 || pLCSPORT->fCloseInProgress || pLCSPORT->fStopQueues)
                 break;
             // "CTC: lcs interface %s read error from port %2.2X: %s"
             WRMSG( HHC00944, "E", pLCSPORT->szNetIfName, pLCSPORT->bPort, strerror( errno ) );
             break;
         }
 
-        // Point to ethernet frame and determine frame type
-        pEthFrame = (PETHFRM)szBuff;
-
-        GetFrameInfo( pEthFrame, &cPktType[0], &hwEthernetType, &bHas8022, &bHas8022Snap );
-
-        if (pLCSPORT->pLCSBLK->fDebug)
+        obtain_lock( &pLCSPORT->PortRxLock );
         {
-            // "%1d:%04X %s: port %2.2X: Receive frame of size %d bytes (with %s packet) from device %s"
-            WRMSG( HHC00984, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
-                                  pLCSPORT->bPort, iLength, cPktType, pLCSPORT->szNetIfName );
-//!!            iTraceLen = iLength;
-//!!            if (iTraceLen > MAX_TRACE_LEN)
-//!!            {
-//!!                iTraceLen = MAX_TRACE_LEN;
-//!!                // HHC00980 "%1d:%04X %s: Data of size %d bytes displayed, data of size %d bytes not displayed"
-//!!                WRMSG(HHC00980, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
-//!!                                     iTraceLen, (iLength - iTraceLen) );
-//!!            }
-//!!            net_data_trace( pDEVBLK, szBuff, iTraceLen, '>', 'D', "eth frame", 0 );
-            bReported = 0;
+            pLCSPORT->uRxWakeups++;
+            pLCSPORT->uRxFrames += iFrames;
+            if ((U32)iFrames > pLCSPORT->uRxMaxBatch)
+                pLCSPORT->uRxMaxBatch = iFrames;
         }
+        release_lock( &pLCSPORT->PortRxLock );
 
-        // Perform multicast assist if necessary: discard any multicast
-        // packets the guest didn't specifically register. We only need
-        // to do this if tuntap said that it was unable to do so for us.
+        // Pass each frame to the device that it belongs to...
+        // (unless they were read directly into its frame buffer)
 
-        if (1
-            && pLCSPORT->fDoMCastAssist                                     // do mcast filtering ourself?
-            && pLCSPORT->nMCastCount                                        // we have MACs in our table?
-            && memcmp( pEthFrame->bDestMAC, mcast3, sizeof( mcast3 )) == 0  // this is a multicast frame?
-            && IsMACTab( pLCSPORT->MCastTab, pEthFrame->bDestMAC ) < 0      // its MAC not in our table?
-        )
+        if (!pLCSDev)
         {
-            if (pLCSPORT->pLCSBLK->fDebug)
-                // "CTC: lcs device port %2.2X: MCAST not in table, discarding frame"
-                WRMSG( HHC00945, "D", pLCSPORT->bPort );
-            continue;
+            for (i=0; i < iFrames; i++)
+                LCS_DispatchFrame( pLCSPORT, pDEVBLK, pRxRing + (i * LCS_RXBUF_SIZE),
+                                   iFrameLen[i], &bReported );
         }
 
-        // Housekeeping
-        pPrimaryLCSDEV   = NULL;
-        pSecondaryLCSDEV = NULL;
-        pMatchingLCSDEV  = NULL;
+        // ...and only then wake up the LCS_Read of each IP device
+        // that received any, so that a burst of frames is presented
+        // to the guest in as few Read CCWs as possible.
 
-        // Attempt to find the device that this frame belongs to
         for (pLCSDev = pLCSPORT->pLCSBLK->pDevices; pLCSDev; pLCSDev = pLCSDev->pNext)
         {
-            // Only process devices that are on this port
-            if (pLCSDev->bPort == pLCSPORT->bPort)
-            {
-                // hwEthernetType indicates which protocol is encapsulated in the payload.
-                // bHas8022 indicates whether the payload begins with an 802.2 LLC.
-                // bHas8022Snap indicates whether the payload begins with an 802.2 LLC and SNAP.
-                if (hwEthernetType == ETH_TYPE_IP)
-                {
-                    if (!bHas8022Snap)
-                        pIPFrame   = (PIP4FRM)pEthFrame->bData;
-                    else
-                        pIPFrame   = (PIP4FRM)pEthFrame->bData+ETH_LLC_SNAP_SIZE;
-                    lIPAddress = pIPFrame->lDstIP;  // (network byte order)
-
-                    if (pLCSPORT->pLCSBLK->fDebug && !bReported)
-                    {
-                        union converter { struct { unsigned char a, b, c, d; } b; U32 i; } c;
-                        char  str[40];
-
-                        c.i = ntohl(lIPAddress);
-                        MSGBUF( str, "%8.08X %d.%d.%d.%d", c.i, c.b.d, c.b.c, c.b.b, c.b.a );
-
-                        // "CTC: lcs device port %2.2X: IPv4 frame received for %s"
-                        WRMSG( HHC00946, "D", pLCSPORT->bPort, str );
-                        bReported = 1;
-                    }
-
-                    // If this is an exact match use it
-                    // otherwise look for primary and secondary
-                    // default devices
-                    if (pLCSDev->lIPAddress == lIPAddress)
-                    {
-                        pMatchingLCSDEV = pLCSDev;
-                        break;
-                    }
-                    else if (pLCSDev->bType == LCSDEV_TYPE_PRIMARY)
-                        pPrimaryLCSDEV = pLCSDev;
-                    else if (pLCSDev->bType == LCSDEV_TYPE_SECONDARY)
-                        pSecondaryLCSDEV = pLCSDev;
-                }
-                else if (hwEthernetType == ETH_TYPE_ARP)
-                {
-                    if (!bHas8022Snap)
-                        pARPFrame  = (PARPFRM)pEthFrame->bData;
-                    else
-                        pARPFrame  = (PARPFRM)pEthFrame->bData+ETH_LLC_SNAP_SIZE;
-                    lIPAddress = pARPFrame->lTargIPAddr; // (network byte order)
-
-                    if (pLCSPORT->pLCSBLK->fDebug && !bReported)
-                    {
-                        union converter { struct { unsigned char a, b, c, d; } b; U32 i; } c;
-                        char  str[40];
-
-                        c.i = ntohl(lIPAddress);
-                        MSGBUF( str, "%8.08X %d.%d.%d.%d", c.i, c.b.d, c.b.c, c.b.b, c.b.a );
-
-                        // "CTC: lcs device port %2.2X: ARP frame received for %s"
-                        WRMSG( HHC00947, "D", pLCSPORT->bPort, str );
-                        bReported = 1;
-                    }
-
-                    // If this is an exact match use it
-                    // otherwise look for primary and secondary
-                    // default devices
-                    if (pLCSDev->lIPAddress == lIPAddress)
-                    {
-                        pMatchingLCSDEV = pLCSDev;
-                        break;
-                    }
-                    else if (pLCSDev->bType == LCSDEV_TYPE_PRIMARY)
-                        pPrimaryLCSDEV = pLCSDev;
-                    else if (pLCSDev->bType == LCSDEV_TYPE_SECONDARY)
-                        pSecondaryLCSDEV = pLCSDev;
-                }
-                else if (hwEthernetType == ETH_TYPE_RARP)
-                {
-                    if (!bHas8022Snap)
-                        pARPFrame  = (PARPFRM)pEthFrame->bData;
-                    else
-                        pARPFrame  = (PARPFRM)pEthFrame->bData+ETH_LLC_SNAP_SIZE;
-                    pMAC = pARPFrame->bTargEthAddr;
-
-                    if (pLCSPORT->pLCSBLK->fDebug && !bReported)
-                    {
-                        // "CTC: lcs device port %2.2X: RARP frame received for %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X"
-                        WRMSG( HHC00948, "D" ,pLCSPORT->bPort ,*(pMAC+0) ,*(pMAC+1) ,*(pMAC+2) ,*(pMAC+3) ,*(pMAC+4) ,*(pMAC+5) );
-                        bReported = 1;
-                    }
-
-                    // If this is an exact match use it
-                    // otherwise look for primary and secondary
-                    // default devices
-                    memcpy( &mac, pLCSPORT->MAC_Address, IFHWADDRLEN );
-#if !defined( OPTION_TUNTAP_LCS_SAME_ADDR )
-                    mac[5]++;
-#endif
-                    if (memcmp( pMAC, &mac, IFHWADDRLEN ) == 0)
-                    {
-                        pMatchingLCSDEV = pLCSDev;
-                        break;
-                    }
-                    else if (pLCSDev->bType == LCSDEV_TYPE_PRIMARY)
-                        pPrimaryLCSDEV = pLCSDev;
-                    else if (pLCSDev->bType == LCSDEV_TYPE_SECONDARY)
-                        pSecondaryLCSDEV = pLCSDev;
-                }
-                else if (hwEthernetType == ETH_TYPE_SNA)
-                {
-                    pMAC = pEthFrame->bDestMAC;
-
-                    if (pLCSPORT->pLCSBLK->fDebug && !bReported)
-                    {
-                        // "CTC: lcs device port %2.2X: SNA frame received for %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X"
-                        WRMSG( HHC00949, "D" ,pLCSPORT->bPort ,*(pMAC+0) ,*(pMAC+1) ,*(pMAC+2) ,*(pMAC+3) ,*(pMAC+4) ,*(pMAC+5) );
-                        bReported = 1;
-                    }
-
-                    // If this is an exact match use it
-                    // otherwise look for primary and secondary
-                    // default devices
-                    memcpy( &mac, pLCSPORT->MAC_Address, IFHWADDRLEN );
-#if !defined( OPTION_TUNTAP_LCS_SAME_ADDR )
-                    mac[5]++;
-#endif
-                    if (memcmp( pMAC, &mac, IFHWADDRLEN ) == 0)
-                    {
-                        pMatchingLCSDEV = pLCSDev;
-                        break;
-                    }
-                    else if (pLCSDev->bType == LCSDEV_TYPE_PRIMARY)
-                        pPrimaryLCSDEV = pLCSDev;
-                    else if (pLCSDev->bType == LCSDEV_TYPE_SECONDARY)
-                        pSecondaryLCSDEV = pLCSDev;
-                }
-            }
+            if (pLCSDev->bPort == pLCSPORT->bPort && pLCSDev->bMode == LCSDEV_MODE_IP)
+                LCS_SignalReadEvent( pLCSDev );
         }
 
-        // If the matching device is not started
-        // nullify the pointer and pass frame to one
-        // of the defaults if present
-        if (pMatchingLCSDEV && !pMatchingLCSDEV->fDevStarted)
-            pMatchingLCSDEV = NULL;
-
-        // Match not found, check for default devices
-        // If one is defined and started, use it
-        if (!pMatchingLCSDEV)
-        {
-            if (pPrimaryLCSDEV && pPrimaryLCSDEV->fDevStarted)
-            {
-                pMatchingLCSDEV = pPrimaryLCSDEV;
-
-#ifndef LCS_NO_950_952 // (HHC00950 and HHC00952 are rarely interesting)
-                if (pLCSPORT->pLCSBLK->fDebug)
-                    // "CTC: lcs device port %2.2X: no match found, selecting %s %4.4X"
-                    WRMSG( HHC00950, "D", pLCSPORT->bPort, "primary", pMatchingLCSDEV->sAddr );
-#endif // LCS_NO_950_952
-            }
-            else if (pSecondaryLCSDEV && pSecondaryLCSDEV->fDevStarted)
-            {
-                pMatchingLCSDEV = pSecondaryLCSDEV;
+    } // end for (;;)
 
-#ifndef LCS_NO_950_952 // (HHC00950 and HHC00952 are rarely interesting)
-                if (pLCSPORT->pLCSBLK->fDebug)
-                    // "CTC: lcs device port %2.2X: no match found, selecting %s %4.4X"
-                    WRMSG( HHC00950, "D", pLCSPORT->bPort, "secondary", pMatchingLCSDEV->sAddr );
-#endif // LCS_NO_950_952
-            }
-        }
+    if (pRxRing != szBuff)
+        free( pRxRing );
 
-        // Discard frame if no matching device was found.
-        if (!pMatchingLCSDEV)
-        {
-            if (pLCSPORT->pLCSBLK->fDebug)
-                // "CTC: lcs device port %2.2X: no match found, discarding frame"
-                WRMSG( HHC00951, "D", pLCSPORT->bPort );
+}   // End of LCS_PortReader
 
-            continue;
-        }
+// ====================================================================
+//                       LCS_PortThread
+// ====================================================================
+// This is the thread that reads the tap device's first (or only)
+// queue. When the port is closed it stops the threads reading the
+// other queues, closes the tap device and cleans up the port.
+// --------------------------------------------------------------------
 
-        //
-        if (pMatchingLCSDEV->bMode == LCSDEV_MODE_SNA)
-        {
-            // Discard frame if the SNA device isn't accepting frames, or
-            // the frames payload does not begin with an 802.2 LLC, or
-            // the frames payload begins with an 802.2 LLC and SNAP.
-            if (!pMatchingLCSDEV->fAcceptPackets || !bHas8022 || bHas8022Snap )
-            {
-                if (pLCSPORT->pLCSBLK->fDebug)
-                    // "CTC: lcs device port %2.2X: no match found, discarding frame"
-                    WRMSG( HHC00951, "D", pLCSPORT->bPort );
-                continue;
-            }
-        }
+static void*  LCS_PortThread( void* arg)
+{
+    DEVBLK*     pDEVBLK;
+    PLCSPORT    pLCSPORT = (PLCSPORT) arg;
+    PLCSRTE     pLCSRTE;
+    int         i;
 
-#ifndef LCS_NO_950_952 // (HHC00950 and HHC00952 are rarely interesting)
-        if (pLCSPORT->pLCSBLK->fDebug)
-        {
-            union converter { struct { unsigned char a, b, c, d; } b; U32 i; } c;
-            char  str[40];
+    pDEVBLK = pLCSPORT->pLCSBLK->pDevices->pDEVBLK[ LCSDEV_READ_SUBCHANN ];
 
-            c.i = ntohl(pMatchingLCSDEV->lIPAddress);
-            MSGBUF( str, "%8.08X %d.%d.%d.%d", c.i, c.b.d, c.b.c, c.b.b, c.b.a );
+    pLCSPORT->pid = getpid();
 
-            // "CTC: lcs device port %2.2X: enqueing frame to device %4.4X %s"
-            WRMSG( HHC00952, "D", pLCSPORT->bPort, pMatchingLCSDEV->sAddr, str );
-        }
-#endif // LCS_NO_950_952
+    PTT_DEBUG(            "PORTHRD: ENTRY    ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
 
-        if (pLCSPORT->pLCSBLK->fDebug)
-        {
-            iTraceLen = iLength;
-            if (iTraceLen > MAX_TRACE_LEN)
-            {
-                iTraceLen = MAX_TRACE_LEN;
-                // HHC00980 "%1d:%04X %s: Data of size %d bytes displayed, data of size %d bytes not displayed"
-                WRMSG(HHC00980, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
-                                     iTraceLen, (iLength - iTraceLen) );
-            }
-            net_data_trace( pDEVBLK, szBuff, iTraceLen, '>', 'D', "eth frame", 0 );
-        }
+    LCS_PortReader( pLCSPORT, pLCSPORT->fd );
 
-        // Match was found. Enqueue frame on buffer.
+    PTT_DEBUG( "PORTHRD Closing...", pLCSPORT->fPortStarted, pDEVBLK->devnum, pLCSPORT->bPort );
 
-        if (pMatchingLCSDEV->bMode == LCSDEV_MODE_IP)
-        {
-            LCS_EnqueueEthFrame( pLCSPORT, pMatchingLCSDEV, szBuff, iLength );
-        }
-        else  //  (pMatchingLCSDEV->bMode == LCSDEV_MODE_SNA)
-        {
-            LCS_ProcessAccepted_SNA ( pLCSPORT, pMatchingLCSDEV, szBuff, iLength );
-        }
+    // Stop the threads reading the port's other queues...
 
-    } // end for (;;)
+    obtain_lock( &pLCSPORT->PortEventLock );
+    {
+        pLCSPORT->fStopQueues = 1;
+        broadcast_condition( &pLCSPORT->PortEvent );
+    }
+    release_lock( &pLCSPORT->PortEventLock );
 
-    PTT_DEBUG( "PORTHRD Closing...", pLCSPORT->fPortStarted, pDEVBLK->devnum, pLCSPORT->bPort );
+    for (i=1; i < pLCSPORT->iQueues; i++)
+    {
+        join_thread( pLCSPORT->Queue[i].tid, NULL );
+        detach_thread( pLCSPORT->Queue[i].tid );
+        VERIFY( TUNTAP_Close( pLCSPORT->Queue[i].fd ) == 0 );
+        pLCSPORT->Queue[i].fd = -1;
+    }
 
     // We must do the close since we were the one doing the i/o...
 
@@ -2687,6 +2642,8 @@ static void*  LCS_PortThread( void* arg)
     pLCSPORT->fPortStarted = 0;
     pLCSPORT->fRouteAdded  = 0;
     pLCSPORT->fd           = -1;
+    pLCSPORT->iQueues      = 0;
+    pLCSPORT->fStopQueues  = 0;
 
     PTT_DEBUG( "PORTHRD: EXIT     ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
 
@@ -2695,30 +2652,633 @@ static void*  LCS_PortThread( void* arg)
 }   // End of LCS_PortThread
 
 // ====================================================================
-//                       LCS_EnqueueEthFrame
+//                       LCS_QueueThread
 // ====================================================================
-//
-// Places the provided ethernet frame in the next available frame
-// slot in the adapter buffer. If buffer is full, keep trying.
-// The LCS device data lock must NOT be held when called!
-//
+// This is the thread that reads one of the other queues of a multi-
+// queue tap device. The port thread stops it when the port is closed.
 // --------------------------------------------------------------------
 
-static void LCS_EnqueueEthFrame( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pData, size_t iSize )
+static void*  LCS_QueueThread( void* arg)
 {
-    DEVBLK*   pDEVBLK;
-    BYTE      bPort;
-    time_t    t1, t2;
+    PLCSQUEUE   pLCSQUEUE = (PLCSQUEUE) arg;
 
+    LCS_PortReader( pLCSQUEUE->pLCSPORT, pLCSQUEUE->fd );
 
-    pDEVBLK = pLCSDEV->pDEVBLK[ LCSDEV_READ_SUBCHANN ];
-    bPort   = pLCSPORT->bPort;
-
-    PTT_DEBUG( "ENQ EthFrame ENTRY", 000, pDEVBLK->devnum, bPort );
-
-    time( &t1 );
+    return NULL;
 
-    PTT_TIMING( "b4 enqueue", 0, iSize, 0 );
+}   // End of LCS_QueueThread
+
+// ====================================================================
+//                       LCS_DispatchFrame
+// ====================================================================
+//
+// Enqueues the ethernet frame just read from the TAP device to the
+// LCS device it belongs to (IP mode) or processes it (SNA mode).
+// Frames that do not belong to any started device are discarded.
+//
+// Called by LCS_PortReader on the LCS_PortThread and on every
+// LCS_QueueThread, so several calls for one port may run at once.
+// The caller must hold no LCS locks: LCS_EnqueueEthFrame obtains the
+// device data lock, and SNA frames are processed under PortRxLock,
+// which is obtained here.
+//
+// --------------------------------------------------------------------
+
+static void LCS_DispatchFrame( PLCSPORT pLCSPORT, DEVBLK* pDEVBLK, BYTE* pFrame, int iLength, char* pbReported )
+{
+    PLCSDEV     pMatchingLCSDEV;
+
+    pMatchingLCSDEV = LCS_MatchFrame( pLCSPORT, pDEVBLK, pFrame, iLength, pbReported );
+
+    if (!pMatchingLCSDEV)
+        return;
+
+    // Match was found. Enqueue frame on buffer.
+
+    if (pMatchingLCSDEV->bMode == LCSDEV_MODE_IP)
+    {
+        LCS_EnqueueEthFrame( pLCSPORT, pMatchingLCSDEV, pFrame, iLength );
+    }
+    else  //  (pMatchingLCSDEV->bMode == LCSDEV_MODE_SNA)
+    {
+        // (the queue threads of a port take turns at the SNA state)
+        obtain_lock( &pLCSPORT->PortRxLock );
+        LCS_ProcessAccepted_SNA ( pLCSPORT, pMatchingLCSDEV, pFrame, iLength );
+        release_lock( &pLCSPORT->PortRxLock );
+    }
+
+}   // End of LCS_DispatchFrame
+
+// ====================================================================
+//                       LCS_MatchFrame
+// ====================================================================
+//
+// Determines which LCS device the ethernet frame just read from the
+// TAP device belongs to. Returns NULL if the frame does not belong
+// to any started device (or is not acceptable to the SNA device it
+// belongs to) and should be discarded. The frame is traced if debug
+// is active.
+//
+// Called by LCS_DispatchFrame (with no LCS locks held) and by
+// LCS_ReadDirect (with the device data lock held), on the
+// LCS_PortThread and on every LCS_QueueThread concurrently. It only
+// reads the port's device chain and MAC tables and obtains no locks.
+//
+// --------------------------------------------------------------------
+
+static PLCSDEV LCS_MatchFrame( PLCSPORT pLCSPORT, DEVBLK* pDEVBLK, BYTE* pFrame, int iLength, char* pbReported )
+{
+    PLCSDEV     pPrimaryLCSDEV;
+    PLCSDEV     pSecondaryLCSDEV;
+    PLCSDEV     pMatchingLCSDEV;
+    PETHFRM     pEthFrame;
+    PIP4FRM     pIPFrame   = NULL;
+    PARPFRM     pARPFrame  = NULL;
+    U32         lIPAddress;             // (network byte order)
+    BYTE*       pMAC;
+    char        cPktType[16];
+    U16         hwEthernetType;
+    BYTE        bHas8022;
+    BYTE        bHas8022Snap;
+    int         iTraceLen;
+    MAC         mac;
+
+    // Point to ethernet frame and determine frame type
+    pEthFrame = (PETHFRM)pFrame;
+
+    GetFrameInfo( pEthFrame, &cPktType[0], &hwEthernetType, &bHas8022, &bHas8022Snap );
+
+    if (pLCSPORT->pLCSBLK->fDebug)
+    {
+        // "%1d:%04X %s: port %2.2X: Receive frame of size %d bytes (with %s packet) from device %s"
+        WRMSG( HHC00984, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                              pLCSPORT->bPort, iLength, cPktType, pLCSPORT->szNetIfName );
+//!!            iTraceLen = iLength;
+//!!            if (iTraceLen > MAX_TRACE_LEN)
+//!!            {
+//!!                iTraceLen = MAX_TRACE_LEN;
+//!!                // HHC00980 "%1d:%04X %s: Data of size %d bytes displayed, data of size %d bytes not displayed"
+//!!                WRMSG(HHC00980, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+//!!                                     iTraceLen, (iLength - iTraceLen) );
+//!!            }
+//!!            net_data_trace( pDEVBLK, pFrame, iTraceLen, '>', 'D', "eth frame", 0 );
+        *pbReported = 0;
+    }
+
+    // Perform multicast assist if necessary: discard any multicast
+    // packets the guest didn't specifically register. We only need
+    // to do this if tuntap said that it was unable to do so for us.
+
+    if (1
+        && pLCSPORT->fDoMCastAssist                                     // do mcast filtering ourself?
+        && pLCSPORT->nMCastCount                                        // we have MACs in our table?
+        && memcmp( pEthFrame->bDestMAC, mcast3, sizeof( mcast3 )) == 0  // this is a multicast frame?
+        && IsMACTab( pLCSPORT->MCastTab, pEthFrame->bDestMAC ) < 0      // its MAC not in our table?
+    )
+    {
+        if (pLCSPORT->pLCSBLK->fDebug)
+            // "CTC: lcs device port %2.2X: MCAST not in table, discarding frame"
+            WRMSG( HHC00945, "D", pLCSPORT->bPort );
+        return NULL;
+    }
+
+    // Housekeeping
+    pPrimaryLCSDEV   = NULL;
+    pSecondaryLCSDEV = NULL;
+    pMatchingLCSDEV  = NULL;
+
+    // Attempt to find the device that this frame belongs to.
+    // hwEthernetType indicates which protocol is encapsulated in the payload.
+    // bHas8022 indicates whether the payload begins with an 802.2 LLC.
+    // bHas8022Snap indicates whether the payload begins with an 802.2 LLC and SNAP.
+    // If there is no exact match look for the primary and secondary
+    // default devices. Frames of any other type are discarded.
+    if (!pLCSPORT->pFirstDev)
+        ;   // (no devices on this port)
+    else if (hwEthernetType == ETH_TYPE_IP)
+    {
+        if (!bHas8022Snap)
+            pIPFrame   = (PIP4FRM)pEthFrame->bData;
+        else
+            pIPFrame   = (PIP4FRM)pEthFrame->bData+ETH_LLC_SNAP_SIZE;
+        lIPAddress = pIPFrame->lDstIP;  // (network byte order)
+
+        if (pLCSPORT->pLCSBLK->fDebug && !*pbReported)
+        {
+            union converter { struct { unsigned char a, b, c, d; } b; U32 i; } c;
+            char  str[40];
+
+            c.i = ntohl(lIPAddress);
+            MSGBUF( str, "%8.08X %d.%d.%d.%d", c.i, c.b.d, c.b.c, c.b.b, c.b.a );
+
+            // "CTC: lcs device port %2.2X: IPv4 frame received for %s"
+            WRMSG( HHC00946, "D", pLCSPORT->bPort, str );
+            *pbReported = 1;
+        }
+
+        pMatchingLCSDEV  = LCS_FindDevByIP( pLCSPORT, lIPAddress );
+        pPrimaryLCSDEV   = pLCSPORT->pPrimaryDev;
+        pSecondaryLCSDEV = pLCSPORT->pSecondaryDev;
+    }
+    else if (hwEthernetType == ETH_TYPE_ARP)
+    {
+        if (!bHas8022Snap)
+            pARPFrame  = (PARPFRM)pEthFrame->bData;
+        else
+            pARPFrame  = (PARPFRM)pEthFrame->bData+ETH_LLC_SNAP_SIZE;
+        lIPAddress = pARPFrame->lTargIPAddr; // (network byte order)
+
+        if (pLCSPORT->pLCSBLK->fDebug && !*pbReported)
+        {
+            union converter { struct { unsigned char a, b, c, d; } b; U32 i; } c;
+            char  str[40];
+
+            c.i = ntohl(lIPAddress);
+            MSGBUF( str, "%8.08X %d.%d.%d.%d", c.i, c.b.d, c.b.c, c.b.b, c.b.a );
+
+            // "CTC: lcs device port %2.2X: ARP frame received for %s"
+            WRMSG( HHC00947, "D", pLCSPORT->bPort, str );
+            *pbReported = 1;
+        }
+
+        pMatchingLCSDEV  = LCS_FindDevByIP( pLCSPORT, lIPAddress );
+        pPrimaryLCSDEV   = pLCSPORT->pPrimaryDev;
+        pSecondaryLCSDEV = pLCSPORT->pSecondaryDev;
+    }
+    else if (hwEthernetType == ETH_TYPE_RARP || hwEthernetType == ETH_TYPE_SNA)
+    {
+        if (hwEthernetType == ETH_TYPE_RARP)
+        {
+            if (!bHas8022Snap)
+                pARPFrame  = (PARPFRM)pEthFrame->bData;
+            else
+                pARPFrame  = (PARPFRM)pEthFrame->bData+ETH_LLC_SNAP_SIZE;
+            pMAC = pARPFrame->bTargEthAddr;
+
+            if (pLCSPORT->pLCSBLK->fDebug && !*pbReported)
+            {
+                // "CTC: lcs device port %2.2X: RARP frame received for %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X"
+                WRMSG( HHC00948, "D" ,pLCSPORT->bPort ,*(pMAC+0) ,*(pMAC+1) ,*(pMAC+2) ,*(pMAC+3) ,*(pMAC+4) ,*(pMAC+5) );
+                *pbReported = 1;
+            }
+        }
+        else
+        {
+            pMAC = pEthFrame->bDestMAC;
+
+            if (pLCSPORT->pLCSBLK->fDebug && !*pbReported)
+            {
+                // "CTC: lcs device port %2.2X: SNA frame received for %2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X"
+                WRMSG( HHC00949, "D" ,pLCSPORT->bPort ,*(pMAC+0) ,*(pMAC+1) ,*(pMAC+2) ,*(pMAC+3) ,*(pMAC+4) ,*(pMAC+5) );
+                *pbReported = 1;
+            }
+        }
+
+        // A frame for the port's MAC address belongs to the first
+        // device on the port.
+        memcpy( &mac, pLCSPORT->MAC_Address, IFHWADDRLEN );
+#if !defined( OPTION_TUNTAP_LCS_SAME_ADDR )
+        mac[5]++;
+#endif
+        if (memcmp( pMAC, &mac, IFHWADDRLEN ) == 0)
+            pMatchingLCSDEV  = pLCSPORT->pFirstDev;
+        pPrimaryLCSDEV   = pLCSPORT->pPrimaryDev;
+        pSecondaryLCSDEV = pLCSPORT->pSecondaryDev;
+    }
+
+    // If the matching device is not started
+    // nullify the pointer and pass frame to one
+    // of the defaults if present
+    if (pMatchingLCSDEV && !pMatchingLCSDEV->fDevStarted)
+        pMatchingLCSDEV = NULL;
+
+    // Match not found, check for default devices
+    // If one is defined and started, use it
+    if (!pMatchingLCSDEV)
+    {
+        if (pPrimaryLCSDEV && pPrimaryLCSDEV->fDevStarted)
+        {
+            pMatchingLCSDEV = pPrimaryLCSDEV;
+
+#ifndef LCS_NO_950_952 // (HHC00950 and HHC00952 are rarely interesting)
+            if (pLCSPORT->pLCSBLK->fDebug)
+                // "CTC: lcs device port %2.2X: no match found, selecting %s %4.4X"
+                WRMSG( HHC00950, "D", pLCSPORT->bPort, "primary", pMatchingLCSDEV->sAddr );
+#endif // LCS_NO_950_952
+        }
+        else if (pSecondaryLCSDEV && pSecondaryLCSDEV->fDevStarted)
+        {
+            pMatchingLCSDEV = pSecondaryLCSDEV;
+
+#ifndef LCS_NO_950_952 // (HHC00950 and HHC00952 are rarely interesting)
+            if (pLCSPORT->pLCSBLK->fDebug)
+                // "CTC: lcs device port %2.2X: no match found, selecting %s %4.4X"
+                WRMSG( HHC00950, "D", pLCSPORT->bPort, "secondary", pMatchingLCSDEV->sAddr );
+#endif // LCS_NO_950_952
+        }
+    }
+
+    // Discard frame if no matching device was found.
+    if (!pMatchingLCSDEV)
+    {
+        if (pLCSPORT->pLCSBLK->fDebug)
+            // "CTC: lcs device port %2.2X: no match found, discarding frame"
+            WRMSG( HHC00951, "D", pLCSPORT->bPort );
+
+        return NULL;
+    }
+
+    //
+    if (pMatchingLCSDEV->bMode == LCSDEV_MODE_SNA)
+    {
+        // Discard frame if the SNA device isn't accepting frames, or
+        // the frames payload does not begin with an 802.2 LLC, or
+        // the frames payload begins with an 802.2 LLC and SNAP.
+        if (!pMatchingLCSDEV->fAcceptPackets || !bHas8022 || bHas8022Snap )
+        {
+            if (pLCSPORT->pLCSBLK->fDebug)
+                // "CTC: lcs device port %2.2X: no match found, discarding frame"
+                WRMSG( HHC00951, "D", pLCSPORT->bPort );
+            return NULL;
+        }
+    }
+
+#ifndef LCS_NO_950_952 // (HHC00950 and HHC00952 are rarely interesting)
+    if (pLCSPORT->pLCSBLK->fDebug)
+    {
+        union converter { struct { unsigned char a, b, c, d; } b; U32 i; } c;
+        char  str[40];
+
+        c.i = ntohl(pMatchingLCSDEV->lIPAddress);
+        MSGBUF( str, "%8.08X %d.%d.%d.%d", c.i, c.b.d, c.b.c, c.b.b, c.b.a );
+
+        // "CTC: lcs device port %2.2X: enqueing frame to device %4.4X %s"
+        WRMSG( HHC00952, "D", pLCSPORT->bPort, pMatchingLCSDEV->sAddr, str );
+    }
+#endif // LCS_NO_950_952
+
+    if (pLCSPORT->pLCSBLK->fDebug)
+    {
+        iTraceLen = iLength;
+        if (iTraceLen > MAX_TRACE_LEN)
+        {
+            iTraceLen = MAX_TRACE_LEN;
+            // HHC00980 "%1d:%04X %s: Data of size %d bytes displayed, data of size %d bytes not displayed"
+            WRMSG(HHC00980, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                                 iTraceLen, (iLength - iTraceLen) );
+        }
+        net_data_trace( pDEVBLK, pFrame, iTraceLen, '>', 'D', "eth frame", 0 );
+    }
+
+    return pMatchingLCSDEV;
+
+}   // End of LCS_MatchFrame
+
+// ====================================================================
+//                       hash_ip_address
+// ====================================================================
+// Folds all four bytes of an IP address into a dispatch hash bucket.
+// --------------------------------------------------------------------
+
+static INLINE int hash_ip_address( U32 lIPAddress )
+{
+    lIPAddress ^= lIPAddress >> 16;
+    lIPAddress ^= lIPAddress >> 8;
+    return (int)(lIPAddress & (LCS_IPHASH_SIZE - 1));
+}
+
+// ====================================================================
+//                       LCS_BuildDispatch
+// ====================================================================
+//
+// Builds the port's inbound frame dispatch table from the device
+// chain: the devices on the port hashed by IP address, in chain order
+// so that the first device with a given address is the one found, and
+// the first device and the (last defined) primary and secondary
+// default devices on the port. Called by LCS_Init before the port
+// thread is started.
+//
+// --------------------------------------------------------------------
+
+static void LCS_BuildDispatch( PLCSBLK pLCSBLK, PLCSPORT pLCSPORT )
+{
+    PLCSDEV     pLCSDev;
+    PLCSDEV*    ppLCSDev;
+    int         i;
+
+    for (i = 0; i < LCS_IPHASH_SIZE; i++)
+        pLCSPORT->pDevByIP[i] = NULL;
+
+    pLCSPORT->pFirstDev     = NULL;
+    pLCSPORT->pPrimaryDev   = NULL;
+    pLCSPORT->pSecondaryDev = NULL;
+
+    for (pLCSDev = pLCSBLK->pDevices; pLCSDev; pLCSDev = pLCSDev->pNext)
+    {
+        if (pLCSDev->bPort != pLCSPORT->bPort)
+            continue;
+
+        if (!pLCSPORT->pFirstDev)
+            pLCSPORT->pFirstDev = pLCSDev;
+
+        if (pLCSDev->bType == LCSDEV_TYPE_PRIMARY)
+            pLCSPORT->pPrimaryDev = pLCSDev;
+        else if (pLCSDev->bType == LCSDEV_TYPE_SECONDARY)
+            pLCSPORT->pSecondaryDev = pLCSDev;
+
+        // (add to the end of its hash chain)
+        ppLCSDev = &pLCSPORT->pDevByIP[ hash_ip_address( pLCSDev->lIPAddress ) ];
+        while (*ppLCSDev)
+            ppLCSDev = &(*ppLCSDev)->pNextByIP;
+
+        pLCSDev->pNextByIP = NULL;
+        *ppLCSDev = pLCSDev;
+    }
+}
+
+// ====================================================================
+//                       LCS_UnhashDev
+// ====================================================================
+//
+// Removes a device that is being closed from the port's inbound frame
+// dispatch table. The device must already have been removed from the
+// device chain. Only single pointers are updated, so the port thread
+// of any devices remaining on the port can keep on using the table.
+//
+// --------------------------------------------------------------------
+
+static void LCS_UnhashDev( PLCSBLK pLCSBLK, PLCSPORT pLCSPORT, PLCSDEV pLCSDEV )
+{
+    PLCSDEV     pLCSDev;
+    PLCSDEV*    ppLCSDev;
+
+    for (ppLCSDev = &pLCSPORT->pDevByIP[ hash_ip_address( pLCSDEV->lIPAddress ) ];
+         *ppLCSDev; ppLCSDev = &(*ppLCSDev)->pNextByIP)
+    {
+        if (*ppLCSDev == pLCSDEV)
+        {
+            *ppLCSDev = pLCSDEV->pNextByIP;
+            break;
+        }
+    }
+
+    if (0
+        || pLCSPORT->pFirstDev     == pLCSDEV
+        || pLCSPORT->pPrimaryDev   == pLCSDEV
+        || pLCSPORT->pSecondaryDev == pLCSDEV
+    )
+    {
+        PLCSDEV  pFirstDev     = NULL;
+        PLCSDEV  pPrimaryDev   = NULL;
+        PLCSDEV  pSecondaryDev = NULL;
+
+        for (pLCSDev = pLCSBLK->pDevices; pLCSDev; pLCSDev = pLCSDev->pNext)
+        {
+            if (pLCSDev->bPort != pLCSPORT->bPort)
+                continue;
+
+            if (!pFirstDev)
+                pFirstDev = pLCSDev;
+
+            if (pLCSDev->bType == LCSDEV_TYPE_PRIMARY)
+                pPrimaryDev = pLCSDev;
+            else if (pLCSDev->bType == LCSDEV_TYPE_SECONDARY)
+                pSecondaryDev = pLCSDev;
+        }
+
+        pLCSPORT->pFirstDev     = pFirstDev;
+        pLCSPORT->pPrimaryDev   = pPrimaryDev;
+        pLCSPORT->pSecondaryDev = pSecondaryDev;
+    }
+}
+
+// ====================================================================
+//                       LCS_FindDevByIP
+// ====================================================================
+//
+// Returns the first device on the port with the specified IP address
+// (network byte order), or NULL if there is none.
+//
+// --------------------------------------------------------------------
+
+static PLCSDEV LCS_FindDevByIP( PLCSPORT pLCSPORT, U32 lIPAddress )
+{
+    PLCSDEV     pLCSDev;
+
+    for (pLCSDev = pLCSPORT->pDevByIP[ hash_ip_address( lIPAddress ) ];
+         pLCSDev; pLCSDev = pLCSDev->pNextByIP)
+    {
+        if (pLCSDev->lIPAddress == lIPAddress)
+            break;
+    }
+
+    return pLCSDev;
+}
+
+#if !defined( OPTION_W32_CTCI )
+
+// ====================================================================
+//                       LCS_ZeroCopyDevice
+// ====================================================================
+//
+// Returns the device that frames on this port can be read directly
+// into, or NULL. That is only possible when the port's one and only
+// device is a started IP mode device with zero-copy frame buffers,
+// since otherwise we can't know which buffer to read a frame into
+// until we've looked at it.
+//
+// --------------------------------------------------------------------
+
+static PLCSDEV LCS_ZeroCopyDevice( PLCSPORT pLCSPORT )
+{
+    PLCSDEV     pLCSDev;
+    PLCSDEV     pZeroCopyLCSDEV = NULL;
+
+    for (pLCSDev = pLCSPORT->pLCSBLK->pDevices; pLCSDev; pLCSDev = pLCSDev->pNext)
+    {
+        if (pLCSDev->bPort != pLCSPORT->bPort)
+            continue;
+
+        if (pZeroCopyLCSDEV
+            || pLCSDev->bMode != LCSDEV_MODE_IP
+            || !pLCSDev->fDevStarted
+            || !pLCSDev->pFrameBuffers[0])
+            return NULL;
+
+        pZeroCopyLCSDEV = pLCSDev;
+    }
+
+    return pZeroCopyLCSDEV;
+}
+
+// ====================================================================
+//                       LCS_ReadDirect
+// ====================================================================
+//
+// Reads up to iMaxFrames frames from TAP device queue fd directly into
+// the next available frame slots of the device's frame buffer, building
+// each LCS Ethernet Passthru frame header around the frame in place.
+// Frames that do not belong to the device are discarded by simply not
+// advancing the frame offset over them.
+//
+// Returns the number of frames read (including discarded frames), or
+// -1 with errno = ENOBUFS if the frame buffer is full before any frame
+// could be read, or -1 with the TUNTAP_Read errno if the read failed.
+// The TAP device is non-blocking, so the read stops as soon as there
+// are no more frames waiting.
+//
+// Called by LCS_PortReader on the LCS_PortThread and on every
+// LCS_QueueThread. The caller must not hold the device data lock: it
+// is obtained here for the whole read, which also keeps two queue
+// threads from filling the device's frame buffer at the same time.
+//
+// --------------------------------------------------------------------
+
+static int LCS_ReadDirect( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, DEVBLK* pDEVBLK, int fd, int iMaxFrames, char* pbReported )
+{
+    PLCSETHFRM  pLCSEthFrame;
+    int         iFrames;
+    int         iLength;
+    int         iError = 0;
+
+    PTT_DEBUG(       "GET  DevDataLock  ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
+    obtain_lock( &pLCSDEV->DevDataLock );
+    PTT_DEBUG(       "GOT  DevDataLock  ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
+    {
+        for (iFrames = 0; iFrames < iMaxFrames; iFrames++)
+        {
+            // Ensure even the largest frame can't overflow the buffer
+            if (( pLCSDEV->iFrameOffset +                   // Current buffer Offset
+                  sizeof(LCSETHFRM) +                       // Size of Frame Header
+                  LCS_RXBUF_SIZE +                          // Size of largest frame
+                  sizeof(pLCSEthFrame->bLCSHdr.hwOffset) )  // Size of Frame terminator
+                > pLCSDEV->iMaxFrameBufferSize)             // Size of Frame buffer
+            {
+                PTT_DEBUG( "*ReadDirect ENOBUFS", 000, pDEVBLK->devnum, pLCSPORT->bPort );
+                iError = ENOBUFS;
+                break;
+            }
+
+            // Point to next available LCS Frame slot in our buffer
+            pLCSEthFrame = (PLCSETHFRM)( pLCSDEV->pFrameBuffer +
+                                         pLCSDEV->iFrameOffset );
+
+            // Read the Ethernet packet straight into the frame slot
+            iLength = TUNTAP_Read( fd, pLCSEthFrame->bData, LCS_RXBUF_SIZE );
+
+            if (iLength <= 0)
+            {
+                if (iLength < 0 && EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+                    iError = errno;
+                break;
+            }
+
+            // Discard it if it isn't for this device (or too big)
+            if (LCS_MatchFrame( pLCSPORT, pDEVBLK, pLCSEthFrame->bData, iLength, pbReported ) != pLCSDEV)
+                continue;
+
+            if (iLength > (int)MAX_LCS_ETH_FRAME_SIZE( pLCSDEV ))
+            {
+                // "CTC: lcs device port %2.2X: packet frame too big, dropped"
+                WRMSG( HHC00953, "W", pLCSPORT->bPort );
+                continue;
+            }
+
+            // Increment offset to NEXT available slot (after ours)
+            pLCSDEV->iFrameOffset += (U16)(sizeof(LCSETHFRM) + iLength);
+
+            // Plug updated offset to next frame into our frame header
+            STORE_HW( pLCSEthFrame->bLCSHdr.hwOffset, pLCSDEV->iFrameOffset );
+
+            // Finish building the LCS Ethernet Passthru frame header
+            pLCSEthFrame->bLCSHdr.bType = LCS_FRMTYP_ENET;
+            pLCSEthFrame->bLCSHdr.bSlot = pLCSPORT->bPort;
+
+            // Tell "LCS_Read" function that data is available for reading
+            PTT_DEBUG( "SET  DataPending  ", 1, pDEVBLK->devnum, pLCSPORT->bPort );
+            pLCSDEV->fDataPending   = 1;
+            pLCSDEV->fSignalPending = 1;
+        }
+    }
+    PTT_DEBUG(        "REL  DevDataLock  ", 000, pDEVBLK->devnum, pLCSPORT->bPort );
+    release_lock( &pLCSDEV->DevDataLock );
+
+    if (!iFrames && iError)
+    {
+        errno = iError;
+        return -1;
+    }
+
+    return iFrames;
+}
+
+#endif // !defined( OPTION_W32_CTCI )
+
+// ====================================================================
+//                       LCS_EnqueueEthFrame
+// ====================================================================
+//
+// Places the provided ethernet frame in the next available frame
+// slot in the adapter buffer. If buffer is full, keep trying.
+// The LCS device data lock must NOT be held when called!
+//
+// --------------------------------------------------------------------
+
+static void LCS_EnqueueEthFrame( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pData, size_t iSize )
+{
+    DEVBLK*   pDEVBLK;
+    BYTE      bPort;
+    time_t    t1, t2;
+
+
+    pDEVBLK = pLCSDEV->pDEVBLK[ LCSDEV_READ_SUBCHANN ];
+    bPort   = pLCSPORT->bPort;
+
+    PTT_DEBUG( "ENQ EthFrame ENTRY", 000, pDEVBLK->devnum, bPort );
+
+    time( &t1 );
+
+    PTT_TIMING( "b4 enqueue", 0, iSize, 0 );
 
     // While port open, not close in progress, and frame buffer full...
 
@@ -2761,6 +3321,7 @@ static void LCS_EnqueueEthFrame( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pData
         // Wait for LCS_Read to empty the buffer...
 
         ASSERT( ENOBUFS == errno );
+        LCS_SignalReadEvent( pLCSDEV );
         usleep( CTC_DELAY_USECS );
     }
     PTT_TIMING( "af enqueue", 0, iSize, 0 );
@@ -2824,7 +3385,7 @@ static int  LCS_DoEnqueueEthFrame( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pDa
         }
 
         // Point to next available LCS Frame slot in our buffer
-        pLCSEthFrame = (PLCSETHFRM)( pLCSDEV->bFrameBuffer +
+        pLCSEthFrame = (PLCSETHFRM)( pLCSDEV->pFrameBuffer +
                                      pLCSDEV->iFrameOffset );
 
         // Increment offset to NEXT available slot (after ours)
@@ -2839,26 +3400,62 @@ static int  LCS_DoEnqueueEthFrame( PLCSPORT pLCSPORT, PLCSDEV pLCSDEV, BYTE* pDa
 
         // Copy Ethernet packet to LCS Ethernet Passthru frame
         memcpy( pLCSEthFrame->bData, pData, iSize );
+        pLCSDEV->uBytesCopied += iSize;
 
         // Tell "LCS_Read" function that data is available for reading
         PTT_DEBUG( "SET  DataPending  ", 1, pDEVBLK->devnum, bPort );
         pLCSDEV->fDataPending = 1;
+
+        // (the port thread wakes up "LCS_Read" once the entire batch
+        //  of frames it read from the TAP device has been enqueued)
+        pLCSDEV->fSignalPending = 1;
     }
     PTT_DEBUG(        "REL  DevDataLock  ", 000, pDEVBLK->devnum, bPort );
     release_lock( &pLCSDEV->DevDataLock );
 
+    return 0;       // (success)
+}
+
+// ====================================================================
+//                       LCS_SignalReadEvent
+// ====================================================================
+//
+// Wakes up the "LCS_Read" function of the specified device if any
+// frames were enqueued to it since it was last woken up.
+// The LCS device data lock must NOT be held when called!
+//
+// --------------------------------------------------------------------
+
+static void LCS_SignalReadEvent( PLCSDEV pLCSDEV )
+{
+    DEVBLK*     pDEVBLK;
+    BYTE        bSignal;
+
+    pDEVBLK = pLCSDEV->pDEVBLK[ LCSDEV_READ_SUBCHANN ];
+
+    PTT_DEBUG(       "GET  DevDataLock  ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
+    obtain_lock( &pLCSDEV->DevDataLock );
+    PTT_DEBUG(       "GOT  DevDataLock  ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
+    {
+        bSignal = pLCSDEV->fSignalPending;
+        pLCSDEV->fSignalPending = 0;
+    }
+    PTT_DEBUG(        "REL  DevDataLock  ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
+    release_lock( &pLCSDEV->DevDataLock );
+
+    if (!bSignal)
+        return;
+
     // (wake up "LCS_Read" function)
-    PTT_DEBUG(       "GET  DevEventLock ", 000, pDEVBLK->devnum, bPort );
+    PTT_DEBUG(       "GET  DevEventLock ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
     obtain_lock( &pLCSDEV->DevEventLock );
-    PTT_DEBUG(       "GOT  DevEventLock ", 000, pDEVBLK->devnum, bPort );
+    PTT_DEBUG(       "GOT  DevEventLock ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
     {
-        PTT_DEBUG(            "SIG  DevEvent     ", 000, pDEVBLK->devnum, bPort );
+        PTT_DEBUG(            "SIG  DevEvent     ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
         signal_condition( &pLCSDEV->DevEvent );
     }
-    PTT_DEBUG(        "REL  DevEventLock ", 000, pDEVBLK->devnum, bPort );
+    PTT_DEBUG(        "REL  DevEventLock ", 000, pDEVBLK->devnum, pLCSDEV->bPort );
     release_lock( &pLCSDEV->DevEventLock );
-
-    return 0;       // (success)
 }
 
 // ====================================================================
@@ -2896,6 +3493,7 @@ void  LCS_Read( DEVBLK* pDEVBLK,   U32   sCount,
 {
     PLCSHDR     pLCSHdr;
     PLCSDEV     pLCSDEV = (PLCSDEV)pDEVBLK->dev_data;
+    BYTE*       pFrameBuffer;
     size_t      iLength = 0;
     int         iTraceLen;
 
@@ -2933,12 +3531,19 @@ void  LCS_Read( DEVBLK* pDEVBLK,   U32   sCount,
         obtain_lock( &pLCSDEV->DevEventLock );
         PTT_DEBUG(       "GOT  DevEventLock ", 000, pDEVBLK->devnum, -1 );
         {
-            PTT_DEBUG( "WAIT DevEventLock ", 000, pDEVBLK->devnum, -1 );
-            pLCSDEV->fReadWaiting = 1;
-            timed_wait_condition( &pLCSDEV->DevEvent,
-                                  &pLCSDEV->DevEventLock,
-                                  &waittime );
-            pLCSDEV->fReadWaiting = 0;
+            // Data may have arrived since we looked. The port thread
+            // signals the event while holding the event lock, so if
+            // it isn't pending now we can't miss the signal for it.
+
+            if (!pLCSDEV->fDataPending && !pLCSDEV->fReplyPending)
+            {
+                PTT_DEBUG( "WAIT DevEventLock ", 000, pDEVBLK->devnum, -1 );
+                pLCSDEV->fReadWaiting = 1;
+                timed_wait_condition( &pLCSDEV->DevEvent,
+                                      &pLCSDEV->DevEventLock,
+                                      &waittime );
+                pLCSDEV->fReadWaiting = 0;
+            }
         }
 
         PTT_DEBUG(        "WOKE DevEventLock ", 000, pDEVBLK->devnum, -1 );
@@ -2971,7 +3576,7 @@ void  LCS_Read( DEVBLK* pDEVBLK,   U32   sCount,
     // Point to the end of all buffered LCS Frames...
     // (where the next Frame *would* go if there was one)
 
-    pLCSHdr = (PLCSHDR)( pLCSDEV->bFrameBuffer +
+    pLCSHdr = (PLCSHDR)( pLCSDEV->pFrameBuffer +
                          pLCSDEV->iFrameOffset );
 
     // Mark the end of this batch of LCS Frames by setting
@@ -3019,23 +3624,8 @@ void  LCS_Read( DEVBLK* pDEVBLK,   U32   sCount,
 
     *pUnitStat = CSW_CE | CSW_DE;
 
-    memcpy( pIOBuf, pLCSDEV->bFrameBuffer, iLength );
-
-    // Display up to Max_TRACE_LEN bytes of the data going to the guest, if debug is active
-    if (pLCSDEV->pLCSBLK->fDebug)
-    {
-        // "%1d:%04X %s: Present data of size %d bytes to guest"
-        WRMSG(HHC00982, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname, (int)iLength );
-        iTraceLen = iLength;
-        if (iTraceLen > MAX_TRACE_LEN)
-        {
-            iTraceLen = MAX_TRACE_LEN;
-            // HHC00980 "%1d:%04X %s: Data of size %d bytes displayed, data of size %d bytes not displayed"
-            WRMSG(HHC00980, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
-                                 iTraceLen, (int)(iLength - iTraceLen) );
-        }
-        net_data_trace( pDEVBLK, pIOBuf, iTraceLen, '<', 'D', "data", 0 );
-    }
+    pLCSDEV->uBytesIn     += iLength;
+    pLCSDEV->uBytesCopied += iLength;
 
     // Reset frame buffer to empty...
 
@@ -3050,12 +3640,49 @@ void  LCS_Read( DEVBLK* pDEVBLK,   U32   sCount,
     // data-chaining or not, but if they do we should fix this).
 
     PTT_DEBUG( "READ empty buffer ", 000, pDEVBLK->devnum, -1 );
+    pFrameBuffer = pLCSDEV->pFrameBuffer;
     pLCSDEV->iFrameOffset  = 0;
     pLCSDEV->fReplyPending = 0;
     pLCSDEV->fDataPending  = 0;
 
-    PTT_DEBUG(        "REL  DevDataLock  ", 000, pDEVBLK->devnum, -1 );
-    release_lock( &pLCSDEV->DevDataLock );
+    // With double buffers, switch the port thread to the other
+    // buffer so that it can keep on filling it while we copy
+    // this one to the channel without holding the data lock.
+
+    if (pLCSDEV->pFrameBuffers[0])
+    {
+        if (pFrameBuffer == pLCSDEV->pFrameBuffers[0])
+            pLCSDEV->pFrameBuffer = pLCSDEV->pFrameBuffers[1];
+        else
+            pLCSDEV->pFrameBuffer = pLCSDEV->pFrameBuffers[0];
+
+        PTT_DEBUG(    "REL  DevDataLock  ", 000, pDEVBLK->devnum, -1 );
+        release_lock( &pLCSDEV->DevDataLock );
+    }
+
+    memcpy( pIOBuf, pFrameBuffer, iLength );
+
+    // Display up to Max_TRACE_LEN bytes of the data going to the guest, if debug is active
+    if (pLCSDEV->pLCSBLK->fDebug)
+    {
+        // "%1d:%04X %s: Present data of size %d bytes to guest"
+        WRMSG(HHC00982, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname, (int)iLength );
+        iTraceLen = iLength;
+        if (iTraceLen > MAX_TRACE_LEN)
+        {
+            iTraceLen = MAX_TRACE_LEN;
+            // HHC00980 "%1d:%04X %s: Data of size %d bytes displayed, data of size %d bytes not displayed"
+            WRMSG(HHC00980, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                                 iTraceLen, (int)(iLength - iTraceLen) );
+        }
+        net_data_trace( pDEVBLK, pIOBuf, iTraceLen, '<', 'D', "data", 0 );
+    }
+
+    if (!pLCSDEV->pFrameBuffers[0])
+    {
+        PTT_DEBUG(    "REL  DevDataLock  ", 000, pDEVBLK->devnum, -1 );
+        release_lock( &pLCSDEV->DevDataLock );
+    }
 
     PTT_DEBUG( "READ: EXIT        ", 000, pDEVBLK->devnum, -1 );
 }
@@ -3267,6 +3894,10 @@ int  ParseArgs( DEVBLK* pDEVBLK, PLCSBLK pLCSBLK,
     pLCSBLK->pszTUNDevice   = strdup( DEF_NETDEV );
     pLCSBLK->pszOATFilename = NULL;
     pLCSBLK->pszIPAddress   = NULL;
+    pLCSBLK->iRxBatch       = LCS_DEF_RXBATCH;
+    pLCSBLK->iQueues        = LCS_DEF_QUEUES;
+    pLCSBLK->iAttnCount     = LCS_DEF_ATTNCOUNT;
+    pLCSBLK->iAttnWait      = LCS_DEF_ATTNWAIT;
 #if defined( OPTION_W32_CTCI )
     pLCSBLK->iKernBuff = DEF_CAPTURE_BUFFSIZE;
     pLCSBLK->iIOBuff   = DEF_PACKET_BUFFSIZE;
@@ -3283,9 +3914,9 @@ int  ParseArgs( DEVBLK* pDEVBLK, PLCSBLK pLCSBLK,
         int     c;
 
 #if defined( OPTION_W32_CTCI )
-  #define  LCS_OPTSTRING    "e:n:m:o:dk:i:w"
+  #define  LCS_OPTSTRING    "e:n:m:o:db:a:t:k:i:w"
 #else
-  #define  LCS_OPTSTRING    "e:n:x:m:o:d"
+  #define  LCS_OPTSTRING    "e:n:x:m:o:db:a:t:zq:"
 #endif
 #if defined( HAVE_GETOPT_LONG )
         int     iOpt;
@@ -3300,6 +3931,13 @@ int  ParseArgs( DEVBLK* pDEVBLK, PLCSBLK pLCSBLK,
             { "mac",    required_argument, NULL, 'm' },
             { "oat",    required_argument, NULL, 'o' },
             { "debug",  no_argument,       NULL, 'd' },
+            { "rxbatch",required_argument, NULL, 'b' },
+            { "attncount",required_argument, NULL, 'a' },
+            { "attnwait", required_argument, NULL, 't' },
+#if !defined( OPTION_W32_CTCI )
+            { "zerocopy", no_argument,     NULL, 'z' },
+            { "queues", required_argument, NULL, 'q' },
+#endif
 #if defined( OPTION_W32_CTCI )
             { "kbuff",  required_argument, NULL, 'k' },
             { "ibuff",  required_argument, NULL, 'i' },
@@ -3398,6 +4036,75 @@ int  ParseArgs( DEVBLK* pDEVBLK, PLCSBLK pLCSBLK,
             pLCSBLK->fDebug = TRUE;
             break;
 
+        case 'b':     // Maximum frames read per port thread wakeup
+
+            i = atoi( optarg );
+
+            if (i < 1 || i > LCS_MAX_RXBATCH)
+            {
+                // "%1d:%04X CTC: option %s value %s invalid"
+                WRMSG( HHC00916, "E", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                       "receive batch size", optarg );
+                return -1;
+            }
+
+            pLCSBLK->iRxBatch = i;
+            break;
+
+        case 'a':     // Inbound SNA frames coalesced into one Attention
+
+            i = atoi( optarg );
+
+            if (i < 1 || i > LCS_MAX_ATTNCOUNT)
+            {
+                // "%1d:%04X CTC: option %s value %s invalid"
+                WRMSG( HHC00916, "E", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                       "attention frame count", optarg );
+                return -1;
+            }
+
+            pLCSBLK->iAttnCount = i;
+            break;
+
+        case 't':     // Microseconds an SNA Attention may be held
+
+            i = atoi( optarg );
+
+            if (i < 0 || i > LCS_MAX_ATTNWAIT)
+            {
+                // "%1d:%04X CTC: option %s value %s invalid"
+                WRMSG( HHC00916, "E", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                       "attention wait", optarg );
+                return -1;
+            }
+
+            pLCSBLK->iAttnWait = i;
+            break;
+
+#if !defined( OPTION_W32_CTCI )
+
+        case 'z':     // Read frames directly into the frame buffer
+
+            pLCSBLK->fZeroCopy = TRUE;
+            break;
+
+        case 'q':     // Number of TAP queues (and reader threads) per port
+
+            i = atoi( optarg );
+
+            if (i < 1 || i > LCS_MAX_QUEUES)
+            {
+                // "%1d:%04X CTC: option %s value %s invalid"
+                WRMSG( HHC00916, "E", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname,
+                       "TAP queues", optarg );
+                return -1;
+            }
+
+            pLCSBLK->iQueues = i;
+            break;
+
+#endif
+
 #if defined( OPTION_W32_CTCI )
 
         case 'k':     // Kernel Buffer Size (Windows only)
@@ -3965,6 +4672,14 @@ static char*  ReadOAT( char* pszOATName, FILE* fp, char* pszBuff )
 // This is the thread that generates Attention interrupts to the guest.
 // Only used when there are one or more SNA devices.
 //
+// An Attention cannot be raised while the device is busy. Rather than
+// sleeping and retrying, such an Attention is deferred and retried as
+// soon as LCS_EndChannelProgram reports the device's channel program
+// has ended, or failing that after a short delay (LCS_ATTN_RETRY_MIN
+// microseconds, doubling on each retry up to LCS_ATTN_RETRY_MAX).
+// An Attention whose coalescing window is still open (see
+// LCS_QueueAttn) is held on the same chain until it is due.
+//
 // --------------------------------------------------------------------
 
 static void*  LCS_AttnThread( void* arg)
@@ -3973,14 +4688,17 @@ static void*  LCS_AttnThread( void* arg)
     PLCSBLK     pLCSBLK;
     PLCSATTN    pLCSATTN;
     PLCSATTN    pLCSATTNprev, pLCSATTNcurr, pLCSATTNnext;
+    PLCSATTN    pDeferred;             /* Attentions found busy      */
+    PLCSATTN*   ppDeferred;            /* -> end of deferred chain   */
     PLCSDEV     pLCSDEV;
     DEVBLK*     pDEVBLK;
     /* --------------------------------------------------------------------- */
-    int         interval;              /* interval between attempts  FixMe! Configurable? */
-    int         dev_attn_rc;           /* device_attention RC    */
-//  int         attn_can;              /* = 1 : Atttention Cancelled */
-    int         busy_waits;            /* Number of times waited for */
-                                       /* a Busy condition to end    */
+    int         interval;              /* Delay before busy retry    */
+    int         wait;                  /* Delay before next pass     */
+    int         dev_attn_rc;           /* device_attention RC        */
+    BYTE        busy;                  /* An Attention found busy    */
+    U64         now;                   /* Current time in usecs      */
+    U64         held;                  /* Earliest held Attention due */
     /* --------------------------------------------------------------------- */
 
 
@@ -3996,38 +4714,49 @@ static void*  LCS_AttnThread( void* arg)
     pLCSBLK = (PLCSBLK) arg;
     pLCSBLK->AttnPid = getpid();
 
+    interval = LCS_ATTN_RETRY_MIN;
+    wait = interval;
+
     for ( ; ; )
     {
 
-        /* */
+        /* Wait for a new attention, for a channel program to end, */
+        /* or for the next deferred or held attention to be due.   */
         PTT_DEBUG( "GET  AttnEventLock", 000, 000, 000 );
         obtain_lock( &pLCSBLK->AttnEventLock );
         PTT_DEBUG( "GOT  AttnEventLock", 000, 000, 000 );
         {
-            for( ; ; )
+            if (1
+                && !pLCSBLK->fCloseInProgress
+                && !pLCSBLK->pAttns
+                && !pLCSBLK->fAttnRetry
+            )
             {
-                if ( pLCSBLK->fCloseInProgress )
+                PTT_DEBUG( "WAIT AttnEventLock", 000, 000, 000 );
+                if ( pLCSBLK->pDeferredAttns )
                 {
-                    PTT_DEBUG( "ATTNTHRD Closing...", 000, 000, 000 );
-                    break;
+                    timed_wait_condition_relative_usecs
+                    (
+                        &pLCSBLK->AttnEvent,         // ptr to condition to wait on
+                        &pLCSBLK->AttnEventLock,     // ptr to controlling lock (must be held!)
+                        wait,                        // max #of microseconds to wait
+                        NULL                         // [OPTIONAL] ptr to tod value (may be NULL)
+                    );
                 }
-
-                if ( pLCSBLK->pAttns )
+                else
                 {
-                    PTT_DEBUG( "ATTNTHRD Attn...", 000, 000, 000 );
-                    break;
+                    wait_condition( &pLCSBLK->AttnEvent, &pLCSBLK->AttnEventLock );
                 }
-
-                PTT_DEBUG( "WAIT AttnEventLock", 000, 000, 000 );
-                timed_wait_condition_relative_usecs
-                (
-                    &pLCSBLK->AttnEvent,         // ptr to condition to wait on
-                    &pLCSBLK->AttnEventLock,     // ptr to controlling lock (must be held!)
-                    3*1000*1000,                 // max #of microseconds to wait, i.e. 3 seconds
-                    NULL                         // [OPTIONAL] ptr to tod value (may be NULL)
-                );
                 PTT_DEBUG( "WOKE AttnEventLock", 000, 000, 000 );
             }
+
+            /* A channel program ended, retry without delay */
+            if ( pLCSBLK->fAttnRetry )
+            {
+                PTT_DEBUG( "ATTNTHRD Retry...", 000, 000, 000 );
+                pLCSBLK->fAttnRetry = FALSE;
+                interval = LCS_ATTN_RETRY_MIN;
+            }
         }
         PTT_DEBUG( "REL  AttnEventLock", 000, 000, 000 );
         release_lock( &pLCSBLK->AttnEventLock );
@@ -4039,14 +4768,16 @@ static void*  LCS_AttnThread( void* arg)
             break;
         }
 
-        /* Remove the chain of LCSATTN blocks */
+        /* Remove the chains of new and deferred LCSATTN blocks */
         PTT_DEBUG( "GET  AttnLock", 000, 000, 000 );
         obtain_lock( &pLCSBLK->AttnLock );
         PTT_DEBUG( "GOT  AttnLock", 000, 000, 000 );
         {
             pLCSATTN = pLCSBLK->pAttns;
             pLCSBLK->pAttns = NULL;
-            if ( pLCSATTN )
+            pDeferred = pLCSBLK->pDeferredAttns;
+            pLCSBLK->pDeferredAttns = NULL;
+            if ( pLCSATTN || pDeferred )
             {
                 PTT_DEBUG( "REM  Attn (All)", pLCSATTN, 000, 000 );
             }
@@ -4058,7 +4789,7 @@ static void*  LCS_AttnThread( void* arg)
         PTT_DEBUG( "REL  AttnLock", 000, 000, 000 );
         release_lock( &pLCSBLK->AttnLock );
 
-        /* Reverse the chain of LCSATTN blocks */
+        /* Reverse the chain of new LCSATTN blocks */
         if ( pLCSATTN )
         {
             pLCSATTNprev = NULL;
@@ -4073,11 +4804,24 @@ static void*  LCS_AttnThread( void* arg)
             pLCSATTN = pLCSATTNprev;
         }
 
+        /* Process the deferred LCSATTN blocks before the new ones */
+        if ( pDeferred )
+        {
+            for (ppDeferred = &pDeferred; *ppDeferred; ppDeferred = &(*ppDeferred)->pNext);
+            *ppDeferred = pLCSATTN;
+            pLCSATTN = pDeferred;
+            pDeferred = NULL;
+        }
+        ppDeferred = &pDeferred;
+        busy = FALSE;
+        held = 0;
+
         /* Process the chain of LCSATTN blocks */
         while ( pLCSATTN )
         {
             /* Point to the next LCSATTN block in the chain, assuming there is one */
             pLCSATTNnext = pLCSATTN->pNext;
+            pLCSATTN->pNext = NULL;
 
             /* Point to the LCSDEV and the read DEVBLK for the command */
             pLCSDEV = pLCSATTN->pDevice;
@@ -4086,87 +4830,255 @@ static void*  LCS_AttnThread( void* arg)
 //          if (pLCSBLK->fDebug)                                                                            /* FixMe! Remove! */
 //              net_data_trace( pDEVBLK, (BYTE*)pLCSATTN, sizeof( LCSATTN ), ' ', 'D', "LCSATTN out", 0 );  /* FixMe! Remove! */
 
+            /* An attention already deferred for the device covers this one too */
+            for (pLCSATTNcurr = pDeferred; pLCSATTNcurr; pLCSATTNcurr = pLCSATTNcurr->pNext)
+            {
+                if (pLCSATTNcurr->pDevice == pLCSDEV)
+                    break;
+            }
+
+            now = host_tod() >> 4;
+
             /* Only raise an Attention if there is at least one buffer waiting to be read. */
-            if (pLCSDEV->pFirstLCSIBH)
+            if (!pLCSATTNcurr && pDEVBLK && (pLCSDEV->pFirstLCSIBH || pLCSDEV->pQueuedLCSIBH))
             {
 
+                /* Hold the Attention while its coalescing window is open */
+                if ( pLCSDEV->uAttnDue > now )
+                {
+                    PTT_DEBUG( "HOLD Attn", pLCSATTN, pDEVBLK->devnum, 000 );
+                    if ( !held || pLCSDEV->uAttnDue < held )
+                        held = pLCSDEV->uAttnDue;
+                    *ppDeferred = pLCSATTN;
+                    ppDeferred = &pLCSATTN->pNext;
+                    pLCSATTN = pLCSATTNnext;
+                    continue;
+                }
+
                 PTT_DEBUG( "PRC  Attn", pLCSATTN, pDEVBLK->devnum, 000 );
 
-                /* --------------------------------------------------------------------- */
+                // Raise Attention
+                dev_attn_rc = device_attention( pDEVBLK, CSW_ATTN );
+                PTT_DEBUG( "Raise Attn   ", 000, pDEVBLK->devnum, dev_attn_rc );
 
-//              interval = 25;
-                interval = 100;
-                dev_attn_rc = 0;       /* device_attention RC    */
-//              attn_can = 0;          /* = 1 : Atttention Cancelled */
-                busy_waits = 0;        /* Number of times waited for */
-                                       /* a Busy condition to end    */
+                if (pLCSBLK->fDebug)
+                {
+                    char    tmp[256];
+                    snprintf( (char*)tmp, 256, "device_attention rc=%d  %d", dev_attn_rc, interval );
+                    WRMSG(HHC03991, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname, tmp );
+                }
 
-                for( ; ; )
+                // ATTN RC=1 means a device busy status did
+                // appear so that the signal did not work.
+                // Keep the LCSATTN block and retry when the
+                // channel program ends or after a delay.
+                if ( dev_attn_rc == 1 )
                 {
+                    if ( !pLCSATTN->uBusySince )
+                        pLCSATTN->uBusySince = now;
 
-                    // Wait a small (but increasing) amount of time.
-                    usleep(interval);
-
-//??                // is there still something in our frame buffer?
-//??                if (!pLCSDEV->fDataPending && !pLCSDEV->fReplyPending)
-//??                {
-//??                    break;
-//??                }
-
-                    // Raise Attention
-                    dev_attn_rc = device_attention( pDEVBLK, CSW_ATTN );
-                    PTT_DEBUG( "Raise Attn   ", 000, pDEVBLK->devnum, dev_attn_rc );
-
-    {                                                                                                        /* FixMe! Remove? */
-        char    tmp[256];                                                                                    /* FixMe! Remove? */
-        snprintf( (char*)tmp, 256, "device_attention rc=%d  %d  %d", dev_attn_rc, busy_waits, interval );    /* FixMe! Remove? */
-        WRMSG(HHC03991, "D", SSID_TO_LCSS(pDEVBLK->ssid), pDEVBLK->devnum, pDEVBLK->typname, tmp );          /* FixMe! Remove? */
-    }                                                                                                        /* FixMe! Remove? */
-
-                    // ATTN RC=1 means a device busy status did
-                    // appear so that the signal did not work.
-                    // We will retry after some (increasingly)
-                    // small amount of time.
-                    if ( dev_attn_rc != 1 )
+                    if ( now - pLCSATTN->uBusySince < LCS_ATTN_GIVEUP )
                     {
-                        break;
+                        pLCSDEV->uAttnBusy++;
+                        pLCSDEV->fAttnDeferred = TRUE;
+                        busy = TRUE;
+                        *ppDeferred = pLCSATTN;
+                        ppDeferred = &pLCSATTN->pNext;
+                        pLCSATTN = pLCSATTNnext;
+                        continue;
                     }
 
-                    busy_waits++;
+                    pLCSDEV->uAttnLost++;
+                }
+                else if ( dev_attn_rc == 0 )
+                {
+                    pLCSDEV->uAttnRaised++;
+                }
+
+                /* The guest will read everything queued after a raised */
+                /* Attention. Otherwise the next frame needs a new one.  */
+                if ( dev_attn_rc != 0 )
+                {
+                    obtain_lock( &pLCSBLK->AttnLock );
+                    pLCSDEV->fAttnQueued = FALSE;
+                    release_lock( &pLCSBLK->AttnLock );
+                }
 
-                    if ( busy_waits >= 20 )
-                    {
-                        break;
-                    }
+                pLCSDEV->fAttnDeferred = FALSE;
+            }
+            else if (!pLCSATTNcurr)
+            {
+                pLCSDEV->fAttnDeferred = FALSE;
+            }
+
+            /* Free the LCSATTN block that has just been processed */
+            free (pLCSATTN);
 
-//                  interval = interval * 2;
-                    interval += 100;
+            /* Point to the next LCSATTN block in the chain, assuming there is one */
+            pLCSATTN = pLCSATTNnext;
+        }  // end while (pLCSATTN)
 
-                }   // end for ( ; ; )
+        /* Keep the deferred LCSATTN blocks for the next retry */
+        if ( pDeferred )
+        {
+            PTT_DEBUG( "GET  AttnLock", 000, 000, 000 );
+            obtain_lock( &pLCSBLK->AttnLock );
+            PTT_DEBUG( "GOT  AttnLock", 000, 000, 000 );
+            {
+                PTT_DEBUG( "DEF  Attn", pDeferred, 000, 000 );
+                pLCSBLK->pDeferredAttns = pDeferred;
+            }
+            PTT_DEBUG( "REL  AttnLock", 000, 000, 000 );
+            release_lock( &pLCSBLK->AttnLock );
 
-                /* --------------------------------------------------------------------- */
+            if ( busy )
+            {
+                wait = interval;
+                interval = MIN( interval * 2, LCS_ATTN_RETRY_MAX );
+            }
+            else
+            {
+                wait = LCS_ATTN_GIVEUP;
+                interval = LCS_ATTN_RETRY_MIN;
+            }
 
+            if ( held )
+            {
+                now = host_tod() >> 4;
+                wait = (int) MIN( (U64) wait, held > now ? held - now : 1 );
             }
+        }
+        else
+        {
+            interval = LCS_ATTN_RETRY_MIN;
+        }
 
-            /* Free the LCSATTN block that has just been processed */
-            free (pLCSATTN);
+    }  // end for ( ; ; )
+
+    /* Free any LCSATTN blocks that have not been processed */
+    remove_and_free_any_attns_for_device( pLCSBLK, NULL );
+
+    PTT_DEBUG( "ATTNTHRD: EXIT", 000, 000, 000 );
+
+//  {                                                                          /* FixMe! Remove! */
+//      char    tmp[256];                                                      /* FixMe! Remove! */
+//      snprintf( (char*)tmp, 256, "LCS_AttnThread terminated" );              /* FixMe! Remove! */
+//      WRMSG(HHC03984, "D", tmp );                                            /* FixMe! Remove! */
+//  }                                                                          /* FixMe! Remove! */
+
+    return NULL;
+}   // End of LCS_AttnThread
+
+
+// ====================================================================
+//                       LCS_QueueAttn
+// ====================================================================
+//
+// Queue an Attention for an SNA device and tell the LCS_AttnThread.
+// iFrames is the number of inbound frames just queued for the guest,
+// or zero if the Attention is for something that cannot wait.
+//
+// One Attention covers everything queued for the device until the
+// guest next reads it, so nothing is queued if the device already
+// has an Attention outstanding. When attention coalescing is set up
+// the Attention for inbound frames is held until iAttnCount frames
+// are waiting or the oldest has waited iAttnWait microseconds.
+//
+// --------------------------------------------------------------------
+
+static void  LCS_QueueAttn( PLCSDEV pLCSDEV, int iFrames )
+{
+    PLCSBLK     pLCSBLK = pLCSDEV->pLCSBLK;
+    DEVBLK*     pDEVBLK = pLCSDEV->pDEVBLK[ LCSDEV_READ_SUBCHANN ];
+    PLCSATTN    pLCSATTN;
+    U64         now;
+    U64         uDue;
+
+
+    now = host_tod() >> 4;
+
+    /* Work out when the Attention should be raised */
+    PTT_DEBUG( "GET  AttnLock", 000, pDEVBLK->devnum, 000 );
+    obtain_lock( &pLCSBLK->AttnLock );
+    PTT_DEBUG( "GOT  AttnLock", 000, pDEVBLK->devnum, 000 );
+    {
+        pLCSDEV->iAttnFrames += iFrames;
+
+        if (0
+            || !iFrames
+            || !pLCSBLK->iAttnWait
+            || pLCSDEV->iAttnFrames >= pLCSBLK->iAttnCount
+        )
+            uDue = 0;
+        else if (pLCSDEV->fAttnQueued)
+            uDue = pLCSDEV->uAttnDue;
+        else
+            uDue = now + pLCSBLK->iAttnWait;
+
+        if (pLCSDEV->fAttnQueued)
+        {
+            /* The outstanding Attention covers this one too */
+            if (iFrames)
+                pLCSDEV->uAttnCoalesced++;
+
+            /* Raise a held Attention now if the window is full */
+            if (pLCSDEV->uAttnDue && !uDue)
+            {
+                pLCSDEV->uAttnDue = 0;
+                pLCSATTN = NULL;
+            }
+            else
+            {
+                PTT_DEBUG( "REL  AttnLock", 000, pDEVBLK->devnum, 000 );
+                release_lock( &pLCSBLK->AttnLock );
+                return;
+            }
+        }
+        else
+        {
+            /* Create an LCSATTN block */
+            pLCSATTN = malloc( sizeof( LCSATTN ) );
+            if (!pLCSATTN)  /* FixMe! Produce a message? */
+            {
+                release_lock( &pLCSBLK->AttnLock );
+                return;
+            }
+            pLCSATTN->pNext = NULL;
+            pLCSATTN->pDevice = pLCSDEV;
+            pLCSATTN->uBusySince = 0;
 
-            /* Point to the next LCSATTN block in the chain, assuming there is one */
-            pLCSATTN = pLCSATTNnext;
-        }  // end while (pLCSATTN)
+//          if (pLCSBLK->fDebug)                                                                         /* FixMe! Remove! */
+//            net_data_trace( pDEVBLK, (BYTE*)pLCSATTN, sizeof( LCSATTN ), ' ', 'D', "LCSATTN in", 0 );  /* FixMe! Remove! */
 
-    }  // end for ( ; ; )
+            /* Note when an Attention was first wanted for the queued data */
+            if (!pLCSDEV->uAttnTime)
+                pLCSDEV->uAttnTime = now;
 
-    PTT_DEBUG( "ATTNTHRD: EXIT", 000, 000, 000 );
+            pLCSDEV->fAttnQueued = TRUE;
+            pLCSDEV->uAttnDue = uDue;
 
-//  {                                                                          /* FixMe! Remove! */
-//      char    tmp[256];                                                      /* FixMe! Remove! */
-//      snprintf( (char*)tmp, 256, "LCS_AttnThread terminated" );              /* FixMe! Remove! */
-//      WRMSG(HHC03984, "D", tmp );                                            /* FixMe! Remove! */
-//  }                                                                          /* FixMe! Remove! */
+            /* Add LCSATTN block to start of chain */
+            PTT_DEBUG( "ADD  Attn", pLCSATTN, pDEVBLK->devnum, 000 );
+            pLCSATTN->pNext = pLCSBLK->pAttns;
+            pLCSBLK->pAttns = pLCSATTN;
+        }
+    }
+    PTT_DEBUG( "REL  AttnLock", 000, pDEVBLK->devnum, 000 );
+    release_lock( &pLCSBLK->AttnLock );
 
-    return NULL;
-}   // End of LCS_AttnThread
+    /* Signal the LCS_AttnThread to process the LCSATTN block(s) on the chain */
+    PTT_DEBUG( "GET  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
+    obtain_lock( &pLCSBLK->AttnEventLock );
+    PTT_DEBUG( "GOT  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
+    {
+        PTT_DEBUG( "SIG  AttnEvent", 000, pDEVBLK->devnum, 000 );
+        if (!pLCSATTN)
+            pLCSBLK->fAttnRetry = TRUE;
+        signal_condition( &pLCSBLK->AttnEvent );
+    }
+    PTT_DEBUG( "REL  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
+    release_lock( &pLCSBLK->AttnEventLock );
+}
 
 
 // ====================================================================
@@ -4707,8 +5619,13 @@ void Process_0D10 (PLCSDEV pLCSDEV, PLCSHDR pLCSHDR, PLCSBAF1 pLCSBAF1, PLCSBAF2
         pLCSDEV->iTuntapErrno = errno;
         pLCSDEV->fTuntapError = TRUE;
         PTT_TIMING( "*WRITE ERR", 0, iEthLen, 1 );
+        return;
     }
 
+    LCSCONN_COUNT( pLCSCONN, uIFramesOut, 1 );
+    if ( iTHetcLen > 0 )
+        LCSCONN_COUNT( pLCSCONN, uBytesOut, iTHetcLen );
+
     return;
 }
 
@@ -4980,6 +5897,7 @@ static const BYTE Inbound_CC0A[INBOUND_CC0A_SIZE] =
             STORE_FW( pLCSCONN->bOutToken, uToken );                                        // Outbound token
             uToken += INCREMENT_TOKEN;
             release_lock( &TokenLock );
+            rehash_connection_tokens( pLCSDEV, pLCSCONN );
 
             WRMSG( HHC03984, "I", "Updated LCSCONN Inbound");
             if (pLCSDEV->pLCSBLK->fDebug)                                                             /* FixMe! Remove! */
@@ -5986,7 +6904,6 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
     int         illcsize;
     DEVBLK*     pDEVBLK;
     PLCSBLK     pLCSBLK;
-    PLCSATTN    pLCSATTN;
     PETHFRM     pEthFrame;
     BYTE*       pLLCandData;
     int         iLLCandDatasize;
@@ -6049,17 +6966,25 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
             break;
         }
 
-        pLCSCONN->fIframe = TRUE;
+        // Check that the remote NS value has incremented by one. A
+        // repeat of the last NS is the partner retransmitting a frame
+        // whose acknowledgement it did not see.
+        if (pLCSCONN->fIframe && llc.hwNS != ((pLCSCONN->hwRemoteNS + 1) & 0x7F))
+        {
+            if (llc.hwNS == pLCSCONN->hwRemoteNS)
+                LCSCONN_COUNT( pLCSCONN, uRetransmits, 1 );
+            else
+                LCSCONN_COUNT( pLCSCONN, uOutOfSeq, 1 );
+        }
 
-        // Check that the remote NS value has incremented by one.
-        /* FixMe! Add some code here! */
+        pLCSCONN->fIframe = TRUE;
 
         // Save the remote NS and NR values.
         pLCSCONN->hwRemoteNS = llc.hwNS;
         pLCSCONN->hwRemoteNR = llc.hwNR;
 
         // Obtain a buffer in which to construct the data to be passed to VTAM.
-        pLCSIBH = alloc_lcs_buffer( pLCSDEV, 2032 );
+        pLCSIBH = alloc_lcs_pool_buffer( pLCSDEV, 2032 );
 
         memcpy( &pLCSIBH->bData, Inbound_4D10, Inbound_4D10_Size );
         pLCSIBH->iDataLen = Inbound_4D10_Size;
@@ -6106,6 +7031,16 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
             STORE_HW( pLCSHDR->hwOffset, hwOffset );
         }
 
+        LCSCONN_COUNT( pLCSCONN, uIFramesIn, 1 );
+        if ( iDatasize > 0 )
+            LCSCONN_COUNT( pLCSCONN, uBytesIn, iDatasize );
+
+        // Note when the frame was queued, so that LCS_Read_SNA can
+        // tell how long it waited for VTAM to read it.
+        LCSCONN_COUNT( pLCSCONN, uQueueDepth, 1 );
+        LCSCONN_MAX( pLCSCONN, uQueueDepthMax, pLCSCONN->uQueueDepth );
+        pLCSIBH->uQueued = host_tod() >> 4;
+
         // Add the buffer containing the inbond TH etc to the chain.
         add_lcs_buffer_to_chain( pLCSDEV, pLCSIBH );
 
@@ -6137,6 +7072,8 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
                 break;
             }
 
+            LCSCONN_COUNT( pLCSCONN, uRRIn, 1 );
+
             // ??
             if (!llc.hwPF)
             {
@@ -6185,8 +7122,11 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
 //??            pLCSDEV->iTuntapErrno = errno;
 //??            pLCSDEV->fTuntapError = TRUE;
                 PTT_TIMING( "*WRITE ERR", 0, iEthLenOut, 1 );
+                break;
             }
 
+            LCSCONN_COUNT( pLCSCONN, uRROut, 1 );
+
             break;
 
         // Supervisory Frame: Receiver Not Ready.
@@ -6198,6 +7138,9 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
           WRMSG(HHC03984, "D", tmp );                                              /* FixMe! Remove! */
         }                                                                          /* FixMe! Remove! */
 
+            if ((pLCSCONN = find_connection_by_remote_mac( pLCSDEV, &pEthFrame->bSrcMAC )))
+                LCSCONN_COUNT( pLCSCONN, uRNRIn, 1 );
+
             break;
 
         // Supervisory Frame: Reject
@@ -6209,6 +7152,9 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
           WRMSG(HHC03984, "D", tmp );                                              /* FixMe! Remove! */
         }                                                                          /* FixMe! Remove! */
 
+            if ((pLCSCONN = find_connection_by_remote_mac( pLCSDEV, &pEthFrame->bSrcMAC )))
+                LCSCONN_COUNT( pLCSCONN, uREJIn, 1 );
+
             break;
 
         // Supervisory Frame: Unknown.
@@ -6255,7 +7201,7 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
             }
 
             // Obtain a buffer in which to construct the data to be passed to VTAM.
-            pLCSIBH = alloc_lcs_buffer( pLCSDEV, ( INBOUND_4C0B_SIZE * 2 ) );
+            pLCSIBH = alloc_lcs_pool_buffer( pLCSDEV, ( INBOUND_4C0B_SIZE * 2 ) );
 
             memcpy( &pLCSIBH->bData, Inbound_4C0B, INBOUND_4C0B_SIZE );
             pLCSIBH->iDataLen = INBOUND_4C0B_SIZE;
@@ -6295,7 +7241,7 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
             }
 
             // Obtain a buffer in which to construct the data to be passed to VTAM.
-            pLCSIBH = alloc_lcs_buffer( pLCSDEV, ( INBOUND_CD00_SIZE * 2 ) );
+            pLCSIBH = alloc_lcs_pool_buffer( pLCSDEV, ( INBOUND_CD00_SIZE * 2 ) );
 
             memcpy( &pLCSIBH->bData, Inbound_CD00, INBOUND_CD00_SIZE );
             pLCSIBH->iDataLen = INBOUND_CD00_SIZE;
@@ -6340,7 +7286,7 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
             }
 
             // Obtain a buffer in which to construct the data to be passed to VTAM.
-            pLCSIBH = alloc_lcs_buffer( pLCSDEV, ( INBOUND_4D00_SIZE * 2 ) );
+            pLCSIBH = alloc_lcs_pool_buffer( pLCSDEV, ( INBOUND_4D00_SIZE * 2 ) );
 
             memcpy( &pLCSIBH->bData, Inbound_4D00, INBOUND_4D00_SIZE );
             pLCSIBH->iDataLen = INBOUND_4D00_SIZE;
@@ -6478,7 +7424,7 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
 
             // Obtain a buffer in which to construct the data to be passed to VTAM.
             // Note: The largest XID3 and CV's seen has been less than 160-bytes.
-            pLCSIBH = alloc_lcs_buffer( pLCSDEV, 496 );
+            pLCSIBH = alloc_lcs_pool_buffer( pLCSDEV, 496 );
 
             memcpy( &pLCSIBH->bData, Inbound_4C22, INBOUND_4C22_SIZE );
             pLCSIBH->iDataLen = INBOUND_4C22_SIZE;
@@ -6573,7 +7519,7 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
                 }
 
                 // Obtain a buffer in which to construct the data to be passed to VTAM.
-                pLCSIBH = alloc_lcs_buffer( pLCSDEV, ( INBOUND_4C25_SIZE * 2 ) );
+                pLCSIBH = alloc_lcs_pool_buffer( pLCSDEV, ( INBOUND_4C25_SIZE * 2 ) );
 
                 memcpy( &pLCSIBH->bData, Inbound_4C25, INBOUND_4C25_SIZE );
                 pLCSIBH->iDataLen = INBOUND_4C25_SIZE;
@@ -6666,35 +7612,7 @@ static const BYTE Inbound_CD00[INBOUND_CD00_SIZE] =
         // device_attention at this point, but the channel program
         // is still considered to be busy, and a return code of one
         // would be returned to us.
-
-        /* Create an LCSATTN block */
-        pLCSATTN = malloc( sizeof( LCSATTN ) );
-        if (!pLCSATTN) return;  /* FixMe! Produce a message? */
-        pLCSATTN->pNext = NULL;
-        pLCSATTN->pDevice = pLCSDEV;
-
-        /* Add LCSATTN block to start of chain */
-        PTT_DEBUG( "GET  AttnLock", 000, pDEVBLK->devnum, 000 );
-        obtain_lock( &pLCSBLK->AttnLock );
-        PTT_DEBUG( "GOT  AttnLock", 000, pDEVBLK->devnum, 000 );
-        {
-            PTT_DEBUG( "ADD  Attn", pLCSATTN, pDEVBLK->devnum, 000 );
-            pLCSATTN->pNext = pLCSBLK->pAttns;
-            pLCSBLK->pAttns = pLCSATTN;
-        }
-        PTT_DEBUG( "REL  AttnLock", 000, pDEVBLK->devnum, 000 );
-        release_lock( &pLCSBLK->AttnLock );
-
-        /* Signal the LCS_AttnThread to process the LCSATTN block(s) on the chain */
-        PTT_DEBUG( "GET  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
-        obtain_lock( &pLCSBLK->AttnEventLock );
-        PTT_DEBUG( "GOT  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
-        {
-            PTT_DEBUG( "SIG  AttnEvent", 000, pDEVBLK->devnum, 000 );
-            signal_condition( &pLCSBLK->AttnEvent );
-        }
-        PTT_DEBUG( "REL  AttnEventLock ", 000, pDEVBLK->devnum, 000 );
-        release_lock( &pLCSBLK->AttnEventLock );
+        LCS_QueueAttn( pLCSDEV, 1 );
     }
 
     return;
@@ -6740,6 +7658,12 @@ void  LCS_Read_SNA( DEVBLK* pDEVBLK,   U32   sCount,
     U16         hwDataSize;
     BYTE        WantLCSICTL;
     BYTE        WantLCSIBH;
+    BYTE        fReadLCSIBH = FALSE;
+    U64         uLatency;
+    U64         uWaited;
+    PLCSBAF1    pLCSBAF1;
+    PLCSCONN    pLCSCONN;
+    int         i;
 
 
     PTT_DEBUG( "RSNA: ENTRY       ", 000, pDEVBLK->devnum, -1 );
@@ -6801,23 +7725,44 @@ void  LCS_Read_SNA( DEVBLK* pDEVBLK,   U32   sCount,
     //
     if ( WantLCSIBH )
     {
-        while (pLCSDEV->pFirstLCSIBH)
+        // Hold the chain lock so that a flush on another thread can't
+        // free the LCSIBH between looking at it and removing it.
+        obtain_lock( &pLCSDEV->LCSIBHChainLock );
+
+        while ((pLCSIBH = first_lcs_buffer_on_chain( pLCSDEV )))
         {
             //
-            if ( pLCSDEV->pFirstLCSIBH->iDataLen & 0x01 )
+            if ( pLCSIBH->iDataLen & 0x01 )
                 iFiller = 1;
             else
                 iFiller = 0;
 
-            // Ensure the contents of the buffer will fit into the frame buffer
+            // Ensure the contents of the buffer will fit into the frame
+            // buffer, and into the Read CCW so that it is not discarded
             if ((pLCSDEV->iFrameOffset +            // Current buffer Offset
-                 pLCSDEV->pFirstLCSIBH->iDataLen +  // Size of inbound data
+                 pLCSIBH->iDataLen +                // Size of inbound data
                  iFiller +                          // Size of filler
                  sizeof(pFrameSlot->hwOffset))      // Size of Frame terminator
-              <= pLCSDEV->iMaxFrameBufferSize)      // Size of Frame buffer
+              <= MIN( pLCSDEV->iMaxFrameBufferSize, sCount )) // Size of Frame buffer or CCW
             {
                 pLCSIBH = remove_lcs_buffer_from_chain( pLCSDEV );
 
+                // Account for the time an inbound I-frame waited to be
+                // read. Its connection is found by the inbound token.
+                if ( pLCSIBH->uQueued )
+                {
+                    pLCSBAF1 = (PLCSBAF1)( pLCSIBH->bData + sizeof(LCSHDR) );
+                    pLCSCONN = find_connection_by_inbound_token( pLCSDEV, pLCSBAF1->bTokenA );
+                    if ( pLCSCONN )
+                    {
+                        uWaited = (host_tod() >> 4) - pLCSIBH->uQueued;
+                        LCSCONN_COUNT( pLCSCONN, uQueueDepth, -1 );
+                        LCSCONN_COUNT( pLCSCONN, uQueueReads, 1 );
+                        LCSCONN_COUNT( pLCSCONN, uQueueTime, uWaited );
+                        LCSCONN_MAX( pLCSCONN, uQueueTimeMax, uWaited );
+                    }
+                }
+
                 // Point to next available LCS Frame slot in our buffer...
                 // Copy the inbound frame into the frame buffer slot...
                 // Increment buffer offset to NEXT next-available-slot...
@@ -6851,8 +7796,16 @@ void  LCS_Read_SNA( DEVBLK* pDEVBLK,   U32   sCount,
                 pLCSIBH = NULL;
 
                 pLCSDEV->fDataPending = 1;
+                fReadLCSIBH = TRUE;
+            }
+            else
+            {
+                // The rest will be presented on the next Read.
+                break;
             }
         }
+
+        release_lock( &pLCSDEV->LCSIBHChainLock );
     }
 
     // Point to the end of all buffered LCS Frames (where
@@ -6933,6 +7886,33 @@ void  LCS_Read_SNA( DEVBLK* pDEVBLK,   U32   sCount,
 
     memcpy( pIOBuf, pLCSDEV->bFrameBuffer, iLength );
 
+    // The guest has read what the outstanding Attention was for, so
+    // the next inbound frame needs a new one. Count the time from the
+    // Attention being wanted to the guest reading the data in the
+    // attention latency histogram.
+    if ( fReadLCSIBH )
+    {
+        obtain_lock( &pLCSDEV->pLCSBLK->AttnLock );
+        {
+            pLCSDEV->fAttnQueued = FALSE;
+            pLCSDEV->iAttnFrames = 0;
+            pLCSDEV->uAttnDue = 0;
+
+            if ( pLCSDEV->uAttnTime )
+            {
+                uLatency = (host_tod() >> 4) - pLCSDEV->uAttnTime;
+                for (i = 0; i < LCS_ATTN_HIST_SIZE - 1; i++)
+                {
+                    if (uLatency < ((U64)LCS_ATTN_HIST_BASE << i))
+                        break;
+                }
+                pLCSDEV->uAttnLatency[i]++;
+                pLCSDEV->uAttnTime = 0;
+            }
+        }
+        release_lock( &pLCSDEV->pLCSBLK->AttnLock );
+    }
+
     // Display up to MAX_TRACE_LEN bytes of the data going to the guest, if debug is active
     if (pLCSDEV->pLCSBLK->fDebug)
     {
@@ -7270,50 +8250,181 @@ PLCSIBH  alloc_lcs_buffer( PLCSDEV pLCSDEV, int iSize )
     return pLCSIBH;
 }
 
+/* ------------------------------------------------------------------ */
+/* lcs_buffer_cas(): Compare and swap the head of an LCSIBH list.     */
+/* ------------------------------------------------------------------ */
+// The queue of LCSIBHs waiting to be read and the pool's list of
+// returned LCSIBHs are lock-free lists. Any thread may push an LCSIBH
+// onto the head of the list, but a consumer always takes the entire
+// list at once (by swapping in NULL), so the ABA problem that comes
+// with popping single entries cannot arise. Only the free pool and
+// the queue are lock-free: the chain the queue is moved onto is still
+// serialized by LCSIBHChainLock.
+static BYTE  lcs_buffer_cas( PLCSDEV pLCSDEV, PLCSIBH volatile* ppHead,
+                             PLCSIBH pOld, PLCSIBH pNew )
+{
+#if defined( _MSVC_ )
+    UNREFERENCED( pLCSDEV );
+    return (InterlockedCompareExchangePointer( (PVOID volatile*) ppHead, pNew, pOld ) == pOld);
+#elif defined( HAVE_SYNC_BUILTINS )
+    UNREFERENCED( pLCSDEV );
+    return __sync_bool_compare_and_swap( ppHead, pOld, pNew );
+#else
+    BYTE       bSwapped = FALSE;
+
+    obtain_lock( &pLCSDEV->LCSIBHQueueLock );
+    if (*ppHead == pOld)
+    {
+        *ppHead = pNew;
+        bSwapped = TRUE;
+    }
+    release_lock( &pLCSDEV->LCSIBHQueueLock );
+
+    return bSwapped;
+#endif
+}
+
+/* ------------------------------------------------------------------ */
+/* push_lcs_buffer(): Push LCSIBH onto the head of a lock-free list.  */
+/* ------------------------------------------------------------------ */
+static void  push_lcs_buffer( PLCSDEV pLCSDEV, PLCSIBH volatile* ppHead,
+                              PLCSIBH pLCSIBH )
+{
+    PLCSIBH    pOld;                                   // Current head
+
+    do
+    {
+        pOld = *ppHead;
+        pLCSIBH->pNextLCSIBH = pOld;
+    }
+    while (!lcs_buffer_cas( pLCSDEV, ppHead, pOld, pLCSIBH ));
+}
+
+/* ------------------------------------------------------------------ */
+/* take_lcs_buffers(): Take all LCSIBHs from a lock-free list.        */
+/* ------------------------------------------------------------------ */
+static PLCSIBH  take_lcs_buffers( PLCSDEV pLCSDEV, PLCSIBH volatile* ppHead )
+{
+    PLCSIBH    pOld;                                   // Current head
+
+    do
+        pOld = *ppHead;
+    while (pOld && !lcs_buffer_cas( pLCSDEV, ppHead, pOld, NULL ));
+
+    return pOld;                                       // (newest first)
+}
+
+/* ------------------------------------------------------------------ */
+/* alloc_lcs_pool_buffer(): Obtain a pooled LCSIBH (Port thread only) */
+/* ------------------------------------------------------------------ */
+// Only the port thread takes buffers from the free list, so it needs
+// no serialization. Buffers freed by the read subchannel are pushed
+// onto the returned list and taken back here in one go when the free
+// list runs dry. Pooled buffers are already cleared (see below).
+PLCSIBH  alloc_lcs_pool_buffer( PLCSDEV pLCSDEV, int iSize )
+{
+    PLCSIBH    pLCSIBH;                // LCSIBH
+
+
+    // Too large for the pool? Allocate it the hard way.
+    if (iSize > LCSIBH_POOL_AREA)
+        return alloc_lcs_buffer( pLCSDEV, iSize );
+
+    // Refill the free list with any buffers that have been returned.
+    if (!pLCSDEV->pPoolLCSIBH)
+        pLCSDEV->pPoolLCSIBH = take_lcs_buffers( pLCSDEV, &pLCSDEV->pReturnedLCSIBH );
+
+    // Take the first free buffer, if there is one...
+    pLCSIBH = pLCSDEV->pPoolLCSIBH;
+    if (pLCSIBH)
+    {
+        pLCSDEV->pPoolLCSIBH = pLCSIBH->pNextLCSIBH;
+        pLCSIBH->pNextLCSIBH = NULL;
+        return pLCSIBH;
+    }
+
+    // ...otherwise grow the pool, unless it is already at its maximum
+    // size, in which case the buffer is allocated the hard way.
+    if (pLCSDEV->iPoolLCSIBH >= LCSIBH_POOL_MAX)
+        return alloc_lcs_buffer( pLCSDEV, iSize );
+
+    pLCSIBH = alloc_lcs_buffer( pLCSDEV, LCSIBH_POOL_AREA );
+    if (pLCSIBH)
+    {
+        pLCSIBH->fPooled = TRUE;
+        pLCSDEV->iPoolLCSIBH++;
+    }
+
+    return pLCSIBH;
+}
+
 /* ------------------------------------------------------------------ */
 /* add_lcs_buffer_to_chain(): Add LCSIBH to end of chain.             */
 /* ------------------------------------------------------------------ */
+// The LCSIBH is queued on the lock-free list; it is moved onto the
+// end of the chain proper by first_lcs_buffer_on_chain().
 void  add_lcs_buffer_to_chain( PLCSDEV pLCSDEV, PLCSIBH pLCSIBH )
 {
 
     // Prepare LCSIBH for adding to chain.
     if (!pLCSIBH)                                      // Any LCSIBH been passed?
         return;
-    pLCSIBH->pNextLCSIBH = NULL;                       // Clear the pointer to next LCSIBH
 
-    // Obtain the buffer chain lock.
-    obtain_lock( &pLCSDEV->LCSIBHChainLock );
+    // Queue the LCSIBH.
+    push_lcs_buffer( pLCSDEV, &pLCSDEV->pQueuedLCSIBH, pLCSIBH );
 
-    // Add LCSIBH to end of chain.
-    if (pLCSDEV->pFirstLCSIBH)                         // if there are already LCSIBHs
-    {
-        pLCSDEV->pLastLCSIBH->pNextLCSIBH = pLCSIBH;   // Add the LCSIBH to
-        pLCSDEV->pLastLCSIBH = pLCSIBH;                // the end of the chain
-    }
-    else
+    return;
+}
+
+/* ------------------------------------------------------------------ */
+/* first_lcs_buffer_on_chain(): Return first LCSIBH on chain.         */
+/* ------------------------------------------------------------------ */
+// The chain itself is consumed by the read subchannel, but it is also
+// flushed by the SEM CCW and by LCS_StopLan_SNA on other threads, so
+// the caller must hold LCSIBHChainLock across looking at the first
+// LCSIBH and removing it.
+PLCSIBH  first_lcs_buffer_on_chain( PLCSDEV pLCSDEV )
+{
+    PLCSIBH    pQueued;                                // Queued LCSIBHs
+    PLCSIBH    pNext;                                  // Next queued LCSIBH
+    PLCSIBH    pChain;                                 // Queued LCSIBHs, oldest first
+    PLCSIBH    pLast;                                  // Newest queued LCSIBH
+
+    // Take any LCSIBHs queued since the last call.
+    pQueued = take_lcs_buffers( pLCSDEV, &pLCSDEV->pQueuedLCSIBH );
+    if (pQueued)
     {
-        pLCSDEV->pFirstLCSIBH = pLCSIBH;               // Make the LCSIBH
-        pLCSDEV->pLastLCSIBH = pLCSIBH;                // the only LCSIBH
-    }
+        // Reverse the queued LCSIBHs into arrival order. The newest
+        // of them becomes the last LCSIBH on the chain.
+        pLast = pQueued;
+        for (pChain = NULL; pQueued; pQueued = pNext)
+        {
+            pNext = pQueued->pNextLCSIBH;
+            pQueued->pNextLCSIBH = pChain;
+            pChain = pQueued;
+        }
 
-    // Release the buffer chain lock.
-    release_lock( &pLCSDEV->LCSIBHChainLock );
+        // Add them to the end of the chain.
+        if (pLCSDEV->pFirstLCSIBH)                     // if there are already LCSIBHs
+            pLCSDEV->pLastLCSIBH->pNextLCSIBH = pChain;
+        else
+            pLCSDEV->pFirstLCSIBH = pChain;
+        pLCSDEV->pLastLCSIBH = pLast;
+    }
 
-    return;
+    return pLCSDEV->pFirstLCSIBH;
 }
 
 /* ------------------------------------------------------------------ */
 /* remove_lcs_buffer_from_chain(): Remove LCSIBH from start of chain. */
 /* ------------------------------------------------------------------ */
+// The caller must hold LCSIBHChainLock.
 PLCSIBH  remove_lcs_buffer_from_chain( PLCSDEV pLCSDEV )
 {
     PLCSIBH    pLCSIBH;                                // LCSIBH
 
-    // Obtain the buffer chain lock.
-    obtain_lock( &pLCSDEV->LCSIBHChainLock );
-
     // Point to first LCSIBH on the chain.
-    pLCSIBH = pLCSDEV->pFirstLCSIBH;                   // Pointer to first LCSIBH
+    pLCSIBH = first_lcs_buffer_on_chain( pLCSDEV );    // Pointer to first LCSIBH
 
     // Remove the first LCSIBH from the chain, if there is one...
     if (pLCSIBH)                                       // If there is a LCSIBH
@@ -7327,9 +8438,6 @@ PLCSIBH  remove_lcs_buffer_from_chain( PLCSDEV pLCSDEV )
         pLCSIBH->pNextLCSIBH = NULL;                   // Clear the pointer to next LCSIBH
     }
 
-    // Release the buffer chain lock.
-    release_lock( &pLCSDEV->LCSIBHChainLock );
-
     return pLCSIBH;
 }
 
@@ -7344,18 +8452,12 @@ void  remove_and_free_any_lcs_buffers_on_chain( PLCSDEV pLCSDEV )
     obtain_lock( &pLCSDEV->LCSIBHChainLock );
 
     // Remove and free the first LCSIBH on the chain, if there is one...
-    while(pLCSDEV->pFirstLCSIBH)
+    while ((pLCSIBH = remove_lcs_buffer_from_chain( pLCSDEV )))
     {
-        pLCSIBH = pLCSDEV->pFirstLCSIBH;               // Pointer to first LCSIBH
-        pLCSDEV->pFirstLCSIBH = pLCSIBH->pNextLCSIBH;  // Make the next the first LCSIBH
         free_lcs_buffer( pLCSDEV, pLCSIBH );           // Free the buffer
         pLCSIBH = NULL;
     }
 
-    // Reset the chain pointers.
-    pLCSDEV->pFirstLCSIBH = NULL;                      // Clear the
-    pLCSDEV->pLastLCSIBH = NULL;                       // chain pointers
-
     // Release the buffer chain lock.
     release_lock( &pLCSDEV->LCSIBHChainLock );
 
@@ -7365,14 +8467,106 @@ void  remove_and_free_any_lcs_buffers_on_chain( PLCSDEV pLCSDEV )
 /* ------------------------------------------------------------------ */
 /* free_lcs_buffer(): Free LCSIBH.                                    */
 /* ------------------------------------------------------------------ */
+// A pooled LCSIBH is returned to the pool rather than freed. Only the
+// bytes that were used are cleared, so the whole buffer is clear when
+// the port thread next obtains it.
 void  free_lcs_buffer( PLCSDEV pLCSDEV, PLCSIBH pLCSIBH )
 {
-    UNREFERENCED( pLCSDEV );
+    if (pLCSIBH->fPooled)
+    {
+        memset( pLCSIBH->bData, 0, MIN( pLCSIBH->iDataLen, pLCSIBH->iAreaLen ) );
+        pLCSIBH->iDataLen = 0;
+        pLCSIBH->uQueued = 0;
+        push_lcs_buffer( pLCSDEV, &pLCSDEV->pReturnedLCSIBH, pLCSIBH );
+        return;
+    }
 
     free( pLCSIBH );
     return;
 }
 
+/* ------------------------------------------------------------------ */
+/* free_lcs_buffer_pool(): Free all pooled LCSIBHs.                   */
+/* ------------------------------------------------------------------ */
+void  free_lcs_buffer_pool( PLCSDEV pLCSDEV )
+{
+    PLCSIBH    pLCSIBH;                                // LCSIBH
+    PLCSIBH    pNext;                                  // Next LCSIBH
+
+    for (pLCSIBH = pLCSDEV->pPoolLCSIBH; pLCSIBH; pLCSIBH = pNext)
+    {
+        pNext = pLCSIBH->pNextLCSIBH;
+        free( pLCSIBH );
+    }
+    pLCSDEV->pPoolLCSIBH = NULL;
+
+    for (pLCSIBH = take_lcs_buffers( pLCSDEV, &pLCSDEV->pReturnedLCSIBH ); pLCSIBH; pLCSIBH = pNext)
+    {
+        pNext = pLCSIBH->pNextLCSIBH;
+        free( pLCSIBH );
+    }
+
+    pLCSDEV->iPoolLCSIBH = 0;
+
+    return;
+}
+
+/* ------------------------------------------------------------------ */
+/* free_lcs_frame_buffers(): Free the zero-copy frame buffers.        */
+/* ------------------------------------------------------------------ */
+void  free_lcs_frame_buffers( PLCSDEV pLCSDEV )
+{
+    int        i;
+
+    pLCSDEV->pFrameBuffer = pLCSDEV->bFrameBuffer;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (pLCSDEV->pFrameBuffers[i])
+            free_aligned( pLCSDEV->pFrameBuffers[i] );
+        pLCSDEV->pFrameBuffers[i] = NULL;
+    }
+
+    return;
+}
+
+/* ------------------------------------------------------------------ */
+/* remove_and_free_any_attns_for_device(): Remove & free LCSATTNs.    */
+/* ------------------------------------------------------------------ */
+// Removes the new and deferred LCSATTNs of the LCSDEV, or of every
+// LCSDEV when pLCSDEV is NULL.
+void  remove_and_free_any_attns_for_device( PLCSBLK pLCSBLK, PLCSDEV pLCSDEV )
+{
+    PLCSATTN*  ppLCSATTN;                              // -> LCSATTN ptr
+    PLCSATTN   pLCSATTN;                               // LCSATTN
+    PLCSATTN*  ppChain[2];                             // Chains to search
+    int        i;
+
+    ppChain[0] = &pLCSBLK->pAttns;
+    ppChain[1] = &pLCSBLK->pDeferredAttns;
+
+    obtain_lock( &pLCSBLK->AttnLock );
+
+    for (i = 0; i < 2; i++)
+    {
+        ppLCSATTN = ppChain[i];
+        while ((pLCSATTN = *ppLCSATTN))
+        {
+            if (!pLCSDEV || pLCSATTN->pDevice == pLCSDEV)
+            {
+                *ppLCSATTN = pLCSATTN->pNext;
+                free( pLCSATTN );
+            }
+            else
+                ppLCSATTN = &pLCSATTN->pNext;
+        }
+    }
+
+    release_lock( &pLCSBLK->AttnLock );
+
+    return;
+}
+
 
 /* ------------------------------------------------------------------ */
 /* alloc_connection(): Allocate storage for an LCSCONN                */
@@ -7398,6 +8592,66 @@ PLCSCONN  alloc_connection( PLCSDEV pLCSDEV )
     return pLCSCONN;
 }
 
+/* ------------------------------------------------------------------ */
+/* hash_connection_key(): Hash an LCSCONN remote MAC or token.        */
+/* ------------------------------------------------------------------ */
+static U16  hash_connection_key( BYTE* pKey, int iLen )
+{
+    U32        uHash = 2166136261U;    // FNV-1a offset basis
+    int        i;
+
+    for (i = 0; i < iLen; i++)
+        uHash = (uHash ^ pKey[i]) * 16777619U;   // FNV-1a prime
+
+    return (U16)((uHash ^ (uHash >> 16)) & (LCSCONN_HASH_SIZE - 1));
+}
+
+/* ------------------------------------------------------------------ */
+/* hash_connection_tokens(): Add LCSCONN to the token hash tables.    */
+/* ------------------------------------------------------------------ */
+/* The caller must hold the connection chain lock.                    */
+/* ------------------------------------------------------------------ */
+static void  hash_connection_tokens( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN )
+{
+    pLCSCONN->hwHashInToken = hash_connection_key( pLCSCONN->bInToken, sizeof(pLCSCONN->bInToken) );
+    pLCSCONN->pNextByInToken = pLCSDEV->pLCSCONNByInToken[ pLCSCONN->hwHashInToken ];
+    pLCSDEV->pLCSCONNByInToken[ pLCSCONN->hwHashInToken ] = pLCSCONN;
+
+    pLCSCONN->hwHashOutToken = hash_connection_key( pLCSCONN->bOutToken, sizeof(pLCSCONN->bOutToken) );
+    pLCSCONN->pNextByOutToken = pLCSDEV->pLCSCONNByOutToken[ pLCSCONN->hwHashOutToken ];
+    pLCSDEV->pLCSCONNByOutToken[ pLCSCONN->hwHashOutToken ] = pLCSCONN;
+}
+
+/* ------------------------------------------------------------------ */
+/* unhash_connection_tokens(): Remove LCSCONN from token hash tables. */
+/* ------------------------------------------------------------------ */
+/* The caller must hold the connection chain lock.                    */
+/* ------------------------------------------------------------------ */
+static void  unhash_connection_tokens( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN )
+{
+    PLCSCONN*  ppLCSCONN;
+
+    for (ppLCSCONN = &pLCSDEV->pLCSCONNByInToken[ pLCSCONN->hwHashInToken ]; *ppLCSCONN; ppLCSCONN = &(*ppLCSCONN)->pNextByInToken)
+    {
+        if (*ppLCSCONN == pLCSCONN)
+        {
+            *ppLCSCONN = pLCSCONN->pNextByInToken;
+            break;
+        }
+    }
+    pLCSCONN->pNextByInToken = NULL;
+
+    for (ppLCSCONN = &pLCSDEV->pLCSCONNByOutToken[ pLCSCONN->hwHashOutToken ]; *ppLCSCONN; ppLCSCONN = &(*ppLCSCONN)->pNextByOutToken)
+    {
+        if (*ppLCSCONN == pLCSCONN)
+        {
+            *ppLCSCONN = pLCSCONN->pNextByOutToken;
+            break;
+        }
+    }
+    pLCSCONN->pNextByOutToken = NULL;
+}
+
 /* ------------------------------------------------------------------ */
 /* add_connection_to_chain(): Add LCSCONN to end of chain.            */
 /* ------------------------------------------------------------------ */
@@ -7415,6 +8669,13 @@ void  add_connection_to_chain( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN )
     // Add the LCSCONN to the start of the chain.
     pLCSCONN->pNextLCSCONN = pLCSDEV->pFirstLCSCONN;
     pLCSDEV->pFirstLCSCONN = pLCSCONN;
+    pLCSDEV->iLCSCONNCount++;
+
+    // Add the LCSCONN to the start of its hash buckets.
+    pLCSCONN->hwHashMAC = hash_connection_key( pLCSCONN->bRemoteMAC, IFHWADDRLEN );
+    pLCSCONN->pNextByMAC = pLCSDEV->pLCSCONNByMAC[ pLCSCONN->hwHashMAC ];
+    pLCSDEV->pLCSCONNByMAC[ pLCSCONN->hwHashMAC ] = pLCSCONN;
+    hash_connection_tokens( pLCSDEV, pLCSCONN );
 
     // Release the connection chain lock.
     release_lock( &pLCSDEV->LCSCONNChainLock );
@@ -7422,22 +8683,41 @@ void  add_connection_to_chain( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN )
     return;
 }
 
+/* ------------------------------------------------------------------ */
+/* rehash_connection_tokens(): Rehash LCSCONN after token change.     */
+/* ------------------------------------------------------------------ */
+void  rehash_connection_tokens( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN )
+{
+    obtain_lock( &pLCSDEV->LCSCONNChainLock );
+    unhash_connection_tokens( pLCSDEV, pLCSCONN );
+    hash_connection_tokens( pLCSDEV, pLCSCONN );
+    release_lock( &pLCSDEV->LCSCONNChainLock );
+    return;
+}
+
 /* ------------------------------------------------------------------ */
 /* find_connection_by_remote_mac(): Find LCSCONN.                     */
 /* ------------------------------------------------------------------ */
 PLCSCONN  find_connection_by_remote_mac( PLCSDEV pLCSDEV, MAC* pMAC )
 {
     PLCSCONN   pLCSCONN;
+    U16        hwHash;
+    U64        uCompares = 0;
 
-    // Locate the LCSCONN on the chain.
-    for (pLCSCONN = pLCSDEV->pFirstLCSCONN; pLCSCONN; pLCSCONN = pLCSCONN->pNextLCSCONN)
+    // Locate the LCSCONN in its hash bucket.
+    hwHash = hash_connection_key( (BYTE*)pMAC, IFHWADDRLEN );
+    for (pLCSCONN = pLCSDEV->pLCSCONNByMAC[ hwHash ]; pLCSCONN; pLCSCONN = pLCSCONN->pNextByMAC)
     {
+        uCompares++;
         if ( ( memcmp( &pLCSCONN->bRemoteMAC, pMAC, IFHWADDRLEN ) == 0 ) )
         {
             break;
         }
     }
 
+    pLCSDEV->uLCSCONNLookups++;
+    pLCSDEV->uLCSCONNCompares += uCompares;
+
     return pLCSCONN;
 }
 
@@ -7447,15 +8727,22 @@ PLCSCONN  find_connection_by_remote_mac( PLCSDEV pLCSDEV, MAC* pMAC )
 PLCSCONN find_connection_by_outbound_token( PLCSDEV pLCSDEV, BYTE* pToken )
 {
     PLCSCONN   pLCSCONN;
+    U16        hwHash;
+    U64        uCompares = 0;
 
-    for (pLCSCONN = pLCSDEV->pFirstLCSCONN; pLCSCONN; pLCSCONN = pLCSCONN->pNextLCSCONN)
+    hwHash = hash_connection_key( pToken, sizeof(pLCSCONN->bOutToken) );
+    for (pLCSCONN = pLCSDEV->pLCSCONNByOutToken[ hwHash ]; pLCSCONN; pLCSCONN = pLCSCONN->pNextByOutToken)
     {
+        uCompares++;
         if ( memcmp( &pLCSCONN->bOutToken, pToken, sizeof(pLCSCONN->bOutToken) ) == 0 )
         {
             break;
         }
     }
 
+    pLCSDEV->uLCSCONNLookups++;
+    pLCSDEV->uLCSCONNCompares += uCompares;
+
     return pLCSCONN;
 }
 
@@ -7465,15 +8752,22 @@ PLCSCONN find_connection_by_outbound_token( PLCSDEV pLCSDEV, BYTE* pToken )
 PLCSCONN find_connection_by_inbound_token( PLCSDEV pLCSDEV, BYTE* pToken )
 {
     PLCSCONN   pLCSCONN;
+    U16        hwHash;
+    U64        uCompares = 0;
 
-    for (pLCSCONN = pLCSDEV->pFirstLCSCONN; pLCSCONN; pLCSCONN = pLCSCONN->pNextLCSCONN)
+    hwHash = hash_connection_key( pToken, sizeof(pLCSCONN->bInToken) );
+    for (pLCSCONN = pLCSDEV->pLCSCONNByInToken[ hwHash ]; pLCSCONN; pLCSCONN = pLCSCONN->pNextByInToken)
     {
+        uCompares++;
         if ( memcmp( &pLCSCONN->bInToken, pToken, sizeof(pLCSCONN->bInToken) ) == 0 )
         {
             break;
         }
     }
 
+    pLCSDEV->uLCSCONNLookups++;
+    pLCSDEV->uLCSCONNCompares += uCompares;
+
     return pLCSCONN;
 }
 
@@ -7596,12 +8890,28 @@ int  remove_connection_from_chain( PLCSDEV pLCSDEV, PLCSCONN pLCSCONN )
         {
             *ppPrevLCSCONN = pCurrLCSCONN->pNextLCSCONN;
             pCurrLCSCONN->pNextLCSCONN = NULL;
+            pLCSDEV->iLCSCONNCount--;
             rc = 0;
             break;
         }
         ppPrevLCSCONN = &pCurrLCSCONN->pNextLCSCONN;
     }
 
+    // Remove the LCSCONN from its hash buckets.
+    if (rc == 0)
+    {
+        for (ppPrevLCSCONN = &pLCSDEV->pLCSCONNByMAC[ pLCSCONN->hwHashMAC ]; *ppPrevLCSCONN; ppPrevLCSCONN = &(*ppPrevLCSCONN)->pNextByMAC)
+        {
+            if (*ppPrevLCSCONN == pLCSCONN)
+            {
+                *ppPrevLCSCONN = pLCSCONN->pNextByMAC;
+                break;
+            }
+        }
+        pLCSCONN->pNextByMAC = NULL;
+        unhash_connection_tokens( pLCSDEV, pLCSCONN );
+    }
+
     // Release the connection chain lock.
     release_lock( &pLCSDEV->LCSCONNChainLock );
 
@@ -7627,6 +8937,12 @@ void  remove_and_free_any_connections_on_chain( PLCSDEV pLCSDEV )
         pLCSCONN = NULL;
     }
 
+    // Empty the hash tables.
+    memset( pLCSDEV->pLCSCONNByMAC, 0, sizeof(pLCSDEV->pLCSCONNByMAC) );
+    memset( pLCSDEV->pLCSCONNByInToken, 0, sizeof(pLCSDEV->pLCSCONNByInToken) );
+    memset( pLCSDEV->pLCSCONNByOutToken, 0, sizeof(pLCSDEV->pLCSCONNByOutToken) );
+    pLCSDEV->iLCSCONNCount = 0;
+
     // Release the connection chain lock.
     release_lock( &pLCSDEV->LCSCONNChainLock );
 
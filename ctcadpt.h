@@ -58,6 +58,7 @@ typedef uint8_t  MAC[ IFHWADDRLEN ];    // Data Type for MAC Addresses
 struct  _LCSBLK;            // Common Storage for LCS Emulation
 struct  _LCSDEV;            // LCS Device
 struct  _LCSPORT;           // LCS Port (or Relative Adapter)
+struct  _LCSQUEUE;          // LCS Port TAP queue
 struct  _LCSRTE;            // LCS Routing Entries
 struct  _LCSHDR;            // LCS Frame Header
 struct  _LCSCMDHDR;         // LCS Command Frame Header
@@ -80,6 +81,7 @@ struct  _LCSCONN;           // LCS SNA Connection
 typedef struct  _LCSBLK     LCSBLK,     *PLCSBLK;
 typedef struct  _LCSDEV     LCSDEV,     *PLCSDEV;
 typedef struct  _LCSPORT    LCSPORT,    *PLCSPORT;
+typedef struct  _LCSQUEUE   LCSQUEUE,   *PLCSQUEUE;
 typedef struct  _LCSRTE     LCSRTE,     *PLCSRTE;
 typedef struct  _LCSHDR     LCSHDR,     *PLCSHDR;
 typedef struct  _LCSCMDHDR  LCSCMDHDR,  *PLCSCMDHDR;
@@ -630,9 +632,19 @@ struct _LCSIBH                         // LCS SNA Inbound Buffer Header
     PLCSIBH   pNextLCSIBH;             // Pointer to next LCSIBH
     int       iAreaLen;                // Data area length
     int       iDataLen;                // Data length
+    int       fPooled;                 // Buffer belongs to LCSDEV pool
+    U64       uQueued;                 // When I-frame data was queued
     BYTE      bData[FLEXIBLE_ARRAY];   //
 } ATTRIBUTE_PACKED;
 
+// The port thread takes the buffers for inbound SNA frames from a
+// per-LCSDEV pool of fixed size LCSIBHs. Pooled buffers are kept
+// cleared: only the bytes actually used are cleared when a buffer
+// is returned, so they behave exactly like freshly calloc'ed ones.
+
+#define LCSIBH_POOL_AREA        2032    // Data area of a pooled LCSIBH
+#define LCSIBH_POOL_MAX         256     // Max pooled LCSIBHs per LCSDEV
+
 
 // --------------------------------------------------------------------
 // LCS SNA Connection
@@ -641,6 +653,12 @@ struct _LCSIBH                         // LCS SNA Inbound Buffer Header
 struct _LCSCONN                        // LCS SNA Connection
 {
     PLCSCONN  pNextLCSCONN;            // Pointer to next LCSCONN
+    PLCSCONN  pNextByMAC;              // Next LCSCONN in remote MAC bucket
+    PLCSCONN  pNextByInToken;          // Next LCSCONN in inbound token bucket
+    PLCSCONN  pNextByOutToken;         // Next LCSCONN in outbound token bucket
+    U16       hwHashMAC;               // Remote MAC hash bucket
+    U16       hwHashInToken;           // Inbound token hash bucket
+    U16       hwHashOutToken;          // Outbound token hash bucket
     BYTE      bInToken[4];             // Inbound Token. VTAM tells LCS that
                                        // it will use this token for inbound.
     BYTE      bOutToken[4];            // Outbound Token. LCS tells VTAM that
@@ -659,8 +677,53 @@ struct _LCSCONN                        // LCS SNA Connection
     U16       hwRemoteNR;              // Remote NR
     u_int     fIframe:1;               // I-frame received
 
+    // Statistics, updated with atomic adds (see the lcs command)
+    U64       uIFramesIn;              // I-frames received from partner
+    U64       uIFramesOut;             // I-frames sent to partner
+    U64       uBytesIn;                // TH etc bytes received
+    U64       uBytesOut;               // TH etc bytes sent
+    U64       uRRIn;                   // RR frames received
+    U64       uRROut;                  // RR frames sent
+    U64       uRNRIn;                  // RNR frames received
+    U64       uREJIn;                  // REJ frames received
+    U64       uRetransmits;            // I-frames received again
+    U64       uOutOfSeq;               // I-frames received out of sequence
+    U64       uQueueDepth;             // I-frames waiting for VTAM
+    U64       uQueueDepthMax;          // Most I-frames ever waiting
+    U64       uQueueReads;             // I-frames read by VTAM
+    U64       uQueueTime;              // Total time waiting (usecs)
+    U64       uQueueTimeMax;           // Longest time waiting (usecs)
 };
 
+// The LCSCONNs of an LCSDEV are also hashed by remote MAC address and
+// by both tokens, so the connection for a frame is found without
+// walking the chain however many partners there are behind the port.
+
+#define LCSCONN_HASH_SIZE       64      // Hash buckets (power of 2)
+
+// The attention thread retries an attention that found the device
+// busy when the device's channel program ends, and otherwise after a
+// short delay that doubles on each retry. The time from an attention
+// being requested to the guest reading the data is kept in a histogram
+// of power of two buckets, the first of which is LCS_ATTN_HIST_BASE
+// microseconds wide.
+
+#define LCS_ATTN_RETRY_MIN      10      // First retry delay (usecs)
+#define LCS_ATTN_RETRY_MAX      1000    // Longest retry delay (usecs)
+#define LCS_ATTN_GIVEUP         (1000*1000) // Abandon after (usecs)
+#define LCS_ATTN_HIST_BASE      16      // First bucket width (usecs)
+#define LCS_ATTN_HIST_SIZE      12      // Buckets in latency histogram
+
+// Inbound SNA frames are coalesced into one Attention. The Attention
+// for the first frame queued since the guest last read is held until
+// iAttnCount frames are waiting or iAttnWait microseconds have passed.
+// An iAttnWait of zero raises the Attention at once.
+
+#define LCS_DEF_ATTNCOUNT       1       // Default frames per Attention
+#define LCS_MAX_ATTNCOUNT       256     // Maximum frames per Attention
+#define LCS_DEF_ATTNWAIT        0       // Default Attention hold (usecs)
+#define LCS_MAX_ATTNWAIT        100000  // Maximum Attention hold (usecs)
+
 
 // --------------------------------------------------------------------
 // LCS Device                                   (host byte order)
@@ -682,6 +745,7 @@ struct  _LCSDEV
 
     U32         lIPAddress;             // IP Address (binary)
                                         // (network byte order)
+    PLCSDEV     pNextByIP;              // -> Next in port IP hash
 
     LOCK        DevDataLock;            // Data LOCK
     LOCK        DevEventLock;           // Condition LOCK
@@ -694,6 +758,7 @@ struct  _LCSDEV
     u_int       fDataPending:1;         // Data is Pending
     u_int       fReadWaiting:1;         // LCS_Read waiting
     u_int       fHaltOrClear:1;         // HSCH or CSCH issued
+    u_int       fSignalPending:1;       // DevEvent signal deferred
 
     U16         hwOctlSize;             // SNA
     LCSOCTL     Octl;                   // SNA Outbound Control
@@ -716,14 +781,41 @@ struct  _LCSDEV
     U16         hwInDataSeqNum;         // SNA Data Sequence number
 
     LOCK        LCSIBHChainLock;        // SNA LCSIBH Chain LOCK
+    LOCK        LCSIBHQueueLock;        // SNA LCSIBH queue LOCK (no atomics only)
     PLCSIBH     pFirstLCSIBH;           // SNA First LCSIBH in chain
     PLCSIBH     pLastLCSIBH;            // SNA Last LCSIBH in chain
+    PLCSIBH volatile pQueuedLCSIBH;     // SNA LCSIBHs queued, newest first
+    PLCSIBH     pPoolLCSIBH;            // SNA Free pooled LCSIBHs
+    PLCSIBH volatile pReturnedLCSIBH;   // SNA Pooled LCSIBHs returned
+    int         iPoolLCSIBH;            // SNA Pooled LCSIBHs allocated
 
     LOCK        LCSCONNChainLock;       // SNA LCSCONN Chain LOCK
     PLCSCONN    pFirstLCSCONN;          // SNA First LCSCONN in chain
+    PLCSCONN    pLCSCONNByMAC[ LCSCONN_HASH_SIZE ];      // SNA by remote MAC
+    PLCSCONN    pLCSCONNByInToken[ LCSCONN_HASH_SIZE ];  // SNA by inbound token
+    PLCSCONN    pLCSCONNByOutToken[ LCSCONN_HASH_SIZE ]; // SNA by outbound token
+    int         iLCSCONNCount;          // SNA LCSCONNs on chain
+    U64         uLCSCONNLookups;        // SNA LCSCONN lookups
+    U64         uLCSCONNCompares;       // SNA LCSCONNs compared by lookups
+
+    BYTE        fAttnQueued;            // SNA Attention outstanding
+    BYTE        fAttnDeferred;          // SNA Attention waiting for idle
+    int         iAttnFrames;            // SNA Frames since last read
+    U64         uAttnDue;               // SNA Held Attention due (usecs)
+    U64         uAttnCoalesced;         // SNA Frames covered by an Attention
+    U64         uAttnTime;              // SNA Attention requested (usecs)
+    U64         uAttnRaised;            // SNA Attentions raised
+    U64         uAttnBusy;              // SNA Attention retries when busy
+    U64         uAttnLost;              // SNA Attentions abandoned
+    U64         uAttnLatency[ LCS_ATTN_HIST_SIZE ]; // SNA Attention to read
+
+    U64         uBytesIn;               // Bytes presented to the guest
+    U64         uBytesCopied;           // Bytes copied getting them there
 
     U16         iFrameOffset;           // Curr Offset into Buffer
     U16         iMaxFrameBufferSize;    // Device Buffer Size
+    BYTE*       pFrameBuffer;           // -> Buffer being filled
+    BYTE*       pFrameBuffers[2];       // Zero-copy double buffers
     BYTE        bFrameBuffer[CTC_DEF_FRAME_BUFFER_SIZE]; // (this really SHOULD be dynamically allocated!)
 };
 
@@ -744,6 +836,58 @@ struct  _LCSDEV
 #define  WCTL  0x17          // Write Control
 #define  SCB   0x14          // Sense Command Byte
 
+// --------------------------------------------------------------------
+// LCS Port receive batching
+// --------------------------------------------------------------------
+// The port thread drains every frame that is ready on the TAP device
+// each time it wakes up (up to iRxBatch frames) into a ring of fixed
+// size receive buffers, and only then dispatches them to the devices.
+
+#define LCS_RXBUF_SIZE          2048    // Size of each receive buffer
+#define LCS_DEF_RXBATCH         16      // Default max frames per wakeup
+#define LCS_MAX_RXBATCH         256     // Maximum max frames per wakeup
+
+// --------------------------------------------------------------------
+// LCS zero-copy receive
+// --------------------------------------------------------------------
+// With the zerocopy option an IP mode device that is alone on its port
+// has two page aligned frame buffers. The port thread reads each frame
+// from the TAP device straight into the LCS frame slot of the buffer
+// being filled, and LCS_Read swaps buffers and copies the full one to
+// the channel outside of the device data lock.
+
+#define LCS_FRAMEBUF_ALIGN      4096    // Zero-copy buffer alignment
+
+// --------------------------------------------------------------------
+// LCS Port inbound frame dispatch table
+// --------------------------------------------------------------------
+// The devices on each port are hashed by IP address when the LCS group
+// is built (and again whenever a device is removed), and the port's
+// default and first devices are remembered, so the port thread finds
+// the device an inbound frame belongs to without walking the device
+// chain however many devices the OAT defines.
+
+#define LCS_IPHASH_SIZE         64      // Hash buckets (power of 2)
+
+// --------------------------------------------------------------------
+// LCS Port TAP queues
+// --------------------------------------------------------------------
+// With the queues option the port's TAP interface is created with
+// IFF_MULTI_QUEUE and opened once per queue. The kernel steers each
+// flow to one queue, so every queue gets its own reader thread and
+// frames of a flow (or of an SNA LLC connection) stay in order. The
+// port's own fd and port thread are queue 0.
+
+#define LCS_DEF_QUEUES          1       // Default TAP queues per port
+#define LCS_MAX_QUEUES          16      // Maximum TAP queues per port
+
+struct  _LCSQUEUE
+{
+    PLCSPORT    pLCSPORT;                 // -> LCSPORT
+    int         fd;                       // TUN/TAP queue fd
+    TID         tid;                      // Queue Read Thread ID
+};
+
 // --------------------------------------------------------------------
 // LCS Port (or Relative Adapter)               (host byte order)
 // --------------------------------------------------------------------
@@ -757,12 +901,18 @@ struct  _LCSPORT
     PLCSBLK     pLCSBLK;                  // -> LCSBLK
     MACTAB      MCastTab[ MACTABMAX ];    // Multicast table
 
+    PLCSDEV     pDevByIP[ LCS_IPHASH_SIZE ]; // Devices by IP address
+    PLCSDEV     pFirstDev;                // First device on port
+    PLCSDEV     pPrimaryDev;              // Primary default device
+    PLCSDEV     pSecondaryDev;            // Secondary default device
+
     U16         sIPAssistsSupported;      // (See #defines below)
     U16         sIPAssistsEnabled;        // (See #defines below)
 
     LOCK        PortDataLock;             // Data LOCK
     LOCK        PortEventLock;            // Condition LOCK
     COND        PortEvent;                // Condition signal
+    LOCK        PortRxLock;               // Receive stats & SNA LOCK
 
     u_int       fUsed:1;                  // Port is used
     u_int       fLocalMAC:1;              // MAC is specified in OAT
@@ -773,9 +923,15 @@ struct  _LCSPORT
     u_int       fPreconfigured:1;         // TAP device pre-configured
     u_int       fDoCkSumOffload:1;        // Do manual CSUM Offload
     u_int       fDoMCastAssist:1;         // Do manual MCAST Assist
+    BYTE        fStopQueues;              // Queue threads must exit
 
     int         fd;                       // TUN/TAP fd
     TID         tid;                      // Read Thread ID
+    int         iQueues;                  // TAP queues (incl. fd)
+    LCSQUEUE    Queue[LCS_MAX_QUEUES];    // Queues (Queue[0] unused)
+    U64         uRxWakeups;               // Read wakeups with data
+    U64         uRxFrames;                // Frames read from TAP
+    U32         uRxMaxBatch;              // Most frames in one wakeup
     pid_t       pid;                      // Read Thread pid
     int         icDevices;                // Device count
     char        szNetIfName[IFNAMSIZ];    // Network Interface Name (e.g. tap0)
@@ -816,6 +972,7 @@ struct _LCSATTN                           // LCS Attention Required
 {
     PLCSATTN    pNext;                    // -> Next in chain
     PLCSDEV     pDevice;                  // -> Device
+    U64         uBusySince;               // First found busy (usecs)
 };
 
 
@@ -832,16 +989,24 @@ struct  _LCSBLK
     u_int       fDebug:1;
 #if defined( OPTION_W32_CTCI )
     u_int       fNoMultiWrite:1;          // CTCI-WIN v3.3+ WinPCap v4.1+
+#else
+    u_int       fZeroCopy:1;              // Read frames into frame buffer
 #endif
     int         icDevices;                // Number of devices
     int         iKernBuff;                // Kernel buffer in K bytes.
     int         iIOBuff;                  // I/O buffer in K bytes.
+    int         iRxBatch;                 // Max frames read per wakeup
+    int         iQueues;                  // TAP queues per port
+    int         iAttnCount;               // SNA frames per Attention
+    int         iAttnWait;                // SNA Attention hold (usecs)
 
     LOCK        AttnLock;                 // Attention LOCK
     PLCSATTN    pAttns;                   // -> Attention chain
+    PLCSATTN    pDeferredAttns;           // -> Attentions found busy
 
     LOCK        AttnEventLock;            // Attention event LOCK
     COND        AttnEvent;                // Attention event signal
+    BYTE        fAttnRetry;               // Retry deferred attentions
 
     TID         AttnTid;                  // Attention Thread ID
     pid_t       AttnPid;                  // Attention Thread pid
@@ -740,6 +740,96 @@ U16     eax;                            /* Authorization index       */
 } /* end function load_address_space_designator */
 
 
+/*-------------------------------------------------------------------*/
+/* TLB page frame filter                                             */
+/*                                                                   */
+/* Each CPU records a hash of the page frame of every page table     */
+/* entry it places in its TLB.  The filter is cleared whenever the   */
+/* whole TLB is purged, so a CPU whose filter bit for a page frame   */
+/* is clear holds no entry for it and purge_tlbe need not scan its   */
+/* TLB.  False positives merely cause an unnecessary scan.           */
+/*-------------------------------------------------------------------*/
+#undef TLB_FILTER_PTEMASK
+#if !defined( FEATURE_S390_DAT ) && !defined( FEATURE_001_ZARCH_INSTALLED_FACILITY )
+  #define TLB_FILTER_PTEMASK    PAGETAB_PFRA_4K
+#elif defined( FEATURE_001_ZARCH_INSTALLED_FACILITY )
+  #define TLB_FILTER_PTEMASK    ZPGETAB_PFRA
+#else
+  #define TLB_FILTER_PTEMASK    PAGETAB_PFRA
+#endif
+
+static inline U32 ARCH_DEP( tlb_filter_bit )( U64 pte )
+{
+    return (U32)(((pte & TLB_FILTER_PTEMASK) * 0x9E3779B97F4A7C15ULL)
+                 >> (64 - TLB_FILTER_SHIFT));
+}
+
+static inline void ARCH_DEP( tlb_filter_set )( REGS* regs, U64 pte )
+{
+    U32  bit = ARCH_DEP( tlb_filter_bit )( pte );
+    regs->tlbfilter[ bit >> 6 ] |= 1ULL << (bit & 63);
+}
+
+static inline bool ARCH_DEP( tlb_filter_test )( REGS* regs, U64 pte )
+{
+    U32  bit = ARCH_DEP( tlb_filter_bit )( pte );
+    return (regs->tlbfilter[ bit >> 6 ] & (1ULL << (bit & 63))) != 0;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Locate the TLB entry for a virtual page                           */
+/*                                                                   */
+/* Input:                                                            */
+/*      vaddr   virtual address to be translated                     */
+/*      asd     Address space designator of the translation          */
+/*      regs    Pointer to the CPU register context                  */
+/*                                                                   */
+/* Output:                                                           */
+/*      tlbix   Index of the matching TLB entry if one exists,       */
+/*              otherwise the index of the entry to be replaced:     */
+/*              an unused way of the set if there is one, else the   */
+/*              next way in round-robin order.                       */
+/*                                                                   */
+/*      The return value is true if a matching entry was found.      */
+/*-------------------------------------------------------------------*/
+static inline bool ARCH_DEP( tlb_lookup )( VADR vaddr, RADR asd,
+                                           REGS* regs, int* tlbix )
+{
+int     ix = TLBIX( regs, vaddr );      /* First way of the set      */
+int     victim = -1;                    /* Entry to be replaced      */
+U32     way;                            /* Way number                */
+
+    for (way = 0; way < regs->tlbways; way++, ix += regs->tlbsets)
+    {
+        if (((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(ix))
+        {
+            if (   (regs->tlb.common[ix] || asd == regs->tlb.TLB_ASD(ix))
+                && !(regs->tlb.common[ix] && regs->dat.pvtaddr) )
+            {
+                *tlbix = ix;
+                return true;
+            }
+        }
+        else if (victim < 0
+            && (regs->tlb.TLB_VADDR(ix) & TLBID_BYTEMASK) != regs->tlbID)
+            victim = ix;
+    }
+
+    /* No match: prefer an unused way, else replace round-robin */
+    if (victim < 0)
+    {
+        victim = TLBIX( regs, vaddr ) + regs->tlbnextway * regs->tlbsets;
+        if (++regs->tlbnextway >= regs->tlbways)
+            regs->tlbnextway = 0;
+    }
+
+    *tlbix = victim;
+    return false;
+
+} /* end function tlb_lookup */
+
+
 /*-------------------------------------------------------------------*/
 /* Translate a virtual address to a real address                     */
 /*                                                                   */
@@ -835,7 +925,7 @@ int ARCH_DEP(translate_addr) (VADR vaddr, int arn,
 RADR    sto = 0;                        /* Segment table origin      */
 RADR    pto = 0;                        /* Page table origin         */
 int     cc;                             /* Condition code            */
-int     tlbix = TLBIX(vaddr);           /* TLB entry index           */
+int     tlbix = TLBIX(regs, vaddr);     /* TLB entry index           */
 
 #if !defined( FEATURE_S390_DAT ) && !defined( FEATURE_001_ZARCH_INSTALLED_FACILITY )
 /*-----------------------------------*/
@@ -860,10 +950,8 @@ U32     ptl;                            /* Page table length         */
        goto tran_spec_excp;
 
     /* Look up the address in the TLB */
-    if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(tlbix)
-        && (regs->tlb.common[tlbix] || regs->dat.asd == regs->tlb.TLB_ASD(tlbix))
-        && !(regs->tlb.common[tlbix] && regs->dat.pvtaddr)
-        && !(acctype & ACC_NOTLB) )
+    if (   !(acctype & ACC_NOTLB)
+        && ARCH_DEP( tlb_lookup )( vaddr, regs->dat.asd, regs, &tlbix ) )
     {
         pte = regs->tlb.TLB_PTE(tlbix);
 
@@ -961,6 +1049,7 @@ U32     ptl;                            /* Page table length         */
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
+            ARCH_DEP( tlb_filter_set )( regs, regs->tlb.TLB_PTE(tlbix) );
             regs->tlb.common[tlbix]    = (ste & SEGTAB_370_CMN) ? 1 : 0;
             regs->tlb.protect[tlbix]   = regs->dat.protect;
             regs->tlb.acc[tlbix]       = 0;
@@ -1015,10 +1104,8 @@ U32     ptl;                            /* Page table length         */
     regs->dat.pvtaddr = ((regs->dat.asd & STD_PRIVATE) != 0);
 
     /* [3.11.4] Look up the address in the TLB */
-    if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(tlbix)
-        && (regs->tlb.common[tlbix] || regs->dat.asd == regs->tlb.TLB_ASD(tlbix))
-        && !(regs->tlb.common[tlbix] && regs->dat.pvtaddr)
-        && !(acctype & ACC_NOTLB) )
+    if (   !(acctype & ACC_NOTLB)
+        && ARCH_DEP( tlb_lookup )( vaddr, regs->dat.asd, regs, &tlbix ) )
     {
         pte = regs->tlb.TLB_PTE(tlbix);
         if (regs->tlb.protect[tlbix])
@@ -1099,6 +1186,7 @@ U32     ptl;                            /* Page table length         */
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
+            ARCH_DEP( tlb_filter_set )( regs, regs->tlb.TLB_PTE(tlbix) );
             regs->tlb.common[tlbix]    = (ste & SEGTAB_COMMON) ? 1 : 0;
             regs->tlb.acc[tlbix]       = 0;
             regs->tlb.protect[tlbix]   = regs->dat.protect;
@@ -1148,10 +1236,8 @@ U16     sx, px;                         /* Segment and page index,
 //  LOGMSG("asce=%16.16"PRIX64"\n",regs->dat.asd);
 
     /* [3.11.4] Look up the address in the TLB */
-    if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(tlbix)
-        && (regs->tlb.common[tlbix] || regs->dat.asd == regs->tlb.TLB_ASD(tlbix))
-        && !(regs->tlb.common[tlbix] && regs->dat.pvtaddr)
-        && !(acctype & ACC_NOTLB) )
+    if (   !(acctype & ACC_NOTLB)
+        && ARCH_DEP( tlb_lookup )( vaddr, regs->dat.asd, regs, &tlbix ) )
     {
         pte = regs->tlb.TLB_PTE(tlbix);
         if (regs->tlb.protect[tlbix])
@@ -1444,6 +1530,7 @@ U16     sx, px;                         /* Segment and page index,
                     regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
                     /* Fake 4K PTE for TLB purposes */
                     regs->tlb.TLB_PTE(tlbix)   = ((ste & ZSEGTAB_SFAA) | (vaddr & ~ZSEGTAB_SFAA)) & PAGEFRAME_PAGEMASK;
+                    ARCH_DEP( tlb_filter_set )( regs, regs->tlb.TLB_PTE(tlbix) );
                     regs->tlb.common[tlbix]    = (ste & SEGTAB_COMMON) ? 1 : 0;
                     regs->tlb.protect[tlbix]   = regs->dat.protect;
                     regs->tlb.acc[tlbix]       = 0;
@@ -1452,6 +1539,7 @@ U16     sx, px;                         /* Segment and page index,
 
                 /* Clear exception code and return with zero return code */
                 regs->dat.xcode = 0;
+                regs->dat.tlbix = tlbix;
                 return 0;
 
             }
@@ -1511,6 +1599,7 @@ U16     sx, px;                         /* Segment and page index,
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
+            ARCH_DEP( tlb_filter_set )( regs, regs->tlb.TLB_PTE(tlbix) );
             regs->tlb.common[tlbix]    = (ste & SEGTAB_COMMON) ? 1 : 0;
             regs->tlb.protect[tlbix]   = regs->dat.protect;
             regs->tlb.acc[tlbix]       = 0;
@@ -1535,6 +1624,7 @@ U16     sx, px;                         /* Segment and page index,
 
     /* Clear exception code and return with zero return code */
     regs->dat.xcode = 0;
+    regs->dat.tlbix = tlbix;
     return 0;
 
 /* Conditions which always cause program check, except
@@ -1755,6 +1845,7 @@ void ARCH_DEP(purge_tlb) (REGS *regs)
         memset(&regs->tlb.vaddr, 0, TLBN * sizeof(DW) );
         regs->tlbID = 1;
     }
+    memset(regs->tlbfilter, 0, sizeof(regs->tlbfilter));
 
 #if defined( _FEATURE_SIE )
     /* Also clear the guest registers in the SIE copy */
@@ -1767,6 +1858,7 @@ void ARCH_DEP(purge_tlb) (REGS *regs)
             memset(&GUESTREGS->tlb.vaddr, 0, TLBN * sizeof(DW));
             GUESTREGS->tlbID = 1;
         }
+        memset(GUESTREGS->tlbfilter, 0, sizeof(GUESTREGS->tlbfilter));
     }
 #endif /* defined( _FEATURE_SIE ) */
 } /* end function purge_tlb */
@@ -1814,9 +1906,23 @@ RADR ptemask;
 
     INVALIDATE_AIA(regs);
 
-    for (i = 0; i < TLBN; i++)
-        if ((regs->tlb.TLB_PTE(i) & ptemask) == pte)
-            regs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
+    /* Scan the TLB only if the page frame may have been cached in it
+       since it was last purged; SIE entries are always scanned since
+       guest and host entries are checked against each other below */
+    regs->tlbpurges++;
+    if (0
+#if defined( _FEATURE_SIE )
+        || (regs->host && GUESTREGS)
+        || regs->guest
+#endif
+        || ARCH_DEP( tlb_filter_test )( regs, pte )
+    )
+    {
+        regs->tlbscans++;
+        for (i = 0; i < TLB_ENTRIES(regs); i++)
+            if ((regs->tlb.TLB_PTE(i) & ptemask) == pte)
+                regs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
+    }
 
 #if defined( _FEATURE_SIE )
     /* Also clear the guest registers in the SIE copy */
@@ -1838,7 +1944,7 @@ RADR ptemask;
 /*                                                                        */
 /*                                        (Peter J. Jansen, 29-Jul-2016)  */
 /**************************************************************************/
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES(GUESTREGS); i++)
             if ((GUESTREGS->tlb.TLB_PTE(i) & ptemask) == pte ||
                  (HOSTREGS->tlb.TLB_PTE(i) & ptemask) == pte)
                 GUESTREGS->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
@@ -1847,7 +1953,7 @@ RADR ptemask;
     {
         INVALIDATE_AIA(HOSTREGS);
 
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES(HOSTREGS); i++)
             if ((HOSTREGS->tlb.TLB_PTE(i) & ptemask) == pte)
                 HOSTREGS->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
     }
@@ -1882,7 +1988,7 @@ int  i;
     if (mask == 0)
         memset(&regs->tlb.acc, 0, TLBN);
     else
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES(regs); i++)
             if ((regs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->tlbID)
                 regs->tlb.acc[i] &= mask;
 
@@ -1894,7 +2000,7 @@ int  i;
         if (mask == 0)
             memset(&GUESTREGS->tlb.acc, 0, TLBN);
         else
-            for (i = 0; i < TLBN; i++)
+            for (i = 0; i < TLB_ENTRIES(GUESTREGS); i++)
                 if ((GUESTREGS->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == GUESTREGS->tlbID)
                     GUESTREGS->tlb.acc[i] &= mask;
     }
@@ -1906,7 +2012,7 @@ int  i;
         if (mask == 0)
             memset(&HOSTREGS->tlb.acc, 0, TLBN);
         else
-            for (i = 0; i < TLBN; i++)
+            for (i = 0; i < TLB_ENTRIES(HOSTREGS); i++)
                 if ((HOSTREGS->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == HOSTREGS->tlbID)
                     HOSTREGS->tlb.acc[i] &= mask;
     }
@@ -1931,7 +2037,8 @@ int  i;
 /*    the tlb (removing hash).  This is done using MAINADDR() macro. */
 /* NOTES:                                                            */
 /*   TLB_VADDR does not contain all the effective address bits and   */
-/*   must be created on-the-fly using the tlb index (i << shift).    */
+/*   must be created on-the-fly using the tlb set number, which is   */
+/*   the tlb index masked with tlbsetmask (shifted by shift bits).   */
 /*   TLB_VADDR also contains the tlbid, so the regs->tlbid is merged */
 /*   with the main input variable before the search is begun.        */
 /*-------------------------------------------------------------------*/
@@ -1951,9 +2058,9 @@ void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
 
     INVALIDATE_AIA_MAIN(regs, main);
     shift = regs->arch_mode == ARCH_370_IDX ? 11 : 12;
-    for (i = 0; i < TLBN; i++)
+    for (i = 0; i < TLB_ENTRIES(regs); i++)
         if (MAINADDR(regs->tlb.main[i],
-                     (regs->tlb.TLB_VADDR(i) | (i << shift)))
+                     (regs->tlb.TLB_VADDR(i) | ((i & regs->tlbsetmask) << shift)))
                      == mainwid)
         {
             regs->tlb.acc[i] = 0;
@@ -1969,9 +2076,9 @@ void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     {
         INVALIDATE_AIA_MAIN(GUESTREGS, main);
         shift = GUESTREGS->arch_mode == ARCH_370_IDX ? 11 : 12;
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES(GUESTREGS); i++)
             if (MAINADDR(GUESTREGS->tlb.main[i],
-                         (GUESTREGS->tlb.TLB_VADDR(i) | (i << shift)))
+                         (GUESTREGS->tlb.TLB_VADDR(i) | ((i & GUESTREGS->tlbsetmask) << shift)))
                          == mainwid)
             {
                 GUESTREGS->tlb.acc[i] = 0;
@@ -1987,9 +2094,9 @@ void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     {
         INVALIDATE_AIA_MAIN(HOSTREGS, main);
         shift = HOSTREGS->arch_mode == ARCH_370_IDX ? 11 : 12;
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLB_ENTRIES(HOSTREGS); i++)
             if (MAINADDR(HOSTREGS->tlb.main[i],
-                         (HOSTREGS->tlb.TLB_VADDR(i) | (i << shift)))
+                         (HOSTREGS->tlb.TLB_VADDR(i) | ((i & HOSTREGS->tlbsetmask) << shift)))
                          == mainwid)
             {
                 HOSTREGS->tlb.acc[i] = 0;
@@ -2197,7 +2304,7 @@ _LOGICAL_C_STATIC BYTE *ARCH_DEP(logical_to_main_l) (VADR addr, int arn,
 {
 RADR    aaddr;                          /* Absolute address          */
 RADR    apfra;                          /* Abs page frame address    */
-int     ix = TLBIX(addr);               /* TLB index                 */
+int     ix;                             /* TLB index                 */
 
     /* Convert logical address to real address */
     if ( (REAL_MODE(&regs->psw) || arn == USE_REAL_ADDR)
@@ -2220,6 +2327,7 @@ int     ix = TLBIX(addr);               /* TLB index                 */
         regs->dat.rpfra = addr & PAGEFRAME_PAGEMASK;
 
         /* Setup `real' TLB entry (for MADDR) */
+        ARCH_DEP( tlb_lookup )( addr, TLB_REAL_ASD, regs, &ix );
         regs->tlb.TLB_ASD(ix)   = TLB_REAL_ASD;
         regs->tlb.TLB_VADDR(ix) = (addr & TLBID_PAGEMASK) | regs->tlbID;
         regs->tlb.TLB_PTE(ix)   = addr & TLBID_PAGEMASK;
@@ -2230,6 +2338,7 @@ int     ix = TLBIX(addr);               /* TLB index                 */
     else {
         if (ARCH_DEP(translate_addr) (addr, arn, regs, acctype))
             goto vabs_prog_check;
+        ix = regs->dat.tlbix;
     }
 
     if (regs->dat.protect
@@ -14,6 +14,84 @@
 /*   that use this header file.                                      */
 /*-------------------------------------------------------------------*/
 
+/*-------------------------------------------------------------------*/
+/*                           tlb_probe                               */
+/*-------------------------------------------------------------------*/
+/* Search the ways of the TLB set for a logical address for an entry */
+/* which satisfies the requested access without a new translation.  */
+/*                                                                   */
+/* Input:                                                            */
+/*      addr    Logical address to be translated                     */
+/*      aea_crn AEA control register number of the address space,   */
+/*              or zero if the TLB cannot be used                    */
+/*      regs    Pointer to the CPU register context                  */
+/*      acctype Type of access requested                             */
+/*      akey    Bits 0-3=access key, 4-7=zeroes                      */
+/*                                                                   */
+/* Returns:                                                          */
+/*      Index of the matching TLB entry, or -1 for a TLB miss.       */
+/*-------------------------------------------------------------------*/
+static inline int ARCH_DEP( tlb_probe )
+    ( VADR addr, int aea_crn, REGS* regs, const int acctype, const BYTE akey )
+{
+    /* Note: ALL of the below conditions must be true for a TLB hit
+       to occur.  If ANY of them are false, then it's a TLB miss,
+       requiring us to then perform a full DAT address translation.
+
+       Note too that on the grand scheme of things the order/sequence
+       of the below tests (if statements) is completely unimportant
+       since ALL conditions must be checked anyway in order for a hit
+       to occur, and it doesn't matter that a miss tests a few extra
+       conditions since it's going to do a full translation anyway!
+       (which is many, many instructions)
+    */
+
+    int  tlbix    = TLBIX( regs, addr );
+    U32  ways     = regs->tlbways;
+
+    /* Non-zero AEA Control Register number? */
+    if (!aea_crn)
+        return -1;
+
+    do
+    {
+        /* Same Addess Space Designator as before? */
+        /* Or if not, is address in a common segment? */
+        if (0
+            || (regs->CR( aea_crn ) == regs->tlb.TLB_ASD( tlbix ))
+            || (regs->AEA_COMMON( aea_crn ) & regs->tlb.common[ tlbix ])
+        )
+        {
+            /* Storage Key zero? */
+            /* Or if not, same Storage Key as before? */
+            if (0
+                || akey == 0
+                || akey == regs->tlb.skey[ tlbix ]
+            )
+            {
+                /* Does the page address match the one in the TLB? */
+                /* (does a TLB entry exist for this page address?) */
+                if (
+                    ((addr & TLBID_PAGEMASK) | regs->tlbID)
+                    ==
+                    regs->tlb.TLB_VADDR( tlbix )
+                )
+                {
+                    /* Is storage being accessed same way as before? */
+                    if (acctype & regs->tlb.acc[ tlbix ])
+                        return tlbix;
+                }
+            }
+        }
+
+        /* Try the same set's entry in the next way */
+        tlbix += regs->tlbsets;
+    }
+    while (--ways);
+
+    return -1;
+}
+
 /*-------------------------------------------------------------------*/
 /*                           maddr_l                                 */
 /*-------------------------------------------------------------------*/
@@ -65,69 +143,34 @@
 static inline  BYTE* ARCH_DEP( maddr_l )
     ( VADR addr, size_t len, const int arn, REGS* regs, const int acctype, const BYTE akey )
 {
-    /* Note: ALL of the below conditions must be true for a TLB hit
-       to occur.  If ANY of them are false, then it's a TLB miss,
-       requiring us to then perform a full DAT address translation.
-
-       Note too that on the grand scheme of things the order/sequence
-       of the below tests (if statements) is completely unimportant
-       since ALL conditions must be checked anyway in order for a hit
-       to occur, and it doesn't matter that a miss tests a few extra
-       conditions since it's going to do a full translation anyway!
-       (which is many, many instructions)
-    */
-
     int  aea_crn  = (arn >= USE_ARMODE) ? 0 : regs->AEA_AR( arn );
-    U16  tlbix    = TLBIX( addr );
-    BYTE *maddr   = NULL;
+    int  tlbix    = ARCH_DEP( tlb_probe )( addr, aea_crn, regs, acctype, akey );
+    BYTE *maddr;
 
-    /* Non-zero AEA Control Register number? */
-    if (aea_crn)
+    if (tlbix >= 0)
     {
-        /* Same Addess Space Designator as before? */
-        /* Or if not, is address in a common segment? */
-        if (0
-            || (regs->CR( aea_crn ) == regs->tlb.TLB_ASD( tlbix ))
-            || (regs->AEA_COMMON( aea_crn ) & regs->tlb.common[ tlbix ])
-        )
-        {
-            /* Storage Key zero? */
-            /* Or if not, same Storage Key as before? */
-            if (0
-                || akey == 0
-                || akey == regs->tlb.skey[ tlbix ]
-            )
-            {
-                /* Does the page address match the one in the TLB? */
-                /* (does a TLB entry exist for this page address?) */
-                if (
-                    ((addr & TLBID_PAGEMASK) | regs->tlbID)
-                    ==
-                    regs->tlb.TLB_VADDR( tlbix )
-                )
-                {
-                    /* Is storage being accessed same way as before? */
-                    if (acctype & regs->tlb.acc[ tlbix ])
-                    {
-                        /*------------------------------------------*/
-                        /* TLB hit: use previously translated value */
-                        /*------------------------------------------*/
+        /*------------------------------------------*/
+        /* TLB hit: use previously translated value */
+        /*------------------------------------------*/
 
-                        if (acctype & ACC_CHECK)
-                            regs->dat.storkey = regs->tlb.storkey[ tlbix ];
+        if (acctype & ACC_CHECK)
+            regs->dat.storkey = regs->tlb.storkey[ tlbix ];
 
-                        maddr = MAINADDR( regs->tlb.main[tlbix], addr );
-                    }
-                }
-            }
-        }
+        maddr = MAINADDR( regs->tlb.main[tlbix], addr );
+        regs->tlbhits++;
     }
-
-    /*---------------------------------------*/
-    /* TLB miss: do full address translation */
-    /*---------------------------------------*/
-    if (!maddr)
+    else
+    {
+        /*---------------------------------------*/
+        /* TLB miss: do full address translation */
+        /*---------------------------------------*/
+        regs->tlbmisses++;
         maddr = ARCH_DEP( logical_to_main_l )( addr, arn, regs, acctype, akey, len );
+    }
+
+    /* Note stores into frames holding executed instructions */
+    if (acctype & (ACC_WRITE | ACC_CHECK))
+        SMC_STORE( maddr, len );
 
 #if defined( FEATURE_073_TRANSACT_EXEC_FACILITY )
     if (FACILITY_ENABLED( 073_TRANSACT_EXEC, regs ))
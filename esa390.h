@@ -211,10 +211,32 @@ typedef struct PSW  PSW;
 /*      main, storkey, skey, read and write,                         */
 /*      and are used for accelerated address lookup (formerly AEA).  */
 /*                                                                   */
+/*  The TLB is organized as 'tlbsets' sets of 'tlbways' entries      */
+/*  each, as configured by the TLBSIZE statement. Entries are stored */
+/*  way after way: the entry for way w of set s is at index          */
+/*  s + (w * tlbsets), so way 0 is the classic direct mapped TLB.    */
+/*  Since the TLBID_PAGEMASK tag only holds the address bits above   */
+/*  the first 1024 sets, there are never fewer than TLB_MIN_SETS.    */
+/*                                                                   */
+/*  Every REGS holds TLBN entries whatever TLBSIZE selects, at 44    */
+/*  bytes each on a 64-bit host (44K for 1024, 176K for 4096), so    */
+/*  the default build keeps the classic 1024 entry TLB. Build with   */
+/*  TLBN defined as 2048 or 4096 to allow a larger TLBSIZE.          */
+/*                                                                   */
 /*-------------------------------------------------------------------*/
 
-#define TLBN            1024            /* Number TLB entries        */
-#define TLB_MASK        0x3FF           /* Mask for 1024 entries     */
+#if !defined( TLBN )
+#define TLBN            1024            /* Maximum TLB entries       */
+#endif
+#define TLB_MIN_SETS    1024            /* Minimum number of sets    */
+#if TLBN < TLB_MIN_SETS || TLBN > 4096 || (TLBN & (TLBN - 1))
+  #error TLBN must be 1024, 2048 or 4096
+#endif
+#define TLB_MAX_WAYS    4               /* Maximum associativity     */
+#define DEF_TLB_ENTRIES 1024            /* Default TLB entries       */
+#define DEF_TLB_WAYS    1               /* Default associativity     */
+#define TLB_FILTER_SHIFT 12             /* log2 of page filter bits  */
+#define TLB_FILTER_BITS (1 << TLB_FILTER_SHIFT)
 #define TLB_REAL_ASD_L  0xFFFFFFFF      /* ASD values for real mode  */
 #define TLB_REAL_ASD_G  0xFFFFFFFFFFFFFFFFULL
 #define TLB_HOST_ASD    0x800           /* Host entry for XC guest   */
@@ -255,6 +277,7 @@ struct DAT
     RADR    asd;            /* Address space designator: STD or ASCE */
     int     stid;           /* Address space indicator               */
     BYTE   *storkey;        /* ->Storage key                         */
+    int     tlbix;          /* TLB entry used for this translation   */
     U16     xcode;          /* Translation exception code            */
     u_int   pvtaddr:1,      /* 1=Private address space               */
             protect:2;      /* 1=Page prot, 2=ALE prot               */
@@ -6094,11 +6094,17 @@ int     page_offset;                    /* Low order bits of R2      */
                when referenced next */
             STORKEY_INVALIDATE(regs, n);
 
+            /* Invalidate anything cached for code in this frame */
+            SMC_STORE(regs->mainstor + aaddr, 1);
+
         }
 
         /* Clear Frame Control */
         if(regs->GR_L(r1) & PFMF_FMFI_CF)
+        {
+            SMC_STORE(regs->mainstor + aaddr, PAGEFRAME_PAGESIZE);
             memset(regs->mainstor + aaddr, 0, PAGEFRAME_PAGESIZE);
+        }
 
         /* Update r2 - point to the next frame */
         switch (PFMF_FMFI_FSC & regs->GR_L(r1)) {
@@ -505,6 +505,7 @@ int fba_dasd_read_blkgrp (DEVBLK *dev, int blkgrp, BYTE *unitstat)
 {
 int             rc;                     /* Return code               */
 int             i, o;                   /* Cache indexes             */
+U64             key;                    /* Cache key of block group  */
 int             len;                    /* Length to read            */
 off_t           offset;                 /* File offsets              */
 
@@ -528,9 +529,9 @@ off_t           offset;                 /* File offsets              */
                    dev->filename, "lseek()", strerror( errno ));
             dev->sense[0] = SENSE_EC;
             *unitstat = CSW_CE | CSW_DE | CSW_UC;
-            cache_lock(CACHE_DEVBUF);
+            cache_lock_entry(CACHE_DEVBUF, dev->cache);
             cache_setflag(CACHE_DEVBUF, dev->cache, ~FBA_CACHE_ACTIVE, 0);
-            cache_unlock(CACHE_DEVBUF);
+            cache_unlock_entry(CACHE_DEVBUF, dev->cache);
             dev->bufupdlo = dev->bufupdhi = 0;
             dev->bufcur = dev->cache = -1;
             return -1;
@@ -547,9 +548,9 @@ off_t           offset;                 /* File offsets              */
                    dev->filename, "write()", strerror( errno ));
             dev->sense[0] = SENSE_EC;
             *unitstat = CSW_CE | CSW_DE | CSW_UC;
-            cache_lock(CACHE_DEVBUF);
+            cache_lock_entry(CACHE_DEVBUF, dev->cache);
             cache_setflag(CACHE_DEVBUF, dev->cache, ~FBA_CACHE_ACTIVE, 0);
-            cache_unlock(CACHE_DEVBUF);
+            cache_unlock_entry(CACHE_DEVBUF, dev->cache);
             dev->bufupdlo = dev->bufupdhi = 0;
             dev->bufcur = dev->cache = -1;
             return -1;
@@ -558,31 +559,33 @@ off_t           offset;                 /* File offsets              */
         dev->bufupdlo = dev->bufupdhi = 0;
     }
 
-    cache_lock (CACHE_DEVBUF);
-
     /* Make the previous cache entry inactive */
     if (dev->cache >= 0)
+    {
+        cache_lock_entry(CACHE_DEVBUF, dev->cache);
         cache_setflag(CACHE_DEVBUF, dev->cache, ~FBA_CACHE_ACTIVE, 0);
+        cache_unlock_entry(CACHE_DEVBUF, dev->cache);
+    }
     dev->bufcur = dev->cache = -1;
 
     /* Return on special case when called by the close handler */
     if (blkgrp < 0)
-    {
-        cache_unlock (CACHE_DEVBUF);
         return 0;
-    }
+
+    key = FBA_CACHE_SETKEY(dev->devnum, blkgrp);
+    cache_lock_key (CACHE_DEVBUF, key);
 
 fba_read_blkgrp_retry:
 
     /* Search the cache */
-    i = cache_lookup (CACHE_DEVBUF, FBA_CACHE_SETKEY(dev->devnum, blkgrp), &o);
+    i = cache_lookup (CACHE_DEVBUF, key, &o);
 
     /* Cache hit */
     if (i >= 0)
     {
         cache_setflag(CACHE_DEVBUF, i, ~0, FBA_CACHE_ACTIVE);
         cache_setage(CACHE_DEVBUF, i);
-        cache_unlock(CACHE_DEVBUF);
+        cache_unlock_key(CACHE_DEVBUF, key);
 
         // "%1d:%04X FBA file %s: read blkgrp %d cache hit, using cache[%d]"
         LOGDEVTR( HHC00516, "I", dev->filename, blkgrp, i );
@@ -604,7 +607,7 @@ fba_read_blkgrp_retry:
         // "%1d:%04X FBA file %s: read blkgrp %d no available cache entry, waiting"
         LOGDEVTR( HHC00517, "I", dev->filename, blkgrp );
         dev->cachewaits++;
-        cache_wait(CACHE_DEVBUF);
+        cache_wait(CACHE_DEVBUF, key);
         goto fba_read_blkgrp_retry;
     }
 
@@ -615,11 +618,11 @@ fba_read_blkgrp_retry:
     dev->cachemisses++;
 
     /* Make this cache entry active */
-    cache_setkey (CACHE_DEVBUF, o, FBA_CACHE_SETKEY(dev->devnum, blkgrp));
+    cache_setkey (CACHE_DEVBUF, o, key);
     cache_setflag(CACHE_DEVBUF, o, 0, FBA_CACHE_ACTIVE|DEVBUF_TYPE_FBA);
     cache_setage (CACHE_DEVBUF, o);
     dev->buf = cache_getbuf(CACHE_DEVBUF, o, CFBA_BLKGRP_SIZE);
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_key (CACHE_DEVBUF, key);
 
     /* Get offset and length */
     offset = (off_t)((S64)blkgrp * CFBA_BLKGRP_SIZE);
@@ -638,9 +641,9 @@ fba_read_blkgrp_retry:
                dev->filename, "lseek()", strerror( errno ));
         dev->sense[0] = SENSE_EC;
         *unitstat = CSW_CE | CSW_DE | CSW_UC;
-        cache_lock(CACHE_DEVBUF);
+        cache_lock_entry(CACHE_DEVBUF, o);
         cache_release(CACHE_DEVBUF, o, 0);
-        cache_unlock(CACHE_DEVBUF);
+        cache_unlock_entry(CACHE_DEVBUF, o);
         return -1;
     }
 
@@ -654,9 +657,9 @@ fba_read_blkgrp_retry:
                dev->filename, "read()", rc < 0 ? strerror( errno ) : "unexpected end of file" );
         dev->sense[0] = SENSE_EC;
         *unitstat = CSW_CE | CSW_DE | CSW_UC;
-        cache_lock(CACHE_DEVBUF);
+        cache_lock_entry(CACHE_DEVBUF, o);
         cache_release(CACHE_DEVBUF, o, 0);
-        cache_unlock(CACHE_DEVBUF);
+        cache_unlock_entry(CACHE_DEVBUF, o);
         return -1;
     }
 
@@ -2663,11 +2663,7 @@ BYTE    rbyte[4],                       /* Register bytes            */
 /*-------------------------------------------------------------------*/
 static INLINE U32 memneq( const BYTE* m1, const BYTE* m2, U32 len )
 {
-    U32  i;
-    for (i=0; i < len; i++)
-        if (m1[i] != m2[i])
-            break;
-    return i;
+    return (U32) mem_neq( m1, m2, len );
 }
 #endif // MEMNEQ
 
@@ -4523,9 +4519,12 @@ int     cc = 0;                         /* Condition code            */
             else
             {
                /* (1b) - Dest and source are not the sam */
-                for (i=0; i <= len; i++)
-                    if (*dest1++ ^= *source1++)
-                        cc = 1;
+                if (len >= SIMD_MIN_DIST && labs( dest1 - source1 ) >= SIMD_MIN_DIST)
+                    cc = mem_xor( dest1, source1, len + 1 );
+                else
+                    for (i=0; i <= len; i++)
+                        if (*dest1++ ^= *source1++)
+                            cc = 1;
             }
         }
         else
@@ -4689,8 +4688,7 @@ BYTE   *ip;                             /* -> executed instruction   */
     regs->ip -= ILC(regs->exinst[0]);
 
     EXECUTE_INSTRUCTION(regs->ARCH_DEP(runtime_opcode_xxxx), regs->exinst, regs);
-    regs->instcount++;
-    UPDATE_SYSBLK_INSTCOUNT( 1 );
+    UPDATE_INSTCOUNT( regs, 1 );
 
     /* Leave execflag on if pending PER so ILC will reflect EX */
     if (!OPEN_IC_PER(regs))
@@ -4793,8 +4791,7 @@ DEF_INST(execute_relative_long)
     regs->ip      -= ILC( regs->exinst[0] );
 
     EXECUTE_INSTRUCTION( regs->ARCH_DEP( runtime_opcode_xxxx ), regs->exinst, regs );
-    regs->instcount++;
-    UPDATE_SYSBLK_INSTCOUNT( 1 );
+    UPDATE_INSTCOUNT( regs, 1 );
 
     /* Leave execflag on if pending PER so ILC will reflect EXRL */
     if (!OPEN_IC_PER( regs ))
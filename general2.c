@@ -1740,8 +1740,14 @@ BYTE   *dest, *dest2 = NULL, *tab, *tab2; /* Mainstor pointers       */
     {
         tab = MADDRL(effective_addr2, 256, b2, regs, ACCTYPE_READ, regs->psw.pkey );
         /* Perform translate function */
-        for (i=0; i <= len;  i++) dest [i] = tab[dest [i]];
-        for (i=0; i <= len2; i++) dest2[i] = tab[dest2[i]];
+        if (tab + 256 <= dest || dest + len + 1 <= tab)
+            mem_tr( dest, len + 1, tab );
+        else
+            for (i=0; i <= len;  i++) dest [i] = tab[dest [i]];
+        if (dest2 && (tab + 256 <= dest2 || dest2 + len2 + 1 <= tab))
+            mem_tr( dest2, len2 + 1, tab );
+        else
+            for (i=0; i <= len2; i++) dest2[i] = tab[dest2[i]];
     }
     else /* Translate table spans a boundary */
     {
@@ -1837,9 +1843,8 @@ bool    op1crosses, op2crosses;         /* Operand crosses Page Bdy  */
        }
        else /* BEST case: NEITHER operand crosses a page boundary */
        {
-            for (i=0; i <= len; i++)
-                if ((sbyte = op2[ op1[i] ]))
-                    break;
+            if ((i = (int) mem_trt( op1, len + 1, op2 )) <= len)
+                sbyte = op2[ op1[i] ];
        }
     }
 
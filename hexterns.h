@@ -67,6 +67,7 @@ int  configure_memlock(int);
 int  configure_memfree(int);
 int  configure_storage( U64 /* number of 4K pages */ );
 int  configure_xstorage(U64);
+int  configure_tlb( U32 entries, U32 ways );
 U64  adjust_mainsize( int archnum, U64 mainsize );
 
 int  configure_shrdport(U16 shrdport);
@@ -255,6 +256,12 @@ IMPL_DLL_IMPORT COMMANDHANDLER getCommandHandler(void);
 
 /* Functions in module timer.c */
 void* timer_thread( void* argp );
+int pswsamp_histogram( PSWHIST** tab, int shift, U64* total, U64* waits );
+const char* pswsamp_state( BYTE flags );
+void cputelem_snapshot( int cpu, CPUTELEM* snap, U64 now );
+const char* cputelem_state( U64 state );
+int cputelem_start( const char* target, U32 msecs );
+void cputelem_stop();
 #if defined( _FEATURE_073_TRANSACT_EXEC_FACILITY )
 void* rubato_thread( void* argp );
 #endif
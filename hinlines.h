@@ -233,21 +233,114 @@ static inline void store_scsw_as_csw( const REGS* regs, const SCSW* scsw )
     /* Update storage key for reference and change done by caller */
 }
 
+/*-------------------------------------------------------------------*/
+/*                      Per-CPU telemetry                            */
+/*-------------------------------------------------------------------*/
+/* Each CPU thread is the only writer of its own CPUTELEM block, so  */
+/* its counters are updated with a relaxed load and store instead of */
+/* a locked read-modify-write.  The state times are additionally     */
+/* bracketed by a sequence number which is odd while they are being  */
+/* changed, letting a reader (see cputelem_snapshot) retry until it  */
+/* has a consistent copy without ever delaying the CPU.              */
+/*-------------------------------------------------------------------*/
+#if defined( HAVE_ATOMIC_INTRINSICS )
+  #define CPUTELEM_LOAD( _p )       __atomic_load_n( (_p), __ATOMIC_RELAXED )
+  #define CPUTELEM_STORE( _p, _v )  __atomic_store_n( (_p), (_v), __ATOMIC_RELAXED )
+  #define CPUTELEM_RELEASE()        __atomic_thread_fence( __ATOMIC_RELEASE )
+  #define CPUTELEM_ACQUIRE()        __atomic_thread_fence( __ATOMIC_ACQUIRE )
+#else
+  #define CPUTELEM_LOAD( _p )       (*(volatile U64*)(_p))
+  #define CPUTELEM_STORE( _p, _v )  (*(volatile U64*)(_p) = (_v))
+  #define CPUTELEM_RELEASE()        HARDWARE_SYNC()
+  #define CPUTELEM_ACQUIRE()        HARDWARE_SYNC()
+#endif
+
+#define CPUTELEM_ADD( _regs, _field, _count )                        \
+  do {                                                               \
+    CPUTELEM* _t = &sysblk.cputelem[ (_regs)->cpuad ];               \
+    CPUTELEM_STORE( &_t->_field, _t->_field + (_count) );            \
+  } while (0)
+
+/* Host monotonic clock in nanoseconds */
+static inline U64 host_nanos()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/* Start a new telemetry period for a CPU whose thread is starting */
+static inline void cputelem_reset( int cpu )
+{
+    CPUTELEM* t = &sysblk.cputelem[ cpu ];
+
+    CPUTELEM_STORE( &t->seq, t->seq + 1 );
+    CPUTELEM_RELEASE();
+    CPUTELEM_STORE( &t->instcount, 0 );
+    CPUTELEM_STORE( &t->intcount,  0 );
+    memset( (void*) t->ns, 0, sizeof( t->ns ));
+    CPUTELEM_STORE( &t->since, host_nanos() );
+    CPUTELEM_STORE( &t->state, CPUTELEM_STOPPED );
+    CPUTELEM_RELEASE();
+    CPUTELEM_STORE( &t->seq, t->seq + 1 );
+}
+
+/* Charge the time since the last change to the CPU's current state,
+   switch it to a new state and return the one it was in before */
+static inline U64 cputelem_enter( REGS* regs, U64 state )
+{
+    CPUTELEM* t    = &sysblk.cputelem[ regs->cpuad ];
+    U64       prev = t->state;
+    U64       now;
+
+    if (prev == state)
+        return prev;
+
+    now = host_nanos();
+
+    CPUTELEM_STORE( &t->seq, t->seq + 1 );
+    CPUTELEM_RELEASE();
+    CPUTELEM_STORE( &t->ns[ prev ], t->ns[ prev ] + (now - t->since) );
+    CPUTELEM_STORE( &t->since, now );
+    CPUTELEM_STORE( &t->state, state );
+    CPUTELEM_RELEASE();
+    CPUTELEM_STORE( &t->seq, t->seq + 1 );
+
+    return prev;
+}
+
 /*-------------------------------------------------------------------*/
 /* Synchronize CPUS                                                  */
 /*-------------------------------------------------------------------*/
 /*                                                                   */
 /* Locks                                                             */
 /*      INTLOCK(regs)                                                */
+/*                                                                   */
+/* Every other started CPU is asked to take an interrupt check. A    */
+/* CPU that then calls OBTAIN_INTLOCK(regs) flags itself with its    */
+/* 'intwait' field and blocks on the intlock we hold, so the flag    */
+/* is its acknowledgement: once all have acknowledged we may proceed */
+/* without ever handing the intlock around.                          */
+/*                                                                   */
+/* A CPU that is blocked elsewhere (such as on OBTAIN_INTLOCK(NULL)  */
+/* in the channel subsystem) never raises the flag. If not all have  */
+/* acknowledged after SYNC_SPIN_USECS, we fall back to releasing     */
+/* the intlock until each remaining CPU reaches its sync point in    */
+/* Interrupt_Lock_Obtained or CPU_Wait.                              */
 /*-------------------------------------------------------------------*/
+#define SYNC_SPIN_USECS     100         /* Acknowledgement spin time */
+
 #define SYNCHRONIZE_CPUS( _regs )   synchronize_cpus( _regs, PTT_LOC )
 static inline void synchronize_cpus( REGS* regs, const char* location )
 {
     int i, n = 0;
     REGS*  i_regs;
+    U64    start;
 
     CPU_BITMAP mask = sysblk.started_mask;
 
+    ++HOSTREGS->syncs;
+
     /* Deselect current processor and waiting processors from mask */
     mask &= ~(sysblk.waiting_mask | HOSTREGS->cpubit);
 
@@ -268,6 +361,7 @@ static inline void synchronize_cpus( REGS* regs, const char* location )
             {
                 /* Update count of active processors */
                 ++n;
+                ++i_regs->synced;
 
                 /* Test and set interrupt pending conditions */
                 ON_IC_INTERRUPT( i_regs );
@@ -278,24 +372,62 @@ static inline void synchronize_cpus( REGS* regs, const char* location )
         }
     }
 
-    /* If any interrupts are pending with active processors, other than
-     * self, open an interrupt window for those processors prior to
-     * considering self as synchronized.
+    if (!n || !mask)
+        return;
+
+    start = host_tod();
+    sysblk.sync_mask = mask;
+    sysblk.syncing   = true;
+
+    /* Wait for each active processor to acknowledge by blocking on
+     * the intlock we hold. Yield while waiting in case one of them
+     * needs our host processor to get there.
      */
-    if (n && mask)
+    for (;;)
     {
+        for (i=0; mask && i < sysblk.hicpu; ++i)
+            if ((mask & CPU_BIT( i )) && AT_SYNCPOINT( sysblk.regs[i] ))
+                mask ^= CPU_BIT(i);
+
         sysblk.sync_mask = mask;
-        sysblk.syncing   = true;
+
+        if (!mask || host_tod() - start > SYNC_SPIN_USECS * ETOD_USEC)
+            break;
+
+        sched_yield();
+    }
+
+    /* If any processors did not acknowledge, open an interrupt window
+     * for those processors prior to considering self as synchronized.
+     */
+    if (mask)
+    {
+        U64 state = cputelem_enter( HOSTREGS, CPUTELEM_SPIN );
+
+        ++HOSTREGS->syncslow;
 
         sysblk.intowner  = LOCK_OWNER_NONE;
         {
-            hthread_wait_condition( &sysblk.all_synced_cond, &sysblk.intlock, location );
+            while (sysblk.sync_mask)
+                hthread_wait_condition( &sysblk.all_synced_cond, &sysblk.intlock, location );
         }
         sysblk.intowner  = HOSTREGS->cpuad;
 
-        sysblk.syncing   = false;
-        hthread_broadcast_condition( &sysblk.sync_done_cond, location );
+        cputelem_enter( HOSTREGS, state );
     }
+#if defined( HARDWARE_SYNC )
+    else
+        /* See everything they stored before acknowledging */
+        HARDWARE_SYNC();
+#endif
+
+    sysblk.syncing   = false;
+
+    if (mask)
+        hthread_broadcast_condition( &sysblk.sync_done_cond, location );
+
+    HOSTREGS->synctime += host_tod() - start;
+
     /* All active processors other than self, are now waiting at their
      * respective sync point. We may now safely proceed doing whatever
      * it is we need to do.
@@ -390,7 +522,12 @@ static inline void Interrupt_Lock_Obtained( REGS* regs, const char* location )
 {
     if (regs)
     {
+        U64  state = CPUTELEM_SPIN;
+
         /* Wait for any SYNCHRONIZE_CPUS to finish before proceeding */
+        if (sysblk.syncing)
+            state = cputelem_enter( HOSTREGS, CPUTELEM_SPIN );
+
         while (sysblk.syncing)
         {
             /* Indicate we have reached the sync point */
@@ -409,6 +546,9 @@ static inline void Interrupt_Lock_Obtained( REGS* regs, const char* location )
             hthread_wait_condition( &sysblk.sync_done_cond, &sysblk.intlock, location );
         }
 
+        if (state != CPUTELEM_SPIN)
+            cputelem_enter( HOSTREGS, state );
+
         HOSTREGS->intwait = false;
         sysblk.intowner = HOSTREGS->cpuad;
     }
@@ -420,9 +560,22 @@ static inline void Interrupt_Lock_Obtained( REGS* regs, const char* location )
 
 static inline void Obtain_Interrupt_Lock( REGS* regs, const char* location )
 {
-    if (regs)
+    U64  state;
+
+    if (!regs)
+        hthread_obtain_lock( &sysblk.intlock, location );
+    else
+    {
         HOSTREGS->intwait = true;
-    hthread_obtain_lock( &sysblk.intlock, location );
+
+        /* Time a CPU spends blocked on the lock is spin time */
+        if (hthread_try_obtain_lock( &sysblk.intlock, location ) != 0)
+        {
+            state = cputelem_enter( HOSTREGS, CPUTELEM_SPIN );
+            hthread_obtain_lock( &sysblk.intlock, location );
+            cputelem_enter( HOSTREGS, state );
+        }
+    }
     Interrupt_Lock_Obtained( regs, location );
 }
 
@@ -431,12 +584,10 @@ static inline void Obtain_Interrupt_Lock( REGS* regs, const char* location )
 static inline int Try_Obtain_Interrupt_Lock( REGS* regs, const char* location )
 {
     int rc;
-    if (regs)
-        HOSTREGS->intwait = true;
+    /* Don't set intwait: we never block here, so we are never at a
+       sync point, and a fleeting intwait could be mistaken for one */
     if ((rc = hthread_try_obtain_lock( &sysblk.intlock, location )) == 0)
         Interrupt_Lock_Obtained( regs, location );
-    else if (regs)
-        HOSTREGS->intwait = false;
     return rc;
 }
 
@@ -480,6 +631,38 @@ static inline void atomic_update64( volatile S64* p, S64 count )
   WARNING( "Missing atomic 32/64 bit increment support!" )
 #endif
 
+/*-------------------------------------------------------------------*/
+/*     Atomically OR/AND 32-bit value, returning its prior value     */
+/*-------------------------------------------------------------------*/
+static inline U32 atomic_or32( volatile U32* p, U32 bits )
+{
+#if defined( _MSVC_ )
+    return (U32) _InterlockedOr( (volatile LONG*) p, (LONG) bits );
+#else // GCC (and CLANG?)
+  #if defined( HAVE_SYNC_BUILTINS )
+    return __sync_fetch_and_or( p, bits );
+  #else
+    U32 old = *p;
+    *p = old | bits;  /* (N.B. non-atomic!) */
+    return old;
+  #endif
+#endif
+}
+static inline U32 atomic_and32( volatile U32* p, U32 bits )
+{
+#if defined( _MSVC_ )
+    return (U32) _InterlockedAnd( (volatile LONG*) p, (LONG) bits );
+#else // GCC (and CLANG?)
+  #if defined( HAVE_SYNC_BUILTINS )
+    return __sync_fetch_and_and( p, bits );
+  #else
+    U32 old = *p;
+    *p = old & bits;  /* (N.B. non-atomic!) */
+    return old;
+  #endif
+#endif
+}
+
 /*-------------------------------------------------------------------*/
 /*           Atomically update SYSBLK Instruction Counter            */
 /*-------------------------------------------------------------------*/
@@ -487,6 +670,17 @@ static inline void atomic_update64( volatile S64* p, S64 count )
 #define UPDATE_SYSBLK_INSTCOUNT( _count ) \
         atomic_update64( &sysblk.instcount, (_count) )
 
+/*-------------------------------------------------------------------*/
+/*    Update CPU, SYSBLK and CPU telemetry instruction counters      */
+/*-------------------------------------------------------------------*/
+
+#define UPDATE_INSTCOUNT( _regs, _count )                            \
+  do {                                                               \
+    (_regs)->instcount += (_count);                                  \
+    UPDATE_SYSBLK_INSTCOUNT( (_count) );                             \
+    CPUTELEM_ADD( (_regs), instcount, (_count) );                    \
+  } while (0)
+
 /*-------------------------------------------------------------------*/
 /* Stop ALL CPUs                                      (INTLOCK held) */
 /*-------------------------------------------------------------------*/
@@ -621,6 +815,435 @@ static inline void start_all_cpus()
     RELEASE_INTLOCK( NULL );
 }
 
+/*-------------------------------------------------------------------*/
+/*                Self-modifying code (SMC) tracking                 */
+/*-------------------------------------------------------------------*/
+/* sysblk.smcmap holds one entry per 4K frame of main storage. The   */
+/* SMC_CODE bit is set when instructions are fetched from the frame  */
+/* and is turned off again the first time the frame is modified by  */
+/* a CPU store, by channel input or by a SET STORAGE KEY. Anything   */
+/* caching information derived from a frame's instructions may rely */
+/* on it only while the frame's SMC_CODE bit remains set. The low    */
+/* order bits count how often a code frame was invalidated this way. */
+/* Tracking is only performed while sysblk.smctrack is set. CPU and  */
+/* channel threads update the map concurrently, so every update of   */
+/* an entry is atomic.                                               */
+/*-------------------------------------------------------------------*/
+#define SMC_CODE        0x80000000      /* Frame holds executed code */
+#define SMC_COUNT       0x7FFFFFFF      /* Frame invalidation count  */
+
+static inline void smc_mark_code( const BYTE* maddr )
+{
+    U64   frame = (U64)(maddr - sysblk.mainstor) >> SHIFT_4K;
+    U32*  smc;
+
+    if (frame < (sysblk.mainsize >> SHIFT_4K))
+    {
+        smc = &sysblk.smcmap[ frame ];
+
+        /* (avoid dirtying the cache line when already marked) */
+        if (!(*smc & SMC_CODE))
+            atomic_or32( smc, SMC_CODE );
+    }
+}
+
+static inline void smc_store( const BYTE* maddr, size_t len )
+{
+    U64   frames = sysblk.mainsize >> SHIFT_4K;
+    U64   frame  = (U64)(maddr - sysblk.mainstor) >> SHIFT_4K;
+    U64   last   = (U64)(maddr - sysblk.mainstor + (len ? len - 1 : 0)) >> SHIFT_4K;
+    U32*  smc;
+    U32   old;
+
+    if (frame >= frames)
+        return;
+
+    if (last >= frames)
+        last = frames - 1;
+
+    for (; frame <= last; frame++)
+    {
+        smc = &sysblk.smcmap[ frame ];
+
+        if (unlikely( *smc & SMC_CODE ))
+        {
+            /* Only the thread that turns the bit off counts it */
+            old = atomic_and32( smc, SMC_COUNT );
+
+            if (old & SMC_CODE)
+            {
+                if ((old & SMC_COUNT) != SMC_COUNT)
+                    atomic_update32( (volatile S32*) smc, 1 );
+
+                atomic_update64( (volatile S64*) &sysblk.smcinvals, 1 );
+            }
+        }
+    }
+}
+
+#define SMC_MARK_CODE( _maddr )                                       \
+    do {                                                              \
+        if (unlikely( sysblk.smctrack ))                              \
+            smc_mark_code( (_maddr) );                                \
+    } while (0)
+
+#define SMC_STORE( _maddr, _len )                                     \
+    do {                                                              \
+        if (unlikely( sysblk.smctrack ))                              \
+            smc_store( (_maddr), (_len) );                            \
+    } while (0)
+
+/*-------------------------------------------------------------------*/
+/*                  Host SIMD operand kernels                        */
+/*-------------------------------------------------------------------*/
+/* Inner loops of the MVC, MVCL, CLCL, TR, TRT and XC storage-to-    */
+/* storage instructions for operands contained within a page. (CLC   */
+/* uses memcmp, which the C library already vectorizes.)             */
+/* Each kernel comes in a portable scalar flavour and, on x86 hosts, */
+/* SSE2 and AVX2 flavours; all flavours give identical results.      */
+/* sysblk.hostsimd selects the flavour used: it is initialized to    */
+/* host_simd_level() at startup and may be changed by 'simd'.        */
+/*                                                                   */
+/* mem_copy and mem_xor process several bytes at a time. Callers     */
+/* must ensure the operands are at least SIMD_MIN_DIST bytes apart   */
+/* so that the result is the same as when moving byte by byte.       */
+/*-------------------------------------------------------------------*/
+#define HOST_SIMD_SCALAR    0           /* Portable C kernels        */
+#define HOST_SIMD_SSE2      1           /* 16-byte SSE2 kernels      */
+#define HOST_SIMD_AVX2      2           /* 32-byte AVX2 kernels      */
+
+#define SIMD_MIN_DIST       32          /* Min. mem_copy/mem_xor
+                                           operand distance          */
+
+#if defined( __GNUC__ ) && (defined( __x86_64__ ) || defined( __i386__ ))
+  #define _HOST_SIMD_
+  #define SIMD_SSE2_FUNC    __attribute__(( target( "sse2" )))
+  #define SIMD_AVX2_FUNC    __attribute__(( target( "avx2" )))
+  #define simd_ctz( _m )    __builtin_ctz( _m )
+#elif defined( _MSVC_ ) && defined( _M_X64 )
+  #define _HOST_SIMD_
+  #define SIMD_SSE2_FUNC
+  #define SIMD_AVX2_FUNC
+  static inline int simd_ctz( U32 m )
+  {
+      unsigned long  i;
+      _BitScanForward( &i, m );
+      return (int) i;
+  }
+#endif
+
+/* Best kernel flavour supported by both this build and the host */
+static inline BYTE host_simd_level()
+{
+#if defined( _HOST_SIMD_ )
+    if (hostinfo.cpu_avx2) return HOST_SIMD_AVX2;
+    if (hostinfo.cpu_sse2) return HOST_SIMD_SSE2;
+#endif
+    return HOST_SIMD_SCALAR;
+}
+
+/*-------------------------------------------------------------------*/
+/* Scalar kernels (also used for the tails of the SIMD kernels)      */
+/*-------------------------------------------------------------------*/
+
+/* Copy n bytes left to right, a doubleword at a time */
+static inline void mem_copy_scalar( BYTE* d, const BYTE* s, size_t n )
+{
+    U64  dw;
+
+    for (; n >= 8; d += 8, s += 8, n -= 8)
+    {
+        memcpy( &dw, s, 8 );
+        memcpy( d, &dw, 8 );
+    }
+    for (; n; n--)
+        *d++ = *s++;
+}
+
+/* Exclusive-or n bytes into d; returns 1 if any result is nonzero */
+static inline int mem_xor_scalar( BYTE* d, const BYTE* s, size_t n )
+{
+    U64   dw, sw, acc = 0;
+    BYTE  b = 0;
+
+    for (; n >= 8; d += 8, s += 8, n -= 8)
+    {
+        memcpy( &dw, d, 8 );
+        memcpy( &sw, s, 8 );
+        dw ^= sw;
+        memcpy( d, &dw, 8 );
+        acc |= dw;
+    }
+    for (; n; n--)
+        b |= (*d++ ^= *s++);
+    return (acc | b) != 0;
+}
+
+/* Return index of first unequal byte, or n if all are equal */
+static inline size_t mem_neq_scalar( const BYTE* m1, const BYTE* m2, size_t n )
+{
+    size_t  i = 0;
+    U64     w1, w2;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        memcpy( &w1, m1 + i, 8 );
+        memcpy( &w2, m2 + i, 8 );
+        if (w1 != w2)
+            break;
+    }
+    for (; i < n; i++)
+        if (m1[i] != m2[i])
+            break;
+    return i;
+}
+
+/* Translate n bytes in place using a 256-byte table */
+static inline void mem_tr_scalar( BYTE* d, size_t n, const BYTE* tab )
+{
+    size_t  i;
+
+    for (i=0; i < n; i++)
+        d[i] = tab[ d[i] ];
+}
+
+/* Return index of first byte whose table entry is nonzero, or n */
+static inline size_t mem_trt_scalar( const BYTE* op, size_t n, const BYTE* tab )
+{
+    size_t  i;
+
+    for (i=0; i < n; i++)
+        if (tab[ op[i] ])
+            break;
+    return i;
+}
+
+#if defined( _HOST_SIMD_ )
+/*-------------------------------------------------------------------*/
+/* SSE2 kernels (SSE2 has no byte shuffle, so no TR or TRT kernel)   */
+/*-------------------------------------------------------------------*/
+
+SIMD_SSE2_FUNC
+static inline void mem_copy_sse2( BYTE* d, const BYTE* s, size_t n )
+{
+    for (; n >= 16; d += 16, s += 16, n -= 16)
+        _mm_storeu_si128( (__m128i*) d,
+            _mm_loadu_si128( (const __m128i*) s ));
+    mem_copy_scalar( d, s, n );
+}
+
+SIMD_SSE2_FUNC
+static inline int mem_xor_sse2( BYTE* d, const BYTE* s, size_t n )
+{
+    __m128i  v, acc = _mm_setzero_si128();
+
+    for (; n >= 16; d += 16, s += 16, n -= 16)
+    {
+        v = _mm_xor_si128( _mm_loadu_si128( (const __m128i*) d ),
+                           _mm_loadu_si128( (const __m128i*) s ));
+        _mm_storeu_si128( (__m128i*) d, v );
+        acc = _mm_or_si128( acc, v );
+    }
+    return mem_xor_scalar( d, s, n )
+        || _mm_movemask_epi8( _mm_cmpeq_epi8( acc, _mm_setzero_si128() )) != 0xFFFF;
+}
+
+SIMD_SSE2_FUNC
+static inline size_t mem_neq_sse2( const BYTE* m1, const BYTE* m2, size_t n )
+{
+    size_t  i = 0;
+    U32     m;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        m = (U32) _mm_movemask_epi8( _mm_cmpeq_epi8(
+                _mm_loadu_si128( (const __m128i*)(m1 + i) ),
+                _mm_loadu_si128( (const __m128i*)(m2 + i) )));
+        if (m != 0xFFFF)
+            return i + simd_ctz( ~m );
+    }
+    return i + mem_neq_scalar( m1 + i, m2 + i, n - i );
+}
+
+/*-------------------------------------------------------------------*/
+/* AVX2 kernels                                                      */
+/*-------------------------------------------------------------------*/
+
+SIMD_AVX2_FUNC
+static inline void mem_copy_avx2( BYTE* d, const BYTE* s, size_t n )
+{
+    for (; n >= 32; d += 32, s += 32, n -= 32)
+        _mm256_storeu_si256( (__m256i*) d,
+            _mm256_loadu_si256( (const __m256i*) s ));
+    mem_copy_scalar( d, s, n );
+}
+
+SIMD_AVX2_FUNC
+static inline int mem_xor_avx2( BYTE* d, const BYTE* s, size_t n )
+{
+    __m256i  v, acc = _mm256_setzero_si256();
+
+    for (; n >= 32; d += 32, s += 32, n -= 32)
+    {
+        v = _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*) d ),
+                              _mm256_loadu_si256( (const __m256i*) s ));
+        _mm256_storeu_si256( (__m256i*) d, v );
+        acc = _mm256_or_si256( acc, v );
+    }
+    return mem_xor_scalar( d, s, n ) || !_mm256_testz_si256( acc, acc );
+}
+
+SIMD_AVX2_FUNC
+static inline size_t mem_neq_avx2( const BYTE* m1, const BYTE* m2, size_t n )
+{
+    size_t  i = 0;
+    U32     m;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        m = (U32) _mm256_movemask_epi8( _mm256_cmpeq_epi8(
+                _mm256_loadu_si256( (const __m256i*)(m1 + i) ),
+                _mm256_loadu_si256( (const __m256i*)(m2 + i) )));
+        if (m != 0xFFFFFFFF)
+            return i + simd_ctz( ~m );
+    }
+    return i + mem_neq_scalar( m1 + i, m2 + i, n - i );
+}
+
+/* The table is split into 16 rows of 16 bytes. Each row is looked
+   up with the low nibbles of all 32 bytes at once, and the result
+   kept for those bytes whose high nibble selects that row. */
+SIMD_AVX2_FUNC
+static inline void mem_tr_avx2( BYTE* d, size_t n, const BYTE* tab )
+{
+    const __m256i  nib = _mm256_set1_epi8( 0x0F );
+    __m256i        row[16], x, lo, hi, r;
+    size_t         i = 0;
+    int            k;
+
+    if (n < 32)
+    {
+        mem_tr_scalar( d, n, tab );
+        return;
+    }
+
+    for (k=0; k < 16; k++)
+        row[k] = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128( (const __m128i*)(tab + 16*k) ));
+
+    for (; i + 32 <= n; i += 32)
+    {
+        x  = _mm256_loadu_si256( (const __m256i*)(d + i) );
+        lo = _mm256_and_si256( x, nib );
+        hi = _mm256_and_si256( _mm256_srli_epi16( x, 4 ), nib );
+        r  = _mm256_setzero_si256();
+
+        for (k=0; k < 16; k++)
+            r = _mm256_or_si256( r, _mm256_and_si256(
+                    _mm256_cmpeq_epi8( hi, _mm256_set1_epi8( (char) k )),
+                    _mm256_shuffle_epi8( row[k], lo )));
+
+        _mm256_storeu_si256( (__m256i*)(d + i), r );
+    }
+    mem_tr_scalar( d + i, n - i, tab );
+}
+
+/* TRT only needs to know which table entries are nonzero. These are
+   condensed into a 256-bit map: bit (h & 7) of byte l of map[h >> 3]
+   is on when the entry for byte value (h << 4) | l is nonzero. The
+   map bytes for 32 argument bytes are then found with one shuffle
+   per half of the map, selected by the high bit of each byte. */
+SIMD_AVX2_FUNC
+static inline size_t mem_trt_avx2( const BYTE* op, size_t n, const BYTE* tab )
+{
+    const __m256i  nib  = _mm256_set1_epi8( 0x0F );
+    const __m256i  bits = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128 );
+    __m128i        map[2], v;
+    __m256i        map0, map1, x, lo, hi, hit;
+    size_t         i = 0;
+    U32            m;
+    int            k;
+
+    if (n < 64)
+        return mem_trt_scalar( op, n, tab );
+
+    map[0] = map[1] = _mm_setzero_si128();
+
+    for (k=0; k < 16; k++)
+    {
+        v = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(tab + 16*k) ),
+                            _mm_setzero_si128() );
+        map[k >> 3] = _mm_or_si128( map[k >> 3],
+            _mm_andnot_si128( v, _mm_set1_epi8( (char)(1 << (k & 7)) )));
+    }
+    map0 = _mm256_broadcastsi128_si256( map[0] );
+    map1 = _mm256_broadcastsi128_si256( map[1] );
+
+    for (; i + 32 <= n; i += 32)
+    {
+        x   = _mm256_loadu_si256( (const __m256i*)(op + i) );
+        lo  = _mm256_and_si256( x, nib );
+        hi  = _mm256_and_si256( _mm256_srli_epi16( x, 4 ), nib );
+        hit = _mm256_and_si256( _mm256_shuffle_epi8( bits, hi ),
+                                _mm256_blendv_epi8( _mm256_shuffle_epi8( map0, lo ),
+                                                     _mm256_shuffle_epi8( map1, lo ), x ));
+        m = ~(U32) _mm256_movemask_epi8( _mm256_cmpeq_epi8( hit, _mm256_setzero_si256() ));
+        if (m)
+            return i + simd_ctz( m );
+    }
+    return i + mem_trt_scalar( op + i, n - i, tab );
+}
+#endif /* defined( _HOST_SIMD_ ) */
+
+/*-------------------------------------------------------------------*/
+/* Kernels selected by sysblk.hostsimd                               */
+/*-------------------------------------------------------------------*/
+
+static inline void mem_copy( BYTE* d, const BYTE* s, size_t n )
+{
+#if defined( _HOST_SIMD_ )
+    if (sysblk.hostsimd >= HOST_SIMD_AVX2) { mem_copy_avx2( d, s, n ); return; }
+    if (sysblk.hostsimd >= HOST_SIMD_SSE2) { mem_copy_sse2( d, s, n ); return; }
+#endif
+    mem_copy_scalar( d, s, n );
+}
+
+static inline int mem_xor( BYTE* d, const BYTE* s, size_t n )
+{
+#if defined( _HOST_SIMD_ )
+    if (sysblk.hostsimd >= HOST_SIMD_AVX2) return mem_xor_avx2( d, s, n );
+    if (sysblk.hostsimd >= HOST_SIMD_SSE2) return mem_xor_sse2( d, s, n );
+#endif
+    return mem_xor_scalar( d, s, n );
+}
+
+static inline size_t mem_neq( const BYTE* m1, const BYTE* m2, size_t n )
+{
+#if defined( _HOST_SIMD_ )
+    if (sysblk.hostsimd >= HOST_SIMD_AVX2) return mem_neq_avx2( m1, m2, n );
+    if (sysblk.hostsimd >= HOST_SIMD_SSE2) return mem_neq_sse2( m1, m2, n );
+#endif
+    return mem_neq_scalar( m1, m2, n );
+}
+
+static inline void mem_tr( BYTE* d, size_t n, const BYTE* tab )
+{
+#if defined( _HOST_SIMD_ )
+    if (sysblk.hostsimd >= HOST_SIMD_AVX2) { mem_tr_avx2( d, n, tab ); return; }
+#endif
+    mem_tr_scalar( d, n, tab );
+}
+
+static inline size_t mem_trt( const BYTE* op, size_t n, const BYTE* tab )
+{
+#if defined( _HOST_SIMD_ )
+    if (sysblk.hostsimd >= HOST_SIMD_AVX2) return mem_trt_avx2( op, n, tab );
+#endif
+    return mem_trt_scalar( op, n, tab );
+}
+
 /*-------------------------------------------------------------------*/
 #undef asm
 
@@ -65,6 +65,11 @@ DLL_EXPORT void init_hostinfo ( HOST_INFO* pHostInfo )
         pHostInfo->ullTotalPhys = (RADR)((RADR)sysconf(_SC_PAGESIZE) * (RADR)sysconf(_SC_PHYS_PAGES));
       #endif
    #endif
+   #if defined( __GNUC__ ) && (defined( __x86_64__ ) || defined( __i386__ ))
+    __builtin_cpu_init();
+    pHostInfo->cpu_sse2 = __builtin_cpu_supports( "sse2" ) ? 1 : 0;
+    pHostInfo->cpu_avx2 = __builtin_cpu_supports( "avx2" ) ? 1 : 0;
+   #endif
 #endif
 
 #if defined( __APPLE__ ) || defined( FREEBSD_OR_NETBSD )
@@ -41,6 +41,8 @@ typedef struct HOST_INFO
         int     fp_unit;                /* CPU has Floating Point    */
         int     cpu_64bits;             /* CPU is 64 bit             */
         int     cpu_aes_extns;          /* CPU supports aes extension*/
+        int     cpu_sse2;               /* CPU supports SSE2         */
+        int     cpu_avx2;               /* CPU supports AVX2         */
         int     valid_cache_nums;       /* Cache nums are obtained   */
 
         U64     bus_speed;              /* Motherboard BUS Speed   Hz*/
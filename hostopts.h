@@ -196,6 +196,11 @@
 #undef  OPTION_FBA_BLKDEVICE            /* (no FBA BLKDEVICE support)*/
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #undef  MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" same as "fOo"!!)   */
+#ifdef _MSVC_
+#undef  OPTION_POSITIONED_IO            /* (no pread/pwrite)         */
+#else // (mingw or cygwin?)
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
+#endif
 
 #define CASELESS_SYMBOLS
 
@@ -248,6 +253,7 @@
 #define DLL_EXPORT
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
 #define HOW_TO_IMPLEMENT_SH_COMMAND       USE_ANSI_SYSTEM_API_FOR_SH_COMMAND
 #define SET_CONSOLE_CURSOR_SHAPE_METHOD   CURSOR_SHAPE_NOT_SUPPORTED
 #undef  OPTION_EXTCURS                  /* Normal cursor handling    */
@@ -270,6 +276,7 @@
 #undef  OPTION_FBA_BLKDEVICE            /* (no FBA BLKDEVICE support)*/
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
 #define HOW_TO_IMPLEMENT_SH_COMMAND       USE_ANSI_SYSTEM_API_FOR_SH_COMMAND
 #define SET_CONSOLE_CURSOR_SHAPE_METHOD   CURSOR_SHAPE_NOT_SUPPORTED
 #undef  OPTION_EXTCURS                  /* Normal cursor handling    */
@@ -291,6 +298,7 @@
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported)           */
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
 #define HOW_TO_IMPLEMENT_SH_COMMAND       USE_ANSI_SYSTEM_API_FOR_SH_COMMAND
 #define SET_CONSOLE_CURSOR_SHAPE_METHOD   CURSOR_SHAPE_NOT_SUPPORTED
 #undef  OPTION_EXTCURS                  /* Normal cursor handling    */
@@ -312,6 +320,7 @@
 #define OPTION_FBA_BLKDEVICE            /* FBA block device support  */
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
 
 #if defined( HAVE_FORK )
   #define HOW_TO_IMPLEMENT_SH_COMMAND     USE_FORK_API_FOR_SH_COMMAND
@@ -322,6 +331,11 @@
 #undef  OPTION_EXTCURS                  /* Normal cursor handling    */
 #define SCANDIR_CONST_STRUCT_DIRENT     /* define if scandir uses
                                            const for struct dirent   */
+#if defined( __has_include )
+  #if __has_include( <linux/io_uring.h> )
+    #define OPTION_CCKD_IO_URING        /* io_uring cckd readahead   */
+  #endif
+#endif
 
 
 /*-------------------------------------------------------------------*/
@@ -339,6 +353,7 @@
 #define OPTION_FBA_BLKDEVICE            /* FBA block device support  */
 #define MAX_DEVICE_THREADS        255   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
 #if defined( HAVE_FORK )
   #define HOW_TO_IMPLEMENT_SH_COMMAND     USE_FORK_API_FOR_SH_COMMAND
 #else
@@ -366,6 +381,7 @@ WARNING( "unknown target platform: defaulting to generic platform settings" )
 #undef  OPTION_FBA_BLKDEVICE            /* (no FBA BLKDEVICE support)*/
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
+#define OPTION_POSITIONED_IO            /* pread/pwrite available    */
 #if defined( HAVE_FORK )
   #define HOW_TO_IMPLEMENT_SH_COMMAND     USE_FORK_API_FOR_SH_COMMAND
 #else
@@ -2176,6 +2176,230 @@ int ctc_cmd( int argc, char *argv[], char *cmdline )
     return 0;
 }
 
+/*-------------------------------------------------------------------*/
+/* lcs command - display LCS statistics                              */
+/*-------------------------------------------------------------------*/
+int lcs_cmd( int argc, char *argv[], char *cmdline )
+{
+    DEVBLK*  dev;
+    LCSDEV*  pLCSDEV;
+    LCSBLK*  pLCSBLK;
+    LCSPORT* pLCSPORT;
+    LCSCONN* pLCSCONN;
+    DEVGRP*  pDEVGRP;
+    U16      lcss;
+    U16      devnum;
+    int      i, j, k, n;
+    BYTE     found = FALSE;
+    BYTE     attn;
+    char     buf[256];
+
+    UNREFERENCED( cmdline );
+
+    UPPER_ARGV_0( argv );
+
+    // Format:  "LCS  { STATS | ATTN }  [ <devnum> | ALL ]"
+
+    if (0
+        || argc < 2
+        || argc > 3
+        || (!CMD(argv[1],stats,5) && !CMD(argv[1],attn,4))
+    )
+    {
+        // "Invalid command usage. Type 'help %s' for assistance."
+        WRMSG( HHC02299, "E", argv[0] );
+        return -1;
+    }
+
+    attn = CMD(argv[1],attn,4);
+    pDEVGRP = NULL;
+
+    if (argc == 3 && !CMD(argv[2],ALL,3))
+    {
+        if (parse_single_devnum( argv[2], &lcss, &devnum ) < 0)
+        {
+            // "Invalid command usage. Type 'help %s' for assistance."
+            WRMSG( HHC02299, "E", argv[0] );
+            return -1;
+        }
+        if (!(dev = find_device_by_devnum( lcss, devnum )))
+        {
+            // HHC02200 "%1d:%04X device not found"
+            devnotfound_msg( lcss, devnum );
+            return -1;
+        }
+        if (!dev->allocated || 0x3088 != dev->devtype || CTC_LCS != dev->ctctype)
+        {
+            // "%1d:%04X device is not a %s"
+            WRMSG( HHC02209, "E", lcss, devnum, "LCS" );
+            return -1;
+        }
+        pDEVGRP = dev->group;
+    }
+
+    for (dev = sysblk.firstdev; dev; dev = dev->nextdev)
+    {
+        // Display each complete LCS group only once, via its first device
+
+        if (0
+            || !dev->allocated
+            || 0x3088 != dev->devtype
+            || CTC_LCS != dev->ctctype
+            || !dev->group
+            || dev->group->members != dev->group->acount
+            || dev != dev->group->memdev[0]
+            || (pDEVGRP && pDEVGRP != dev->group)
+        )
+            continue;
+
+        found = TRUE;
+        pLCSBLK = ((LCSDEV*) dev->dev_data)->pLCSBLK;
+
+        for (i=0; i < LCS_MAX_PORTS; i++)
+        {
+            pLCSPORT = &pLCSBLK->Port[i];
+
+            if (!pLCSPORT->fUsed)
+                continue;
+
+            if (attn)
+            {
+                for (pLCSDEV = pLCSBLK->pDevices; pLCSDEV; pLCSDEV = pLCSDEV->pNext)
+                {
+                    if (0
+                        || pLCSDEV->bPort != pLCSPORT->bPort
+                        || pLCSDEV->bMode != LCSDEV_MODE_SNA
+                    )
+                        continue;
+
+                    MSGBUF( buf, "SNA %04X attentions raised %"PRIu64
+                        ", busy retries %"PRIu64", abandoned %"PRIu64,
+                        pLCSDEV->sAddr, pLCSDEV->uAttnRaised,
+                        pLCSDEV->uAttnBusy, pLCSDEV->uAttnLost );
+                    // "%s device %1d:%04X port %2.2X: %s"
+                    WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+                    MSGBUF( buf, "SNA %04X frames coalesced %"PRIu64
+                        ", window %d frames or %d usecs",
+                        pLCSDEV->sAddr, pLCSDEV->uAttnCoalesced,
+                        pLCSBLK->iAttnCount, pLCSBLK->iAttnWait );
+                    // "%s device %1d:%04X port %2.2X: %s"
+                    WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+                    // Attention to read latency histogram, half a line at a time
+                    for (j=0; j < LCS_ATTN_HIST_SIZE; j += LCS_ATTN_HIST_SIZE / 2)
+                    {
+                        n = MSGBUF( buf, "SNA %04X attn to read usecs", pLCSDEV->sAddr );
+                        for (k=j; k < j + LCS_ATTN_HIST_SIZE / 2; k++)
+                        {
+                            if (k < LCS_ATTN_HIST_SIZE - 1)
+                                n += snprintf( buf + n, sizeof( buf ) - n, " <%d:%"PRIu64,
+                                    LCS_ATTN_HIST_BASE << k, pLCSDEV->uAttnLatency[k] );
+                            else
+                                n += snprintf( buf + n, sizeof( buf ) - n, " >=%d:%"PRIu64,
+                                    LCS_ATTN_HIST_BASE << (k-1), pLCSDEV->uAttnLatency[k] );
+                        }
+                        // "%s device %1d:%04X port %2.2X: %s"
+                        WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+                    }
+                }
+                continue;
+            }
+
+            MSGBUF( buf, "interface %s, queues %d, receive batch size %d",
+                pLCSPORT->szNetIfName, pLCSPORT->iQueues, pLCSBLK->iRxBatch );
+            // "%s device %1d:%04X port %2.2X: %s"
+            WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+            MSGBUF( buf, "frames read %"PRIu64", wakeups %"PRIu64
+                ", frames/wakeup avg %.2f max %"PRIu32,
+                pLCSPORT->uRxFrames, pLCSPORT->uRxWakeups,
+                pLCSPORT->uRxWakeups ? (double) pLCSPORT->uRxFrames /
+                                       (double) pLCSPORT->uRxWakeups : 0.0,
+                pLCSPORT->uRxMaxBatch );
+            // "%s device %1d:%04X port %2.2X: %s"
+            WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+            for (pLCSDEV = pLCSBLK->pDevices; pLCSDEV; pLCSDEV = pLCSDEV->pNext)
+            {
+                if (pLCSDEV->bPort != pLCSPORT->bPort)
+                    continue;
+
+                if (pLCSDEV->bMode == LCSDEV_MODE_IP)
+                {
+                    MSGBUF( buf, "IP %04X bytes read %"PRIu64", copied %"PRIu64
+                        ", copies/byte %.2f, %s",
+                        pLCSDEV->sAddr, pLCSDEV->uBytesIn, pLCSDEV->uBytesCopied,
+                        pLCSDEV->uBytesIn ? (double) pLCSDEV->uBytesCopied /
+                                            (double) pLCSDEV->uBytesIn : 0.0,
+                        pLCSDEV->pFrameBuffers[0] ? "zero-copy" : "copying" );
+                    // "%s device %1d:%04X port %2.2X: %s"
+                    WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+                    continue;
+                }
+
+                MSGBUF( buf, "SNA %04X connections %d, lookups %"PRIu64
+                    ", compares/lookup avg %.2f",
+                    pLCSDEV->sAddr, pLCSDEV->iLCSCONNCount,
+                    pLCSDEV->uLCSCONNLookups,
+                    pLCSDEV->uLCSCONNLookups ? (double) pLCSDEV->uLCSCONNCompares /
+                                               (double) pLCSDEV->uLCSCONNLookups : 0.0 );
+                // "%s device %1d:%04X port %2.2X: %s"
+                WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+                // One set of lines per SNA connection (i.e. partner)
+                obtain_lock( &pLCSDEV->LCSCONNChainLock );
+                for (pLCSCONN = pLCSDEV->pFirstLCSCONN; pLCSCONN; pLCSCONN = pLCSCONN->pNextLCSCONN)
+                {
+                    n = MSGBUF( buf, "SNA %04X %02X:%02X:%02X:%02X:%02X:%02X",
+                        pLCSDEV->sAddr,
+                        pLCSCONN->bRemoteMAC[0], pLCSCONN->bRemoteMAC[1],
+                        pLCSCONN->bRemoteMAC[2], pLCSCONN->bRemoteMAC[3],
+                        pLCSCONN->bRemoteMAC[4], pLCSCONN->bRemoteMAC[5] );
+
+                    snprintf( buf + n, sizeof( buf ) - n,
+                        " I-frames in %"PRIu64" out %"PRIu64
+                        ", bytes in %"PRIu64" out %"PRIu64,
+                        pLCSCONN->uIFramesIn, pLCSCONN->uIFramesOut,
+                        pLCSCONN->uBytesIn, pLCSCONN->uBytesOut );
+                    // "%s device %1d:%04X port %2.2X: %s"
+                    WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+                    snprintf( buf + n, sizeof( buf ) - n,
+                        " RR in %"PRIu64" out %"PRIu64", RNR in %"PRIu64
+                        ", REJ in %"PRIu64", retransmits %"PRIu64
+                        ", out of sequence %"PRIu64,
+                        pLCSCONN->uRRIn, pLCSCONN->uRROut, pLCSCONN->uRNRIn,
+                        pLCSCONN->uREJIn, pLCSCONN->uRetransmits,
+                        pLCSCONN->uOutOfSeq );
+                    // "%s device %1d:%04X port %2.2X: %s"
+                    WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+
+                    snprintf( buf + n, sizeof( buf ) - n,
+                        " queued %"PRIu64" max %"PRIu64
+                        ", queue usecs avg %.1f max %"PRIu64,
+                        pLCSCONN->uQueueDepth, pLCSCONN->uQueueDepthMax,
+                        pLCSCONN->uQueueReads ? (double) pLCSCONN->uQueueTime /
+                                                (double) pLCSCONN->uQueueReads : 0.0,
+                        pLCSCONN->uQueueTimeMax );
+                    // "%s device %1d:%04X port %2.2X: %s"
+                    WRMSG( HHC02348, "I", dev->typname, LCSS_DEVNUM, pLCSPORT->bPort, buf );
+                }
+                release_lock( &pLCSDEV->LCSCONNChainLock );
+            }
+        }
+    }
+
+    if (!found)
+    {
+        // "No %s devices found"
+        WRMSG( HHC02347, "E", "LCS" );
+        return -1;
+    }
+
+    return 0;
+}
+
 /*-------------------------------------------------------------------*/
 /* ptp command - enable/disable PTP debugging                        */
 /*-------------------------------------------------------------------*/
@@ -3531,6 +3755,84 @@ u_int   locktype = 0;
     return rc;
 }
 
+/*-------------------------------------------------------------------*/
+/* tlbsize command                                                   */
+/*-------------------------------------------------------------------*/
+int tlbsize_cmd( int argc, char* argv[], char* cmdline )
+{
+    //  "TLBSIZE [entries [ways]]"
+    //
+    //  'entries' is the total number of TLB entries per CPU and must
+    //  be a power of two. 'ways' is the associativity (1, 2 or 4).
+    //  Each way holds at least TLB_MIN_SETS entries.
+
+    U32    entries, ways;
+    BYTE   c;
+    char   buf[64];
+    int    rc;
+
+    UNREFERENCED( cmdline );
+    UPPER_ARGV_0( argv );
+
+    if (argc > 3)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc < 2)
+    {
+        MSGBUF( buf, "%u entries, %u-way", sysblk.tlbentries, sysblk.tlbways );
+        // "%-14s: %s"
+        WRMSG( HHC02203, "I", argv[0], buf );
+        return 0;
+    }
+
+    ways = sysblk.tlbways;
+
+    if (argc > 2)
+    {
+        if (0
+            || sscanf( argv[2], "%u%c", &ways, &c ) != 1
+            || (ways != 1 && ways != 2 && ways != TLB_MAX_WAYS)
+        )
+        {
+            // "Invalid value %s specified for %s"
+            WRMSG( HHC01451, "E", argv[2], argv[0] );
+            return -1;
+        }
+    }
+
+    if (0
+        || sscanf( argv[1], "%u%c", &entries, &c ) != 1
+        || entries & (entries - 1)
+        || entries < TLB_MIN_SETS * ways
+        || entries > TLBN
+    )
+    {
+        // "Invalid value %s specified for %s"
+        WRMSG( HHC01451, "E", argv[1], argv[0] );
+        return -1;
+    }
+
+    if ((rc = configure_tlb( entries, ways )) == HERRCPUONL)
+    {
+        // "CPUs must be offline or stopped"
+        WRMSG( HHC02389, "E" );
+        return -1;
+    }
+
+    if (MLVL( VERBOSE ))
+    {
+        MSGBUF( buf, "%u entries, %u-way", entries, ways );
+        // "%-14s set to %s"
+        WRMSG( HHC02204, "I", argv[0], buf );
+    }
+
+    return rc;
+}
+
 /*-------------------------------------------------------------------*/
 /* Deprecated 'xxxPRIO' and HERCNICE commands                        */
 /*-------------------------------------------------------------------*/
@@ -4459,6 +4761,140 @@ int legacysenseid_cmd(int argc, char *argv[], char *cmdline)
     return 0;
 }
 
+/*-------------------------------------------------------------------*/
+/* fastbranch command                                                */
+/*-------------------------------------------------------------------*/
+int fastbranch_cmd(int argc, char *argv[], char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+    UPPER_ARGV_0( argv );
+
+    /* Parse fastbranch option */
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if ( argc == 2 )
+    {
+        if ( CMD(argv[1],enable,3) || CMD(argv[1],on,2) )
+            sysblk.fastbranch = TRUE;
+        else if ( CMD(argv[1],disable,4) || CMD(argv[1],off,3) )
+            sysblk.fastbranch = FALSE;
+        else
+        {
+            WRMSG( HHC02205, "E", argv[1] , "" );
+            return -1;
+        }
+        if ( MLVL(VERBOSE) )
+            WRMSG( HHC02204, "I", argv[0],
+                   sysblk.fastbranch ? "enabled" : "disabled" );
+    }
+    else
+        WRMSG( HHC02203, "I", argv[0], sysblk.fastbranch ? "enabled" : "disabled" );
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* smc command - self-modifying code tracking                        */
+/*-------------------------------------------------------------------*/
+#define SMC_TOP_FRAMES  10              /* Frames listed by display  */
+
+int smc_cmd(int argc, char *argv[], char *cmdline)
+{
+    U64   top[ SMC_TOP_FRAMES ];        /* Most invalidated frames   */
+    U32   cnt[ SMC_TOP_FRAMES ];        /* Their invalidation counts */
+    U64   frames, frame;
+    U32   count;
+    int   i, n = 0;
+
+    UNREFERENCED(cmdline);
+
+    UPPER_ARGV_0( argv );
+
+    if ( argc > 2 )
+    {
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    frames = sysblk.mainsize >> SHIFT_4K;
+
+    if ( argc == 2 )
+    {
+        if ( CMD(argv[1],enable,3) || CMD(argv[1],on,2) )
+        {
+            if (frames && !sysblk.smcmap)
+            {
+                WRMSG( HHC02205, "E", argv[1], "; main storage map not allocated" );
+                return -1;
+            }
+            sysblk.smctrack = TRUE;
+        }
+        else if ( CMD(argv[1],disable,4) || CMD(argv[1],off,3) )
+        {
+            sysblk.smctrack = FALSE;
+
+            /* Code marks are stale once stores are no longer seen */
+            for (frame = 0; frame < frames; frame++)
+                atomic_and32( &sysblk.smcmap[ frame ], SMC_COUNT );
+        }
+        else if ( CMD(argv[1],reset,5) )
+        {
+            for (frame = 0; frame < frames; frame++)
+                atomic_and32( &sysblk.smcmap[ frame ], SMC_CODE );
+            sysblk.smcinvals = 0;
+
+            WRMSG( HHC02352, "I" );
+            return 0;
+        }
+        else
+        {
+            WRMSG( HHC02205, "E", argv[1] , "" );
+            return -1;
+        }
+        if ( MLVL(VERBOSE) )
+            WRMSG( HHC02204, "I", argv[0],
+                   sysblk.smctrack ? "enabled" : "disabled" );
+        return 0;
+    }
+
+    WRMSG( HHC02350, "I", sysblk.smctrack ? "enabled" : "disabled",
+           sysblk.smcinvals );
+
+    /* List the most frequently invalidated frames */
+    for (frame = 0; frame < frames; frame++)
+    {
+        if (!(count = sysblk.smcmap[ frame ] & SMC_COUNT))
+            continue;
+
+        for (i = n; i > 0 && cnt[ i-1 ] < count; i--)
+        {
+            if (i < SMC_TOP_FRAMES)
+            {
+                top[ i ] = top[ i-1 ];
+                cnt[ i ] = cnt[ i-1 ];
+            }
+        }
+        if (i < SMC_TOP_FRAMES)
+        {
+            top[ i ] = frame;
+            cnt[ i ] = count;
+            if (n < SMC_TOP_FRAMES)
+                n++;
+        }
+    }
+
+    for (i = 0; i < n; i++)
+        WRMSG( HHC02351, "I", top[i] << SHIFT_4K, cnt[i],
+               (sysblk.smcmap[ top[i] ] & SMC_CODE) ? " (code)" : "" );
+
+    return 0;
+}
+
 /*-------------------------------------------------------------------
  * cp_updt command       User code page management
  *
@@ -389,6 +389,66 @@ DLL_EXPORT int aia_cmd( int argc, char* argv[], char* cmdline )
 }
 
 
+/*-------------------------------------------------------------------*/
+/* tlb stats - display or reset per-CPU TLB hit/miss counters        */
+/*-------------------------------------------------------------------*/
+static void tlb_stats_line( REGS* regs, const char* sie )
+{
+    char    buf[128];
+    U64     total = regs->tlbhits + regs->tlbmisses;
+
+    MSGBUF( buf, "%s%s%02X: %u entries %u-way  hits %"PRIu64"  misses %"PRIu64
+        "  hit ratio %5.1f%%", sie, PTYPSTR( regs->cpuad ), regs->cpuad,
+        regs->tlbsets * regs->tlbways, regs->tlbways,
+        regs->tlbhits, regs->tlbmisses,
+        total ? (100.0 * regs->tlbhits) / total : 0.0 );
+    WRMSG( HHC02284, "I", buf );
+
+    MSGBUF( buf, "%s%s%02X: purge entry requests %"PRIu64"  TLB scans %"PRIu64,
+        sie, PTYPSTR( regs->cpuad ), regs->cpuad,
+        regs->tlbpurges, regs->tlbscans );
+    WRMSG( HHC02284, "I", buf );
+}
+
+static int tlb_stats( bool reset )
+{
+    int     cpu;
+    REGS   *regs;
+
+    OBTAIN_INTLOCK( NULL );
+
+    for (cpu = 0; cpu < sysblk.maxcpu; cpu++)
+    {
+        if (!IS_CPU_ONLINE( cpu ))
+            continue;
+
+        regs = sysblk.regs[ cpu ];
+
+        if (reset)
+        {
+            regs->tlbhits = regs->tlbmisses = 0;
+            regs->tlbpurges = regs->tlbscans = 0;
+            if (GUESTREGS)
+            {
+                GUESTREGS->tlbhits = GUESTREGS->tlbmisses = 0;
+                GUESTREGS->tlbpurges = GUESTREGS->tlbscans = 0;
+            }
+            continue;
+        }
+
+        tlb_stats_line( regs, "" );
+        if (regs->sie_active)
+            tlb_stats_line( GUESTREGS, "SIE: " );
+    }
+
+    RELEASE_INTLOCK( NULL );
+
+    if (reset)
+        WRMSG( HHC02284, "I", "TLB statistics reset" );
+
+    return 0;
+}
+
 /*-------------------------------------------------------------------*/
 /* tlb - display tlb table                                           */
 /*-------------------------------------------------------------------*/
@@ -397,9 +457,9 @@ DLL_EXPORT int aia_cmd( int argc, char* argv[], char* cmdline )
 /*   The "tlbid" field is part of TLB_VADDR so it must be extracted  */
 /*   whenever it's used or displayed. The TLB_VADDR does not contain */
 /*   all of the effective address bits so they are created on-the-fly*/
-/*   with (i << shift) The "main" field of the tlb contains an XOR   */
-/*   hash of effective address. So MAINADDR() macro is used to remove*/
-/*   the hash before it's displayed.                                 */
+/*   from the set number ((i & tlbsetmask) << shift). The "main"     */
+/*   field of the tlb contains an XOR hash of effective address. So  */
+/*   MAINADDR() macro is used to remove the hash before it's shown.  */
 /*                                                                   */
 int tlb_cmd(int argc, char *argv[], char *cmdline)
 {
@@ -412,10 +472,23 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
     char    buf[128];
 
 
-    UNREFERENCED(argc);
-    UNREFERENCED(argv);
     UNREFERENCED(cmdline);
 
+    if (argc > 2)
+    {
+        WRMSG(HHC01455, "E", argv[0]);
+        return -1;
+    }
+    if (argc == 2)
+    {
+        if (str_caseless_eq( argv[1], "STATS" ))
+            return tlb_stats(false);
+        if (str_caseless_eq( argv[1], "RESET" ))
+            return tlb_stats(true);
+        WRMSG(HHC02205, "E", argv[1], "");
+        return -1;
+    }
+
     obtain_lock(&sysblk.cpulock[sysblk.pcpu]);
 
     if (!IS_CPU_ONLINE(sysblk.pcpu))
@@ -433,19 +506,19 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
 
     MSGBUF( buf, "tlbID 0x%6.6X mainstor %p",regs->tlbID,regs->mainstor);
     WRMSG(HHC02284, "I", buf);
-    WRMSG(HHC02284, "I", "  ix              asd            vaddr              pte   id c p r w ky     main");
-    for (i = 0; i < TLBN; i++)
+    WRMSG(HHC02284, "I", "   ix              asd            vaddr              pte   id c p r w ky     main");
+    for (i = 0; i < TLB_ENTRIES(regs); i++)
     {
-        MSGBUF( buf, "%s%3.3X %16.16"PRIX64" %16.16"PRIX64" %16.16"PRIX64" %4.4X %1d %1d %1d %1d %2.2X %8.8X",
+        MSGBUF( buf, "%s%4.4X %16.16"PRIX64" %16.16"PRIX64" %16.16"PRIX64" %4.4X %1d %1d %1d %1d %2.2X %8.8X",
          ((regs->tlb.TLB_VADDR_G(i) & bytemask) == regs->tlbID ? "*" : " "),
          i,regs->tlb.TLB_ASD_G(i),
-         ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)),
+         ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & regs->tlbsetmask) << shift)),
          regs->tlb.TLB_PTE_G(i),(int)(regs->tlb.TLB_VADDR_G(i) & bytemask),
          regs->tlb.common[i],regs->tlb.protect[i],
          (regs->tlb.acc[i] & ACC_READ) != 0,(regs->tlb.acc[i] & ACC_WRITE) != 0,
          regs->tlb.skey[i],
          (unsigned int)(MAINADDR(regs->tlb.main[i],
-                  ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)(i << shift)))
+                  ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)((i & regs->tlbsetmask) << shift)))
                   - regs->mainstor));
         matches += ((regs->tlb.TLB_VADDR(i) & bytemask) == regs->tlbID);
        WRMSG(HHC02284, "I", buf);
@@ -464,19 +537,19 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
 
         MSGBUF( buf, "SIE: tlbID 0x%4.4x mainstor %p",regs->tlbID,regs->mainstor);
         WRMSG(HHC02284, "I", buf);
-        WRMSG(HHC02284, "I", "  ix              asd            vaddr              pte   id c p r w ky       main");
-        for (i = matches = 0; i < TLBN; i++)
+        WRMSG(HHC02284, "I", "   ix              asd            vaddr              pte   id c p r w ky       main");
+        for (i = matches = 0; i < TLB_ENTRIES(regs); i++)
         {
-            MSGBUF( buf, "%s%3.3X %16.16"PRIX64" %16.16"PRIX64" %16.16"PRIX64" %4.4X %1d %1d %1d %1d %2.2X %8.8X",
+            MSGBUF( buf, "%s%4.4X %16.16"PRIX64" %16.16"PRIX64" %16.16"PRIX64" %4.4X %1d %1d %1d %1d %2.2X %8.8X",
              ((regs->tlb.TLB_VADDR_G(i) & bytemask) == regs->tlbID ? "*" : " "),
              i,regs->tlb.TLB_ASD_G(i),
-             ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)),
+             ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & regs->tlbsetmask) << shift)),
              regs->tlb.TLB_PTE_G(i),(int)(regs->tlb.TLB_VADDR_G(i) & bytemask),
              regs->tlb.common[i],regs->tlb.protect[i],
              (regs->tlb.acc[i] & ACC_READ) != 0,(regs->tlb.acc[i] & ACC_WRITE) != 0,
              regs->tlb.skey[i],
              (unsigned int) (MAINADDR(regs->tlb.main[i],
-                     ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)(i << shift)))
+                     ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (unsigned int)((i & regs->tlbsetmask) << shift)))
                     - regs->mainstor));
             matches += ((regs->tlb.TLB_VADDR(i) & bytemask) == regs->tlbID);
            WRMSG(HHC02284, "I", buf);
@@ -1701,6 +1774,9 @@ int ipending_cmd(int argc, char *argv[], char *cmdline)
                               states[sysblk.regs[i]->cpustate] );
         WRMSG( HHC00867, "I", PTYPSTR(sysblk.regs[i]->cpuad), sysblk.regs[i]->cpuad, INSTCOUNT(sysblk.regs[i]));
         WRMSG( HHC00868, "I", PTYPSTR(sysblk.regs[i]->cpuad), sysblk.regs[i]->cpuad, sysblk.regs[i]->siototal);
+        WRMSG( HHC00877, "I", PTYPSTR(sysblk.regs[i]->cpuad), sysblk.regs[i]->cpuad,
+                              sysblk.regs[i]->syncs, sysblk.regs[i]->syncslow,
+                              sysblk.regs[i]->synctime / ETOD_USEC, sysblk.regs[i]->synced);
         copy_psw(sysblk.regs[i], curpsw);
         if (ARCH_900_IDX == sysblk.arch_mode)
         {
@@ -2450,6 +2526,723 @@ int icount_cmd( int argc, char* argv[], char* cmdline )
 #endif /* defined( OPTION_INSTRUCTION_COUNTING ) */
 
 
+/*-------------------------------------------------------------------*/
+/* opprof command helpers                                            */
+/*-------------------------------------------------------------------*/
+#define OPPROF_DEF_TOP  20              /* Default report lines      */
+
+typedef struct OPPROF_ENTRY
+{
+    U64     count;                      /* Instructions executed     */
+    U64     cycles;                     /* Host cycles consumed      */
+    U16     ix;                         /* opprof_index value        */
+}
+OPPROF_ENTRY;
+
+static int opprof_sort_cycles( const void* a, const void* b )
+{
+    const OPPROF_ENTRY* ea = a;
+    const OPPROF_ENTRY* eb = b;
+
+    if (ea->cycles != eb->cycles)
+        return ea->cycles < eb->cycles ? 1 : -1;
+    return ea->count < eb->count ? 1 : ea->count > eb->count ? -1 : 0;
+}
+
+/* Format the opcode and assembler mnemonic for an opprof_index value */
+static void opprof_opcode( U16 ix, char* opcode, size_t oplen,
+                                   char* mnem,   size_t mnlen )
+{
+    BYTE    inst[6] = {0};
+    char    prtbuf[256];
+    char*   p;
+
+    /* Probe whether the opcode has an extended opcode byte at all */
+    inst[0] = ix >> 8;
+    inst[1] = inst[5] = 0xFF;
+
+    if (opprof_index( inst ) == (inst[0] << 8))
+        snprintf( opcode, oplen, "%2.2X", inst[0] );
+    else
+        snprintf( opcode, oplen, "%4.4X", ix );
+
+    /* Place the extended opcode wherever it may be taken from */
+    inst[1] = inst[5] = ix & 0xFF;
+
+    iprint_router_func( inst, NULL, prtbuf );
+    for (p = prtbuf; *p && *p != ' '; p++);
+    *p = 0;
+    strlcpy( mnem, prtbuf, mnlen );
+}
+
+/* Sum the per-CPU counters of every profiled CPU */
+static int opprof_collect( OPPROF_ENTRY* tab, U64* tcount, U64* tcycles )
+{
+    int  cpu, ix, n = 0;
+
+    *tcount = *tcycles = 0;
+
+    for (ix = 0; ix < OPPROF_OPCODES; ix++)
+    {
+        tab[n].count = tab[n].cycles = 0;
+        tab[n].ix = ix;
+
+        for (cpu = 0; cpu < MAX_CPU_ENGS; cpu++)
+        {
+            if (!OPPROF_COUNT( cpu ))
+                continue;
+            tab[n].count  += OPPROF_COUNT( cpu )[ ix ];
+            tab[n].cycles += OPPROF_CYCLES( cpu )[ ix ];
+        }
+
+        if (tab[n].count)
+        {
+            *tcount  += tab[n].count;
+            *tcycles += tab[n].cycles;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/* Write every non-zero per-CPU counter to a CSV file */
+static int opprof_csv( const char* fname )
+{
+    FILE*   f;
+    char    path[ MAX_PATH ];
+    char    opcode[8], mnem[16];
+    int     cpu, ix, lines = 0;
+
+    hostpath( path, fname, sizeof( path ));
+
+    if (!(f = fopen( path, "w" )))
+    {
+        // "Error in function %s: %s"
+        WRMSG( HHC01430, "E", "fopen()", strerror( errno ));
+        return -1;
+    }
+
+    fprintf( f, "cpu,opcode,mnemonic,count,cycles\n" );
+
+    for (cpu = 0; cpu < MAX_CPU_ENGS; cpu++)
+    {
+        if (!OPPROF_COUNT( cpu ))
+            continue;
+
+        for (ix = 0; ix < OPPROF_OPCODES; ix++)
+        {
+            if (!OPPROF_COUNT( cpu )[ ix ])
+                continue;
+
+            opprof_opcode( (U16) ix, opcode, sizeof( opcode ), mnem, sizeof( mnem ));
+            fprintf( f, "%s%02X,%s,%s,%"PRIu64",%"PRIu64"\n",
+                PTYPSTR( cpu ), cpu, opcode, mnem,
+                OPPROF_COUNT( cpu )[ ix ], OPPROF_CYCLES( cpu )[ ix ]);
+            lines++;
+        }
+    }
+
+    if (fclose( f ) != 0)
+    {
+        // "Error in function %s: %s"
+        WRMSG( HHC01430, "E", "fclose()", strerror( errno ));
+        return -1;
+    }
+
+    // "Opcode profile written to %s: %d lines"
+    WRMSG( HHC02356, "I", path, lines );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* opprof command - per-opcode execution profiler                    */
+/*-------------------------------------------------------------------*/
+int opprof_cmd( int argc, char* argv[], char* cmdline )
+{
+    OPPROF_ENTRY*  tab;
+    U64     tcount, tcycles;
+    char    opcode[8], mnem[16];
+    int     cpu, i, n, top = OPPROF_DEF_TOP;
+    BYTE    c;
+
+    UNREFERENCED( cmdline );
+    UPPER_ARGV_0( argv );
+
+    if (argc > 3)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc == 3 && !CMD( argv[1], CSV, 3 ))
+    {
+        // "Invalid argument %s%s"
+        WRMSG( HHC02205, "E", argv[1], "" );
+        return -1;
+    }
+
+    if (argc >= 2)
+    {
+        if (CMD( argv[1], ON, 2 ) || CMD( argv[1], ENABLE, 3 ))
+        {
+            /* Counters are allocated once and never freed, so that
+               a CPU never sees its counters disappear while running */
+            for (cpu = 0; cpu < sysblk.maxcpu; cpu++)
+            {
+                if (!IS_CPU_ONLINE( cpu ) || OPPROF_COUNT( cpu ))
+                    continue;
+
+                if (!(sysblk.opprof[ cpu ] = calloc( 2 * OPPROF_OPCODES, sizeof( U64 ))))
+                {
+                    // "Error in function %s: %s"
+                    WRMSG( HHC01430, "E", "calloc()", strerror( errno ));
+                    return -1;
+                }
+            }
+            sysblk.opprofile = TRUE;
+            if (MLVL( VERBOSE ))
+                // "%-14s set to %s"
+                WRMSG( HHC02204, "I", argv[0], "enabled" );
+            return 0;
+        }
+
+        if (CMD( argv[1], OFF, 3 ) || CMD( argv[1], DISABLE, 4 ))
+        {
+            sysblk.opprofile = FALSE;
+            if (MLVL( VERBOSE ))
+                // "%-14s set to %s"
+                WRMSG( HHC02204, "I", argv[0], "disabled" );
+            return 0;
+        }
+
+        if (CMD( argv[1], RESET, 5 ))
+        {
+            for (cpu = 0; cpu < MAX_CPU_ENGS; cpu++)
+                if (OPPROF_COUNT( cpu ))
+                    memset( OPPROF_COUNT( cpu ), 0, 2 * OPPROF_OPCODES * sizeof( U64 ));
+            // "Opcode profile counters reset"
+            WRMSG( HHC02357, "I" );
+            return 0;
+        }
+
+        if (CMD( argv[1], CSV, 3 ))
+        {
+            if (argc != 3)
+            {
+                // "Invalid number of arguments for %s"
+                WRMSG( HHC01455, "E", argv[0] );
+                return -1;
+            }
+            return opprof_csv( argv[2] );
+        }
+
+        if (sscanf( argv[1], "%d%c", &top, &c ) != 1 || top <= 0)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+    }
+
+    /* Display the opcodes that used the most host cycles */
+    if (!(tab = malloc( OPPROF_OPCODES * sizeof( OPPROF_ENTRY ))))
+    {
+        // "Error in function %s: %s"
+        WRMSG( HHC01430, "E", "malloc()", strerror( errno ));
+        return -1;
+    }
+
+    n = opprof_collect( tab, &tcount, &tcycles );
+    qsort( tab, n, sizeof( OPPROF_ENTRY ), opprof_sort_cycles );
+
+    // "Opcode profiling %s; %"PRIu64" instructions, %"PRIu64" host cycles"
+    WRMSG( HHC02353, "I", sysblk.opprofile ? "enabled" : "disabled", tcount, tcycles );
+
+    if (n)
+        // "Opcode Mnemonic    Count ..."
+        WRMSG( HHC02354, "I" );
+
+    for (i = 0; i < n && i < top; i++)
+    {
+        opprof_opcode( tab[i].ix, opcode, sizeof( opcode ), mnem, sizeof( mnem ));
+        // "%-6s %-8s %14"PRIu64" %6.2f %17"PRIu64" %6.2f %12.1f"
+        WRMSG( HHC02355, "I", opcode, mnem,
+            tab[i].count,  (100.0 * tab[i].count)  / tcount,
+            tab[i].cycles, tcycles ? (100.0 * tab[i].cycles) / tcycles : 0.0,
+            (double) tab[i].cycles / tab[i].count );
+    }
+
+    free( tab );
+    return 0;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* pswsamp command - guest PSW hot-spot sampling                     */
+/*-------------------------------------------------------------------*/
+#define PSWSAMP_DEF_TOP    20           /* Default report lines      */
+#define PSWSAMP_DEF_SHIFT  12           /* Default range: 4K         */
+
+int pswsamp_cmd( int argc, char* argv[], char* cmdline )
+{
+    PSWHIST* tab;
+    U64     total, waits, size;
+    int     cpu, i, n, msecs, top = PSWSAMP_DEF_TOP, shift = PSWSAMP_DEF_SHIFT;
+    char    c;
+
+    UNREFERENCED( cmdline );
+    UPPER_ARGV_0( argv );
+
+    if (argc > 3)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc >= 2)
+    {
+        if (CMD( argv[1], ON, 2 ) || CMD( argv[1], ENABLE, 3 ))
+        {
+            if (argc == 3)
+            {
+                if (sscanf( argv[2], "%d%c", &msecs, &c ) != 1
+                    || msecs < 1 || msecs > 1000)
+                {
+                    // "Invalid argument %s%s"
+                    WRMSG( HHC02205, "E", argv[2], "; msecs must be 1 to 1000" );
+                    return -1;
+                }
+                sysblk.pswsampint = msecs;
+            }
+
+            /* Rings are allocated once and never freed, so that
+               the timer thread never sees a ring disappear */
+            for (cpu = 0; cpu < sysblk.maxcpu; cpu++)
+            {
+                if (!IS_CPU_ONLINE( cpu ) || sysblk.pswring[ cpu ])
+                    continue;
+
+                if (!(sysblk.pswring[ cpu ] = calloc( 1, sizeof( PSWRING ))))
+                {
+                    // "Error in function %s: %s"
+                    WRMSG( HHC01430, "E", "calloc()", strerror( errno ));
+                    return -1;
+                }
+            }
+            sysblk.pswsample = TRUE;
+            if (MLVL( VERBOSE ))
+                // "%-14s set to %s"
+                WRMSG( HHC02204, "I", argv[0], "enabled" );
+            return 0;
+        }
+
+        if (argc == 3 && !isdigit( (unsigned char) argv[1][0] ))
+        {
+            // "Invalid number of arguments for %s"
+            WRMSG( HHC01455, "E", argv[0] );
+            return -1;
+        }
+
+        if (CMD( argv[1], OFF, 3 ) || CMD( argv[1], DISABLE, 4 ))
+        {
+            sysblk.pswsample = FALSE;
+            if (MLVL( VERBOSE ))
+                // "%-14s set to %s"
+                WRMSG( HHC02204, "I", argv[0], "disabled" );
+            return 0;
+        }
+
+        if (CMD( argv[1], RESET, 5 ))
+        {
+            /* Only the timer thread moves a ring's head, so
+               a reset just forgets everything before it */
+            for (cpu = 0; cpu < MAX_CPU_ENGS; cpu++)
+                if (sysblk.pswring[ cpu ])
+                    sysblk.pswring[ cpu ]->base = sysblk.pswring[ cpu ]->head;
+            // "PSW samples reset"
+            WRMSG( HHC02378, "I" );
+            return 0;
+        }
+
+        if (sscanf( argv[1], "%d%c", &top, &c ) != 1 || top <= 0)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        if (argc == 3)
+        {
+            if (sscanf( argv[2], "%"SCNu64"%c", &size, &c ) != 1
+                || size < 2 || (size & (size - 1)))
+            {
+                // "Invalid argument %s%s"
+                WRMSG( HHC02205, "E", argv[2], "; range size must be a power of 2" );
+                return -1;
+            }
+            for (shift = 0; ((U64) 1 << shift) < size; shift++);
+        }
+    }
+
+    /* Display the most frequently sampled address ranges */
+    if ((n = pswsamp_histogram( &tab, shift, &total, &waits )) < 0)
+    {
+        // "Error in function %s: %s"
+        WRMSG( HHC01430, "E", "malloc()", strerror( errno ));
+        return -1;
+    }
+
+    // "PSW sampling %s every %u msecs; %"PRIu64" samples, %"PRIu64" in wait state"
+    WRMSG( HHC02358, "I", sysblk.pswsample ? "enabled" : "disabled",
+        sysblk.pswsampint, total, waits );
+
+    if (n)
+        // "Address range                      State          ASN  ASCE ..."
+        WRMSG( HHC02359, "I" );
+
+    for (i = 0; i < n && i < top; i++)
+    {
+        // "%16.16"PRIX64"-%16.16"PRIX64" %-14s %4.4X %16.16"PRIX64" %10"PRIu64" %6.2f"
+        WRMSG( HHC02377, "I", tab[i].addr, tab[i].addr + ((U64) 1 << shift) - 1,
+            pswsamp_state( tab[i].flags ), tab[i].asn, tab[i].asce,
+            tab[i].count, (100.0 * tab[i].count) / total );
+    }
+
+    free( tab );
+    return 0;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* cputelem command - per-CPU telemetry                              */
+/*-------------------------------------------------------------------*/
+int cputelem_cmd( int argc, char* argv[], char* cmdline )
+{
+    CPUTELEM snap;
+    U64     now, total;
+    double  pct[ CPUTELEM_STATES ];
+    int     cpu, i, msecs = sysblk.cputelemint;
+    char    c;
+
+    UNREFERENCED( cmdline );
+    UPPER_ARGV_0( argv );
+
+    if (argc > 4)
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc >= 2)
+    {
+        if (CMD( argv[1], ON, 2 ) || CMD( argv[1], ENABLE, 3 ))
+        {
+            if (argc < 3)
+            {
+                // "Invalid number of arguments for %s"
+                WRMSG( HHC01455, "E", argv[0] );
+                return -1;
+            }
+
+            if (argc == 4
+                && (sscanf( argv[3], "%d%c", &msecs, &c ) != 1
+                    || msecs < 10 || msecs > 3600000))
+            {
+                // "Invalid argument %s%s"
+                WRMSG( HHC02205, "E", argv[3], "; msecs must be 10 to 3600000" );
+                return -1;
+            }
+
+            if (cputelem_start( argv[2], msecs ) != 0)
+                return -1;
+
+            if (MLVL( VERBOSE ))
+                // "%-14s set to %s"
+                WRMSG( HHC02204, "I", argv[0], "enabled" );
+            return 0;
+        }
+
+        if (argc > 2)
+        {
+            // "Invalid number of arguments for %s"
+            WRMSG( HHC01455, "E", argv[0] );
+            return -1;
+        }
+
+        if (CMD( argv[1], OFF, 3 ) || CMD( argv[1], DISABLE, 4 ))
+        {
+            cputelem_stop();
+            if (MLVL( VERBOSE ))
+                // "%-14s set to %s"
+                WRMSG( HHC02204, "I", argv[0], "disabled" );
+            return 0;
+        }
+
+        // "Invalid argument %s%s"
+        WRMSG( HHC02205, "E", argv[1], "" );
+        return -1;
+    }
+
+    /* Display each online CPU's counters since it came online */
+
+    // "CPU telemetry %s every %u msecs%s%s"
+    WRMSG( HHC02364, "I", sysblk.cputelemetry ? "enabled" : "disabled",
+        sysblk.cputelemint, sysblk.cputelemetry ? " to " : "",
+        sysblk.cputelemetry ? sysblk.cputelemto : "" );
+
+    // "CPU      Instructions      MIPS  Exec%  Wait%  Spin%  Intr%  Stop%   Interrupts"
+    WRMSG( HHC02367, "I" );
+
+    now = host_nanos();
+
+    for (cpu = 0; cpu < sysblk.hicpu; cpu++)
+    {
+        if (!IS_CPU_ONLINE( cpu ))
+            continue;
+
+        cputelem_snapshot( cpu, &snap, now );
+
+        for (total = 0, i = 0; i < CPUTELEM_STATES; i++)
+            total += snap.ns[i];
+        for (i = 0; i < CPUTELEM_STATES; i++)
+            pct[i] = total ? (100.0 * snap.ns[i]) / total : 0.0;
+
+        // "%s%02X %17"PRIu64" %9.2f %6.2f %6.2f %6.2f %6.2f %6.2f %12"PRIu64
+        WRMSG( HHC02368, "I", PTYPSTR( cpu ), cpu, snap.instcount,
+            total ? (snap.instcount * 1000.0) / total : 0.0,
+            pct[ CPUTELEM_EXEC ], pct[ CPUTELEM_WAIT ], pct[ CPUTELEM_SPIN ],
+            pct[ CPUTELEM_INTR ], pct[ CPUTELEM_STOPPED ], snap.intcount );
+    }
+
+    return 0;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* simd command helpers                                              */
+/*-------------------------------------------------------------------*/
+#define SIMD_BENCH_DEF_LEN  256         /* Default operand length    */
+#define SIMD_BENCH_BYTES    (64 * ONE_MEGABYTE) /* Bytes per kernel  */
+
+static const char* simd_level_names[] = { "SCALAR", "SSE2", "AVX2" };
+
+static volatile size_t simd_bench_sink; /* Kernel results (unused)   */
+
+/* Every kernel is benchmarked through the same signature: op1 is the
+   operand that is modified, op2 the one that is only read and tab a
+   256-byte translate table. Results are returned to keep the calls
+   from being optimized away. */
+typedef size_t SIMDBENCH( BYTE* op1, BYTE* op2, size_t n, const BYTE* tab );
+
+#define SIMD_BENCH_KERNELS( _lvl )                                    \
+static size_t simd_bench_copy_ ## _lvl( BYTE* op1, BYTE* op2,         \
+                                   size_t n, const BYTE* tab )        \
+{                                                                     \
+    UNREFERENCED( tab );                                              \
+    mem_copy_ ## _lvl( op1, op2, n );                                 \
+    return 0;                                                         \
+}                                                                     \
+static size_t simd_bench_xor_ ## _lvl( BYTE* op1, BYTE* op2,          \
+                                  size_t n, const BYTE* tab )         \
+{                                                                     \
+    UNREFERENCED( tab );                                              \
+    return mem_xor_ ## _lvl( op1, op2, n );                           \
+}                                                                     \
+static size_t simd_bench_neq_ ## _lvl( BYTE* op1, BYTE* op2,          \
+                                  size_t n, const BYTE* tab )         \
+{                                                                     \
+    UNREFERENCED( op1 );                                              \
+    UNREFERENCED( tab );                                              \
+    return mem_neq_ ## _lvl( op2, op2 + n, n );                       \
+}
+
+#define SIMD_BENCH_TR_KERNELS( _lvl )                                 \
+static size_t simd_bench_tr_ ## _lvl( BYTE* op1, BYTE* op2,           \
+                                 size_t n, const BYTE* tab )          \
+{                                                                     \
+    UNREFERENCED( op2 );                                              \
+    mem_tr_ ## _lvl( op1, n, tab );                                   \
+    return 0;                                                         \
+}                                                                     \
+static size_t simd_bench_trt_ ## _lvl( BYTE* op1, BYTE* op2,          \
+                                  size_t n, const BYTE* tab )         \
+{                                                                     \
+    UNREFERENCED( op1 );                                              \
+    return mem_trt_ ## _lvl( op2, n, tab + 256 );                     \
+}
+
+SIMD_BENCH_KERNELS( scalar )
+SIMD_BENCH_TR_KERNELS( scalar )
+#if defined( _HOST_SIMD_ )
+SIMD_BENCH_KERNELS( sse2 )
+SIMD_BENCH_KERNELS( avx2 )
+SIMD_BENCH_TR_KERNELS( avx2 )
+#define SIMD_BENCH_FUNCS( _op )                                       \
+    { simd_bench_ ## _op ## _scalar, simd_bench_ ## _op ## _sse2,     \
+      simd_bench_ ## _op ## _avx2 }
+#define SIMD_BENCH_TR_FUNCS( _op )                                    \
+    { simd_bench_ ## _op ## _scalar, NULL, simd_bench_ ## _op ## _avx2 }
+#else
+#define SIMD_BENCH_FUNCS( _op )     { simd_bench_ ## _op ## _scalar, NULL, NULL }
+#define SIMD_BENCH_TR_FUNCS( _op )  { simd_bench_ ## _op ## _scalar, NULL, NULL }
+#endif
+
+static const struct
+{
+    const char*  name;                  /* Instructions served       */
+    SIMDBENCH*   func[3];               /* Kernel per HOST_SIMD_xxx  */
+}
+simd_bench_tab[] =
+{
+    { "MVC",  SIMD_BENCH_FUNCS( copy )   },
+    { "XC",   SIMD_BENCH_FUNCS( xor )    },
+    { "CLCL", SIMD_BENCH_FUNCS( neq )    },
+    { "TR",   SIMD_BENCH_TR_FUNCS( tr )  },
+    { "TRT",  SIMD_BENCH_TR_FUNCS( trt ) },
+};
+
+/*-------------------------------------------------------------------*/
+/* Measure each kernel in bytes per host cycle (see host_cycles)     */
+/*-------------------------------------------------------------------*/
+static int simd_bench( U32 len )
+{
+    BYTE*   op1;                        /* Modified operand          */
+    BYTE*   op2;                        /* Read-only operand (twice) */
+    BYTE    tab[512];                   /* TR and TRT tables         */
+    char    res[3][16];                 /* Formatted results         */
+    U64     start, cycles;
+    U32     iters = SIMD_BENCH_BYTES / len, i;
+    size_t  sink = 0;                   /* Sum of kernel results     */
+    int     k, lvl;
+
+    if (!(op1 = malloc( len )) || !(op2 = malloc( 2 * len )))
+    {
+        free( op1 );
+        // "Error in function %s: %s"
+        WRMSG( HHC01430, "E", "malloc()", strerror( errno ));
+        return -1;
+    }
+
+    /* Operands never contain X'FF', the only byte that TRT's table
+       marks, so that TRT and CLCL have to scan all of op2 */
+    for (i=0; i < len; i++)
+    {
+        op1[i] = (BYTE) i;
+        op2[i] = op2[ len + i ] = (BYTE)(1 + i % 254);
+    }
+    for (i=0; i < 256; i++)
+    {
+        tab[i]       = (BYTE)(i ^ 0x5A);
+        tab[256 + i] = (i == 0xFF);
+    }
+
+    // "Bytes per host cycle for %u byte operands:"
+    WRMSG( HHC02362, "I", len );
+    // "%-6s %8s %8s %8s"
+    WRMSG( HHC02363, "I", "Kernel", simd_level_names[ HOST_SIMD_SCALAR ],
+        simd_level_names[ HOST_SIMD_SSE2 ], simd_level_names[ HOST_SIMD_AVX2 ] );
+
+    for (k=0; k < (int) _countof( simd_bench_tab ); k++)
+    {
+        for (lvl = HOST_SIMD_SCALAR; lvl <= HOST_SIMD_AVX2; lvl++)
+        {
+            if (lvl > host_simd_level() || !simd_bench_tab[k].func[ lvl ])
+            {
+                STRLCPY( res[ lvl ], "-" );
+                continue;
+            }
+
+            sink += simd_bench_tab[k].func[ lvl ]( op1, op2, len, tab );
+
+            start = host_cycles();
+            for (i=0; i < iters; i++)
+                sink += simd_bench_tab[k].func[ lvl ]( op1, op2, len, tab );
+            cycles = host_cycles() - start;
+
+            MSGBUF( res[ lvl ], "%.2f", (double) iters * len / (cycles ? cycles : 1) );
+        }
+        // "%-6s %8s %8s %8s"
+        WRMSG( HHC02363, "I", simd_bench_tab[k].name, res[0], res[1], res[2] );
+    }
+
+    simd_bench_sink = sink;
+    free( op1 );
+    free( op2 );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* simd command - select or benchmark the host SIMD operand kernels  */
+/*-------------------------------------------------------------------*/
+int simd_cmd( int argc, char* argv[], char* cmdline )
+{
+    U32     len = SIMD_BENCH_DEF_LEN;
+    int     lvl;
+    char    c;
+
+    UNREFERENCED( cmdline );
+    UPPER_ARGV_0( argv );
+
+    if (argc > 3 || (argc == 3 && !CMD( argv[1], BENCH, 1 )))
+    {
+        // "Invalid number of arguments for %s"
+        WRMSG( HHC01455, "E", argv[0] );
+        return -1;
+    }
+
+    if (argc >= 2)
+    {
+        if (CMD( argv[1], BENCH, 1 ))
+        {
+            if (argc == 3
+                && (sscanf( argv[2], "%u%c", &len, &c ) != 1
+                    || len < 1 || len > FOUR_KILOBYTE))
+            {
+                // "Invalid argument %s%s"
+                WRMSG( HHC02205, "E", argv[2], "; length must be 1 to 4096" );
+                return -1;
+            }
+            return simd_bench( len );
+        }
+
+        for (lvl = HOST_SIMD_SCALAR; lvl <= HOST_SIMD_AVX2; lvl++)
+            if (strcasecmp( argv[1], simd_level_names[ lvl ] ) == 0)
+                break;
+
+        if (lvl > HOST_SIMD_AVX2)
+        {
+            // "Invalid argument %s%s"
+            WRMSG( HHC02205, "E", argv[1], "" );
+            return -1;
+        }
+
+        if (lvl > host_simd_level())
+        {
+            // "%s kernels are not supported by this host"
+            WRMSG( HHC02361, "E", simd_level_names[ lvl ] );
+            return -1;
+        }
+
+        /* Any kernel gives the same results, so the CPUs
+           may switch to another one at any moment */
+        sysblk.hostsimd = (BYTE) lvl;
+        if (MLVL( VERBOSE ))
+            // "%-14s set to %s"
+            WRMSG( HHC02204, "I", argv[0], simd_level_names[ lvl ] );
+        return 0;
+    }
+
+    // "SIMD operand kernels %s; host supports %s"
+    WRMSG( HHC02360, "I", simd_level_names[ sysblk.hostsimd ],
+        simd_level_names[ host_simd_level() ] );
+    return 0;
+}
+
+
 /*-------------------------------------------------------------------*/
 /* createCpuId  -  Create the requested CPU ID                       */
 /*-------------------------------------------------------------------*/
@@ -128,6 +128,9 @@
   #include <sys/ioctl.h>
   #include <sys/mman.h>
 #endif
+#if defined( __GNUC__ ) && (defined( __x86_64__ ) || defined( __i386__ ))
+  #include <immintrin.h>        // (SSE2/AVX2 intrinsics, see hinlines.h)
+#endif
 #include <sys/types.h>
 
 /*-------------------------------------------------------------------*/
@@ -224,6 +224,9 @@ struct REGS {                           /* Processor registers       */
         U64     bcputime;               /* Base (reset) CPU time (us)*/
         U64     prevcount;              /* Previous instruction count*/
         U32     instcount;              /* Instruction counter       */
+        int     execpos;                /* Unrolled loop iterations
+                                           completed in the current
+                                           batch, or -1 (see run_cpu)*/
         U32     mipsrate;               /* Instructions per second   */
         U32     siocount;               /* SIO/SSCH counter          */
         U32     siosrate;               /* IOs per second            */
@@ -233,6 +236,10 @@ struct REGS {                           /* Processor registers       */
         U64     waittod;                /* Time of day last wait     */
         U64     waittime;               /* Wait time in interval     */
         U64     waittime_accumulated;   /* Wait time accumulated     */
+        U64     syncs;                  /* SYNCHRONIZE_CPUS by us    */
+        U64     syncslow;               /* ...needing intlock handoff*/
+        U64     synctime;               /* ...host TOD spent in them */
+        U64     synced;                 /* Synchronized by others    */
 
         CACHE_ALIGN
         DAT     dat;                    /* Fields for DAT use        */
@@ -469,6 +476,14 @@ struct REGS {                           /* Processor registers       */
 
 #endif /* defined( _FEATURE_073_TRANSACT_EXEC_FACILITY ) */
 
+        /*-----------------------------------------------------------*/
+        /* TLB geometry (see esa390.h)                               */
+
+        U32     tlbsets;                /* Number of TLB sets        */
+        U32     tlbsetmask;             /* TLB set index mask        */
+        U32     tlbways;                /* Entries per TLB set       */
+        U32     tlbnextway;             /* Next way to be replaced   */
+
      /* ------------------------------------------------------------ */
         U64     regs_copy_end;          /* Copy regs to here         */
      /* ------------------------------------------------------------ */
@@ -501,6 +516,13 @@ struct REGS {                           /* Processor registers       */
 
      /* TLB - Translation lookaside buffer                           */
         unsigned int tlbID;             /* Validation identifier     */
+        U64     tlbhits;                /* TLB lookup hits           */
+        U64     tlbmisses;              /* TLB lookup misses         */
+        U64     tlbpurges;              /* Purge TLB entry requests  */
+        U64     tlbscans;               /* ...which scanned the TLB  */
+        U64     tlbfilter[ TLB_FILTER_BITS / 64 ]; /* Hashed page
+                                           frames cached in the TLB
+                                           since it was last purged  */
         TLB     tlb;                    /* Translation lookaside buf */
 
         BLOCK_TRAILER;                  /* Name of block  END        */
@@ -556,6 +578,60 @@ struct GSYSINFO {
         BYTE    vmid[8];
 };
 
+/*-------------------------------------------------------------------*/
+/* PSW sample ring          (written by timer_thread, see pswsamp)   */
+/*-------------------------------------------------------------------*/
+struct PSWSAMP {
+        U64     ia;                     /* PSW instruction address   */
+        U64     asce;                   /* Primary ASCE (CR1) or 0   */
+        U16     asn;                    /* Primary ASN (CR4)         */
+        BYTE    flags;                  /* Sample flags              */
+#define PSWSAMP_PROB    0x01            /* Problem state             */
+#define PSWSAMP_WAIT    0x02            /* Wait state                */
+#define PSWSAMP_REAL    0x04            /* DAT off                   */
+#define PSWSAMP_SIE     0x08            /* SIE guest                 */
+};
+
+#define PSWSAMP_RING    16384           /* Samples per CPU (2**n)    */
+
+struct PSWRING {
+        U64     head;                   /* Samples ever written; only
+                                           the timer thread stores   */
+        U64     base;                   /* First sample to report;
+                                           only pswsamp RESET stores */
+        PSWSAMP samp[ PSWSAMP_RING ];   /* Most recent samples       */
+};
+
+struct PSWHIST {                        /* PSW sample histogram bar  */
+        U64     addr;                   /* Start of address range    */
+        U64     asce;                   /* Primary ASCE (CR1) or 0   */
+        U64     count;                  /* Samples in this range     */
+        U16     asn;                    /* Primary ASN (CR4)         */
+        BYTE    flags;                  /* PSWSAMP_xxxx flags        */
+};
+
+/*-------------------------------------------------------------------*/
+/* Per-CPU telemetry      (written by the CPU thread, see cputelem)  */
+/*-------------------------------------------------------------------*/
+#define CPUTELEM_EXEC       0           /* Executing instructions    */
+#define CPUTELEM_WAIT       1           /* Enabled wait state        */
+#define CPUTELEM_SPIN       2           /* Waiting for the intlock   */
+#define CPUTELEM_INTR       3           /* Handling interrupts       */
+#define CPUTELEM_STOPPED    4           /* Stopped                   */
+#define CPUTELEM_STATES     5           /* Number of states          */
+
+struct CPUTELEM {
+        CACHE_ALIGN                     /* (one CPU per cache line)  */
+        U64     instcount;              /* Instructions (approx.)    */
+        U64     intcount;               /* Interrupt handling passes */
+        U64     seq;                    /* Odd while the fields below
+                                           are being updated         */
+        U64     ns[ CPUTELEM_STATES ];  /* Host nanoseconds spent in
+                                           each state before `since' */
+        U64     since;                  /* Host nanoseconds at which
+                                           the current state began   */
+        U64     state;                  /* Current CPUTELEM_xxxx     */
+};
 
 /*-------------------------------------------------------------------*/
 /* Operation Modes                                                   */
@@ -597,12 +673,17 @@ struct SYSBLK {
         RADR    mainsize;               /* Main storage size (bytes) */
         BYTE   *mainstor;               /* -> Main storage           */
         BYTE   *storkeys;               /* -> Main storage key array */
+        U32    *smcmap;                 /* -> Self-modifying code map
+                                              (one U32 per 4K frame) */
+        U64     smcinvals;              /* Code frames invalidated   */
         u_int   lock_mainstor:1;        /* Request mainstor to lock  */
         u_int   mainstor_locked:1;      /* Main storage locked       */
         U32     xpndsize;               /* Expanded size in 4K pages */
         BYTE   *xpndstor;               /* -> Expanded storage       */
         u_int   lock_xpndstor:1;        /* Request xpndstor to lock  */
         u_int   xpndstor_locked:1;      /* Expanded storage locked   */
+        U32     tlbentries;             /* TLB entries per CPU       */
+        U32     tlbways;                /* TLB entries per set       */
         U64     todstart;               /* Time of initialisation    */
         U64     cpuid;                  /* CPU identifier for STIDP  */
         U32     cpuserial;              /* CPU serial number         */
@@ -947,6 +1028,14 @@ atomic_update64( &sysblk.txf_stats[ contran ? 1 : 0 ].txf_ ## ctr, +1 )
                                         /*     Operation Exceptions  */
                 noch9oflow:1,           /* Suppress CH9 O'Flow trace */
                 devnameonly:1,          /* Display only dev filename */
+                fastbranch:1,           /* 1 = branch to other pages
+                                           via TLB without instfetch */
+#define DEF_FASTBRANCH          TRUE    /* Default fastbranch        */
+                smctrack:1,             /* 1 = track self-modifying
+                                               code (see smcmap)     */
+                opprofile:1,            /* 1 = opcode profiling      */
+                pswsample:1,            /* 1 = PSW hot-spot sampling */
+                cputelemetry:1,         /* 1 = CPU telemetry feed    */
                 config_processed;       /* config file processed     */
         U32     ints_state;             /* Common Interrupts Status  */
         CPU_BITMAP config_mask;         /* Configured CPUs           */
@@ -1063,6 +1152,19 @@ atomic_update64( &sysblk.txf_stats[ contran ? 1 : 0 ].txf_ ## ctr, +1 )
 
 #endif // defined( OPTION_INSTRUCTION_COUNTING )
 
+        U64    *opprof[ MAX_CPU_ENGS ]; /* -> Per-CPU opcode profile
+                                           counters (see opcode.h)   */
+        PSWRING *pswring[ MAX_CPU_ENGS ]; /* -> Per-CPU PSW samples  */
+        U32     pswsampint;             /* PSW sample interval msecs */
+#define DEF_PSWSAMPINT  10              /* Default: 100 per second   */
+        CPUTELEM cputelem[ MAX_CPU_ENGS ]; /* Per-CPU telemetry      */
+        TID     cputelemtid;            /* CPU telemetry thread      */
+        char   *cputelemto;             /* Telemetry file/host:port  */
+        U32     cputelemint;            /* Telemetry interval msecs  */
+#define DEF_CPUTELEMINT 1000            /* Default: once per second  */
+        BYTE    hostsimd;               /* Host SIMD operand kernels
+                                           in use (HOST_SIMD_xxx)    */
+
         char    *cnslport;              /* console port string       */
         char    **herclogo;             /* Constructed logo screen   */
         char    *logofile;              /* File name of logo file    */
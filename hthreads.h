@@ -257,6 +257,7 @@ typedef void* (THREAD_FUNC)( void* );   /* Generic thread function   */
 #define LOGGER_THREAD_NAME      "logger_thread"
 #define SCRIPT_THREAD_NAME      "script_thread"
 #define TIMER_THREAD_NAME       "timer_thread"
+#define CPUTELEM_THREAD_NAME    "cputelem"
 #if defined( _FEATURE_073_TRANSACT_EXEC_FACILITY )
 #define RUBATO_THREAD_NAME      "rubato_thread"
 #endif
@@ -264,6 +265,7 @@ typedef void* (THREAD_FUNC)( void* );   /* Generic thread function   */
 #define SCSIMOUNT_THREAD_NAME   "scsi_mount"
 #define CCKD_RA_THREAD_NAME     "cckd_ra"
 #define CCKD_WR_THREAD_NAME     "cckd_writer"
+#define CCKD_CMP_THREAD_NAME    "cckd_compress"
 #define CCKD_GC_THREAD_NAME     "cckd_gcol"
 #define CON_CONN_THREAD_NAME    "console_connect"
 #define CONN_CLI_THREAD_NAME    "connect_client"
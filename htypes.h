@@ -190,6 +190,10 @@ typedef struct CHPBLK    CHPBLK;    // Channel Path config block
 typedef struct IOINT     IOINT;     // I/O interrupt queue
 
 typedef struct GSYSINFO  GSYSINFO;  // Ebcdic machine information
+typedef struct PSWSAMP   PSWSAMP;   // PSW hot-spot sample
+typedef struct PSWRING   PSWRING;   // Per-CPU PSW sample ring
+typedef struct PSWHIST   PSWHIST;   // PSW sample histogram entry
+typedef struct CPUTELEM  CPUTELEM;  // Per-CPU telemetry counters
 
 typedef struct DEVDATA   DEVDATA;   // xxxxxxxxx
 typedef struct DEVGRP    DEVGRP;    // xxxxxxxxx
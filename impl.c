@@ -789,6 +789,22 @@ int     rc;
     /* Initialize automatic creation of missing tape file to default */
     sysblk.auto_tape_create = DEF_AUTO_TAPE_CREATE;
 
+    /* Initialize cross-page branch optimization to default */
+    sysblk.fastbranch = DEF_FASTBRANCH;
+
+    /* Initialize TLB geometry to default */
+    sysblk.tlbentries = DEF_TLB_ENTRIES;
+    sysblk.tlbways    = DEF_TLB_WAYS;
+
+    /* Initialize PSW hot-spot sampling interval to default */
+    sysblk.pswsampint = DEF_PSWSAMPINT;
+
+    /* Initialize CPU telemetry interval to default */
+    sysblk.cputelemint = DEF_CPUTELEMINT;
+
+    /* Use the best SIMD operand kernels the host CPU supports */
+    sysblk.hostsimd = host_simd_level();
+
     /* Default command separator is OFF (disabled) */
     sysblk.cmdsep = 0;
 
@@ -1158,6 +1174,9 @@ int     rc;
     /* Initialize runtime opcode tables */
     init_runtime_opcode_tables();
 
+    /* Initialize opcode profiling tables */
+    init_opprof_tables();
+
     /* Initialize the Hercules Dynamic Loader (HDL) */
     rc = hdl_main
     (
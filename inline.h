@@ -642,6 +642,7 @@ static inline void ARCH_DEP(store_doubleword_absolute) (U64 value,
 
     /* Set the main storage reference and change bits */
     STORAGE_KEY(addr, regs) |= (STORKEY_REF | STORKEY_CHANGE);
+    SMC_STORE( regs->mainstor + addr, 8 );
 
     /* Store the doubleword into absolute storage */
     store_dw(regs->mainstor + addr, value);
@@ -667,6 +668,7 @@ static inline void ARCH_DEP(store_fullword_absolute) (U32 value,
 
     /* Set the main storage reference and change bits */
     STORAGE_KEY(addr, regs) |= (STORKEY_REF | STORKEY_CHANGE);
+    SMC_STORE( regs->mainstor + addr, 4 );
 
     /* Store the fullword into absolute storage */
     store_fw(regs->mainstor + addr, value);
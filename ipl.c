@@ -694,6 +694,7 @@ int ARCH_DEP( initial_cpu_reset )( REGS* regs )
     memset ( &regs->psw,           0, sizeof( regs->psw           ));
     memset ( &regs->captured_zpsw, 0, sizeof( regs->captured_zpsw ));
     memset ( &regs->cr_struct,     0, sizeof( regs->cr_struct     ));
+    regs->CR_G( CR_ASD_REAL ) = TLB_REAL_ASD;
     regs->fpc    = 0;
     regs->PX     = 0;
     regs->psw.AMASK_G = AMASK24;
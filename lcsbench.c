@@ -0,0 +1,1311 @@
+/* LCSBENCH.C   (C) and others 2024                                  */
+/*              LCS Throughput and Latency Benchmark                 */
+/*                                                                   */
+/*   Released under "The Q Public License Version 1"                 */
+/*   (http://www.hercules-390.org/herclic.html) as modifications to  */
+/*   Hercules.                                                       */
+
+/*-------------------------------------------------------------------*/
+/* This program measures the LCS device handler (ctc_lcs.c) without  */
+/* a guest and without a TAP device. It builds the read and write    */
+/* DEVBLKs itself, initializes them through lcs_device_hndinfo and   */
+/* then drives them with the same channel programs a guest would:    */
+/* Read and Write CCWs in IP mode; Write, CTL and SCB channel        */
+/* programs in SNA mode.                                             */
+/*                                                                   */
+/* The TAP interface is replaced by a socketpair. The stand-in       */
+/* TUNTAP_CreateInterface below gives LCS one end of the pair and    */
+/* keeps the other end as the "wire", which the program writes       */
+/* inbound frames to and reads outbound frames from. The remaining   */
+/* interface configuration calls, the interface ioctls and           */
+/* device_attention are redirected to stand-ins by the linker        */
+/* (-Wl,--wrap=..., see lcsbench_LDFLAGS in Makefile.am), which is   */
+/* why this program is only built on request, with GNU ld:           */
+/*                                                                   */
+/*      make lcsbench                                                */
+/*                                                                   */
+/* Every frame carries a sequence number and the time it was sent,   */
+/* so the program reports frames/s, MB/s and the p50 and p99 latency */
+/* from the frame being sent to it being received. Any options that  */
+/* follow "--" are passed to the LCS device unchanged, so the effect */
+/* of e.g. -b, -z, -q, -a and -t can be compared.                    */
+/*-------------------------------------------------------------------*/
+
+#include "hstdinc.h"
+#include "hercules.h"
+#include "ctcadpt.h"
+#include "tuntap.h"
+#include "netsupp.h"
+
+#define UTILITY_NAME    "lcsbench"
+#define UTILITY_DESC    "LCS throughput and latency benchmark"
+
+/*-------------------------------------------------------------------*/
+/* Constants                                                         */
+/*-------------------------------------------------------------------*/
+
+#define BENCH_IFNAME        "lcsbench0"     /* Stand-in interface    */
+#define BENCH_GUEST_IP      "10.1.1.2"      /* IP address of device  */
+#define BENCH_PEER_IP       0x0A010101      /* 10.1.1.1, host order  */
+#define BENCH_DEVNUM        0x0E20          /* First device number   */
+#define BENCH_BUFSIZE       65535           /* Read/Write CCW count  */
+#define BENCH_SOCKBUF       (4*1024*1024)   /* Wire socket buffers   */
+#define BENCH_TIMEOUT       10              /* Secs without progress */
+
+#define BENCH_DEF_FRAMES    100000          /* Default -f            */
+#define BENCH_DEF_SIZE      1024            /* Default -s            */
+#define BENCH_DEF_WINDOW    32              /* Default -w            */
+#define BENCH_DEF_COUNT     8               /* Default -c            */
+#define BENCH_MIN_SIZE      64              /* Smallest frame        */
+#define BENCH_MAX_SIZE      1514            /* Largest frame         */
+
+#define BENCH_STAMP_SIZE    12              /* Seq (4) + time (8)    */
+#define BENCH_IP_STAMP      (eth_hdr_size + ip_hdr_size + udp_hdr_size)
+#define BENCH_SNA_STAMP     (eth_hdr_size + 4)  /* After 802.2 LLC   */
+#define BENCH_SNA_TOKEN     0x00BE0001      /* Our inbound token     */
+
+/*-------------------------------------------------------------------*/
+/* Benchmark state                                                   */
+/*-------------------------------------------------------------------*/
+
+typedef struct BENCH
+{
+    BYTE     bMode;                     /* LCSDEV_MODE_IP or _SNA    */
+    int      fOutbound;                 /* 1=guest to wire, 0=inbound*/
+    int      iFrames;                   /* Number of frames to send  */
+    int      iSize;                     /* Ethernet frame size       */
+    int      iWindow;                   /* Max frames in flight      */
+    int      iCount;                    /* Frames per Write CCW      */
+    int      iDevs;                     /* Number of DEVBLKs         */
+    DEVBLK*  pDEVBLK[2];                /* Read and write DEVBLKs    */
+    int      iWires;                    /* Number of wire sockets    */
+    int      wire[ LCS_MAX_QUEUES ];    /* Our ends of socketpairs   */
+    MAC      bPortMAC;                  /* Stand-in interface MAC    */
+    MAC      bLocalMAC;                 /* MAC the device answers to */
+    MAC      bPeerMAC;                  /* Remote SNA station MAC    */
+    BYTE     bOutToken[4];              /* SNA outbound token        */
+    U64*     pLatency;                  /* Latency of each frame (ns)*/
+    LOCK     lock;                      /* Lock for the fields below */
+    COND     cond;                      /* Signalled on any progress */
+    int      iReceived;                 /* Frames received so far    */
+    U64      uBytes;                    /* Bytes received so far     */
+    U64      uLastArrival;              /* Time of the latest arrival*/
+    int      iAttns;                    /* Attentions not yet taken  */
+    int      fFailed;                   /* A worker thread failed    */
+}
+BENCH;
+
+static BENCH  bench;
+
+/*-------------------------------------------------------------------*/
+/* Linker-wrapped stand-ins (see lcsbench_LDFLAGS in Makefile.am)    */
+/*-------------------------------------------------------------------*/
+
+int __wrap_TUNTAP_CreateInterface( char* pszTUNDevice, int iFlags,
+                                   int* pfd, char* pszNetDevName );
+int __wrap_TUNTAP_SetMTU( char* pszNetDevName, char* pszMTU );
+int __wrap_TUNTAP_SetIPAddr( char* pszNetDevName, char* pszIPAddr );
+int __wrap_TUNTAP_SetFlags( char* pszNetDevName, int iFlags );
+int __wrap_TUNTAP_SetMACAddr( char* pszNetDevName, char* pszMACAddr );
+int __wrap_TUNTAP_AddRoute( char* pszNetDevName, char* pszDestAddr,
+                            char* pszNetMask, char* pszGWAddr, int iFlags );
+int __wrap_TUNTAP_DelRoute( char* pszNetDevName, char* pszDestAddr,
+                            char* pszNetMask, char* pszGWAddr, int iFlags );
+int __wrap_device_attention( DEVBLK* dev, BYTE unitstat );
+int __wrap_ioctl( int fd, unsigned long request, ... );
+int __real_ioctl( int fd, unsigned long request, ... );
+
+/*-------------------------------------------------------------------*/
+/* Create the interface: one socketpair per TAP queue                */
+/*-------------------------------------------------------------------*/
+int __wrap_TUNTAP_CreateInterface( char* pszTUNDevice, int iFlags,
+                                   int* pfd, char* pszNetDevName )
+{
+    int  sv[2];
+    int  size = BENCH_SOCKBUF;
+    int  i;
+
+    UNREFERENCED( pszTUNDevice );
+    UNREFERENCED( iFlags );
+
+    if (bench.iWires >= LCS_MAX_QUEUES)
+    {
+        errno = EMFILE;
+        return -1;
+    }
+
+    if (socketpair( AF_UNIX, SOCK_DGRAM, 0, sv ) != 0)
+        return -1;
+
+    for (i=0; i < 2; i++)
+    {
+        setsockopt( sv[i], SOL_SOCKET, SO_SNDBUF, &size, sizeof( size ));
+        setsockopt( sv[i], SOL_SOCKET, SO_RCVBUF, &size, sizeof( size ));
+    }
+
+    bench.wire[ bench.iWires++ ] = sv[1];
+
+    *pfd = sv[0];
+    strlcpy( pszNetDevName, BENCH_IFNAME, IFNAMSIZ );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Interface configuration: nothing to configure                     */
+/*-------------------------------------------------------------------*/
+int __wrap_TUNTAP_SetMTU( char* pszNetDevName, char* pszMTU )
+{
+    UNREFERENCED( pszNetDevName );
+    UNREFERENCED( pszMTU );
+    return 0;
+}
+
+int __wrap_TUNTAP_SetIPAddr( char* pszNetDevName, char* pszIPAddr )
+{
+    UNREFERENCED( pszNetDevName );
+    UNREFERENCED( pszIPAddr );
+    return 0;
+}
+
+int __wrap_TUNTAP_SetFlags( char* pszNetDevName, int iFlags )
+{
+    UNREFERENCED( pszNetDevName );
+    UNREFERENCED( iFlags );
+    return 0;
+}
+
+int __wrap_TUNTAP_SetMACAddr( char* pszNetDevName, char* pszMACAddr )
+{
+    UNREFERENCED( pszNetDevName );
+    UNREFERENCED( pszMACAddr );
+    return 0;
+}
+
+int __wrap_TUNTAP_AddRoute( char* pszNetDevName, char* pszDestAddr,
+                            char* pszNetMask, char* pszGWAddr, int iFlags )
+{
+    UNREFERENCED( pszNetDevName );
+    UNREFERENCED( pszDestAddr );
+    UNREFERENCED( pszNetMask );
+    UNREFERENCED( pszGWAddr );
+    UNREFERENCED( iFlags );
+    return 0;
+}
+
+int __wrap_TUNTAP_DelRoute( char* pszNetDevName, char* pszDestAddr,
+                            char* pszNetMask, char* pszGWAddr, int iFlags )
+{
+    UNREFERENCED( pszNetDevName );
+    UNREFERENCED( pszDestAddr );
+    UNREFERENCED( pszNetMask );
+    UNREFERENCED( pszGWAddr );
+    UNREFERENCED( iFlags );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Interface ioctls: answer those for the stand-in interface         */
+/*-------------------------------------------------------------------*/
+int __wrap_ioctl( int fd, unsigned long request, ... )
+{
+    va_list  vl;
+    void*    arg;
+    ifreq*   pifr;
+
+    va_start( vl, request );
+    arg = va_arg( vl, void* );
+    va_end( vl );
+
+    if (0
+        || request == SIOCGIFHWADDR
+        || request == SIOCADDMULTI
+        || request == SIOCDELMULTI
+    )
+    {
+        pifr = (ifreq*) arg;
+
+        if (strcmp( pifr->ifr_name, BENCH_IFNAME ) == 0)
+        {
+            if (request == SIOCGIFHWADDR)
+                memcpy( pifr->ifr_hwaddr.sa_data, bench.bPortMAC, IFHWADDRLEN );
+            return 0;
+        }
+    }
+
+    return __real_ioctl( fd, request, arg );
+}
+
+/*-------------------------------------------------------------------*/
+/* Attention: wake up the SNA inbound reader                         */
+/*-------------------------------------------------------------------*/
+int __wrap_device_attention( DEVBLK* dev, BYTE unitstat )
+{
+    UNREFERENCED( dev );
+    UNREFERENCED( unitstat );
+
+    obtain_lock( &bench.lock );
+    {
+        bench.iAttns++;
+        broadcast_condition( &bench.cond );
+    }
+    release_lock( &bench.lock );
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Helper functions                                                  */
+/*-------------------------------------------------------------------*/
+
+static U64 bench_now( void )
+{
+    struct timespec  ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+static void bench_stamp( BYTE* pStamp, int iSeq )
+{
+    U64  uNow = bench_now();
+
+    STORE_FW( pStamp, (U32) iSeq );
+    memcpy( pStamp + 4, &uNow, sizeof( uNow ));
+}
+
+// Record the latency of a received frame. Returns 1 if the frame is
+// one we sent and haven't seen before, else 0.
+
+static int bench_arrived( BYTE* pStamp, U64 uNow )
+{
+    U32  uSeq;
+    U64  uSent;
+
+    FETCH_FW( uSeq, pStamp );
+    memcpy( &uSent, pStamp + 4, sizeof( uSent ));
+
+    if (uSeq >= (U32) bench.iFrames || bench.pLatency[ uSeq ])
+        return 0;
+
+    bench.pLatency[ uSeq ] = (uNow > uSent) ? (uNow - uSent) : 1;
+    return 1;
+}
+
+static void bench_progress( int iFrames, int iBytes )
+{
+    obtain_lock( &bench.lock );
+    {
+        bench.iReceived   += iFrames;
+        bench.uBytes      += iBytes;
+        bench.uLastArrival = bench_now();
+        broadcast_condition( &bench.cond );
+    }
+    release_lock( &bench.lock );
+}
+
+static int bench_done( void )
+{
+    int  rc;
+
+    obtain_lock( &bench.lock );
+    {
+        rc = (bench.iReceived >= bench.iFrames || bench.fFailed);
+    }
+    release_lock( &bench.lock );
+    return rc;
+}
+
+static void bench_failed( const char* pszWhat, const char* pszWhy )
+{
+    // "%s failed: %s"
+    FWRMSG( stderr, HHC02787, "E", pszWhat, pszWhy );
+
+    obtain_lock( &bench.lock );
+    {
+        bench.fFailed = 1;
+        broadcast_condition( &bench.cond );
+    }
+    release_lock( &bench.lock );
+}
+
+// Wait until frame iSeq may be sent without exceeding the window
+
+static void bench_window( int iSeq )
+{
+    obtain_lock( &bench.lock );
+    {
+        while (!bench.fFailed && iSeq - bench.iReceived >= bench.iWindow)
+            timed_wait_condition_relative_usecs( &bench.cond, &bench.lock,
+                                                 100*1000, NULL );
+    }
+    release_lock( &bench.lock );
+}
+
+// Execute one CCW. Returns 0 if it ended with channel end and
+// device end only, else -1.
+
+static int bench_ccw( DEVBLK* dev, BYTE bCode, BYTE* pBuf, U32 uCount,
+                      U32* puResidual )
+{
+    BYTE  bUnitStat = 0;
+    BYTE  bMore     = 0;
+    U32   uResidual = uCount;
+
+    lcs_device_hndinfo.exec( dev, bCode, 0, 0, uCount, 0, 0,
+                             pBuf, &bMore, &bUnitStat, &uResidual );
+
+    if (puResidual)
+        *puResidual = uResidual;
+
+    return (bUnitStat == (CSW_CE | CSW_DE)) ? 0 : -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Frame builders                                                    */
+/*-------------------------------------------------------------------*/
+
+// An Ethernet II frame carrying a UDP datagram, from the peer to the
+// device when inbound, or from the device to the peer when outbound.
+
+static void bench_build_ip( BYTE* pFrame )
+{
+    eth_hdr*  pEth = (eth_hdr*) pFrame;
+    ip_hdr*   pIP  = (ip_hdr*)  (pFrame + eth_hdr_size);
+    udp_hdr*  pUDP = (udp_hdr*) (pFrame + eth_hdr_size + ip_hdr_size);
+    U32       lGuestIP;
+
+    lGuestIP = inet_addr( BENCH_GUEST_IP );
+
+    memset( pFrame, 0, bench.iSize );
+
+    if (bench.fOutbound)
+    {
+        memset( pEth->ether_dhost, 0xFF, IFHWADDRLEN );
+        memcpy( pEth->ether_shost, bench.bLocalMAC, IFHWADDRLEN );
+        pIP->ip_src = lGuestIP;
+        pIP->ip_dst = htonl( BENCH_PEER_IP );
+    }
+    else
+    {
+        memcpy( pEth->ether_dhost, bench.bLocalMAC, IFHWADDRLEN );
+        memcpy( pEth->ether_shost, bench.bPeerMAC, IFHWADDRLEN );
+        pIP->ip_src = htonl( BENCH_PEER_IP );
+        pIP->ip_dst = lGuestIP;
+    }
+    pEth->ether_type = htons( ETHERTYPE_IP );
+
+    pIP->ip_v   = 4;
+    pIP->ip_hl  = ip_hdr_size / 4;
+    pIP->ip_len = htons( (U16)( bench.iSize - eth_hdr_size ));
+    pIP->ip_ttl = 64;
+    pIP->ip_p   = IPPROTO_UDP;
+
+    pUDP->uh_sport = htons( 9 );
+    pUDP->uh_dport = htons( 9 );
+    pUDP->uh_ulen  = htons( (U16)( bench.iSize - eth_hdr_size - ip_hdr_size ));
+}
+
+// An 802.3 frame carrying an LLC information frame, from the peer
+// SNA station to the device.
+
+static void bench_build_sna( BYTE* pFrame, int iSeq )
+{
+    PETHFRM  pEth = (PETHFRM) pFrame;
+
+    memset( pFrame, 0, bench.iSize );
+
+    memcpy( pEth->bDestMAC, bench.bLocalMAC, IFHWADDRLEN );
+    memcpy( pEth->bSrcMAC,  bench.bPeerMAC,  IFHWADDRLEN );
+    STORE_HW( pEth->hwEthernetType, (U16)( bench.iSize - eth_hdr_size ));
+
+    pEth->bData[0] = LSAP_SNA_Path_Control;         // DSAP
+    pEth->bData[1] = LSAP_SNA_Path_Control;         // SSAP
+    pEth->bData[2] = (BYTE)((iSeq & 0x7F) << 1);    // I-frame, N(S)
+    pEth->bData[3] = 0;                             // N(R)
+}
+
+/*-------------------------------------------------------------------*/
+/* Wire threads                                                      */
+/*-------------------------------------------------------------------*/
+
+// Inbound: write frames to the wire, as the TAP device would deliver
+// them, spreading them over the queues.
+
+static void* bench_wire_sender( void* arg )
+{
+    BYTE   frame[ BENCH_MAX_SIZE ];
+    BYTE*  pStamp;
+    int    i;
+
+    UNREFERENCED( arg );
+
+    if (bench.bMode == LCSDEV_MODE_IP)
+    {
+        bench_build_ip( frame );
+        pStamp = frame + BENCH_IP_STAMP;
+    }
+    else
+        pStamp = frame + BENCH_SNA_STAMP;
+
+    for (i=0; i < bench.iFrames; i++)
+    {
+        bench_window( i );
+        if (bench_done())
+            break;
+
+        if (bench.bMode == LCSDEV_MODE_SNA)
+            bench_build_sna( frame, i );
+
+        bench_stamp( pStamp, i );
+
+        if (write( bench.wire[ i % bench.iWires ], frame, bench.iSize ) != bench.iSize)
+        {
+            bench_failed( "write()", strerror( errno ));
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+// Outbound: read the frames that LCS wrote to the TAP device.
+
+static void* bench_wire_drain( void* arg )
+{
+    struct pollfd  fds[ LCS_MAX_QUEUES ];
+    BYTE   frame[ 2048 ];
+    int    iStamp;
+    int    iLen;
+    int    rc;
+    int    i;
+
+    UNREFERENCED( arg );
+
+    iStamp = (bench.bMode == LCSDEV_MODE_IP) ? BENCH_IP_STAMP
+                                             : BENCH_SNA_STAMP;
+
+    for (i=0; i < bench.iWires; i++)
+    {
+        fds[i].fd     = bench.wire[i];
+        fds[i].events = POLLIN;
+    }
+
+    while (!bench_done())
+    {
+        if ((rc = poll( fds, bench.iWires, 100 )) <= 0)
+        {
+            if (rc < 0 && errno != EINTR)
+            {
+                bench_failed( "poll()", strerror( errno ));
+                break;
+            }
+            continue;
+        }
+
+        for (i=0; i < bench.iWires; i++)
+        {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+
+            while ((iLen = recv( fds[i].fd, frame, sizeof( frame ), MSG_DONTWAIT )) > 0)
+            {
+                if (iLen >= iStamp + BENCH_STAMP_SIZE
+                    && bench_arrived( frame + iStamp, bench_now() ))
+                    bench_progress( 1, iLen );
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* IP mode                                                           */
+/*-------------------------------------------------------------------*/
+
+// Add an LCS command frame to a Write CCW buffer
+
+static int bench_add_cmd( BYTE* pBuf, int iOffset, BYTE bCmdCode, BYTE bInitiator )
+{
+    PLCSSTRTFRM  pFrame = (PLCSSTRTFRM)( pBuf + iOffset );
+
+    memset( pFrame, 0, sizeof( LCSSTRTFRM ));
+
+    iOffset += sizeof( LCSSTRTFRM );
+
+    STORE_HW( pFrame->bLCSCmdHdr.bLCSHdr.hwOffset, (U16) iOffset );
+    pFrame->bLCSCmdHdr.bLCSHdr.bType = LCS_FRMTYP_CMD;
+    pFrame->bLCSCmdHdr.bCmdCode      = bCmdCode;
+    pFrame->bLCSCmdHdr.bInitiator    = bInitiator;
+    pFrame->bLCSCmdHdr.bLanType      = LCS_FRMTYP_ENET;
+
+    if (bCmdCode == LCS_CMD_STARTUP)
+        STORE_HW( pFrame->hwBufferSize, CTC_DEF_FRAME_BUFFER_SIZE );
+
+    STORE_HW( pBuf + iOffset, 0x0000 );
+    return iOffset;
+}
+
+// Startup and Start LAN, as TCP/IP does when the device is started
+
+static int bench_start_ip( void )
+{
+    BYTE   buf[ 256 ];
+    BYTE*  pIOBuf;
+    int    iLen;
+
+    iLen = bench_add_cmd( buf, 0,    LCS_CMD_STARTUP, LCS_INITIATOR_TCPIP );
+    iLen = bench_add_cmd( buf, iLen, LCS_CMD_STRTLAN, LCS_INITIATOR_TCPIP );
+
+    if (bench_ccw( bench.pDEVBLK[ LCSDEV_WRITE_SUBCHANN ], 0x01, buf, iLen + 2, NULL ) != 0)
+    {
+        bench_failed( "Startup", "write CCW" );
+        return -1;
+    }
+
+    // Read the replies
+
+    pIOBuf = malloc( BENCH_BUFSIZE );
+
+    if (bench_ccw( bench.pDEVBLK[ LCSDEV_READ_SUBCHANN ], 0x02, pIOBuf, BENCH_BUFSIZE, NULL ) != 0)
+    {
+        bench_failed( "Startup", "read CCW" );
+        free( pIOBuf );
+        return -1;
+    }
+
+    free( pIOBuf );
+    return 0;
+}
+
+// Inbound: read what LCS has buffered, as the guest does
+
+static void* bench_ip_reader( void* arg )
+{
+    DEVBLK*  dev = bench.pDEVBLK[ LCSDEV_READ_SUBCHANN ];
+    BYTE*    pIOBuf;
+    PLCSHDR  pHdr;
+    U32      uResidual;
+    U32      uLength;
+    U16      hwOffset;
+    U16      hwPrevOffset;
+    U64      uNow;
+    int      iFrames;
+    int      iBytes;
+
+    UNREFERENCED( arg );
+
+    pIOBuf = malloc( BENCH_BUFSIZE );
+
+    while (!bench_done())
+    {
+        lcs_device_hndinfo.start( dev );
+
+        if (bench_ccw( dev, 0x02, pIOBuf, BENCH_BUFSIZE, &uResidual ) != 0)
+        {
+            lcs_device_hndinfo.end( dev );
+            bench_failed( "Read CCW", "unit check or halt" );
+            break;
+        }
+
+        lcs_device_hndinfo.end( dev );
+
+        uNow    = bench_now();
+        uLength = BENCH_BUFSIZE - uResidual;
+        iFrames = 0;
+        iBytes  = 0;
+
+        for (hwPrevOffset = 0; hwPrevOffset + sizeof( LCSHDR ) <= uLength; hwPrevOffset = hwOffset)
+        {
+            pHdr = (PLCSHDR)( pIOBuf + hwPrevOffset );
+            FETCH_HW( hwOffset, pHdr->hwOffset );
+            if (hwOffset <= hwPrevOffset || hwOffset > uLength)
+                break;
+
+            if (1
+                && pHdr->bType == LCS_FRMTYP_ENET
+                && (U32)( hwOffset - hwPrevOffset ) >= sizeof( LCSHDR ) + BENCH_IP_STAMP + BENCH_STAMP_SIZE
+                && bench_arrived( (BYTE*) pHdr + sizeof( LCSHDR ) + BENCH_IP_STAMP, uNow )
+            )
+            {
+                iFrames++;
+                iBytes += hwOffset - hwPrevOffset - sizeof( LCSHDR );
+            }
+        }
+
+        if (iFrames)
+            bench_progress( iFrames, iBytes );
+    }
+
+    free( pIOBuf );
+    return NULL;
+}
+
+// Outbound: write frames, iCount per Write CCW, as the guest does
+
+static void* bench_ip_writer( void* arg )
+{
+    DEVBLK*  dev = bench.pDEVBLK[ LCSDEV_WRITE_SUBCHANN ];
+    BYTE*    pIOBuf;
+    BYTE     frame[ BENCH_MAX_SIZE ];
+    PLCSHDR  pHdr;
+    int      iOffset;
+    int      i, j;
+
+    UNREFERENCED( arg );
+
+    pIOBuf = malloc( BENCH_BUFSIZE );
+    bench_build_ip( frame );
+
+    for (i=0; i < bench.iFrames && !bench_done(); )
+    {
+        bench_window( i + bench.iCount - 1 );
+
+        for (iOffset=0, j=0; j < bench.iCount && i < bench.iFrames; j++, i++)
+        {
+            pHdr = (PLCSHDR)( pIOBuf + iOffset );
+            iOffset += sizeof( LCSHDR ) + bench.iSize;
+
+            STORE_HW( pHdr->hwOffset, (U16) iOffset );
+            pHdr->bType = LCS_FRMTYP_ENET;
+            pHdr->bSlot = 0;
+
+            bench_stamp( frame + BENCH_IP_STAMP, i );
+            memcpy( (BYTE*) pHdr + sizeof( LCSHDR ), frame, bench.iSize );
+        }
+        STORE_HW( pIOBuf + iOffset, 0x0000 );
+
+        lcs_device_hndinfo.start( dev );
+
+        if (bench_ccw( dev, 0x01, pIOBuf, iOffset + 2, NULL ) != 0)
+        {
+            lcs_device_hndinfo.end( dev );
+            bench_failed( "Write CCW", "unit check" );
+            break;
+        }
+
+        lcs_device_hndinfo.end( dev );
+    }
+
+    free( pIOBuf );
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* SNA mode                                                          */
+/*-------------------------------------------------------------------*/
+
+// Run the SCB channel program (Sense Command Byte, Write OCTL, Read)
+// that VTAM uses to read inbound data, and call pfn for each frame
+// following the ICTL. Returns the number of frames, or -1.
+
+typedef void BENCHFRM( PLCSHDR pHdr, int iLen, void* arg );
+
+static int bench_sna_scb( BYTE* pIOBuf, BENCHFRM* pfn, void* arg )
+{
+    DEVBLK*  dev = bench.pDEVBLK[0];
+    BYTE     octl[ sizeof( LCSOCTL ) ];
+    BYTE     sense;
+    BYTE*    pData;
+    PLCSHDR  pHdr;
+    U32      uResidual;
+    U32      uLength;
+    U16      hwOffset;
+    U16      hwPrevOffset;
+    int      iFrames = 0;
+
+    memset( octl, 0, sizeof( octl ));
+
+    lcs_device_hndinfo.start( dev );
+
+    if (0
+        || bench_ccw( dev, 0x14, &sense, 1, NULL ) != 0
+        || bench_ccw( dev, 0x01, octl, sizeof( octl ), NULL ) != 0
+        || bench_ccw( dev, 0x02, pIOBuf, BENCH_BUFSIZE, &uResidual ) != 0
+    )
+    {
+        lcs_device_hndinfo.end( dev );
+        return -1;
+    }
+
+    lcs_device_hndinfo.end( dev );
+
+    // The frame offsets are relative to the end of the ICTL
+
+    uLength = BENCH_BUFSIZE - uResidual;
+    if (uLength <= sizeof( LCSICTL ))
+        return 0;
+    pData    = pIOBuf  + sizeof( LCSICTL );
+    uLength -= sizeof( LCSICTL );
+
+    for (hwPrevOffset = 0; hwPrevOffset + sizeof( LCSHDR ) <= uLength; hwPrevOffset = hwOffset)
+    {
+        pHdr = (PLCSHDR)( pData + hwPrevOffset );
+        FETCH_HW( hwOffset, pHdr->hwOffset );
+        if (hwOffset <= hwPrevOffset || hwOffset > uLength)
+            break;
+
+        pfn( pHdr, hwOffset - hwPrevOffset, arg );
+        iFrames++;
+    }
+
+    return iFrames;
+}
+
+// Write an LCS command with a Write CCW on its own, then read the
+// reply with a Read CCW on its own, as VTAM does when the XCA major
+// node is activated.
+
+static int bench_sna_cmd( BYTE bCmdCode, const char* pszWhat )
+{
+    DEVBLK*  dev = bench.pDEVBLK[0];
+    BYTE     buf[ 256 ];
+    BYTE*    pIOBuf;
+    U32      uResidual;
+    int      iLen;
+    int      i;
+
+    iLen = bench_add_cmd( buf, 0, bCmdCode, LCS_INITIATOR_SNA );
+
+    lcs_device_hndinfo.start( dev );
+    i = bench_ccw( dev, 0x01, buf, iLen + 2, NULL );
+    lcs_device_hndinfo.end( dev );
+
+    if (i != 0)
+    {
+        bench_failed( pszWhat, "write CCW" );
+        return -1;
+    }
+
+    pIOBuf = malloc( BENCH_BUFSIZE );
+
+    for (i=0; i < 50; i++)
+    {
+        lcs_device_hndinfo.start( dev );
+        if (bench_ccw( dev, 0x02, pIOBuf, BENCH_BUFSIZE, &uResidual ) != 0)
+        {
+            lcs_device_hndinfo.end( dev );
+            break;
+        }
+        lcs_device_hndinfo.end( dev );
+
+        if (uResidual < BENCH_BUFSIZE)
+        {
+            free( pIOBuf );
+            return 0;
+        }
+        usleep( 100*1000 );
+    }
+
+    free( pIOBuf );
+    bench_failed( pszWhat, "no reply" );
+    return -1;
+}
+
+static void bench_sna_cc0a( PLCSHDR pHdr, int iLen, void* arg )
+{
+    PLCSBAF1  pBaf1 = (PLCSBAF1)( (BYTE*) pHdr + sizeof( LCSHDR ));
+    U16       hwTypeBaf;
+
+    if (pHdr->bType != LCS_FRMTYP_SNA || iLen < (int)( sizeof( LCSHDR ) + 0x1C ))
+        return;
+
+    FETCH_HW( hwTypeBaf, pBaf1->hwTypeBaf );
+    if (hwTypeBaf == 0xCC0A)
+    {
+        memcpy( bench.bOutToken, pBaf1->bTokenC, sizeof( bench.bOutToken ));
+        *(int*) arg = 1;
+    }
+}
+
+// Start the LAN, then connect to the peer station with a 0C0A baffle
+// in a WCTL channel program (Control, Write OCTL and baffles, Read),
+// and pick the outbound token out of the CC0A reply.
+
+static int bench_start_sna( void )
+{
+    DEVBLK*   dev = bench.pDEVBLK[0];
+    BYTE      buf[ 256 ];
+    BYTE*     pIOBuf;
+    PLCSHDR   pHdr;
+    PLCSBAF1  pBaf1;
+    PLCSBAF2  pBaf2;
+    BYTE      ctl;
+    int       fConnected = 0;
+    int       iLen;
+    int       i;
+
+    if (0
+        || bench_sna_cmd( LCS_CMD_STRTLAN_SNA, "Start LAN SNA" ) != 0
+        || bench_sna_cmd( LCS_CMD_LANSTAT_SNA, "LAN Stats SNA" ) != 0
+    )
+        return -1;
+
+    memset( buf, 0, sizeof( buf ));
+
+    pHdr  = (PLCSHDR)( buf + sizeof( LCSOCTL ));
+    pBaf1 = (PLCSBAF1)( (BYTE*) pHdr + sizeof( LCSHDR ));
+    pBaf2 = (PLCSBAF2)( (BYTE*) pBaf1 + 0x10 );
+    iLen  = sizeof( LCSHDR ) + 0x10 + 0x0A;
+
+    STORE_HW( pHdr->hwOffset, (U16) iLen );
+    pHdr->bType = LCS_FRMTYP_SNA;
+    STORE_HW( pBaf1->hwLenBaf1, 0x10 );
+    STORE_HW( pBaf1->hwTypeBaf, 0x0C0A );
+    STORE_HW( pBaf1->hwLenBaf2, 0x0A );
+    STORE_FW( pBaf1->bTokenB, BENCH_SNA_TOKEN );
+    pBaf2->bByte00 = 0x01;
+    STORE_HW( pBaf2->hwSeqNum, 1 );
+    memcpy( pBaf2->bByte03, bench.bPeerMAC, IFHWADDRLEN );
+    STORE_HW( (BYTE*) pHdr + iLen, 0x0000 );
+
+    pIOBuf = malloc( BENCH_BUFSIZE );
+
+    lcs_device_hndinfo.start( dev );
+    if (0
+        || bench_ccw( dev, 0x17, &ctl, 1, NULL ) != 0
+        || bench_ccw( dev, 0x01, buf, sizeof( LCSOCTL ) + iLen + 2, NULL ) != 0
+        || bench_ccw( dev, 0x02, pIOBuf, BENCH_BUFSIZE, NULL ) != 0
+    )
+    {
+        lcs_device_hndinfo.end( dev );
+        free( pIOBuf );
+        bench_failed( "Connect", "WCTL channel program" );
+        return -1;
+    }
+    lcs_device_hndinfo.end( dev );
+
+    for (i=0; i < 50 && !fConnected; i++)
+    {
+        if (bench_sna_scb( pIOBuf, bench_sna_cc0a, &fConnected ) < 0)
+            break;
+        if (!fConnected)
+            usleep( 100*1000 );
+    }
+
+    free( pIOBuf );
+
+    if (!fConnected)
+    {
+        bench_failed( "Connect", "no CC0A reply" );
+        return -1;
+    }
+
+    obtain_lock( &bench.lock );
+    {
+        bench.iAttns = 0;
+    }
+    release_lock( &bench.lock );
+    return 0;
+}
+
+static void bench_sna_4d10( PLCSHDR pHdr, int iLen, void* arg )
+{
+    PLCSBAF1  pBaf1 = (PLCSBAF1)( (BYTE*) pHdr + sizeof( LCSHDR ));
+    BYTE*     pData;
+    U64*      puNow = arg;
+    U16       hwTypeBaf;
+    U16       hwLenBaf1;
+    U16       hwLenBaf2;
+
+    if (pHdr->bType != LCS_FRMTYP_SNA)
+        return;
+
+    FETCH_HW( hwTypeBaf, pBaf1->hwTypeBaf );
+    FETCH_HW( hwLenBaf1, pBaf1->hwLenBaf1 );
+    FETCH_HW( hwLenBaf2, pBaf1->hwLenBaf2 );
+
+    // The TH follows the first 9 bytes of baffle 2
+
+    pData = (BYTE*) pBaf1 + hwLenBaf1 + 9;
+
+    if (1
+        && hwTypeBaf == 0x4D10
+        && hwLenBaf2 >= 9 + BENCH_STAMP_SIZE
+        && (int)( sizeof( LCSHDR ) + hwLenBaf1 + hwLenBaf2 ) <= iLen
+        && bench_arrived( pData, *puNow )
+    )
+        bench_progress( 1, hwLenBaf2 - 9 );
+}
+
+// Inbound: on each attention run an SCB channel program, as VTAM does
+
+static void* bench_sna_reader( void* arg )
+{
+    BYTE*  pIOBuf;
+    U64    uNow;
+    int    iAttns;
+
+    UNREFERENCED( arg );
+
+    pIOBuf = malloc( BENCH_BUFSIZE );
+
+    while (!bench_done())
+    {
+        obtain_lock( &bench.lock );
+        {
+            while (!bench.iAttns && !bench.fFailed && bench.iReceived < bench.iFrames)
+                timed_wait_condition_relative_usecs( &bench.cond, &bench.lock,
+                                                     100*1000, NULL );
+            iAttns = bench.iAttns;
+            bench.iAttns = 0;
+        }
+        release_lock( &bench.lock );
+
+        if (!iAttns)
+            continue;
+
+        uNow = bench_now();
+
+        if (bench_sna_scb( pIOBuf, bench_sna_4d10, &uNow ) < 0)
+        {
+            bench_failed( "SCB channel program", "unit check" );
+            break;
+        }
+    }
+
+    free( pIOBuf );
+    return NULL;
+}
+
+// Outbound: write 0D10 baffles, iCount per WCTL channel program, as
+// VTAM does for PIUs sent on the connection.
+
+static void* bench_sna_writer( void* arg )
+{
+    DEVBLK*   dev = bench.pDEVBLK[0];
+    BYTE*     pIOBuf;
+    BYTE*     pRead;
+    PLCSHDR   pHdr;
+    PLCSBAF1  pBaf1;
+    PLCSBAF2  pBaf2;
+    BYTE      ctl;
+    int       iTHLen;
+    int       iOffset;
+    int       i, j;
+
+    UNREFERENCED( arg );
+
+    pIOBuf = calloc( 1, BENCH_BUFSIZE );
+    pRead  = malloc( BENCH_BUFSIZE );
+
+    // The frame on the wire is the 802.3 header, the 4 byte LLC and
+    // the TH etc that follows the first 5 bytes of baffle 2.
+
+    iTHLen = bench.iSize - BENCH_SNA_STAMP;
+
+    for (i=0; i < bench.iFrames && !bench_done(); )
+    {
+        bench_window( i + bench.iCount - 1 );
+
+        for (iOffset=0, j=0; j < bench.iCount && i < bench.iFrames; j++, i++)
+        {
+            pHdr  = (PLCSHDR)( pIOBuf + sizeof( LCSOCTL ) + iOffset );
+            pBaf1 = (PLCSBAF1)( (BYTE*) pHdr + sizeof( LCSHDR ));
+            pBaf2 = (PLCSBAF2)( (BYTE*) pBaf1 + 0x0F );
+            iOffset += sizeof( LCSHDR ) + 0x0F + 5 + iTHLen;
+
+            STORE_HW( pHdr->hwOffset, (U16) iOffset );
+            pHdr->bType = LCS_FRMTYP_SNA;
+            pHdr->bSlot = 0;
+            STORE_HW( pBaf1->hwLenBaf1, 0x0F );
+            STORE_HW( pBaf1->hwTypeBaf, 0x0D10 );
+            STORE_HW( pBaf1->hwLenBaf2, (U16)( 5 + iTHLen ));
+            memcpy( pBaf1->bTokenA, bench.bOutToken, sizeof( bench.bOutToken ));
+            pBaf2->bByte00 = 0x01;
+
+            bench_stamp( &pBaf2->bByte05, i );
+        }
+        STORE_HW( pIOBuf + sizeof( LCSOCTL ) + iOffset, 0x0000 );
+
+        lcs_device_hndinfo.start( dev );
+
+        if (0
+            || bench_ccw( dev, 0x17, &ctl, 1, NULL ) != 0
+            || bench_ccw( dev, 0x01, pIOBuf, sizeof( LCSOCTL ) + iOffset + 2, NULL ) != 0
+            || bench_ccw( dev, 0x02, pRead, BENCH_BUFSIZE, NULL ) != 0
+        )
+        {
+            lcs_device_hndinfo.end( dev );
+            bench_failed( "WCTL channel program", "unit check" );
+            break;
+        }
+
+        lcs_device_hndinfo.end( dev );
+    }
+
+    free( pRead );
+    free( pIOBuf );
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Create and initialize the LCS devices                             */
+/*-------------------------------------------------------------------*/
+static int bench_init_devices( int argc, char* argv[] )
+{
+    char*    lcsargv[ 64 ];
+    int      lcsargc = 0;
+    DEVBLK*  dev;
+    int      i;
+
+    if (argc > 60)
+    {
+        bench_failed( "LCS device initialization", "too many options" );
+        return -1;
+    }
+
+    lcsargv[ lcsargc++ ] = "-e";
+    lcsargv[ lcsargc++ ] = (bench.bMode == LCSDEV_MODE_IP) ? "IP" : "SNA";
+    for (i=0; i < argc; i++)
+        lcsargv[ lcsargc++ ] = argv[i];
+    if (bench.bMode == LCSDEV_MODE_IP)
+        lcsargv[ lcsargc++ ] = BENCH_GUEST_IP;
+    lcsargv[ lcsargc ] = NULL;
+
+    bench.iDevs = (bench.bMode == LCSDEV_MODE_IP) ? 2 : 1;
+
+    for (i = bench.iDevs - 1; i >= 0; i--)
+    {
+        dev = calloc( 1, sizeof( DEVBLK ));
+        initialize_lock( &dev->lock );
+        dev->devnum    = BENCH_DEVNUM + i;
+        dev->typname   = "LCS";
+        dev->hnd       = &lcs_device_hndinfo;
+        dev->allocated = 1;
+        dev->fd        = -1;
+        dev->nextdev   = sysblk.firstdev;
+        sysblk.firstdev = dev;
+        bench.pDEVBLK[i] = dev;
+    }
+
+    for (i=0; i < bench.iDevs; i++)
+    {
+        if (lcs_device_hndinfo.init( bench.pDEVBLK[i], lcsargc, lcsargv ) != 0)
+        {
+            bench_failed( "LCS device initialization", "see messages above" );
+            return -1;
+        }
+    }
+
+    // The device answers to the MAC address of the interface, or in
+    // SNA mode (see LCS_MatchFrame) to the one after it.
+
+    memcpy( bench.bLocalMAC, bench.bPortMAC, IFHWADDRLEN );
+#if !defined( OPTION_TUNTAP_LCS_SAME_ADDR )
+    if (bench.bMode == LCSDEV_MODE_SNA)
+        bench.bLocalMAC[5]++;
+#endif
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Report the results                                                */
+/*-------------------------------------------------------------------*/
+
+static int bench_compare( const void* a, const void* b )
+{
+    U64  x = *(const U64*) a;
+    U64  y = *(const U64*) b;
+
+    return (x > y) - (x < y);
+}
+
+static void bench_report( U64 uElapsed )
+{
+    double  secs = (double) uElapsed / 1000000000.0;
+    int     n    = bench.iReceived;
+
+    // (frames not received have a latency of 0 and sort first)
+
+    qsort( bench.pLatency, bench.iFrames, sizeof( U64 ), bench_compare );
+
+    // "%s %s: %d frames of %d bytes in %.3f seconds"
+    WRMSG( HHC02785, "I", (bench.bMode == LCSDEV_MODE_IP) ? "IP" : "SNA",
+        bench.fOutbound ? "outbound" : "inbound", n, bench.iSize, secs );
+
+    // "%.0f frames/s, %.2f MB/s, latency p50 %.1f us, p99 %.1f us"
+    WRMSG( HHC02786, "I", n / secs, bench.uBytes / secs / (1024.0 * 1024.0),
+        bench.pLatency[ bench.iFrames - n + (n * 50) / 100 ] / 1000.0,
+        bench.pLatency[ bench.iFrames - n + MIN( (n * 99) / 100, n - 1 ) ] / 1000.0 );
+}
+
+/*-------------------------------------------------------------------*/
+/* Display command syntax                                            */
+/*-------------------------------------------------------------------*/
+static int syntax( const char* pgm )
+{
+    // "Usage: %s ..."
+    WRMSG( HHC02784, "I", pgm, BENCH_DEF_FRAMES, BENCH_DEF_SIZE,
+        BENCH_DEF_WINDOW, BENCH_DEF_COUNT );
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* LCSBENCH main entry point                                         */
+/*-------------------------------------------------------------------*/
+int main( int argc, char* argv[] )
+{
+    char*    pgm;                       /* less any extension (.ext) */
+    TID      tidWire;                   /* Wire sender or drain      */
+    TID      tidGuest;                  /* Guest reader or writer    */
+    U64      uStart;                    /* Time the run started      */
+    U64      uElapsed;                  /* Duration of the run       */
+    U64      uProgress;                 /* Time of the last progress */
+    int      iReceived;                 /* Frames received so far    */
+    int      i;                         /* Index                     */
+    void*  (*pfnGuest)( void* );        /* Guest side thread         */
+    void*  (*pfnWire) ( void* );        /* Wire side thread          */
+
+    INITIALIZE_UTILITY( UTILITY_NAME, UTILITY_DESC, &pgm );
+
+    bench.bMode     = LCSDEV_MODE_IP;
+    bench.iFrames   = BENCH_DEF_FRAMES;
+    bench.iSize     = BENCH_DEF_SIZE;
+    bench.iWindow   = BENCH_DEF_WINDOW;
+    bench.iCount    = BENCH_DEF_COUNT;
+
+    /* parse the arguments */
+    for (argc--, argv++ ; argc > 0 ; argc--, argv++)
+    {
+        if (strcmp( argv[0], "--" ) == 0)
+        {
+            argc--, argv++;
+            break;
+        }
+
+        if (argv[0][0] != '-' || argv[0][1] == '\0' || argv[0][2] != '\0')
+            return syntax( pgm );
+
+        switch (argv[0][1])
+        {
+            case 'i':  bench.fOutbound = 0;
+                       continue;
+            case 'o':  bench.fOutbound = 1;
+                       continue;
+            case 'e':
+            case 'f':
+            case 's':
+            case 'w':
+            case 'c':  if (argc < 2) return syntax( pgm );
+                       break;
+            default:   return syntax( pgm );
+        }
+
+        switch (argv[0][1])
+        {
+            case 'e':  if      (strcasecmp( argv[1], "IP"  ) == 0) bench.bMode = LCSDEV_MODE_IP;
+                       else if (strcasecmp( argv[1], "SNA" ) == 0) bench.bMode = LCSDEV_MODE_SNA;
+                       else return syntax( pgm );
+                       break;
+            case 'f':  bench.iFrames = atoi( argv[1] );
+                       break;
+            case 's':  bench.iSize   = atoi( argv[1] );
+                       break;
+            case 'w':  bench.iWindow = atoi( argv[1] );
+                       break;
+            case 'c':  bench.iCount  = atoi( argv[1] );
+                       break;
+        }
+        argc--, argv++;
+    }
+
+    if (argc > 0 && argv[0][0] != '-')
+        return syntax( pgm );
+
+    if (bench.iFrames < 1 || bench.iWindow < 1 || bench.iCount < 1)
+        return syntax( pgm );
+
+    bench.iSize = MAX( bench.iSize, BENCH_MIN_SIZE );
+    bench.iSize = MIN( bench.iSize, BENCH_MAX_SIZE );
+
+    // The window must hold a whole Write CCW's worth of frames, and
+    // a Write CCW must fit in its buffer.
+
+    bench.iCount  = MIN( bench.iCount,
+                         (BENCH_BUFSIZE - sizeof( LCSOCTL ) - 2)
+                         / (sizeof( LCSHDR ) + 0x0F + 5 + bench.iSize) );
+    bench.iWindow = MAX( bench.iWindow, bench.iCount );
+
+    bench.pLatency = calloc( bench.iFrames, sizeof( U64 ));
+    if (!bench.pLatency)
+    {
+        bench_failed( "calloc()", strerror( errno ));
+        return -1;
+    }
+
+    // Locally administered addresses for the interface and the peer
+
+    memcpy( bench.bPortMAC, "\x02\x00\x5E\x4C\x43\x53", IFHWADDRLEN );
+    memcpy( bench.bPeerMAC, "\x02\x00\x5E\x50\x45\x52", IFHWADDRLEN );
+
+    initialize_lock( &bench.lock );
+    initialize_condition( &bench.cond );
+
+    if (bench_init_devices( argc, argv ) != 0)
+        return -1;
+
+    if ((bench.bMode == LCSDEV_MODE_IP ? bench_start_ip() : bench_start_sna()) != 0)
+        return -1;
+
+    if (bench.bMode == LCSDEV_MODE_IP)
+        pfnGuest = bench.fOutbound ? bench_ip_writer  : bench_ip_reader;
+    else
+        pfnGuest = bench.fOutbound ? bench_sna_writer : bench_sna_reader;
+    pfnWire = bench.fOutbound ? bench_wire_drain : bench_wire_sender;
+
+    uStart = bench_now();
+
+    if (0
+        || create_thread( &tidGuest, JOINABLE, pfnGuest, NULL, "lcsbench guest" ) != 0
+        || create_thread( &tidWire,  JOINABLE, pfnWire,  NULL, "lcsbench wire"  ) != 0
+    )
+    {
+        bench_failed( "create_thread()", strerror( errno ));
+        return -1;
+    }
+
+    // Wait for all the frames to arrive, or for progress to stop
+
+    iReceived = 0;
+    uProgress = uStart;
+
+    obtain_lock( &bench.lock );
+    while (bench.iReceived < bench.iFrames && !bench.fFailed)
+    {
+        if (bench.iReceived != iReceived)
+        {
+            iReceived = bench.iReceived;
+            uProgress = bench_now();
+        }
+        else if (bench_now() - uProgress >= (U64) BENCH_TIMEOUT * 1000000000)
+            break;
+
+        timed_wait_condition_relative_usecs( &bench.cond, &bench.lock,
+                                             1000*1000, NULL );
+    }
+    uElapsed  = bench.uLastArrival - uStart;
+    iReceived = bench.iReceived;
+    release_lock( &bench.lock );
+
+    if (iReceived < bench.iFrames)
+    {
+        if (!bench.fFailed)
+            // "Timed out after %d seconds: %d of %d frames received"
+            FWRMSG( stderr, HHC02788, "E", BENCH_TIMEOUT, iReceived, bench.iFrames );
+
+        // The guest thread may be waiting in a Read CCW that will
+        // never complete; there is nothing more to be measured.
+
+        exit( EXIT_FAILURE );
+    }
+
+    join_thread( tidWire,  NULL );
+    join_thread( tidGuest, NULL );
+
+    bench_report( uElapsed );
+
+    for (i=0; i < bench.iDevs; i++)
+        lcs_device_hndinfo.close( bench.pDEVBLK[i] );
+
+    return 0;
+}
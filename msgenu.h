@@ -419,10 +419,10 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC00331 "%1d:%04X CCKD file[%d] %s: shadow file check failed, sf command busy on device"
 #define HHC00332 "%1d:%04X CCKD file: display cckd statistics"
 #define HHC00333 "%1d:%04X   32/64       size free  nbr st   reads  writes l2reads    hits switches"
-#define HHC00334 "%1d:%04X                                                      readaheads   misses"
+#define HHC00334 "%1d:%04X                                             readaheads   useful   wasted"
 #define HHC00335 "%1d:%04X ------------------------------------------------------------------------"
 #define HHC00336 "%1d:%04X [*] %s %11.11"PRId64" %3.3"PRId64"%% %4.4"PRId64"    %7.7d %7.7d %7.7d %7.7d  %7.7d"
-#define HHC00337 "%1d:%04X                                                         %7.7d  %7.7d"
+#define HHC00337 "%1d:%04X                                                %7.7d  %7.7d  %7.7d"
 #define HHC00338 "%1d:%04X %s"
 #define HHC00339 "%1d:%04X [0] %s %11.11"PRId64" %3.3"PRId64"%% %4.4"PRId64" %s %7.7d %7.7d %7.7d"
 #define HHC00340 "%1d:%04X %s"
@@ -467,7 +467,8 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC00379 "%1d:%04X CCKD file %s: starting %s level %d%s..."
 #define HHC00380 "%1d:%04X CCKD file %s: %s level %d complete; rc=%d"
 #define HHC00381 "%1d:%04X CCKD file %s: closing device while wrpending=%d cckdioact=%d"
-//efine HHC00382 - HHC00395 (available)
+#define HHC00382 "CCKD io_uring not available: %s; reading ahead one track at a time"
+//efine HHC00383 - HHC00395 (available)
 #define HHC00396 "%1d:%04X %s" // (cckd_trace)
 //efine HHC00397 (available)
 #define HHC00398 "%s" // (trace table)
@@ -734,7 +735,7 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC00874 "mainlock %sheld; owner %4.4x"
 #define HHC00875 "intlock %sheld; owner %4.4x"
 #define HHC00876 "ioq lock %sheld"
-//efine HHC00877 (available)
+#define HHC00877 "Processor %s%02X: synchronizations %"PRIu64" (%"PRIu64" with intlock handoff) in %"PRIu64" usecs; synchronized by others %"PRIu64
 //efine HHC00878 (available)
 //efine HHC00879 (available)
 #define HHC00880 "device %1d:%04X: status %s"
@@ -1461,10 +1462,28 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC02345 "%s device %1d:%04X group has registered IP address %s"
 #define HHC02346 "%s device %1d:%04X group has no registered MAC or IP addresses"
 #define HHC02347 "No %s devices found"
-//efine HHC02348 (available)
+#define HHC02348 "%s device %1d:%04X port %2.2X: %s"
 //efine HHC02349 (available)
-//efine HHC02350 - HHC02359 (available)
-//efine HHC02360 - HHC02369 (available)
+#define HHC02350 "Self-modifying code tracking %s; %"PRIu64" code frame invalidations"
+#define HHC02351 "Frame %16.16"PRIX64" invalidated %10u times%s"
+#define HHC02352 "Self-modifying code counters reset"
+#define HHC02353 "Opcode profiling %s; %"PRIu64" instructions, %"PRIu64" host cycles"
+#define HHC02354 "Opcode Mnemonic           Count      %%            Cycles      %%  Cycles/inst"
+#define HHC02355 "%-6s %-8s %14"PRIu64" %6.2f %17"PRIu64" %6.2f %12.1f"
+#define HHC02356 "Opcode profile written to %s: %d lines"
+#define HHC02357 "Opcode profile counters reset"
+#define HHC02358 "PSW sampling %s every %u msecs; %"PRIu64" samples, %"PRIu64" in wait state"
+#define HHC02359 "Address range                     State          ASN  ASCE                Samples      %%"
+#define HHC02360 "SIMD operand kernels %s; host supports %s"
+#define HHC02361 "%s kernels are not supported by this host"
+#define HHC02362 "Bytes per host cycle for %u byte operands:"
+#define HHC02363 "%-6s %8s %8s %8s"
+#define HHC02364 "CPU telemetry %s every %u msecs%s%s"
+#define HHC02365 "CPU telemetry is already active"
+#define HHC02366 "CPU telemetry to %s failed: %s"
+#define HHC02367 "CPU      Instructions      MIPS  Exec%%  Wait%%  Spin%%  Intr%%  Stop%%   Interrupts"
+#define HHC02368 "%s%02X %17"PRIu64" %9.2f %6.2f %6.2f %6.2f %6.2f %6.2f %12"PRIu64
+//efine HHC02369 (available)
 #define HHC02370 "Automatic tracing started at instrcount %"PRIu64" (BEG+%"PRIu64")"
 #define HHC02371 "Automatic tracing stopped at instrcount %"PRIu64" (AMT+%"PRIu64")"
 #define HHC02372 "Automatic tracing not enabled"
@@ -1472,8 +1491,8 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC02374 "Automatic tracing enabled: BEG=%"PRIu64", AMT=%"PRIu64
 #define HHC02375 "Automatic tracing is active"
 #define HHC02376 "Automatic tracing value(s) must be greater than zero"
-//efine HHC02377 (available)
-//efine HHC02378 (available)
+#define HHC02377 "%16.16"PRIX64"-%16.16"PRIX64" %-14s %4.4X %16.16"PRIX64" %10"PRIu64" %6.2f"
+#define HHC02378 "PSW samples reset"
 //efine HHC02379 (available)
 //efine HHC02380 (available)
 //efine HHC02381 (available)
@@ -2151,7 +2170,23 @@ LOGM_DLL_IMPORT int  panel_command_capture( char* cmd, char** resp, bool quiet )
 #define HHC02781 "Invalid %s parameter: %s"
 #define HHC02782 "LRECL %i and BLOCK %i exceeds maximum AWS blocksize of %i"
 #define HHC02783 "Parameter %s ignored due to NLTAPE option"
-//efine HHC02784 - HHC02799 (available)
+
+// lcsbench
+#define HHC02784 "Usage: %s [options] [-- lcs-options]\n" \
+       "HHC02784I Options:\n" \
+       "HHC02784I   -e IP|SNA   emulation mode (default IP)\n" \
+       "HHC02784I   -i          inbound, wire to guest (default)\n" \
+       "HHC02784I   -o          outbound, guest to wire\n" \
+       "HHC02784I   -f frames   number of frames (default %d)\n" \
+       "HHC02784I   -s size     ethernet frame size (default %d)\n" \
+       "HHC02784I   -w window   maximum frames in flight (default %d)\n" \
+       "HHC02784I   -c count    outbound frames per Write CCW (default %d)\n" \
+       "HHC02784I   lcs-options are passed to the LCS device"
+#define HHC02785 "%s %s: %d frames of %d bytes in %.3f seconds"
+#define HHC02786 "%.0f frames/s, %.2f MB/s, latency p50 %.1f us, p99 %.1f us"
+#define HHC02787 "%s failed: %s"
+#define HHC02788 "Timed out after %d seconds: %d of %d frames received"
+//efine HHC02789 - HHC02799 (available)
 
 // mt_cmd
 #define HHC02800 "%1d:%04X %s complete"
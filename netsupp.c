@@ -360,13 +360,17 @@ void EtherIpv4CkSumOffload( BYTE* pFrame, size_t nBytes )
 }
 
 /*-------------------------------------------------------------------*/
-/*                 Timed read from tuntap device                     */
+/*              Timed wait for a frame from tuntap device            */
+/*-------------------------------------------------------------------*/
+/*                                                                   */
+/* Returns 1 if a frame is ready to be read, 0 if the wait timed out */
+/* or -1 if an error occurred. On Windows there is nothing to wait   */
+/* on (the read itself waits), so 1 is always returned.              */
+/*                                                                   */
 /*-------------------------------------------------------------------*/
 
-int read_tuntap( int fd, BYTE* buffer, size_t nBuffLen, int secs )
+int wait_tuntap( int fd, int secs )
 {
-    int nBytesRead;
-
 #if !defined( OPTION_W32_CTCI ) // (i.e. Linux only)
 
     int rc;
@@ -380,8 +384,90 @@ int read_tuntap( int fd, BYTE* buffer, size_t nBuffLen, int secs )
     if (rc == 0)
         return 0;
 
+#else // defined( OPTION_W32_CTCI )
+
+    UNREFERENCED( fd );
+    UNREFERENCED( secs );
+
 #endif // !defined( OPTION_W32_CTCI ) // (i.e. Linux only)
 
+    return 1;
+}
+
+/*-------------------------------------------------------------------*/
+/*                 Timed read from tuntap device                     */
+/*-------------------------------------------------------------------*/
+
+int read_tuntap( int fd, BYTE* buffer, size_t nBuffLen, int secs )
+{
+    int nBytesRead;
+    int rc;
+
+    if ((rc = wait_tuntap( fd, secs )) <= 0)
+        return rc;
+
     nBytesRead = TUNTAP_Read( fd, buffer, nBuffLen );
     return nBytesRead;
 }
+
+/*-------------------------------------------------------------------*/
+/*           Timed batched read of frames from tuntap device         */
+/*-------------------------------------------------------------------*/
+/*                                                                   */
+/* Waits up to 'secs' seconds for the first frame to arrive and then */
+/* drains as many additional frames as are immediately available,    */
+/* up to 'nMaxFrames' frames in total. 'buffer' points to an array   */
+/* of 'nMaxFrames' slots of 'nBuffLen' bytes each, and the length of */
+/* each frame read is returned in the corresponding 'pFrameLen' slot.*/
+/*                                                                   */
+/* The fd MUST be in non-blocking mode for more than one frame to    */
+/* be read per call (otherwise the drain loop would block waiting    */
+/* for a frame that may never come). On Windows only one frame is    */
+/* ever returned per call.                                           */
+/*                                                                   */
+/* Returns the number of frames read, 0 if the wait timed out (or    */
+/* was interrupted), or -1 if an error occurred on the first read.   */
+/*                                                                   */
+/*-------------------------------------------------------------------*/
+
+int read_tuntap_batch( int fd, BYTE* buffer, size_t nBuffLen,
+                       int* pFrameLen, int nMaxFrames, int secs )
+{
+    int nFrames;
+
+    if (nMaxFrames < 1)
+        return 0;
+
+    if ((pFrameLen[0] = read_tuntap( fd, buffer, nBuffLen, secs )) <= 0)
+    {
+#if !defined( OPTION_W32_CTCI ) // (i.e. Linux only)
+        // (frame was grabbed by someone else after select said ready)
+        if (pFrameLen[0] < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+            return 0;
+#endif
+        return pFrameLen[0];
+    }
+
+    nFrames = 1;
+
+#if !defined( OPTION_W32_CTCI ) // (i.e. Linux only)
+
+    // Drain any other frames that are already waiting...
+
+    while (nFrames < nMaxFrames)
+    {
+        pFrameLen[ nFrames ] = TUNTAP_Read( fd, buffer + (nFrames * nBuffLen), nBuffLen );
+
+        // (EAGAIN, EINTR or some other error: stop draining
+        //  and let the next call report any persistent error)
+
+        if (pFrameLen[ nFrames ] <= 0)
+            break;
+
+        nFrames++;
+    }
+
+#endif // !defined( OPTION_W32_CTCI ) // (i.e. Linux only)
+
+    return nFrames;
+}
@@ -171,6 +171,9 @@ extern U16  PseudoHdrCheckSum ( ip_hdr* pIP );
 
 #define DEF_NET_READ_TIMEOUT_SECS   (5)
 
+extern int wait_tuntap( int fd, int secs );
 extern int read_tuntap( int fd, BYTE* buffer, size_t nBuffLen, int secs );
+extern int read_tuntap_batch( int fd, BYTE* buffer, size_t nBuffLen,
+                              int* pFrameLen, int nMaxFrames, int secs );
 
 #endif // _NETSUPP_H_
@@ -275,6 +275,60 @@ extern int iprint_router_func( BYTE inst[], char mnemonic[], char* prtbuf );
 
 #endif // defined( OPTION_INSTRUCTION_COUNTING )
 
+/*-------------------------------------------------------------------*/
+/*                    Opcode execution profiling                     */
+/*-------------------------------------------------------------------*/
+/* While profiling is active the CPU run loop dispatches through a   */
+/* table whose every entry is the profiling function, which counts   */
+/* the instruction, times it with the host cycle counter and then    */
+/* calls the real instruction function. When profiling is inactive   */
+/* the normal opcode table is used and nothing is counted. Each CPU  */
+/* has OPPROF_OPCODES counts followed by OPPROF_OPCODES cycle totals */
+/* indexed by opprof_index, which combines the first opcode byte and */
+/* its extended opcode (the same bytes used to route instruction     */
+/* tracing). Cycles spent in an instruction which ends in a program  */
+/* interrupt are not included as it does not return normally.        */
+/*-------------------------------------------------------------------*/
+
+#define OPPROF_OPCODES      0x10000
+#define OPPROF_COUNT(_cpu)  (sysblk.opprof[(_cpu)])
+#define OPPROF_CYCLES(_cpu) (sysblk.opprof[(_cpu)] + OPPROF_OPCODES)
+
+static inline U16 opprof_index( BYTE inst[] )
+{
+    switch (inst[0])
+    {
+    case 0x01: case 0xA4: case 0xA6: case 0xB2: case 0xB3:
+    case 0xB9: case 0xE4: case 0xE5: case 0xE6:
+        return (inst[0] << 8) | inst[1];
+
+    case 0xA5: case 0xA7: case 0xC0: case 0xC2: case 0xC4:
+    case 0xC6: case 0xC8: case 0xCC:
+        return (inst[0] << 8) | (inst[1] & 0x0F);
+
+    case 0xE3: case 0xEB: case 0xEC: case 0xED:
+        return (inst[0] << 8) | inst[5];
+
+    default:
+        return (inst[0] << 8);
+    }
+}
+
+/* Host cycle counter: the time stamp counter where there is one,
+   otherwise the monotonic clock in nanoseconds */
+static inline U64 host_cycles()
+{
+#if defined( _MSVC_ )
+    return __rdtsc();
+#elif defined( __GNUC__ ) && (defined( __x86_64__ ) || defined( __i386__ ))
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ((U64) ts.tv_sec * 1000000000) + ts.tv_nsec;
+#endif
+}
+
 /*-------------------------------------------------------------------*/
 /*                         SIE macros                                */
 /*                 (architecture INDEPENDENT)                        */
@@ -1377,7 +1431,12 @@ do {                                                                  \
 
 #endif /*!defined( FEATURE_BASIC_FP_EXTENSIONS )*/
 
-#define TLBIX(_addr) (((VADR_L)(_addr) >> TLB_PAGESHIFT) & TLB_MASK)
+/* TLB set index (also the index of the set's way 0 entry) */
+#define TLBIX(_regs, _addr) \
+   (((VADR_L)(_addr) >> TLB_PAGESHIFT) & (_regs)->tlbsetmask)
+
+/* Number of TLB entries in use */
+#define TLB_ENTRIES(_regs) ((int)((_regs)->tlbsets * (_regs)->tlbways))
 
 #define MAINADDR(_main, _addr) \
    (BYTE*)((uintptr_t)(_main) ^ (uintptr_t)(_addr))
@@ -1801,6 +1860,7 @@ void z900_process_trace( REGS* regs, BYTE* dest );
 #endif
 
 int cpu_init (int cpu, REGS *regs, REGS *hostregs);
+void init_opprof_tables();
 void ARCH_DEP( perform_io_interrupt ) (REGS *regs);
 void ARCH_DEP( checkstop_config )(void);
 
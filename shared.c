@@ -672,7 +672,8 @@ BYTE     buf[SHARED_PURGE_MAX * 4];     /* Purge list                */
     /* Make previous active entry active again */
     if (dev->cache >= 0)
     {
-        cache_lock (CACHE_DEVBUF);
+        int cache = dev->cache;
+        cache_lock_entry (CACHE_DEVBUF, cache);
         SHRD_CACHE_GETKEY (dev->cache, devnum, trk);
         if (dev->devnum == devnum && dev->bufcur == trk)
             cache_setflag(CACHE_DEVBUF, dev->cache, ~0, SHRD_CACHE_ACTIVE);
@@ -681,7 +682,7 @@ BYTE     buf[SHARED_PURGE_MAX * 4];     /* Purge list                */
             dev->cache = dev->bufcur = -1;
             dev->buf = NULL;
         }
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_entry (CACHE_DEVBUF, cache);
     }
 } /* shared_start */
 
@@ -702,9 +703,9 @@ int      rc;                            /* Return code               */
     /* Mark the active entry inactive */
     if (dev->cache >= 0)
     {
-        cache_lock (CACHE_DEVBUF);
+        cache_lock_entry (CACHE_DEVBUF, dev->cache);
         cache_setflag (CACHE_DEVBUF, dev->cache, ~SHRD_CACHE_ACTIVE, 0);
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_entry (CACHE_DEVBUF, dev->cache);
     }
 
     /* Send the END request */
@@ -729,6 +730,7 @@ int      rc;                            /* Return code               */
 int      retries = 10;                  /* Number read retries       */
 int      cache;                         /* Lookup index              */
 int      lru;                           /* Available index           */
+U64      key;                           /* Cache key of the track    */
 int      len;                           /* Response length           */
 int      id;                            /* Response id               */
 BYTE    *buf;                           /* Cache buffer              */
@@ -758,23 +760,28 @@ BYTE     hdr[SHRD_HDR_SIZE + 4];        /* Read request header       */
     dev->bufoff = 0;
     dev->bufoffhi = dev->ckdtrksz;
 
-    cache_lock (CACHE_DEVBUF);
-
     /* Inactivate the previous image */
     if (dev->cache >= 0)
+    {
+        cache_lock_entry (CACHE_DEVBUF, dev->cache);
         cache_setflag (CACHE_DEVBUF, dev->cache, ~SHRD_CACHE_ACTIVE, 0);
+        cache_unlock_entry (CACHE_DEVBUF, dev->cache);
+    }
     dev->cache = dev->bufcur = -1;
 
+    key = SHRD_CACHE_SETKEY(dev->devnum, trk);
+    cache_lock_key (CACHE_DEVBUF, key);
+
 cache_retry:
 
     /* Lookup the track in the cache */
-    cache = cache_lookup (CACHE_DEVBUF, SHRD_CACHE_SETKEY(dev->devnum, trk), &lru);
+    cache = cache_lookup (CACHE_DEVBUF, key, &lru);
 
     /* Process cache hit */
     if (cache >= 0)
     {
         cache_setflag (CACHE_DEVBUF, cache, ~0, SHRD_CACHE_ACTIVE);
-        cache_unlock (CACHE_DEVBUF);
+        cache_unlock_key (CACHE_DEVBUF, key);
         dev->cachehits++;
         dev->cache = cache;
         dev->buf = cache_getbuf (CACHE_DEVBUF, cache, 0);
@@ -792,7 +799,7 @@ cache_retry:
     {
         SHRDTRACE( "ckd read trk %d cache wait", trk );
         dev->cachewaits++;
-        cache_wait (CACHE_DEVBUF);
+        cache_wait (CACHE_DEVBUF, key);
         goto cache_retry;
     }
 
@@ -800,11 +807,11 @@ cache_retry:
     SHRDTRACE( "ckd read trk %d cache miss %d", trk, dev->cache );
     dev->cachemisses++;
     cache_setflag (CACHE_DEVBUF, lru, 0, SHRD_CACHE_ACTIVE|DEVBUF_TYPE_SCKD);
-    cache_setkey (CACHE_DEVBUF, lru, SHRD_CACHE_SETKEY(dev->devnum, trk));
+    cache_setkey (CACHE_DEVBUF, lru, key);
     cache_setage (CACHE_DEVBUF, lru);
     buf = cache_getbuf (CACHE_DEVBUF, lru, dev->ckdtrksz);
 
-    cache_unlock (CACHE_DEVBUF);
+    cache_unlock_key (CACHE_DEVBUF, key);
 
 read_retry:
 
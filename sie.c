@@ -901,6 +901,9 @@ static int ARCH_DEP( run_sie )( REGS* regs )
         if (!(icode = setjmp( GUESTREGS->progjmp )))
         {
             PTT_SIE( "run_sie run...", 0, 0, 0 );
+
+            /* Back to executing after a guest interrupt or intercept */
+            cputelem_enter( regs, CPUTELEM_EXEC );
             do
             {
                 SIE_PERFMON( SIE_PERF_RUNLOOP_2 );
@@ -1016,12 +1019,14 @@ static int ARCH_DEP( run_sie )( REGS* regs )
 
                             sysblk.waiting_mask  |=  regs->cpubit;
                             sysblk.intowner       =  LOCK_OWNER_NONE;
+                            cputelem_enter( regs, CPUTELEM_WAIT );
                             {
                                 timed_wait_condition( &regs->intcond, &sysblk.intlock, &waittime );
 
                                 while (sysblk.syncing)
                                      wait_condition( &sysblk.sync_done_cond, &sysblk.intlock );
                             }
+                            cputelem_enter( regs, CPUTELEM_EXEC );
                             sysblk.intowner       =   regs->cpuad;
                             sysblk.waiting_mask  &=  ~regs->cpubit;
 
@@ -1087,17 +1092,17 @@ sie_fetch_instruction:
 
                 PROCESS_TRACE( GUESTREGS, ip, sie_fetch_instruction );
                 EXECUTE_INSTRUCTION( current_opcode_table, ip, GUESTREGS );
-                regs->instcount++;
-                UPDATE_SYSBLK_INSTCOUNT( 1 );
+                UPDATE_INSTCOUNT( regs, 1 );
                 SIE_PERFMON( SIE_PERF_EXEC_U );
 
                 for (i=0; i < MAX_CPU_LOOPS/2; i++)
                 {
+                    GUESTREGS->execpos = i;
                     UNROLLED_EXECUTE( current_opcode_table, GUESTREGS );
                     UNROLLED_EXECUTE( current_opcode_table, GUESTREGS );
                 }
-                regs->instcount +=  (i * 2);
-                UPDATE_SYSBLK_INSTCOUNT( (i * 2) );
+                GUESTREGS->execpos = -1;
+                UPDATE_INSTCOUNT( regs, i * 2 );
 
                 /* Perform automatic instruction tracing if it's enabled */
                 do_automatic_tracing();
@@ -1114,12 +1119,13 @@ txf_facility_loop:
 
                 PROCESS_TRACE( GUESTREGS, ip, sie_fetch_instruction );
                 EXECUTE_INSTRUCTION( current_opcode_table, ip, GUESTREGS );
-                regs->instcount++;
-                UPDATE_SYSBLK_INSTCOUNT( 1 );
+                UPDATE_INSTCOUNT( regs, 1 );
                 SIE_PERFMON( SIE_PERF_EXEC_U );
 
                 for (i=0; i < MAX_CPU_LOOPS/2; i++)
                 {
+                    GUESTREGS->execpos = i;
+
                     if (GUESTREGS->txf_tnd)
                         break;
 
@@ -1130,8 +1136,8 @@ txf_facility_loop:
 
                     UNROLLED_EXECUTE( current_opcode_table, GUESTREGS );
                 }
-                regs->instcount +=  (i * 2);
-                UPDATE_SYSBLK_INSTCOUNT( (i * 2) );
+                GUESTREGS->execpos = -1;
+                UPDATE_INSTCOUNT( regs, i * 2 );
 
                 /* Perform automatic instruction tracing if it's enabled */
                 do_automatic_tracing();
@@ -1141,12 +1147,13 @@ txf_slower_loop:
 
                 PROCESS_TRACE( GUESTREGS, ip, sie_fetch_instruction );
                 TXF_EXECUTE_INSTRUCTION( current_opcode_table, ip, GUESTREGS );
-                regs->instcount++;
-                UPDATE_SYSBLK_INSTCOUNT( 1 );
+                UPDATE_INSTCOUNT( regs, 1 );
                 SIE_PERFMON( SIE_PERF_EXEC_U );
 
                 for (i=0; i < MAX_CPU_LOOPS/2; i++)
                 {
+                    GUESTREGS->execpos = i;
+
                     if (!GUESTREGS->txf_tnd)
                         break;
 
@@ -1157,8 +1164,8 @@ txf_slower_loop:
 
                     TXF_UNROLLED_EXECUTE( current_opcode_table, GUESTREGS );
                 }
-                regs->instcount +=  (i * 2);
-                UPDATE_SYSBLK_INSTCOUNT( (i * 2) );
+                GUESTREGS->execpos = -1;
+                UPDATE_INSTCOUNT( regs, i * 2 );
 
                 /* Perform automatic instruction tracing if it's enabled */
                 do_automatic_tracing();
@@ -1203,16 +1210,20 @@ endloop:        ; // (nop to make compiler happy)
             /* Our above instruction execution loop didn't finish due
                to a longjmp(progjmp) having been done, bringing us to
                here, thereby causing the instruction counter to not be
-               properly updated. Thus, we must update it here instead.
+               properly updated. Thus, we must update it here instead,
+               from the number of unrolled loop iterations completed.
+               (Approximately: the iteration in progress is not counted;
+               see run_cpu.)
            */
             if (sysblk.ipled)
             {
-                regs->instcount += MAX_CPU_LOOPS/2;
-                UPDATE_SYSBLK_INSTCOUNT( MAX_CPU_LOOPS/2 );
+                if (GUESTREGS->execpos >= 0)
+                    UPDATE_INSTCOUNT( regs, GUESTREGS->execpos * 2 );
 
                 /* Perform automatic instruction tracing if it's enabled */
                 do_automatic_tracing();
             }
+            GUESTREGS->execpos = -1;
         }
 
         PTT_SIE( "run_sie !run", icode, 0, 0 );
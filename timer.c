@@ -155,6 +155,463 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
 } /* end function check_timer_event */
 
 
+/*-------------------------------------------------------------------*/
+/* Record each started CPU's current PSW in its PSW sample ring      */
+/*                                                                   */
+/* The timer thread is the only writer of the rings: the sample is   */
+/* stored first and the head advanced afterwards, so that readers    */
+/* (see pswsamp_histogram) never need to take a lock.                */
+/*-------------------------------------------------------------------*/
+static void sample_psws( void )
+{
+int       i;                            /* Loop index                */
+REGS     *regs;                         /* -> REGS                   */
+PSWRING  *ring;                         /* -> CPU's sample ring      */
+PSWSAMP  *samp;                         /* -> Sample being stored    */
+uintptr_t off;                          /* Offset of ip in its page  */
+
+    for (i=0; i < sysblk.hicpu; i++)
+    {
+        if (!(ring = sysblk.pswring[i]))
+            continue;
+
+        obtain_lock( &sysblk.cpulock[ i ]);
+        {
+            if (!IS_CPU_ONLINE( i )
+                || sysblk.regs[i]->cpustate != CPUSTATE_STARTED)
+            {
+                release_lock( &sysblk.cpulock[ i ]);
+                continue;
+            }
+
+            regs = sysblk.regs[i];
+            samp = &ring->samp[ ring->head & (PSWSAMP_RING - 1) ];
+            samp->flags = 0;
+
+#if defined( _FEATURE_SIE )
+            /* Attribute time spent in SIE to the guest's PSW */
+            if (regs->sie_active && GUESTREGS)
+            {
+                regs = GUESTREGS;
+                samp->flags |= PSWSAMP_SIE;
+            }
+#endif
+            /* The PSW IA is only kept current at page boundaries,
+               so derive it from the instruction pointer if we can */
+            off = (uintptr_t)regs->ip - (uintptr_t)regs->aip;
+            if (VALID_AIE( regs ) && off < 0x1000)
+                samp->ia = regs->AIV_G + off;
+            else
+                samp->ia = regs->psw.IA_G;
+            samp->ia &= regs->psw.AMASK_G;
+
+            if (PROBSTATE( &regs->psw ))
+                samp->flags |= PSWSAMP_PROB;
+            if (WAITSTATE( &regs->psw ))
+                samp->flags |= PSWSAMP_WAIT;
+
+            if (0
+                || !(regs->psw.sysmask & PSW_DATMODE)
+                || (regs->arch_mode == ARCH_370_IDX && !ECMODE( &regs->psw ))
+            )
+            {
+                samp->flags |= PSWSAMP_REAL;
+                samp->asce = 0;
+                samp->asn  = 0;
+            }
+            else
+            {
+                samp->asce = regs->arch_mode == ARCH_900_IDX ?
+                             regs->CR_G(1) : regs->CR_L(1);
+                samp->asn  = regs->arch_mode == ARCH_370_IDX ?
+                             0 : regs->CR_LHL(4);
+            }
+        }
+        release_lock( &sysblk.cpulock[ i ]);
+
+        /* Publish the sample only once it is completely stored */
+        HARDWARE_SYNC();
+        ring->head++;
+    }
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Build a histogram of the sampled PSWs                             */
+/*                                                                   */
+/* Samples are grouped by address space, state and instruction       */
+/* address range (2**shift bytes) and returned most frequent first   */
+/* in a malloc'ed table that the caller must free.  Wait state       */
+/* samples are counted in *waits but are not part of any range.      */
+/* Returns the number of ranges, or -1 if no storage is available.   */
+/*-------------------------------------------------------------------*/
+static int pswhist_sort_key( const void* a, const void* b )
+{
+    const PSWHIST* ha = a;
+    const PSWHIST* hb = b;
+
+    if (ha->asce  != hb->asce)  return ha->asce  < hb->asce  ? -1 : 1;
+    if (ha->asn   != hb->asn)   return ha->asn   < hb->asn   ? -1 : 1;
+    if (ha->flags != hb->flags) return ha->flags < hb->flags ? -1 : 1;
+    if (ha->addr  != hb->addr)  return ha->addr  < hb->addr  ? -1 : 1;
+    return 0;
+}
+
+static int pswhist_sort_count( const void* a, const void* b )
+{
+    const PSWHIST* ha = a;
+    const PSWHIST* hb = b;
+
+    if (ha->count != hb->count)
+        return ha->count < hb->count ? 1 : -1;
+    return pswhist_sort_key( a, b );
+}
+
+/* Describe the state of a sampled PSW (PSWSAMP_xxxx flags) */
+DLL_EXPORT const char* pswsamp_state( BYTE flags )
+{
+    static const char* states[8] =
+    {
+        "super",     "prob",     "super/real",     "prob/real",
+        "super/SIE", "prob/SIE", "super/SIE/real", "prob/SIE/real",
+    };
+
+    return states[ ((flags & PSWSAMP_PROB) ? 1 : 0)
+                 | ((flags & PSWSAMP_REAL) ? 2 : 0)
+                 | ((flags & PSWSAMP_SIE)  ? 4 : 0) ];
+}
+
+DLL_EXPORT int pswsamp_histogram( PSWHIST** tab, int shift, U64* total, U64* waits )
+{
+int       cpu, i, j, n = 0;             /* Indexes                   */
+PSWRING  *ring;                         /* -> CPU's sample ring      */
+PSWSAMP  *samp;                         /* -> Sample                 */
+PSWHIST  *hist;                         /* -> Histogram              */
+U64       head, first, s;               /* Ring positions            */
+int       rings = 0;                    /* Number of sample rings    */
+
+    *tab   = NULL;
+    *total = *waits = 0;
+
+    for (cpu = 0; cpu < MAX_CPU_ENGS; cpu++)
+        if (sysblk.pswring[ cpu ])
+            rings++;
+
+    if (!(hist = malloc( (rings ? rings : 1) * PSWSAMP_RING * sizeof( PSWHIST ))))
+        return -1;
+
+    for (cpu = 0; cpu < MAX_CPU_ENGS; cpu++)
+    {
+        if (!(ring = sysblk.pswring[ cpu ]))
+            continue;
+
+        head = ring->head;
+        HARDWARE_SYNC();
+
+        /* Leave the oldest few samples alone: the timer thread
+           may be overwriting them while we are reading */
+        first = head > PSWSAMP_RING - 64 ? head - (PSWSAMP_RING - 64) : 0;
+        if (first < ring->base)
+            first = ring->base;
+
+        for (s = first; s < head; s++)
+        {
+            samp = &ring->samp[ s & (PSWSAMP_RING - 1) ];
+            (*total)++;
+
+            if (samp->flags & PSWSAMP_WAIT)
+            {
+                (*waits)++;
+                continue;
+            }
+
+            hist[n].addr  = samp->ia >> shift << shift;
+            hist[n].asce  = samp->asce;
+            hist[n].asn   = samp->asn;
+            hist[n].flags = samp->flags;
+            hist[n].count = 1;
+            n++;
+        }
+    }
+
+    /* Collapse identical ranges, then order by frequency */
+    if (n)
+    {
+        qsort( hist, n, sizeof( PSWHIST ), pswhist_sort_key );
+
+        for (j = 0, i = 1; i < n; i++)
+        {
+            if (pswhist_sort_key( &hist[j], &hist[i] ) == 0)
+                hist[j].count++;
+            else
+                hist[ ++j ] = hist[i];
+        }
+        n = j + 1;
+
+        qsort( hist, n, sizeof( PSWHIST ), pswhist_sort_count );
+    }
+
+    *tab = hist;
+    return n;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Take a consistent copy of a CPU's telemetry counters              */
+/*                                                                   */
+/* The time the CPU has spent so far in its current state (up to     */
+/* host monotonic time `now') is charged to that state in the copy.  */
+/* The CPU thread never waits for us: if it changes state while we   */
+/* are copying, the sequence number tells us to copy again.          */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void cputelem_snapshot( int cpu, CPUTELEM* snap, U64 now )
+{
+CPUTELEM *t = &sysblk.cputelem[ cpu ];  /* -> CPU's telemetry block  */
+U64       seq;                          /* Sequence number           */
+int       i;                            /* State index               */
+
+    do
+    {
+        seq = CPUTELEM_LOAD( &t->seq );
+        CPUTELEM_ACQUIRE();
+
+        for (i=0; i < CPUTELEM_STATES; i++)
+            snap->ns[i] = CPUTELEM_LOAD( &t->ns[i] );
+        snap->since = CPUTELEM_LOAD( &t->since );
+        snap->state = CPUTELEM_LOAD( &t->state );
+
+        CPUTELEM_ACQUIRE();
+    }
+    while ((seq & 1) || seq != CPUTELEM_LOAD( &t->seq ));
+
+    snap->seq       = seq;
+    snap->instcount = CPUTELEM_LOAD( &t->instcount );
+    snap->intcount  = CPUTELEM_LOAD( &t->intcount  );
+
+    if (snap->state < CPUTELEM_STATES && now > snap->since)
+        snap->ns[ snap->state ] += now - snap->since;
+}
+
+/* Name of a CPUTELEM_xxxx state */
+DLL_EXPORT const char* cputelem_state( U64 state )
+{
+    static const char* states[ CPUTELEM_STATES ] =
+    {
+        "exec", "wait", "spin", "intr", "stopped",
+    };
+
+    return state < CPUTELEM_STATES ? states[ state ] : "?";
+}
+
+
+/*-------------------------------------------------------------------*/
+/* CPU telemetry feed                                                */
+/*                                                                   */
+/* While sysblk.cputelemetry is on, one JSON object per online CPU   */
+/* is written every sysblk.cputelemint milliseconds, one per line,   */
+/* to either a file (appended to) or a TCP connection to host:port.  */
+/* Counters are cumulative since the CPU was brought online; "mips"  */
+/* is the instruction rate over the interval just ended.             */
+/*-------------------------------------------------------------------*/
+static FILE*  cputelem_file = NULL;     /* Output file, or...        */
+static int    cputelem_sock = -1;       /* ...output socket          */
+
+static int cputelem_write( const char* buf, int len )
+{
+    if (cputelem_file)
+        return fwrite( buf, 1, len, cputelem_file ) == (size_t) len ? 0 : -1;
+    return write_socket( cputelem_sock, buf, len ) == len ? 0 : -1;
+}
+
+static void cputelem_close()
+{
+    if (cputelem_file)
+        fclose( cputelem_file );
+    if (cputelem_sock >= 0)
+        close_socket( cputelem_sock );
+    cputelem_file = NULL;
+    cputelem_sock = -1;
+}
+
+static void* cputelem_thread( void* argp )
+{
+U64       previnst[ MAX_CPU_ENGS ];     /* Instructions last interval*/
+U64       prevtime;                     /* Host ns of last interval  */
+U64       now, ms;                      /* Times                     */
+U64       interval, waited, nap;        /* Microseconds              */
+CPUTELEM  snap;                         /* CPU's counters            */
+struct timeval tv;                      /* Time of day for stamps    */
+double    mips;                         /* MIPS over the interval    */
+char      buf[512];                     /* One JSON line             */
+int       cpu, len;
+
+    UNREFERENCED( argp );
+
+    /* Rates start from the counters as they are now */
+    prevtime = host_nanos();
+    for (cpu=0; cpu < MAX_CPU_ENGS; cpu++)
+    {
+        cputelem_snapshot( cpu, &snap, prevtime );
+        previnst[ cpu ] = snap.instcount;
+    }
+
+    while (sysblk.cputelemetry)
+    {
+        /* Sleep for the interval, in short naps so that
+           "cputelem off" doesn't have to wait very long */
+        interval = (U64) sysblk.cputelemint * 1000;
+        for (waited = 0; sysblk.cputelemetry && waited < interval; waited += nap)
+        {
+            nap = MIN( 50000, interval - waited );
+            usleep( (useconds_t) nap );
+        }
+        if (!sysblk.cputelemetry)
+            break;
+
+        now = host_nanos();
+        gettimeofday( &tv, NULL );
+        ms = ((U64) tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+
+        for (cpu=0; cpu < sysblk.hicpu; cpu++)
+        {
+            if (!IS_CPU_ONLINE( cpu ))
+                continue;
+
+            cputelem_snapshot( cpu, &snap, now );
+
+            /* (The counters start over when a CPU comes online) */
+            mips = snap.instcount < previnst[ cpu ] || now <= prevtime ? 0.0
+                 : (double)(snap.instcount - previnst[ cpu ]) * 1000.0
+                 / (double)(now - prevtime);
+            previnst[ cpu ] = snap.instcount;
+
+            len = snprintf( buf, sizeof( buf ),
+                "{\"time\":%"PRIu64",\"cpu\":%d,\"type\":\"%s\","
+                "\"state\":\"%s\",\"instructions\":%"PRIu64","
+                "\"mips\":%.3f,\"interrupts\":%"PRIu64","
+                "\"exec_ns\":%"PRIu64",\"wait_ns\":%"PRIu64","
+                "\"spin_ns\":%"PRIu64",\"intr_ns\":%"PRIu64","
+                "\"stopped_ns\":%"PRIu64"}\n",
+                ms, cpu, PTYPSTR( cpu ), cputelem_state( snap.state ),
+                snap.instcount, mips, snap.intcount,
+                snap.ns[ CPUTELEM_EXEC ], snap.ns[ CPUTELEM_WAIT ],
+                snap.ns[ CPUTELEM_SPIN ], snap.ns[ CPUTELEM_INTR ],
+                snap.ns[ CPUTELEM_STOPPED ]);
+
+            if (cputelem_write( buf, len ) != 0)
+            {
+                // "CPU telemetry to %s failed: %s"
+                WRMSG( HHC02366, "E", sysblk.cputelemto, strerror( errno ));
+                sysblk.cputelemetry = FALSE;
+                break;
+            }
+        }
+        prevtime = now;
+
+        if (cputelem_file)
+            fflush( cputelem_file );
+    }
+
+    cputelem_close();
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Start the CPU telemetry feed to a file or to host:port            */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int cputelem_start( const char* target, U32 msecs )
+{
+char      host[256];                    /* Host name or address      */
+const char* colon;                      /* -> ":port"                */
+struct sockaddr_in sin;                 /* Host address              */
+struct hostent* he;                     /* Resolved host             */
+int       port, rc;
+char      c;
+
+    if (sysblk.cputelemetry)
+    {
+        // "CPU telemetry is already active"
+        WRMSG( HHC02365, "E" );
+        return -1;
+    }
+
+    /* Reap the thread of a feed that ended on an error */
+    cputelem_stop();
+
+    /* host:port (port numeric) means a TCP connection */
+    colon = strrchr( target, ':' );
+    if (colon && colon != target
+        && (size_t)(colon - target) < sizeof( host )
+        && sscanf( colon + 1, "%d%c", &port, &c ) == 1
+        && port > 0 && port <= 65535)
+    {
+        memcpy( host, target, colon - target );
+        host[ colon - target ] = 0;
+
+        memset( &sin, 0, sizeof( sin ));
+        sin.sin_family = AF_INET;
+        sin.sin_port   = htons( (U16) port );
+
+        if (!inet_aton( host, &sin.sin_addr ))
+        {
+            if (!(he = gethostbyname( host )) || he->h_addrtype != AF_INET)
+            {
+                // "CPU telemetry to %s failed: %s"
+                WRMSG( HHC02366, "E", target, "unknown host" );
+                return -1;
+            }
+            memcpy( &sin.sin_addr, he->h_addr, sizeof( sin.sin_addr ));
+        }
+
+        if ((cputelem_sock = socket( AF_INET, SOCK_STREAM, 0 )) < 0
+            || connect( cputelem_sock, (struct sockaddr*) &sin, sizeof( sin )) < 0)
+        {
+            // "CPU telemetry to %s failed: %s"
+            WRMSG( HHC02366, "E", target, strerror( HSO_errno ));
+            cputelem_close();
+            return -1;
+        }
+    }
+    else if (!(cputelem_file = fopen( target, "a" )))
+    {
+        // "CPU telemetry to %s failed: %s"
+        WRMSG( HHC02366, "E", target, strerror( errno ));
+        return -1;
+    }
+
+    free( sysblk.cputelemto );
+    sysblk.cputelemto   = strdup( target );
+    sysblk.cputelemint  = msecs;
+    sysblk.cputelemetry = TRUE;
+
+    if ((rc = create_thread( &sysblk.cputelemtid, JOINABLE,
+        cputelem_thread, NULL, CPUTELEM_THREAD_NAME )) != 0)
+    {
+        // "Error in function create_thread(): %s"
+        WRMSG( HHC00102, "E", strerror( rc ));
+        sysblk.cputelemetry = FALSE;
+        sysblk.cputelemtid  = 0;
+        cputelem_close();
+        return -1;
+    }
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Stop the CPU telemetry feed and wait for its thread to finish     */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT void cputelem_stop()
+{
+    sysblk.cputelemetry = FALSE;
+
+    if (sysblk.cputelemtid)
+    {
+        join_thread( sysblk.cputelemtid, NULL );
+        sysblk.cputelemtid = 0;
+    }
+}
+
+
 /*-------------------------------------------------------------------*/
 /* TOD clock and timer thread                                        */
 /*                                                                   */
@@ -179,6 +636,7 @@ U64     then;                           /* Previous time of day      */
 U64     diff;                           /* Interval                  */
 U64     halfdiff;                       /* One-half interval         */
 U64     waittime;                       /* Wait time                 */
+U64     lastsamp = 0;                   /* Time of last PSW sample   */
 const U64   period = ETOD_SEC;          /* MIPS calculation period   */
 #if defined( _FEATURE_073_TRANSACT_EXEC_FACILITY )
 bool    txf_PPA;                        /* true == PPA assist needed */
@@ -309,6 +767,14 @@ bool    txf_PPA;                        /* true == PPA assist needed */
 
         } /* end if (diff >= period) */
 
+        /* Take a PSW hot-spot sample if one is due */
+        if (sysblk.pswsample
+            && now - lastsamp >= (U64) sysblk.pswsampint * 1000 * ETOD_USEC)
+        {
+            lastsamp = now;
+            sample_psws();
+        }
+
         /* Sleep for another timer update interval... */
 
 #if defined( _FEATURE_073_TRANSACT_EXEC_FACILITY )
@@ -47,6 +47,10 @@
   #define IFF_ONE_QUEUE   0x2000    /* Use only one packet queue     */
 #endif // !defined(HAVE_LINUX_IF_TUN_H)
 
+#if !defined(IFF_MULTI_QUEUE)
+  #define IFF_MULTI_QUEUE 0x0100    /* One fd per queue (Linux 3.8+) */
+#endif
+
   /* Passed  from ctc_ctci to tuntap to indicate that the interface  */
   /* is configured and that only the interface name is to be set.    */
   #define IFF_NO_HERCIFC  0x10000
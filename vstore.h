@@ -714,6 +714,7 @@ int     len;                            /* Length for page crossing  */
 
     /* Get instruction address */
     ip = MADDRL( addr, 6, USE_INST_SPACE, regs, ACCTYPE_INSTFETCH, regs->psw.pkey );
+    SMC_MARK_CODE( ip );
 
     /* If boundary is crossed then copy instruction to destination */
     if (offset + ILC( ip[0] ) > pagesz)
@@ -726,6 +727,7 @@ int     len;                            /* Length for page crossing  */
         len = pagesz - offset;
         addr = (addr + len) & ADDRESS_MAXWRAP( regs );
         ip = MADDR( addr, USE_INST_SPACE, regs, ACCTYPE_INSTFETCH, regs->psw.pkey );
+        SMC_MARK_CODE( ip );
         if (!exec)
             regs->ip = ip - len;
         memcpy( dest + len, ip, 4 );
@@ -818,6 +820,12 @@ static __inline__ void concpy(REGS *regs, void *d, void *s, int n)
   /* Copy double words on enough length and src - dst distance */
   if(n && labs(u8d - u8s) > 7)
   {
+    /* Longer operands far enough apart go to the SIMD kernels */
+    if(n >= SIMD_MIN_DIST && sysblk.hostsimd && labs(u8d - u8s) >= SIMD_MIN_DIST)
+    {
+      mem_copy(u8d, u8s, n);
+      return;
+    }
     while(n > 7)
     {
       store_dw_noswap(u8d, fetch_dw_noswap(u8s));
@@ -1631,6 +1631,16 @@ DLL_EXPORT void w32_init_hostinfo( HOST_INFO* pHostInfo )
             pHostInfo->fp_unit = 1;
         if ( CPUInfo[3] & 0x03800000 ) /* bit 23 = MMX, 24 = SSE, 25 == SSE2 */
             pHostInfo->vector_unit = 1;
+        if ( CPUInfo[3] & ( 1 << 26 ) )
+            pHostInfo->cpu_sse2 = 1;
+
+        /* AVX2 also needs the OS to save the YMM registers */
+        if ( ( CPUInfo[2] & ( 1 << 27 ) ) && ( _xgetbv( 0 ) & 6 ) == 6 )
+        {
+            __cpuidex( CPUInfo, 7, 0 );
+            if ( CPUInfo[1] & ( 1 << 5 ) )
+                pHostInfo->cpu_avx2 = 1;
+        }
     }
 
     pgnsi = (PGNSI) GetProcAddress( GetModuleHandle(TEXT("kernel32.dll")), "GetNativeSystemInfo");